@@ -45,6 +45,7 @@ class record
     BOOST_MOVABLE_BUT_NOT_COPYABLE(record)
 
     friend class core;
+    friend record aux::make_detached_record(BOOST_RV_REF(attribute_value_set) values);
 
 #ifndef BOOST_LOG_DOXYGEN_PASS
 private:
@@ -37,6 +37,13 @@ BOOST_LOG_OPEN_NAMESPACE
 #ifndef BOOST_LOG_DOXYGEN_PASS
 class core;
 class record;
+
+namespace aux {
+
+//! Creates a log record with the specified attribute values, bypassing the logging core and its filters
+BOOST_LOG_API record make_detached_record(BOOST_RV_REF(attribute_value_set) values);
+
+} // namespace aux
 #endif // BOOST_LOG_DOXYGEN_PASS
 
 /*!
@@ -52,6 +59,7 @@ class record_view
 
     friend class core;
     friend class record;
+    friend record aux::make_detached_record(BOOST_RV_REF(attribute_value_set) values);
 
 #ifndef BOOST_LOG_DOXYGEN_PASS
 private:
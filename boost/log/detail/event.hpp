@@ -64,6 +64,8 @@ public:
 
     //! Waits for the object to become signalled
     BOOST_LOG_API void wait();
+    //! Waits for the object to become signalled for no longer than the specified time, returns \c false on timeout
+    BOOST_LOG_API bool timed_wait(unsigned int milliseconds);
     //! Sets the object to a signalled state
     BOOST_LOG_API void set_signalled();
 
@@ -91,6 +93,8 @@ public:
 
     //! Waits for the object to become signalled
     BOOST_LOG_API void wait();
+    //! Waits for the object to become signalled for no longer than the specified time, returns \c false on timeout
+    BOOST_LOG_API bool timed_wait(unsigned int milliseconds);
     //! Sets the object to a signalled state
     BOOST_LOG_API void set_signalled();
 
@@ -119,6 +123,8 @@ public:
 
     //! Waits for the object to become signalled
     BOOST_LOG_API void wait();
+    //! Waits for the object to become signalled for no longer than the specified time, returns \c false on timeout
+    BOOST_LOG_API bool timed_wait(unsigned int milliseconds);
     //! Sets the object to a signalled state
     BOOST_LOG_API void set_signalled();
 
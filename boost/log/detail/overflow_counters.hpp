@@ -0,0 +1,98 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   overflow_counters.hpp
+ * \author Andrey Semashev
+ * \date   16.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#ifndef BOOST_LOG_DETAIL_OVERFLOW_COUNTERS_HPP_INCLUDED_
+#define BOOST_LOG_DETAIL_OVERFLOW_COUNTERS_HPP_INCLUDED_
+
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#ifndef BOOST_LOG_NO_THREADS
+
+#include <cstddef>
+#include <boost/cstdint.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/sinks/queue_statistics.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+/*!
+ * \brief Overflow statistics of a bounded queue
+ *
+ * Bounded queueing strategies invoke the overflow handling strategy through this class, which
+ * counts the dropped records and the time the logging threads spent blocked. All methods must
+ * be called with the queue mutex locked. The overflow handling strategy only gets invoked
+ * on the slow path, so the counting does not affect the enqueueing performance otherwise.
+ */
+class overflow_counters
+{
+private:
+    //! The number of dropped records
+    uintmax_t m_dropped_count;
+    //! Cumulative time spent in the overflow handling strategy
+    posix_time::time_duration m_block_time;
+
+public:
+    overflow_counters() : m_dropped_count(0), m_block_time(0, 0, 0)
+    {
+    }
+
+    //! Invokes the overflow handling strategy and accounts its outcome
+    template< typename OverflowStrategyT, typename LockT >
+    bool on_overflow(OverflowStrategyT& strategy, record_view const& rec, LockT& lock)
+    {
+        const system_time start = get_system_time();
+        const bool result = strategy.on_overflow(rec, lock);
+        m_block_time += get_system_time() - start;
+        if (!result)
+            ++m_dropped_count;
+        return result;
+    }
+
+    //! Accounts records that were dropped by the queue itself
+    void on_dropped(std::size_t count)
+    {
+        m_dropped_count += count;
+    }
+
+    //! Adds the counters to the statistics
+    void get_statistics(sinks::queue_statistics& stats) const
+    {
+        stats.dropped_count += m_dropped_count;
+        stats.producer_block_time += m_block_time;
+    }
+};
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_NO_THREADS
+
+#endif // BOOST_LOG_DETAIL_OVERFLOW_COUNTERS_HPP_INCLUDED_
@@ -0,0 +1,281 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   queue_waiter.hpp
+ * \author Andrey Semashev
+ * \date   14.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#ifndef BOOST_LOG_DETAIL_QUEUE_WAITER_HPP_INCLUDED_
+#define BOOST_LOG_DETAIL_QUEUE_WAITER_HPP_INCLUDED_
+
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#ifndef BOOST_LOG_NO_THREADS
+
+#include <boost/atomic/atomic.hpp>
+#include <boost/atomic/fences.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/log/detail/event.hpp>
+#include <boost/log/sinks/wait_strategy.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+/*!
+ * Performs one step of waiting for a queue element without blocking. Depending on the strategy
+ * and the number of unsuccessful attempts to dequeue an element made so far, the function either
+ * executes a short CPU pause or yields the time slice of the current thread.
+ */
+BOOST_LOG_API void spin_wait(sinks::wait_strategy const& strategy, unsigned int attempt);
+
+/*!
+ * \brief A helper for lock-free queues that implements the wait strategy of the consumer
+ *
+ * Producers have to call \c notify after every enqueued element. The consumer
+ * waits for elements with \c wait_and_pop.
+ */
+class queue_waiter
+{
+private:
+    //! Wait strategy
+    const sinks::wait_strategy m_strategy;
+    //! The event to block the consumer on
+    event m_event;
+    //! The flag is set when the consumer is going to block, only used with the spin_then_block strategy
+    boost::atomic< bool > m_consumer_blocked;
+
+public:
+    //! Initializing constructor
+    explicit queue_waiter(sinks::wait_strategy const& strategy) :
+        m_strategy(strategy),
+        m_consumer_blocked(false)
+    {
+    }
+
+    //! Returns the wait strategy
+    sinks::wait_strategy const& strategy() const { return m_strategy; }
+
+    //! Wakes the consumer up, if needed. Called by producers after enqueueing an element.
+    void notify()
+    {
+        switch (m_strategy.mode())
+        {
+        case sinks::wait_strategy::block_mode:
+            m_event.set_signalled();
+            break;
+
+        case sinks::wait_strategy::spin_then_block_mode:
+            notify_blocked_consumer();
+            break;
+
+        default:
+            // The consumer polls the queue, no need to wake it up
+            break;
+        }
+    }
+
+    //! Wakes the consumer up unconditionally
+    void interrupt()
+    {
+        m_event.set_signalled();
+    }
+
+    /*!
+     * Attempts to pop an element by calling \a pop on \a obj and waits according to the strategy
+     * if the attempt fails. Returns \c false if the wait was interrupted, the interruption flag is reset in this case.
+     */
+    template< typename T, typename ValueT >
+    bool wait_and_pop(T& obj, bool (T::*pop)(ValueT&), ValueT& value, boost::atomic< bool >& interruption_requested)
+    {
+        for (unsigned int attempt = 0u; true; ++attempt)
+        {
+            if ((obj.*pop)(value))
+                return true;
+
+            if (interruption_requested.load(boost::memory_order_relaxed) && interruption_requested.exchange(false, boost::memory_order_acquire))
+                return false;
+
+            switch (m_strategy.mode())
+            {
+            case sinks::wait_strategy::block_mode:
+                m_event.wait();
+                break;
+
+            case sinks::wait_strategy::timed_batch_mode:
+                m_event.timed_wait(m_strategy.interval_milliseconds());
+                break;
+
+            case sinks::wait_strategy::spin_then_block_mode:
+                if (attempt < m_strategy.spin_count())
+                {
+                    spin_wait(m_strategy, attempt);
+                }
+                else
+                {
+                    // Let producers know they have to wake us up and check the queue once again
+                    // to avoid missing an element that was enqueued before the flag was set
+                    set_consumer_blocked(true);
+                    const bool popped = (obj.*pop)(value);
+                    if (!popped && !interruption_requested.load(boost::memory_order_acquire))
+                        m_event.wait();
+                    set_consumer_blocked(false);
+                    if (popped)
+                        return true;
+                }
+                break;
+
+            default:
+                spin_wait(m_strategy, attempt);
+                break;
+            }
+        }
+    }
+
+private:
+    /*!
+     * Wakes the consumer up if it is blocked. The fence pairs with the one in \c set_consumer_blocked:
+     * either the consumer sees the element pushed by the producer or the producer sees the flag set by the consumer.
+     */
+    void notify_blocked_consumer()
+    {
+        boost::atomic_thread_fence(boost::memory_order_seq_cst);
+        if (m_consumer_blocked.load(boost::memory_order_relaxed))
+            m_event.set_signalled();
+    }
+
+    //! Sets or clears the flag indicating that the consumer is blocked
+    void set_consumer_blocked(bool blocked)
+    {
+        m_consumer_blocked.store(blocked, boost::memory_order_relaxed);
+        if (blocked)
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+    }
+
+    //  Copying prohibited
+    queue_waiter(queue_waiter const&);
+    queue_waiter& operator= (queue_waiter const&);
+};
+
+/*!
+ * \brief A helper for mutex-protected queues that implements the wait strategy of the consumer
+ *
+ * All methods must be called with the queue mutex locked. Producers have to call \c notify
+ * when the queue becomes non-empty. The consumer calls \c wait every time it finds the queue empty.
+ */
+class locked_queue_waiter
+{
+private:
+    //! Wait strategy
+    const sinks::wait_strategy m_strategy;
+    //! Condition to block the consumer on
+    condition_variable m_cond;
+    //! The flag is set when the consumer is blocked on the condition
+    bool m_consumer_blocked;
+
+public:
+    //! Default constructor
+    locked_queue_waiter() : m_consumer_blocked(false)
+    {
+    }
+    //! Initializing constructor
+    explicit locked_queue_waiter(sinks::wait_strategy const& strategy) :
+        m_strategy(strategy),
+        m_consumer_blocked(false)
+    {
+    }
+
+    //! Wakes the consumer up if it is blocked. Called by producers when the queue becomes non-empty.
+    void notify()
+    {
+        if (m_consumer_blocked)
+            m_cond.notify_one();
+    }
+
+    //! Wakes the consumer up unconditionally
+    void interrupt()
+    {
+        m_cond.notify_one();
+    }
+
+    /*!
+     * Waits for new elements according to the strategy. \a attempt is the number of times the consumer
+     * has found the queue empty before this call. The mutex may be unlocked during the wait.
+     */
+    void wait(unique_lock< boost::mutex >& lock, unsigned int attempt)
+    {
+        switch (m_strategy.mode())
+        {
+        case sinks::wait_strategy::block_mode:
+            block(lock);
+            break;
+
+        case sinks::wait_strategy::timed_batch_mode:
+            // Producers don't notify the consumer in this mode
+            m_cond.timed_wait(lock, get_system_time() + m_strategy.interval());
+            break;
+
+        case sinks::wait_strategy::spin_then_block_mode:
+            if (attempt >= m_strategy.spin_count())
+                block(lock);
+            else
+                spin(lock, attempt);
+            break;
+
+        default:
+            spin(lock, attempt);
+            break;
+        }
+    }
+
+private:
+    //! Spins or yields with the mutex unlocked
+    void spin(unique_lock< boost::mutex >& lock, unsigned int attempt)
+    {
+        lock.unlock();
+        spin_wait(m_strategy, attempt);
+        lock.lock();
+    }
+
+    //! Blocks until a producer wakes the consumer up
+    void block(unique_lock< boost::mutex >& lock)
+    {
+        m_consumer_blocked = true;
+        m_cond.wait(lock);
+        m_consumer_blocked = false;
+    }
+
+    //  Copying prohibited
+    locked_queue_waiter(locked_queue_waiter const&);
+    locked_queue_waiter& operator= (locked_queue_waiter const&);
+};
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_NO_THREADS
+
+#endif // BOOST_LOG_DETAIL_QUEUE_WAITER_HPP_INCLUDED_
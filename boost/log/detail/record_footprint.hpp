@@ -0,0 +1,50 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   record_footprint.hpp
+ * \author Andrey Semashev
+ * \date   16.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#ifndef BOOST_LOG_DETAIL_RECORD_FOOTPRINT_HPP_INCLUDED_
+#define BOOST_LOG_DETAIL_RECORD_FOOTPRINT_HPP_INCLUDED_
+
+#include <cstddef>
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+/*!
+ * Returns an estimate of the memory occupied by the log record, in bytes. The estimate includes
+ * a fixed overhead of the record and its attribute values and the length of string attribute values,
+ * including the message. The estimate does not account for dynamic memory owned by other attribute values.
+ */
+BOOST_LOG_API std::size_t estimate_record_footprint(record_view const& rec);
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_DETAIL_RECORD_FOOTPRINT_HPP_INCLUDED_
@@ -0,0 +1,268 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   spsc_queue.hpp
+ * \author Andrey Semashev
+ * \date   12.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#ifndef BOOST_LOG_DETAIL_SPSC_QUEUE_HPP_INCLUDED_
+#define BOOST_LOG_DETAIL_SPSC_QUEUE_HPP_INCLUDED_
+
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#ifndef BOOST_LOG_NO_THREADS
+
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <boost/aligned_storage.hpp>
+#include <boost/atomic/atomic.hpp>
+#include <boost/move/core.hpp>
+#include <boost/move/utility.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+//! Base class for the single producer single consumer queue implementation
+struct spsc_queue_impl
+{
+    struct node_base
+    {
+        boost::atomic< node_base* > next;
+    };
+
+    static BOOST_LOG_API spsc_queue_impl* create(node_base* first_node);
+
+    static BOOST_LOG_API void* operator new (std::size_t size);
+    static BOOST_LOG_API void operator delete (void* p, std::size_t);
+
+    virtual ~spsc_queue_impl() {}
+    virtual node_base* reset_last_node() = 0;
+    virtual bool unsafe_empty() = 0;
+    virtual void push(node_base* p) = 0;
+    virtual bool try_pop(node_base*& node_to_free, node_base*& node_with_value) = 0;
+    virtual void close() = 0;
+    virtual bool is_closed() = 0;
+};
+
+//! A helper class to compose some of the types used by the queue
+template< typename T, typename AllocatorT >
+struct spsc_queue_types
+{
+    struct node :
+        public spsc_queue_impl::node_base
+    {
+        typedef typename aligned_storage< sizeof(T), alignment_of< T >::value >::type storage_type;
+        storage_type storage;
+
+        node() {}
+        explicit node(T const& val) { new (storage.address()) T(val); }
+        T& value() { return *static_cast< T* >(storage.address()); }
+        void destroy() { static_cast< T* >(storage.address())->~T(); }
+    };
+
+    typedef typename AllocatorT::BOOST_NESTED_TEMPLATE rebind< node >::other allocator_type;
+};
+
+/*!
+ * \brief An unbounded single producer single consumer queue
+ *
+ * The queue is a singly linked list with a dummy node, where the producer only modifies
+ * the tail and the consumer only modifies the head of the list. Both \c push and \c try_pop
+ * are wait-free, provided that the allocator is. Unlike \c threadsafe_queue, \c push must
+ * not be called by several threads concurrently, and neither must \c try_pop. The queue
+ * imposes the same requirements on the element type as \c threadsafe_queue.
+ */
+template< typename T, typename AllocatorT = std::allocator< void > >
+class spsc_queue :
+    private spsc_queue_types< T, AllocatorT >::allocator_type
+{
+private:
+    typedef typename spsc_queue_types< T, AllocatorT >::allocator_type base_type;
+    typedef typename spsc_queue_types< T, AllocatorT >::node node;
+
+    //! A simple scope guard to automate memory reclaiming
+    struct auto_deallocate;
+    friend struct auto_deallocate;
+    struct auto_deallocate
+    {
+        auto_deallocate(base_type* alloc, node* dealloc, node* destr) :
+            m_pAllocator(alloc),
+            m_pDeallocate(dealloc),
+            m_pDestroy(destr)
+        {
+        }
+        ~auto_deallocate()
+        {
+            m_pAllocator->deallocate(m_pDeallocate, 1);
+            m_pDestroy->destroy();
+        }
+
+    private:
+        base_type* m_pAllocator;
+        node* m_pDeallocate;
+        node* m_pDestroy;
+    };
+
+public:
+    typedef T value_type;
+    typedef T& reference;
+    typedef T const& const_reference;
+    typedef T* pointer;
+    typedef T const* const_pointer;
+    typedef std::ptrdiff_t difference_type;
+    typedef std::size_t size_type;
+    typedef AllocatorT allocator_type;
+
+public:
+    /*!
+     * Default constructor, creates an empty queue. Unlike most containers,
+     * the constructor requires memory allocation.
+     *
+     * \throw std::bad_alloc if there is not sufficient memory
+     */
+    spsc_queue(base_type const& alloc = base_type()) :
+        base_type(alloc)
+    {
+        node* p = base_type::allocate(1);
+        if (p)
+        {
+            try
+            {
+                new (p) node();
+                try
+                {
+                    m_pImpl = spsc_queue_impl::create(p);
+                }
+                catch (...)
+                {
+                    p->~node();
+                    throw;
+                }
+            }
+            catch (...)
+            {
+                base_type::deallocate(p, 1);
+                throw;
+            }
+        }
+        else
+            throw std::bad_alloc();
+    }
+    /*!
+     * Destructor
+     */
+    ~spsc_queue()
+    {
+        // Clear the queue
+        if (!unsafe_empty())
+        {
+            value_type value;
+            while (try_pop(value));
+        }
+
+        // Remove the last dummy node
+        node* p = static_cast< node* >(m_pImpl->reset_last_node());
+        p->~node();
+        base_type::deallocate(p, 1);
+
+        delete m_pImpl;
+    }
+
+    /*!
+     * Checks if the queue is empty. Only the consumer thread can rely on the result,
+     * and only in the sense that the queue may have become non-empty since the check.
+     */
+    bool unsafe_empty() const { return m_pImpl->unsafe_empty(); }
+
+    /*!
+     * Puts a new element to the end of the queue. Can be called concurrently with
+     * the \c try_pop operation, but not with another \c push.
+     */
+    void push(const_reference value)
+    {
+        node* p = base_type::allocate(1);
+        if (p)
+        {
+            try
+            {
+                new (p) node(value);
+            }
+            catch (...)
+            {
+                base_type::deallocate(p, 1);
+                throw;
+            }
+            m_pImpl->push(p);
+        }
+        else
+            throw std::bad_alloc();
+    }
+
+    /*!
+     * Attempts to pop an element from the beginning of the queue. Can be called
+     * concurrently with the \c push operation, but not with another \c try_pop.
+     */
+    bool try_pop(reference value)
+    {
+        spsc_queue_impl::node_base *dealloc, *destr;
+        if (m_pImpl->try_pop(dealloc, destr))
+        {
+            node* p = static_cast< node* >(destr);
+            auto_deallocate guard(static_cast< base_type* >(this), static_cast< node* >(dealloc), p);
+            value = boost::move(p->value());
+            return true;
+        }
+        else
+            return false;
+    }
+
+    /*!
+     * Marks the queue as closed. Must be called by the producer after the last \c push.
+     */
+    void close() { m_pImpl->close(); }
+
+    /*!
+     * Checks if the queue has been closed by the producer. If the queue is closed, all elements
+     * pushed by the producer are visible to the consumer thread that made the check.
+     */
+    bool is_closed() const { return m_pImpl->is_closed(); }
+
+private:
+    // Copying and assignment is prohibited
+    spsc_queue(spsc_queue const&);
+    spsc_queue& operator= (spsc_queue const&);
+
+private:
+    //! Pointer to the implementation
+    spsc_queue_impl* m_pImpl;
+};
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_NO_THREADS
+
+#endif // BOOST_LOG_DETAIL_SPSC_QUEUE_HPP_INCLUDED_
@@ -0,0 +1,266 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   thread_lanes.hpp
+ * \author Andrey Semashev
+ * \date   15.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#ifndef BOOST_LOG_DETAIL_THREAD_LANES_HPP_INCLUDED_
+#define BOOST_LOG_DETAIL_THREAD_LANES_HPP_INCLUDED_
+
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#ifndef BOOST_LOG_NO_THREADS
+
+#include <cstddef>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/atomic/atomic.hpp>
+#include <boost/atomic/fences.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/log/detail/spsc_queue.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+/*!
+ * \brief A set of single producer single consumer queues, one per producer thread
+ *
+ * Every thread that pushes elements lazily registers its own lane upon the first call
+ * to \c current_queue. The consumer picks up the newly registered lanes with \c accept_new_lanes
+ * and is responsible for reclaiming lanes of the terminated threads, which can be detected with
+ * \c is_orphaned. The lane is closed when its thread terminates.
+ *
+ * A consumer that does not want to poll all lanes can park the lanes it has found empty with
+ * \c try_pop_or_park, provided that the producers use \c push. A producer that pushes an element to
+ * a parked lane unparks it and signals the consumer, which picks up such lanes with \c accept_ready_lanes.
+ */
+template< typename T >
+class thread_lanes
+{
+public:
+    //! Lane queue type
+    typedef spsc_queue< T > queue_type;
+
+private:
+    struct registry;
+
+public:
+    //! The queue of elements pushed by a single thread
+    struct lane
+    {
+        //! Elements pushed by the thread
+        queue_type m_queue;
+        //! The registry that created the lane
+        const shared_ptr< registry > m_pRegistry;
+        //! The flag is set when the consumer has found the lane empty and stopped polling it
+        boost::atomic< bool > m_parked;
+        //! Position of the lane in the list of the consumer, only accessed by the consumer
+        std::size_t m_index;
+
+        explicit lane(shared_ptr< registry > const& reg) : m_pRegistry(reg), m_parked(false), m_index(0)
+        {
+        }
+    };
+
+    typedef shared_ptr< lane > lane_ptr;
+    typedef std::vector< lane_ptr > lane_list;
+
+private:
+    //! The lanes that have been registered by producer threads but not yet picked up by the consumer
+    struct registry
+    {
+        //! Synchronization mutex
+        boost::mutex m_mutex;
+        //! The newly registered lanes
+        lane_list m_new_lanes;
+        //! The flag indicates that m_new_lanes is not empty
+        boost::atomic< bool > m_has_new_lanes;
+        //! The parked lanes that have received new elements
+        lane_list m_ready_lanes;
+        //! The flag indicates that m_ready_lanes is not empty
+        boost::atomic< bool > m_has_ready_lanes;
+
+        registry() : m_has_new_lanes(false), m_has_ready_lanes(false)
+        {
+        }
+    };
+
+private:
+    //! Registry of the new lanes
+    const shared_ptr< registry > m_pRegistry;
+    //! The lane of the current thread
+    thread_specific_ptr< lane_ptr > m_current_lane;
+
+public:
+    //! Default constructor
+    thread_lanes() :
+        m_pRegistry(boost::make_shared< registry >()),
+        m_current_lane(&thread_lanes::close_lane)
+    {
+    }
+    //! Destructor
+    ~thread_lanes()
+    {
+        // Break the reference cycle between the registry and the lanes that were not picked up yet
+        lock_guard< boost::mutex > lock(m_pRegistry->m_mutex);
+        m_pRegistry->m_new_lanes.clear();
+        m_pRegistry->m_ready_lanes.clear();
+    }
+
+    //! Returns the queue of the current thread, registers a new lane if needed
+    queue_type& current_queue()
+    {
+        return current_lane()->m_queue;
+    }
+
+    //! Pushes the element to the lane of the current thread, signals the consumer if the lane is parked
+    void push(T const& value)
+    {
+        lane_ptr const& l = current_lane();
+        l->m_queue.push(value);
+
+        // Pairs with the fence in try_pop_or_park: either the consumer sees the element or we see the lane parked
+        boost::atomic_thread_fence(boost::memory_order_seq_cst);
+        if (l->m_parked.load(boost::memory_order_relaxed) && l->m_parked.exchange(false, boost::memory_order_relaxed))
+        {
+            lock_guard< boost::mutex > lock(m_pRegistry->m_mutex);
+            m_pRegistry->m_ready_lanes.push_back(l);
+            m_pRegistry->m_has_ready_lanes.store(true, boost::memory_order_release);
+        }
+    }
+
+    //! Checks if there are lanes registered since the last call to \c accept_new_lanes
+    bool has_new_lanes() const
+    {
+        return m_pRegistry->m_has_new_lanes.load(boost::memory_order_acquire);
+    }
+
+    //! Moves the newly registered lanes to the end of \a lanes
+    void accept_new_lanes(lane_list& lanes)
+    {
+        lock_guard< boost::mutex > lock(m_pRegistry->m_mutex);
+        lanes.insert(lanes.end(), m_pRegistry->m_new_lanes.begin(), m_pRegistry->m_new_lanes.end());
+        m_pRegistry->m_new_lanes.clear();
+        m_pRegistry->m_has_new_lanes.store(false, boost::memory_order_relaxed);
+    }
+
+    //! Checks if there are parked lanes that have received new elements since the last call to \c accept_ready_lanes
+    bool has_ready_lanes() const
+    {
+        return m_pRegistry->m_has_ready_lanes.load(boost::memory_order_acquire);
+    }
+
+    /*!
+     * Moves the parked lanes that have received new elements to the end of \a lanes. The lanes are unparked.
+     * A lane may be reported more than once and may have been reclaimed by the consumer since it was signalled.
+     */
+    void accept_ready_lanes(lane_list& lanes)
+    {
+        lock_guard< boost::mutex > lock(m_pRegistry->m_mutex);
+        lanes.insert(lanes.end(), m_pRegistry->m_ready_lanes.begin(), m_pRegistry->m_ready_lanes.end());
+        m_pRegistry->m_ready_lanes.clear();
+        m_pRegistry->m_has_ready_lanes.store(false, boost::memory_order_relaxed);
+    }
+
+    /*!
+     * Attempts to pop an element from the lane. If the lane is empty, parks it, so that the producer signals
+     * the consumer when it pushes the next element. Returns \c true if an element was popped.
+     */
+    static bool try_pop_or_park(lane_ptr const& l, T& value)
+    {
+        if (l->m_queue.try_pop(value))
+            return true;
+
+        l->m_parked.store(true, boost::memory_order_relaxed);
+        boost::atomic_thread_fence(boost::memory_order_seq_cst);
+
+        // The producer may have pushed an element before it could see the lane parked
+        if (l->m_queue.try_pop(value))
+        {
+            // If the producer has unparked the lane meanwhile, the lane will be reported ready once more, which is harmless
+            l->m_parked.store(false, boost::memory_order_relaxed);
+            return true;
+        }
+
+        return false;
+    }
+
+    /*!
+     * Checks if the thread that owns the lane has terminated, in which case no more elements will be pushed
+     * to the lane. The check has to be done before popping so that the last pushed elements are not missed.
+     */
+    static bool is_orphaned(lane_ptr const& l)
+    {
+        return l->m_queue.is_closed();
+    }
+
+private:
+    //! Returns the lane of the current thread, registers a new lane if needed
+    lane_ptr const& current_lane()
+    {
+        lane_ptr* p = m_current_lane.get();
+        // The thread may still have a lane of an instance that was destroyed and
+        // occupied the same memory location. Such lanes refer to a different registry.
+        if (!p || (*p)->m_pRegistry != m_pRegistry)
+            p = register_lane();
+        return *p;
+    }
+
+    //! Closes the lane of the terminating thread and releases the thread's reference to it
+    static void close_lane(lane_ptr* p)
+    {
+        (*p)->m_queue.close();
+        delete p;
+    }
+
+    //! Creates and registers a new lane for the current thread
+    lane_ptr* register_lane()
+    {
+        lane_ptr l = boost::make_shared< lane >(m_pRegistry);
+        {
+            lock_guard< boost::mutex > lock(m_pRegistry->m_mutex);
+            m_pRegistry->m_new_lanes.push_back(l);
+            m_pRegistry->m_has_new_lanes.store(true, boost::memory_order_release);
+        }
+        lane_ptr* p = new lane_ptr();
+        p->swap(l);
+        m_current_lane.reset(p);
+        return p;
+    }
+
+    //  Copying prohibited
+    thread_lanes(thread_lanes const&);
+    thread_lanes& operator= (thread_lanes const&);
+};
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_NO_THREADS
+
+#endif // BOOST_LOG_DETAIL_THREAD_LANES_HPP_INCLUDED_
@@ -72,6 +72,9 @@ struct threadsafe_queue_impl
     virtual bool unsafe_empty() = 0;
     virtual void push(node_base* p) = 0;
     virtual bool try_pop(node_base*& node_to_free, node_base*& node_with_value) = 0;
+    virtual node_base* get_free_node() = 0;
+    virtual node_base* release_cached_node() = 0;
+    virtual bool recycle_node(node_base* p) = 0;
 };
 
 //! A helper class to compose some of the types used by the queue
@@ -111,6 +114,12 @@ struct threadsafe_queue_types
  *
  * The last requirement is not mandatory but is crucial for decent performance. In future
  * it may be replaced with Moveable requirement.
+ *
+ * The queue recycles nodes of the popped elements. The consumer returns the nodes to a lock-free
+ * stack, from which the producers replenish their caches of free nodes, so that in the steady state
+ * neither \c push nor \c try_pop call the allocator. Every producer thread has its own cache, which
+ * is returned to the stack when the thread terminates. The number of nodes recycled by the consumer
+ * is limited, so the memory is returned to the allocator after bursts of elements.
  */
 template< typename T, typename AllocatorT = std::allocator< void > >
 class threadsafe_queue :
@@ -125,20 +134,23 @@ private:
     friend struct auto_deallocate;
     struct auto_deallocate
     {
-        auto_deallocate(base_type* alloc, node* dealloc, node* destr) :
+        auto_deallocate(base_type* alloc, threadsafe_queue_impl* impl, node* dealloc, node* destr) :
             m_pAllocator(alloc),
+            m_pImpl(impl),
             m_pDeallocate(dealloc),
             m_pDestroy(destr)
         {
         }
         ~auto_deallocate()
         {
-            m_pAllocator->deallocate(m_pDeallocate, 1);
+            if (!m_pImpl->recycle_node(m_pDeallocate))
+                m_pAllocator->deallocate(m_pDeallocate, 1);
             m_pDestroy->destroy();
         }
 
     private:
         base_type* m_pAllocator;
+        threadsafe_queue_impl* m_pImpl;
         node* m_pDeallocate;
         node* m_pDestroy;
     };
@@ -200,8 +212,13 @@ public:
             while (try_pop(value));
         }
 
+        // Release the nodes cached by producers
+        node* p;
+        while ((p = static_cast< node* >(m_pImpl->release_cached_node())) != NULL)
+            base_type::deallocate(p, 1);
+
         // Remove the last dummy node
-        node* p = static_cast< node* >(m_pImpl->reset_last_node());
+        p = static_cast< node* >(m_pImpl->reset_last_node());
         p->~node();
         base_type::deallocate(p, 1);
 
@@ -219,22 +236,24 @@ public:
      */
     void push(const_reference value)
     {
-        node* p = base_type::allocate(1);
-        if (p)
+        node* p = static_cast< node* >(m_pImpl->get_free_node());
+        if (!p)
         {
-            try
-            {
-                new (p) node(value);
-            }
-            catch (...)
-            {
-                base_type::deallocate(p, 1);
-                throw;
-            }
-            m_pImpl->push(p);
+            p = base_type::allocate(1);
+            if (!p)
+                throw std::bad_alloc();
         }
-        else
-            throw std::bad_alloc();
+
+        try
+        {
+            new (p) node(value);
+        }
+        catch (...)
+        {
+            base_type::deallocate(p, 1);
+            throw;
+        }
+        m_pImpl->push(p);
     }
 
     /*!
@@ -248,7 +267,7 @@ public:
         if (m_pImpl->try_pop(dealloc, destr))
         {
             register node* p = static_cast< node* >(destr);
-            auto_deallocate guard(static_cast< base_type* >(this), static_cast< node* >(dealloc), p);
+            auto_deallocate guard(static_cast< base_type* >(this), m_pImpl, static_cast< node* >(dealloc), p);
             value = boost::move(p->value());
             return true;
         }
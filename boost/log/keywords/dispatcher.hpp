@@ -0,0 +1,40 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   keywords/dispatcher.hpp
+ * \author Andrey Semashev
+ * \date   17.10.2013
+ *
+ * The header contains the \c dispatcher keyword declaration.
+ */
+
+#ifndef BOOST_LOG_KEYWORDS_DISPATCHER_HPP_INCLUDED_
+#define BOOST_LOG_KEYWORDS_DISPATCHER_HPP_INCLUDED_
+
+#include <boost/parameter/keyword.hpp>
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace keywords {
+
+//! The keyword specifies the sink dispatcher that feeds log records to the backend in the asynchronous sink frontend
+BOOST_PARAMETER_KEYWORD(tag, dispatcher)
+
+} // namespace keywords
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#endif // BOOST_LOG_KEYWORDS_DISPATCHER_HPP_INCLUDED_
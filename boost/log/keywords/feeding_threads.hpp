@@ -0,0 +1,40 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   keywords/feeding_threads.hpp
+ * \author Andrey Semashev
+ * \date   13.10.2013
+ *
+ * The header contains the \c feeding_threads keyword declaration.
+ */
+
+#ifndef BOOST_LOG_KEYWORDS_FEEDING_THREADS_HPP_INCLUDED_
+#define BOOST_LOG_KEYWORDS_FEEDING_THREADS_HPP_INCLUDED_
+
+#include <boost/parameter/keyword.hpp>
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace keywords {
+
+//! The keyword specifies the number of threads that feed log records to the backend in the asynchronous sink frontend
+BOOST_PARAMETER_KEYWORD(tag, feeding_threads)
+
+} // namespace keywords
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#endif // BOOST_LOG_KEYWORDS_FEEDING_THREADS_HPP_INCLUDED_
@@ -25,7 +25,15 @@
 #include <boost/log/sinks/async_frontend.hpp>
 #include <boost/log/sinks/unbounded_fifo_queue.hpp>
 #include <boost/log/sinks/unbounded_ordering_queue.hpp>
+#include <boost/log/sinks/per_thread_fifo_queue.hpp>
+#include <boost/log/sinks/per_thread_ordering_queue.hpp>
+#include <boost/log/sinks/wait_strategy.hpp>
+#include <boost/log/sinks/queue_statistics.hpp>
+#include <boost/log/sinks/sink_dispatcher.hpp>
+#include <boost/log/sinks/thread_settings.hpp>
 #include <boost/log/sinks/bounded_fifo_queue.hpp>
+#include <boost/log/sinks/bounded_memory_fifo_queue.hpp>
+#include <boost/log/sinks/bounded_severity_fifo_queue.hpp>
 #include <boost/log/sinks/bounded_ordering_queue.hpp>
 #include <boost/log/sinks/drop_on_overflow.hpp>
 #include <boost/log/sinks/block_on_overflow.hpp>
@@ -0,0 +1,182 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   asio_sink_dispatcher.hpp
+ * \author Andrey Semashev
+ * \date   17.10.2013
+ *
+ * The header contains definition of the sink dispatcher that feeds log records
+ * to the backends of asynchronous sink frontends in the threads of a Boost.ASIO \c io_service.
+ */
+
+#ifndef BOOST_LOG_SINKS_ASIO_SINK_DISPATCHER_HPP_INCLUDED_
+#define BOOST_LOG_SINKS_ASIO_SINK_DISPATCHER_HPP_INCLUDED_
+
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if defined(BOOST_LOG_NO_THREADS)
+#error Boost.Log: This header content is only supported in multithreaded environment
+#endif
+
+#include <boost/bind.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/placeholders.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/log/sinks/sink_dispatcher.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace sinks {
+
+/*!
+ * \brief Sink dispatcher that uses Boost.ASIO \c io_service to feed log records
+ *
+ * The dispatcher does not run threads of its own. Instead, whenever an attached asynchronous sink
+ * frontend has records to process, the dispatcher posts a handler to the user-provided \c io_service
+ * or strand, which feeds one batch of the records to the backend. Handlers are only posted when
+ * a frontend becomes ready, not for every record, and a frontend is served by at most one handler
+ * at a time. This way logging shares the threads of the application and no extra thread wakeups are involved.
+ *
+ * Periodic polling of the attached frontends is implemented with a timer on the \c io_service. The pending timer
+ * keeps the \c io_service busy, so its \c run method will not return while the dispatcher exists and polling
+ * is enabled. Polling can be disabled by specifying a special value, such as <tt>posix_time::pos_infin</tt>,
+ * as the polling interval, if the attached frontends use FIFO queueing strategies.
+ *
+ * The dispatcher must be managed by \c shared_ptr, e.g. created with \c make_shared, before any frontends are attached
+ * to it. Otherwise attaching a frontend fails with \c bad_weak_ptr exception. The dispatcher can be destroyed
+ * while the handlers are still pending, in which case the handlers do nothing. The \c io_service and the strand
+ * must outlive the dispatcher.
+ */
+class asio_sink_dispatcher :
+    public sink_dispatcher,
+    public enable_shared_from_this< asio_sink_dispatcher >
+{
+private:
+    //! The service that runs the handlers
+    asio::io_service& m_IOService;
+    //! The strand to post the handlers through, may be \c NULL
+    asio::io_service::strand* const m_pStrand;
+    //! Polling timer
+    asio::deadline_timer m_PollTimer;
+    //! The flag indicates that polling has been started, protected by the dispatcher lock
+    bool m_PollingStarted;
+    //! The pointer to this dispatcher passed to the handlers, protected by the dispatcher lock
+    weak_ptr< asio_sink_dispatcher > m_pSelf;
+
+public:
+    /*!
+     * Constructor. The handlers are posted directly to the \c io_service.
+     *
+     * \param ios The \c io_service to run the handlers.
+     * \param poll_interval The interval of putting all attached frontends into the ready list. Special values
+     *                      disable polling.
+     */
+    explicit asio_sink_dispatcher(asio::io_service& ios, posix_time::time_duration const& poll_interval = posix_time::milliseconds(50)) :
+        sink_dispatcher(poll_interval),
+        m_IOService(ios),
+        m_pStrand(NULL),
+        m_PollTimer(ios),
+        m_PollingStarted(false)
+    {
+    }
+    /*!
+     * Constructor. The handlers are posted through the strand.
+     *
+     * \param ios The \c io_service the strand belongs to.
+     * \param strand The strand to post the handlers through.
+     * \param poll_interval The interval of putting all attached frontends into the ready list. Special values
+     *                      disable polling.
+     */
+    asio_sink_dispatcher(asio::io_service& ios, asio::io_service::strand& strand, posix_time::time_duration const& poll_interval = posix_time::milliseconds(50)) :
+        sink_dispatcher(poll_interval),
+        m_IOService(ios),
+        m_pStrand(&strand),
+        m_PollTimer(ios),
+        m_PollingStarted(false)
+    {
+    }
+
+    /*!
+     * Returns the \c io_service that runs the handlers
+     */
+    asio::io_service& get_io_service() const { return m_IOService; }
+
+protected:
+    //! Posts a handler to serve the ready frontend
+    void on_client_ready()
+    {
+        // The first call is made when the first frontend is attached, so failing to obtain the pointer is reported to the caller of attach
+        if (m_pSelf.expired())
+            m_pSelf = shared_from_this();
+
+        weak_ptr< asio_sink_dispatcher > const& p = m_pSelf;
+        if (m_pStrand)
+            m_pStrand->post(boost::bind(&asio_sink_dispatcher::serve_handler, p));
+        else
+            m_IOService.post(boost::bind(&asio_sink_dispatcher::serve_handler, p));
+
+        if (!m_PollingStarted && !this->poll_interval().is_special())
+        {
+            // The first frontend is being attached
+            m_PollingStarted = true;
+            start_poll_timer(p);
+        }
+    }
+
+private:
+    //! Starts the polling timer
+    void start_poll_timer(weak_ptr< asio_sink_dispatcher > const& p)
+    {
+        m_PollTimer.expires_from_now(this->poll_interval());
+        m_PollTimer.async_wait(boost::bind(&asio_sink_dispatcher::poll_handler, p, asio::placeholders::error));
+    }
+
+    //! The handler feeds records of one ready frontend
+    static void serve_handler(weak_ptr< asio_sink_dispatcher > const& p)
+    {
+        shared_ptr< asio_sink_dispatcher > dispatcher = p.lock();
+        if (dispatcher)
+            dispatcher->serve_ready_client();
+    }
+
+    //! The polling timer handler
+    static void poll_handler(weak_ptr< asio_sink_dispatcher > const& p, system::error_code const& err)
+    {
+        if (err)
+            return;
+
+        shared_ptr< asio_sink_dispatcher > dispatcher = p.lock();
+        if (dispatcher)
+        {
+            dispatcher->poll_clients();
+            dispatcher->start_poll_timer(p);
+        }
+    }
+};
+
+} // namespace sinks
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_SINKS_ASIO_SINK_DISPATCHER_HPP_INCLUDED_
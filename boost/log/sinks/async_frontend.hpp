@@ -15,9 +15,14 @@
 #ifndef BOOST_LOG_SINKS_ASYNC_FRONTEND_HPP_INCLUDED_
 #define BOOST_LOG_SINKS_ASYNC_FRONTEND_HPP_INCLUDED_
 
+#include <climits>
+#include <cstddef>
+#include <vector>
+#include <boost/cstdint.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/static_assert.hpp>
+#include <boost/mpl/bool.hpp>
 #include <boost/log/detail/config.hpp>
 
 #ifdef BOOST_LOG_HAS_PRAGMA_ONCE
@@ -29,18 +34,34 @@
 #endif
 
 #include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/mpl/has_xxx.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/atomic/atomic.hpp>
+#include <boost/detail/atomic_count.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/log/exceptions.hpp>
 #include <boost/log/detail/locking_ptr.hpp>
+#include <boost/log/detail/fake_mutex.hpp>
+#include <boost/log/detail/spin_mutex.hpp>
 #include <boost/log/detail/parameter_tools.hpp>
 #include <boost/log/core/record_view.hpp>
 #include <boost/log/sinks/basic_sink_frontend.hpp>
 #include <boost/log/sinks/frontend_requirements.hpp>
+#include <boost/log/sinks/queue_statistics.hpp>
+#include <boost/log/sinks/sink_dispatcher.hpp>
+#include <boost/log/sinks/thread_settings.hpp>
 #include <boost/log/sinks/unbounded_fifo_queue.hpp>
 #include <boost/log/keywords/start_thread.hpp>
+#include <boost/log/keywords/dispatcher.hpp>
+#include <boost/log/keywords/batch_size.hpp>
+#include <boost/log/keywords/feeding_threads.hpp>
+#include <boost/log/keywords/ordered_commit.hpp>
+#include <boost/log/keywords/collect_statistics.hpp>
 #include <boost/log/detail/header.hpp>
 
 namespace boost {
@@ -51,6 +72,38 @@ namespace sinks {
 
 #ifndef BOOST_LOG_DOXYGEN_PASS
 
+namespace aux {
+
+//! The trait checks if records in the queueing strategy become ready for processing with time
+BOOST_MPL_HAS_XXX_TRAIT_NAMED_DEF(has_delayed_records, delayed_records_tag, false)
+
+//! The trait checks if the queueing strategy maintains overflow statistics. The member is optional for user-defined strategies.
+template< typename QueueT >
+struct has_overflow_statistics
+{
+private:
+    typedef char yes_type;
+    struct no_type { char dummy[2]; };
+
+    struct fallback { void get_overflow_statistics(); };
+    // The member name is ambiguous in this class if the strategy declares it, regardless of its signature and access
+    struct probe : public QueueT, public fallback {};
+
+    template< typename T, T >
+    struct checker;
+
+    template< typename T >
+    static no_type check(checker< void (fallback::*)(), &T::get_overflow_statistics >*);
+    template< typename T >
+    static yes_type check(...);
+
+public:
+    enum value_t { value = (sizeof(check< probe >(0)) == sizeof(yes_type)) };
+    typedef mpl::bool_< value > type;
+};
+
+} // namespace aux
+
 #define BOOST_LOG_SINK_CTOR_FORWARD_INTERNAL(z, n, types)\
     template< BOOST_PP_ENUM_PARAMS(n, typename T) >\
     explicit asynchronous_sink(BOOST_PP_ENUM_BINARY_PARAMS(n, T, const& arg)) :\
@@ -58,10 +111,21 @@ namespace sinks {
         queue_base_type((BOOST_PP_ENUM_PARAMS(n, arg))),\
         m_pBackend(boost::make_shared< sink_backend_type >(BOOST_PP_ENUM_PARAMS(n, arg))),\
         m_StopRequested(false),\
-        m_FlushRequested(false)\
+        m_FlushRequested(false),\
+        m_IdleNotificationPending(false),\
+        m_FeedingThreadCount((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::feeding_threads | 1u]),\
+        m_OrderedCommit((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::ordered_commit | false]),\
+        m_DequeuedBatchCount(0),\
+        m_CollectStatistics((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::collect_statistics | false]),\
+        m_EnqueuedCount(0),\
+        m_DequeuedCount(0),\
+        m_MaxDepth(0),\
+        m_pDispatcher((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::dispatcher | shared_ptr< sink_dispatcher >()]),\
+        m_DispatchFailed(false),\
+        m_ThreadSettings((BOOST_PP_ENUM_PARAMS(n, arg)))\
     {\
-        if ((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::start_thread | true])\
-            start_feeding_thread();\
+        init_batch((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::batch_size | 1u]);\
+        start_feeding((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::start_thread | true]);\
     }\
     template< BOOST_PP_ENUM_PARAMS(n, typename T) >\
     explicit asynchronous_sink(shared_ptr< sink_backend_type > const& backend, BOOST_PP_ENUM_BINARY_PARAMS(n, T, const& arg)) :\
@@ -69,10 +133,21 @@ namespace sinks {
         queue_base_type((BOOST_PP_ENUM_PARAMS(n, arg))),\
         m_pBackend(backend),\
         m_StopRequested(false),\
-        m_FlushRequested(false)\
+        m_FlushRequested(false),\
+        m_IdleNotificationPending(false),\
+        m_FeedingThreadCount((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::feeding_threads | 1u]),\
+        m_OrderedCommit((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::ordered_commit | false]),\
+        m_DequeuedBatchCount(0),\
+        m_CollectStatistics((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::collect_statistics | false]),\
+        m_EnqueuedCount(0),\
+        m_DequeuedCount(0),\
+        m_MaxDepth(0),\
+        m_pDispatcher((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::dispatcher | shared_ptr< sink_dispatcher >()]),\
+        m_DispatchFailed(false),\
+        m_ThreadSettings((BOOST_PP_ENUM_PARAMS(n, arg)))\
     {\
-        if ((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::start_thread | true])\
-            start_feeding_thread();\
+        init_batch((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::batch_size | 1u]);\
+        start_feeding((BOOST_PP_ENUM_PARAMS(n, arg))[keywords::start_thread | true]);\
     }
 
 #endif // BOOST_LOG_DOXYGEN_PASS
@@ -82,6 +157,13 @@ namespace sinks {
  *
  * The frontend starts a separate thread on construction. All logging records are passed
  * to the backend in this dedicated thread only.
+ *
+ * Alternatively, the frontend can be attached to a \c sink_dispatcher with the \c dispatcher named parameter
+ * of the constructor. In this case no dedicated thread is started, and the records are passed to the backend
+ * in the threads of the dispatcher, which may be shared with other frontends. If the backend throws an exception
+ * in a dispatcher thread and the exception is not suppressed by the exception handler, the frontend stops accepting
+ * new records. The exception is rethrown from the following call to \c flush, after which the frontend resumes
+ * normal operation.
  */
 template< typename SinkBackendT, typename QueueingStrategyT = unbounded_fifo_queue >
 class asynchronous_sink :
@@ -177,6 +259,173 @@ private:
         scoped_flag& operator= (scoped_flag const&);
     };
 
+    //! A scope guard that releases the records of the fed batch
+    class scoped_batch
+    {
+    private:
+        record_view* m_pRecords;
+        std::size_t m_Count;
+
+    public:
+        scoped_batch(record_view* records, std::size_t count) : m_pRecords(records), m_Count(count)
+        {
+        }
+        ~scoped_batch()
+        {
+            for (std::size_t i = 0; i < m_Count; ++i)
+                m_pRecords[i].reset();
+        }
+
+    private:
+        scoped_batch(scoped_batch const&);
+        scoped_batch& operator= (scoped_batch const&);
+    };
+
+    //! Completion tracking of the record batches dequeued by the feeding thread pool
+    class commit_sequencer
+    {
+    private:
+        boost::mutex m_Mutex;
+        condition_variable m_Cond;
+        //! The number of completed batches
+        uintmax_t m_CompletedCount;
+
+    public:
+        commit_sequencer() : m_CompletedCount(0)
+        {
+        }
+
+        //! Blocks until all batches dequeued before the batch with the specified ticket are completed
+        void wait_turn(uintmax_t ticket)
+        {
+            unique_lock< boost::mutex > lock(m_Mutex);
+            while (m_CompletedCount != ticket)
+                m_Cond.wait(lock);
+        }
+        //! Blocks until the specified number of batches are completed
+        void wait_completed(uintmax_t count)
+        {
+            unique_lock< boost::mutex > lock(m_Mutex);
+            while (m_CompletedCount < count)
+                m_Cond.wait(lock);
+        }
+        //! Marks a batch completed
+        void complete()
+        {
+            lock_guard< boost::mutex > lock(m_Mutex);
+            ++m_CompletedCount;
+            m_Cond.notify_all();
+        }
+
+    private:
+        commit_sequencer(commit_sequencer const&);
+        commit_sequencer& operator= (commit_sequencer const&);
+    };
+
+    //! A scope guard that marks a record batch completed on destructor
+    class scoped_completion
+    {
+    private:
+        commit_sequencer& m_Sequencer;
+
+    public:
+        explicit scoped_completion(commit_sequencer& seq) : m_Sequencer(seq)
+        {
+        }
+        ~scoped_completion()
+        {
+            try
+            {
+                m_Sequencer.complete();
+            }
+            catch (...)
+            {
+            }
+        }
+
+    private:
+        scoped_completion(scoped_completion const&);
+        scoped_completion& operator= (scoped_completion const&);
+    };
+
+    /*!
+     * A lock adapter for the backend mutex that only lets the lock to be acquired when all
+     * batches dequeued earlier have been passed to the backend. The turn is kept until the
+     * adapter is destroyed, so the backend mutex can be locked several times for one batch.
+     */
+    class ordered_commit_lock
+    {
+    private:
+        commit_sequencer& m_Sequencer;
+        backend_mutex_type& m_BackendMutex;
+        const uintmax_t m_Ticket;
+        bool m_HasTurn;
+
+    public:
+        ordered_commit_lock(commit_sequencer& seq, backend_mutex_type& mut, uintmax_t ticket) :
+            m_Sequencer(seq), m_BackendMutex(mut), m_Ticket(ticket), m_HasTurn(false)
+        {
+        }
+        ~ordered_commit_lock()
+        {
+            try
+            {
+                boost::this_thread::disable_interruption no_interrupts;
+                // Even if the batch was not passed to the backend (e.g. due to formatting errors), wait for our turn
+                // so that the subsequent batches are not committed prematurely
+                if (!m_HasTurn)
+                    m_Sequencer.wait_turn(m_Ticket);
+                m_Sequencer.complete();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        void lock()
+        {
+            if (!m_HasTurn)
+            {
+                m_Sequencer.wait_turn(m_Ticket);
+                m_HasTurn = true;
+            }
+            m_BackendMutex.lock();
+        }
+        void unlock()
+        {
+            m_BackendMutex.unlock();
+        }
+
+    private:
+        ordered_commit_lock(ordered_commit_lock const&);
+        ordered_commit_lock& operator= (ordered_commit_lock const&);
+    };
+
+    //! The adapter that lets the sink dispatcher feed records of the frontend
+    class dispatcher_client :
+        public sink_dispatcher::client
+    {
+    private:
+        asynchronous_sink* m_pSink;
+
+    public:
+        dispatcher_client() :
+            sink_dispatcher::client(aux::has_delayed_records< QueueingStrategyT >::value),
+            m_pSink(NULL)
+        {
+        }
+        void set_sink(asynchronous_sink* sink)
+        {
+            m_pSink = sink;
+        }
+
+    protected:
+        bool dispatch_records()
+        {
+            return m_pSink->dispatch_records();
+        }
+    };
+
 public:
     //! Sink implementation type
     typedef SinkBackendT sink_backend_type;
@@ -214,6 +463,53 @@ private:
     //! The flag indicates that queue flush has been requested
     volatile bool m_FlushRequested; // TODO: make it a real atomic
 
+    //! Buffer for the records being fed to the backend, only accessed by the feeding thread
+    std::vector< record_view > m_Batch;
+    //! The flag indicates that records have been fed since the backend was last notified of the queue becoming empty.
+    //! Only accessed by the feeding thread or, in the feeding thread pool, with m_DequeueMutex locked.
+    bool m_IdleNotificationPending;
+
+    //! The number of threads feeding records to the backend
+    const unsigned int m_FeedingThreadCount;
+    //! The flag indicates that the feeding threads have to pass records to the backend in the queue order
+    const bool m_OrderedCommit;
+    //! The mutex serializes dequeueing records by the feeding threads
+    boost::mutex m_DequeueMutex;
+    //! The number of record batches dequeued by the feeding threads, protected by m_DequeueMutex
+    uintmax_t m_DequeuedBatchCount;
+    //! Completion tracking of the dequeued record batches
+    commit_sequencer m_CommitSequencer;
+    //! The exception thrown in an additional thread of the feeding thread pool, protected by the frontend mutex
+    boost::exception_ptr m_FeedingPoolError;
+
+    //! The flag indicates that the frontend collects queue statistics
+    const bool m_CollectStatistics;
+    //! The number of records passed to the queue, only maintained when statistics collection is enabled
+    boost::detail::atomic_count m_EnqueuedCount;
+    //! The mutex protects the feeding statistics
+    boost::log::aux::spin_mutex m_StatisticsMutex;
+    //! The number of records extracted from the queue
+    uintmax_t m_DequeuedCount;
+    //! The maximum observed queue depth
+    uintmax_t m_MaxDepth;
+    //! Cumulative time spent passing records to the backend
+    posix_time::time_duration m_FeedingBusyTime;
+    //! Cumulative time spent waiting for new records
+    posix_time::time_duration m_FeedingIdleTime;
+
+    //! The dispatcher that feeds records to the backend instead of a dedicated thread
+    const shared_ptr< sink_dispatcher > m_pDispatcher;
+    //! The frontend adapter for the dispatcher
+    dispatcher_client m_DispatcherClient;
+    //! The exception thrown while the dispatcher was feeding records, protected by the frontend mutex
+    boost::exception_ptr m_DispatchError;
+    //! The flag indicates that the dispatcher failed to feed records and the frontend does not accept new records.
+    //! The flag is modified with the frontend mutex locked, the exception is only accessed under the mutex.
+    boost::atomic< bool > m_DispatchFailed;
+
+    //! Settings of the threads created by the frontend
+    const thread_settings m_ThreadSettings;
+
 public:
     /*!
      * Default constructor. Constructs the sink backend instance.
@@ -228,10 +524,19 @@ public:
         base_type(true),
         m_pBackend(boost::make_shared< sink_backend_type >()),
         m_StopRequested(false),
-        m_FlushRequested(false)
+        m_FlushRequested(false),
+        m_IdleNotificationPending(false),
+        m_FeedingThreadCount(1u),
+        m_OrderedCommit(false),
+        m_DequeuedBatchCount(0),
+        m_CollectStatistics(false),
+        m_EnqueuedCount(0),
+        m_DequeuedCount(0),
+        m_MaxDepth(0),
+        m_DispatchFailed(false)
     {
-        if (start_thread)
-            start_feeding_thread();
+        init_batch(1u);
+        start_feeding(start_thread);
     }
     /*!
      * Constructor attaches user-constructed backend instance
@@ -248,21 +553,32 @@ public:
         base_type(true),
         m_pBackend(backend),
         m_StopRequested(false),
-        m_FlushRequested(false)
+        m_FlushRequested(false),
+        m_IdleNotificationPending(false),
+        m_FeedingThreadCount(1u),
+        m_OrderedCommit(false),
+        m_DequeuedBatchCount(0),
+        m_CollectStatistics(false),
+        m_EnqueuedCount(0),
+        m_DequeuedCount(0),
+        m_MaxDepth(0),
+        m_DispatchFailed(false)
     {
-        if (start_thread)
-            start_feeding_thread();
+        init_batch(1u);
+        start_feeding(start_thread);
     }
 
     // Constructors that pass arbitrary parameters to the backend constructor
     BOOST_LOG_PARAMETRIZED_CONSTRUCTORS_GEN(BOOST_LOG_SINK_CTOR_FORWARD_INTERNAL, ~)
 
     /*!
-     * Destructor. Implicitly stops the dedicated feeding thread, if one is running.
+     * Destructor. Implicitly stops the dedicated feeding thread, if one is running, or detaches the frontend from the dispatcher.
      */
     ~asynchronous_sink()
     {
         boost::this_thread::disable_interruption no_interrupts;
+        if (m_pDispatcher)
+            m_pDispatcher->detach(m_DispatcherClient);
         stop();
     }
 
@@ -281,6 +597,8 @@ public:
      */
     void consume(record_view const& rec)
     {
+        if (m_DispatchFailed.load(boost::memory_order_relaxed))
+            return;
         if (m_FlushRequested)
         {
             unique_lock< frontend_mutex_type > lock(base_type::frontend_mutex());
@@ -288,7 +606,11 @@ public:
             while (m_FlushRequested)
                 m_BlockCond.wait(lock);
         }
+        if (m_CollectStatistics)
+            ++m_EnqueuedCount;
         queue_base_type::enqueue(rec);
+        if (m_pDispatcher)
+            m_DispatcherClient.notify();
     }
 
     /*!
@@ -296,12 +618,21 @@ public:
      */
     bool try_consume(record_view const& rec)
     {
-        if (!m_FlushRequested)
+        if (!m_FlushRequested && !m_DispatchFailed.load(boost::memory_order_relaxed))
         {
-            return queue_base_type::try_enqueue(rec);
+            if (m_CollectStatistics)
+                ++m_EnqueuedCount;
+            if (queue_base_type::try_enqueue(rec))
+            {
+                if (m_pDispatcher)
+                    m_DispatcherClient.notify();
+                return true;
+            }
+            if (m_CollectStatistics)
+                --m_EnqueuedCount;
         }
-        else
-            return false;
+
+        return false;
     }
 
     /*!
@@ -311,6 +642,9 @@ public:
      * \li an exception is thrown while processing a log record in the backend, and the exception is
      *     not terminated by the exception handler, if one is installed
      *
+     * If the frontend was constructed with more than one feeding thread, the method spawns the additional
+     * threads and joins them before returning.
+     *
      * \pre The sink frontend must be constructed without spawning a dedicated thread
      */
     void run()
@@ -318,6 +652,12 @@ public:
         // First check that no other thread is running
         scoped_thread_id guard(base_type::frontend_mutex(), m_BlockCond, m_FeedingThreadID, m_StopRequested);
 
+        if (m_FeedingThreadCount > 1u)
+        {
+            run_feeding_pool();
+            return;
+        }
+
         // Now start the feeding loop
         while (true)
         {
@@ -326,8 +666,11 @@ public:
             {
                 // Block until new record is available
                 record_view rec;
-                if (queue_base_type::dequeue_ready(rec))
-                    base_type::feed_record(rec, m_BackendMutex, *m_pBackend);
+                if (wait_for_record(rec))
+                {
+                    feed_batch(&rec, 1u, m_BackendMutex);
+                    m_IdleNotificationPending = true;
+                }
             }
             else
                 break;
@@ -378,11 +721,14 @@ public:
      */
     void feed_records()
     {
-        // First check that no other thread is running
-        scoped_thread_id guard(base_type::frontend_mutex(), m_BlockCond, m_FeedingThreadID, m_StopRequested);
+        {
+            // First check that no other thread is running
+            scoped_thread_id guard(base_type::frontend_mutex(), m_BlockCond, m_FeedingThreadID, m_StopRequested);
 
-        // Now start the feeding loop
-        do_feed_records();
+            // Now start the feeding loop
+            do_feed_records();
+        }
+        reschedule_dispatch();
     }
 
     /*!
@@ -390,39 +736,169 @@ public:
      * Unlike \c feed_records, in case of ordering queueing the method also feeds records
      * that were enqueued during the ordering window, attempting to empty the queue completely.
      *
+     * If the frontend is attached to a dispatcher and feeding records has failed with an exception,
+     * the method rethrows the exception instead of flushing the records.
+     *
      * \pre The sink frontend must be constructed without spawning a dedicated thread
      */
     void flush()
     {
         unique_lock< frontend_mutex_type > lock(base_type::frontend_mutex());
+        rethrow_dispatch_error();
         if (m_FeedingThreadID != thread::id() || m_DedicatedFeedingThread.joinable())
         {
-            // There is already a thread feeding records, let it do the job
+            // There is already a thread feeding records, let it do the job. A dispatcher thread
+            // may finish serving the frontend without noticing the request, in which case we flush ourselves.
             m_FlushRequested = true;
             queue_base_type::interrupt_dequeue();
-            while (!m_StopRequested && m_FlushRequested)
+            while (!m_StopRequested && m_FlushRequested && (m_FeedingThreadID != thread::id() || m_DedicatedFeedingThread.joinable()))
                 m_BlockCond.wait(lock);
 
             // The condition may have been signalled when the feeding thread was finishing.
             // In that case records may not have been flushed, and we do the flush ourselves.
             if (m_FeedingThreadID != thread::id())
                 return;
+
+            rethrow_dispatch_error();
         }
 
         m_FlushRequested = true;
 
-        // Flush records ourselves. The guard releases the lock.
-        scoped_thread_id guard(lock, m_BlockCond, m_FeedingThreadID, m_StopRequested);
+        {
+            // Flush records ourselves. The guard releases the lock.
+            scoped_thread_id guard(lock, m_BlockCond, m_FeedingThreadID, m_StopRequested);
+
+            do_feed_records();
+        }
+        reschedule_dispatch();
+    }
 
-        do_feed_records();
+    /*!
+     * The method returns statistics of the record queue. The number of dropped records and the time logging threads
+     * spent blocked are maintained by the bounded queueing strategies. The rest of the counters are only maintained
+     * if the frontend was constructed with the \c collect_statistics named parameter set to \c true, otherwise they
+     * are zero. The method can be called concurrently with logging and record feeding.
+     */
+    queue_statistics get_statistics()
+    {
+        queue_statistics stats;
+        get_overflow_statistics(stats);
+        if (m_CollectStatistics)
+        {
+            const unsigned long enqueued_count = static_cast< unsigned long >(static_cast< long >(m_EnqueuedCount));
+            lock_guard< boost::log::aux::spin_mutex > lock(m_StatisticsMutex);
+            stats.depth = get_queue_depth(enqueued_count, m_DequeuedCount, stats.dropped_count);
+            if (stats.depth > m_MaxDepth)
+                m_MaxDepth = stats.depth;
+            stats.max_depth = m_MaxDepth;
+            stats.dequeued_count = m_DequeuedCount;
+            stats.enqueued_count = m_DequeuedCount + stats.dropped_count + stats.depth;
+            stats.feeding_busy_time = m_FeedingBusyTime;
+            stats.feeding_idle_time = m_FeedingIdleTime;
+        }
+
+        return stats;
     }
 
 private:
 #ifndef BOOST_LOG_DOXYGEN_PASS
+    //! The method attaches the frontend to the dispatcher or, if there is none, optionally spawns record feeding thread
+    void start_feeding(bool start_thread)
+    {
+        if (m_pDispatcher)
+        {
+            m_DispatcherClient.set_sink(this);
+            m_pDispatcher->attach(m_DispatcherClient);
+        }
+        else if (start_thread)
+            start_feeding_thread();
+    }
+
     //! The method spawns record feeding thread
     void start_feeding_thread()
     {
-        boost::thread(boost::bind(&asynchronous_sink::run, this)).swap(m_DedicatedFeedingThread);
+        boost::thread(boost::bind(&asynchronous_sink::run_dedicated_thread, this)).swap(m_DedicatedFeedingThread);
+    }
+
+    //! The dedicated record feeding thread function
+    void run_dedicated_thread()
+    {
+        m_ThreadSettings.apply();
+        run();
+    }
+
+    //! Rethrows the exception that made the dispatcher stop feeding records, if any. Must be called with the frontend mutex locked.
+    void rethrow_dispatch_error()
+    {
+        if (m_DispatchFailed.load(boost::memory_order_relaxed))
+        {
+            boost::exception_ptr error = m_DispatchError;
+            m_DispatchError = boost::exception_ptr();
+            m_DispatchFailed.store(false, boost::memory_order_relaxed);
+            m_FlushRequested = false;
+            m_BlockCond.notify_all();
+            boost::rethrow_exception(error);
+        }
+    }
+
+    /*!
+     * Schedules the frontend in the dispatcher after records were fed by a user's thread. A dispatcher thread
+     * may have skipped the frontend in the meantime, and records enqueued since then would otherwise wait
+     * for the next record to be logged.
+     */
+    void reschedule_dispatch()
+    {
+        if (m_pDispatcher)
+            m_DispatcherClient.notify();
+    }
+
+    //! Feeds one batch of ready records on behalf of the dispatcher. Returns \c true if there may be more records ready.
+    bool dispatch_records()
+    {
+        unique_lock< frontend_mutex_type > lock(base_type::frontend_mutex());
+        if (m_FeedingThreadID != thread::id())
+        {
+            // Records are being fed by another thread, e.g. the one that called flush. The thread reschedules
+            // the frontend when it finishes, so the dispatcher does not need to poll the frontend meanwhile.
+            return false;
+        }
+
+        scoped_thread_id guard(lock, m_BlockCond, m_FeedingThreadID, m_StopRequested);
+        try
+        {
+            if (m_FlushRequested)
+            {
+                do_feed_records();
+                return false;
+            }
+
+            record_view* const batch = &m_Batch[0];
+            const std::size_t batch_size = m_Batch.size();
+            register std::size_t count = 0;
+            while (count < batch_size && queue_base_type::try_dequeue_ready(batch[count]))
+                ++count;
+
+            if (count > 0)
+            {
+                scoped_batch batch_guard(batch, count);
+                feed_batch(batch, count, m_BackendMutex);
+                m_IdleNotificationPending = true;
+            }
+
+            if (count < batch_size)
+                notify_idle();
+
+            return count == batch_size;
+        }
+        catch (...)
+        {
+            // The exception was not suppressed by the exception handler. Stop accepting records
+            // so that the queue does not grow while nobody feeds it, the exception will be rethrown from flush().
+            lock_guard< frontend_mutex_type > error_lock(base_type::frontend_mutex());
+            m_DispatchError = boost::current_exception();
+            m_DispatchFailed.store(true, boost::memory_order_relaxed);
+            return false;
+        }
     }
 
     // locking_ptr_counter_base methods
@@ -430,30 +906,317 @@ private:
     bool try_lock() { return m_BackendMutex.try_lock(); }
     void unlock() { m_BackendMutex.unlock(); }
 
+    //! The method prepares the buffer for batched record feeding
+    void init_batch(std::size_t batch_size)
+    {
+        m_Batch.resize(batch_size > 0u ? batch_size : static_cast< std::size_t >(1u));
+    }
+
     //! The record feeding loop
     void do_feed_records()
     {
+        record_view* const batch = &m_Batch[0];
+        const std::size_t batch_size = m_Batch.size();
         while (!m_StopRequested)
         {
-            record_view rec;
-            register bool dequeued = false;
+            // Collect the records that are readily available, up to the batch size
+            register std::size_t count = 0;
             if (!m_FlushRequested)
-                dequeued = queue_base_type::try_dequeue_ready(rec);
+            {
+                while (count < batch_size && queue_base_type::try_dequeue_ready(batch[count]))
+                    ++count;
+            }
             else
-                dequeued = queue_base_type::try_dequeue(rec);
+            {
+                while (count < batch_size && queue_base_type::try_dequeue(batch[count]))
+                    ++count;
+            }
 
-            if (dequeued)
-                base_type::feed_record(rec, m_BackendMutex, *m_pBackend);
-            else
+            if (count > 0)
+            {
+                scoped_batch guard(batch, count);
+                feed_batch(batch, count, m_BackendMutex);
+                m_IdleNotificationPending = true;
+            }
+
+            if (count < batch_size)
+            {
+                // The queue has no more records ready. The backend is flushed instead of notified if requested.
+                if (!m_FlushRequested)
+                    notify_idle();
                 break;
+            }
         }
 
         if (m_FlushRequested)
         {
             scoped_flag guard(base_type::frontend_mutex(), m_BlockCond, m_FlushRequested);
+            m_IdleNotificationPending = false;
             base_type::flush_backend(m_BackendMutex, *m_pBackend);
         }
     }
+
+    //! Notifies the backend that the queue has no more records ready, if records have been fed since the last notification
+    void notify_idle()
+    {
+        if (m_IdleNotificationPending)
+        {
+            m_IdleNotificationPending = false;
+            base_type::notify_backend_idle(m_BackendMutex, *m_pBackend);
+        }
+    }
+
+    //! Passes the batch of records to the backend, using the specified mutex for synchronization
+    template< typename MutexT >
+    void feed_batch(record_view* records, std::size_t count, MutexT& mut)
+    {
+        if (!m_CollectStatistics)
+        {
+            feed_batch_to_backend(records, count, mut);
+            return;
+        }
+
+        account_dequeued_records(count);
+        const system_time start = get_system_time();
+        try
+        {
+            feed_batch_to_backend(records, count, mut);
+        }
+        catch (...)
+        {
+            account_feeding_time(get_system_time() - start, m_FeedingBusyTime);
+            throw;
+        }
+        account_feeding_time(get_system_time() - start, m_FeedingBusyTime);
+    }
+
+    //! Passes the batch of records to the backend
+    template< typename MutexT >
+    void feed_batch_to_backend(record_view* records, std::size_t count, MutexT& mut)
+    {
+        if (count == 1)
+            base_type::feed_record(records[0], mut, *m_pBackend);
+        else
+            base_type::feed_batch(records, count, mut, *m_pBackend);
+    }
+
+    //! Blocks until a record is available in the queue, accounts the waiting time in the statistics
+    bool wait_for_record(record_view& rec)
+    {
+        if (!m_CollectStatistics)
+            return queue_base_type::dequeue_ready(rec);
+
+        const system_time start = get_system_time();
+        const bool result = queue_base_type::dequeue_ready(rec);
+        account_feeding_time(get_system_time() - start, m_FeedingIdleTime);
+        return result;
+    }
+
+    //! Accounts the records extracted from the queue and samples the queue depth
+    void account_dequeued_records(std::size_t count)
+    {
+        queue_statistics overflow_stats;
+        get_overflow_statistics(overflow_stats);
+        const unsigned long enqueued_count = static_cast< unsigned long >(static_cast< long >(m_EnqueuedCount));
+
+        lock_guard< boost::log::aux::spin_mutex > lock(m_StatisticsMutex);
+        // The sampled depth includes the records that have just been extracted
+        const uintmax_t depth = get_queue_depth(enqueued_count, m_DequeuedCount, overflow_stats.dropped_count);
+        if (depth > m_MaxDepth)
+            m_MaxDepth = depth;
+        m_DequeuedCount += count;
+    }
+
+    //! Fills the dropped records and blocking time counters maintained by the queueing strategy
+    void get_overflow_statistics(queue_statistics& stats)
+    {
+        get_overflow_statistics(stats, typename aux::has_overflow_statistics< queue_base_type >::type());
+    }
+    void get_overflow_statistics(queue_statistics& stats, mpl::true_)
+    {
+        queue_base_type::get_overflow_statistics(stats);
+    }
+    static void get_overflow_statistics(queue_statistics&, mpl::false_)
+    {
+        // The strategy does not report dropped records or blocking time, the counters remain zero
+    }
+
+    //! Adds the time spent by a feeding thread to the specified counter
+    void account_feeding_time(posix_time::time_duration const& time, posix_time::time_duration& counter)
+    {
+        lock_guard< boost::log::aux::spin_mutex > lock(m_StatisticsMutex);
+        counter += time;
+    }
+
+    //! Computes the number of records in the queue
+    static uintmax_t get_queue_depth(unsigned long enqueued_count, uintmax_t dequeued_count, uintmax_t dropped_count)
+    {
+        // The enqueued records counter may wrap around, so the difference is computed modulo the counter range.
+        // The counters are updated without synchronization with each other, so the difference may also be negative.
+        const unsigned long depth = enqueued_count - static_cast< unsigned long >(dequeued_count + dropped_count);
+        return depth <= static_cast< unsigned long >(LONG_MAX) ? static_cast< uintmax_t >(depth) : static_cast< uintmax_t >(0u);
+    }
+
+    //! The method runs the feeding loop in a pool of threads, the current thread being one of them
+    void run_feeding_pool()
+    {
+        thread_group workers;
+        try
+        {
+            for (unsigned int i = 1u; i < m_FeedingThreadCount; ++i)
+                workers.create_thread(boost::bind(&asynchronous_sink::run_feeding_worker_thread, this));
+
+            run_feeding_worker();
+        }
+        catch (...)
+        {
+            // Make the other threads leave the feeding loop
+            boost::this_thread::disable_interruption no_interrupts;
+            {
+                lock_guard< frontend_mutex_type > lock(base_type::frontend_mutex());
+                m_StopRequested = true;
+                queue_base_type::interrupt_dequeue();
+            }
+            workers.join_all();
+            m_FeedingPoolError = boost::exception_ptr();
+            throw;
+        }
+
+        workers.join_all();
+
+        // Rethrow the exception that terminated the additional threads, if any
+        if (m_FeedingPoolError)
+        {
+            boost::exception_ptr error = m_FeedingPoolError;
+            m_FeedingPoolError = boost::exception_ptr();
+            boost::rethrow_exception(error);
+        }
+    }
+
+    //! The function of the additional threads of the feeding thread pool
+    void run_feeding_worker_thread()
+    {
+        try
+        {
+            m_ThreadSettings.apply();
+            run_feeding_worker();
+        }
+        catch (...)
+        {
+            // Stop the other threads, the exception will be rethrown from the thread that called run()
+            lock_guard< frontend_mutex_type > lock(base_type::frontend_mutex());
+            if (!m_FeedingPoolError)
+                m_FeedingPoolError = boost::current_exception();
+            m_StopRequested = true;
+            queue_base_type::interrupt_dequeue();
+        }
+    }
+
+    //! The record feeding loop of a thread in the feeding thread pool
+    void run_feeding_worker()
+    {
+        std::vector< record_view > batch(m_Batch.size());
+        while (true)
+        {
+            register std::size_t count = 0;
+            uintmax_t ticket = 0;
+            {
+                // Dequeueing is serialized, so that the batch tickets reflect the queue order
+                lock_guard< boost::mutex > lock(m_DequeueMutex);
+                if (m_StopRequested)
+                    break;
+
+                if (m_FlushRequested)
+                {
+                    flush_feeding_pool(batch);
+                    continue;
+                }
+
+                // Block until new record is available and pick up the other records that are ready.
+                // The wait is done with the mutex locked so that no other thread dequeues records before
+                // the ticket is taken. The other threads block on the mutex meanwhile, and stop() and flush()
+                // rely on interrupt_dequeue() to wake the waiting thread, which then checks the flags.
+                if (!queue_base_type::try_dequeue_ready(batch[0]))
+                {
+                    if (m_IdleNotificationPending)
+                    {
+                        // The queue has become empty, notify the backend after the records being fed by other threads
+                        m_IdleNotificationPending = false;
+                        m_CommitSequencer.wait_completed(m_DequeuedBatchCount);
+                        base_type::notify_backend_idle(m_BackendMutex, *m_pBackend);
+                        continue;
+                    }
+
+                    if (!wait_for_record(batch[0]))
+                        continue;
+                }
+
+                count = 1;
+                while (count < batch.size() && queue_base_type::try_dequeue_ready(batch[count]))
+                    ++count;
+
+                ticket = m_DequeuedBatchCount++;
+                m_IdleNotificationPending = true;
+            }
+
+            // Formatting is done in parallel with other feeding threads
+            feed_pool_batch(&batch[0], count, ticket);
+        }
+    }
+
+    //! Feeds the remaining records and flushes the backend. Must be called with m_DequeueMutex locked.
+    void flush_feeding_pool(std::vector< record_view >& batch)
+    {
+        scoped_flag guard(base_type::frontend_mutex(), m_BlockCond, m_FlushRequested);
+
+        while (!m_StopRequested)
+        {
+            register std::size_t count = 0;
+            while (count < batch.size() && queue_base_type::try_dequeue(batch[count]))
+                ++count;
+
+            if (count == 0)
+                break;
+
+            feed_pool_batch(&batch[0], count, m_DequeuedBatchCount++);
+        }
+
+        // Wait for the records that are being fed by other threads
+        m_CommitSequencer.wait_completed(m_DequeuedBatchCount);
+
+        m_IdleNotificationPending = false;
+        base_type::flush_backend(m_BackendMutex, *m_pBackend);
+    }
+
+    //! Passes a batch of records dequeued by a thread of the feeding thread pool to the backend
+    void feed_pool_batch(record_view* records, std::size_t count, uintmax_t ticket)
+    {
+        scoped_batch guard(records, count);
+        if (m_OrderedCommit)
+        {
+            ordered_commit_lock commit_lock(m_CommitSequencer, m_BackendMutex, ticket);
+            feed_batch(records, count, commit_lock);
+        }
+        else
+        {
+            scoped_completion completion(m_CommitSequencer);
+            typedef typename sink_backend_type::frontend_requirements frontend_requirements;
+            feed_pool_batch_unordered(records, count, typename has_requirement< frontend_requirements, concurrent_feeding >::type());
+        }
+    }
+
+    //! Passes a batch of records to the backend that supports concurrent feeding
+    void feed_pool_batch_unordered(record_view* records, std::size_t count, mpl::true_)
+    {
+        boost::log::aux::fake_mutex m;
+        feed_batch(records, count, m);
+    }
+
+    //! Passes a batch of records to the backend that requires synchronized feeding
+    void feed_pool_batch_unordered(record_view* records, std::size_t count, mpl::false_)
+    {
+        feed_batch(records, count, m_BackendMutex);
+    }
 #endif // BOOST_LOG_DOXYGEN_PASS
 };
 
@@ -15,6 +15,8 @@
 #ifndef BOOST_LOG_SINKS_BASIC_SINK_FRONTEND_HPP_INCLUDED_
 #define BOOST_LOG_SINKS_BASIC_SINK_FRONTEND_HPP_INCLUDED_
 
+#include <cstddef>
+#include <vector>
 #include <boost/mpl/bool.hpp>
 #include <boost/log/detail/config.hpp>
 #include <boost/log/detail/cleanup_scope_guard.hpp>
@@ -162,24 +164,8 @@ protected:
     template< typename BackendMutexT, typename BackendT >
     void feed_record(record_view const& rec, BackendMutexT& backend_mutex, BackendT& backend)
     {
-        try
-        {
-            BOOST_LOG_EXPR_IF_MT(boost::log::aux::exclusive_lock_guard< BackendMutexT > lock(backend_mutex);)
-            backend.consume(rec);
-        }
-#if !defined(BOOST_LOG_NO_THREADS)
-        catch (thread_interrupted&)
-        {
-            throw;
-        }
-#endif
-        catch (...)
-        {
-            BOOST_LOG_EXPR_IF_MT(boost::log::aux::shared_lock_guard< mutex_type > lock(m_Mutex);)
-            if (m_ExceptionHandler.empty())
-                throw;
-            m_ExceptionHandler();
-        }
+        do_feed_record(rec, backend_mutex, backend);
+        commit_backend(backend);
     }
 
     //! Attempts to feeds log record to the backend, does not block if \a backend_mutex is locked
@@ -207,12 +193,59 @@ protected:
             this->exception_handler()();
         }
 #endif
-        // No need to lock anything in the feed_record method
+        // No need to lock anything in the do_feed_record method
         boost::log::aux::fake_mutex m;
-        feed_record(rec, m, backend);
+        do_feed_record(rec, m, backend);
+        // The backend must be unlocked while the record is being committed
+        BOOST_LOG_EXPR_IF_MT(lock.unlock();)
+        commit_backend(backend);
         return true;
     }
 
+    //! Feeds log record to the backend without committing it
+    template< typename BackendMutexT, typename BackendT >
+    void do_feed_record(record_view const& rec, BackendMutexT& backend_mutex, BackendT& backend)
+    {
+        try
+        {
+            BOOST_LOG_EXPR_IF_MT(boost::log::aux::exclusive_lock_guard< BackendMutexT > lock(backend_mutex);)
+            backend.consume(rec);
+        }
+#if !defined(BOOST_LOG_NO_THREADS)
+        catch (thread_interrupted&)
+        {
+            throw;
+        }
+#endif
+        catch (...)
+        {
+            BOOST_LOG_EXPR_IF_MT(boost::log::aux::shared_lock_guard< mutex_type > lock(m_Mutex);)
+            if (m_ExceptionHandler.empty())
+                throw;
+            m_ExceptionHandler();
+        }
+    }
+
+    //! Feeds a batch of log records to the backend under a single lock of \a backend_mutex
+    template< typename BackendMutexT, typename BackendT >
+    void feed_batch(record_view* records, std::size_t count, BackendMutexT& backend_mutex, BackendT& backend)
+    {
+        do_feed_batch(record_batch(records), count, backend_mutex, backend);
+        commit_backend(backend);
+    }
+
+    /*!
+     * Feeds a batch of log records to the backend without committing it. The  batch object passes
+     * either the whole batch or a single record of it to the backend, depending on whether the backend accepts batches.
+     */
+    template< typename BatchT, typename BackendMutexT, typename BackendT >
+    void do_feed_batch(BatchT const& batch, std::size_t count, BackendMutexT& backend_mutex, BackendT& backend)
+    {
+        typedef typename BackendT::frontend_requirements frontend_requirements;
+        do_feed_batch_impl(batch, count, backend_mutex, backend,
+            typename has_requirement< frontend_requirements, batched_records >::type());
+    }
+
     //! Flushes record buffers in the backend, if one supports it
     template< typename BackendMutexT, typename BackendT >
     void flush_backend(BackendMutexT& backend_mutex, BackendT& backend)
@@ -222,7 +255,98 @@ protected:
             typename has_requirement< frontend_requirements, flushing >::type());
     }
 
+    //! Notifies the backend that there are no more records ready for feeding, if one wants to know
+    template< typename BackendMutexT, typename BackendT >
+    void notify_backend_idle(BackendMutexT& backend_mutex, BackendT& backend)
+    {
+        typedef typename BackendT::frontend_requirements frontend_requirements;
+        notify_backend_idle_impl(backend_mutex, backend,
+            typename has_requirement< frontend_requirements, idle_notification >::type());
+    }
+
+    //! Waits for the fed records to be committed by the backend, if one supports it. Must be called with the backend unlocked.
+    template< typename BackendT >
+    void commit_backend(BackendT& backend)
+    {
+        typedef typename BackendT::frontend_requirements frontend_requirements;
+        commit_backend_impl(backend,
+            typename has_requirement< frontend_requirements, committing >::type());
+    }
+
 private:
+    //! A batch of log records to be fed to the backend
+    struct record_batch
+    {
+        record_view const* m_Records;
+
+        explicit record_batch(record_view const* records) : m_Records(records) {}
+
+        template< typename BackendT >
+        void consume(BackendT& backend, std::size_t count) const
+        {
+            backend.consume(m_Records, count);
+        }
+        template< typename BackendT >
+        void consume_one(BackendT& backend, std::size_t index) const
+        {
+            backend.consume(m_Records[index]);
+        }
+    };
+
+    //! Feeds a batch of log records to the backend (for backends that accept batches)
+    template< typename BatchT, typename BackendMutexT, typename BackendT >
+    void do_feed_batch_impl(BatchT const& batch, std::size_t count, BackendMutexT& backend_mutex, BackendT& backend, mpl::true_)
+    {
+        try
+        {
+            BOOST_LOG_EXPR_IF_MT(boost::log::aux::exclusive_lock_guard< BackendMutexT > lock(backend_mutex);)
+            batch.consume(backend, count);
+        }
+#if !defined(BOOST_LOG_NO_THREADS)
+        catch (thread_interrupted&)
+        {
+            throw;
+        }
+#endif
+        catch (...)
+        {
+            BOOST_LOG_EXPR_IF_MT(boost::log::aux::shared_lock_guard< mutex_type > lock(m_Mutex);)
+            if (m_ExceptionHandler.empty())
+                throw;
+            m_ExceptionHandler();
+        }
+    }
+    //! Feeds a batch of log records to the backend (for backends that consume records one by one)
+    template< typename BatchT, typename BackendMutexT, typename BackendT >
+    void do_feed_batch_impl(BatchT const& batch, std::size_t count, BackendMutexT& backend_mutex, BackendT& backend, mpl::false_)
+    {
+        std::size_t i = 0;
+        while (i < count)
+        {
+            try
+            {
+                BOOST_LOG_EXPR_IF_MT(boost::log::aux::exclusive_lock_guard< BackendMutexT > lock(backend_mutex);)
+                for (; i < count; ++i)
+                    batch.consume_one(backend, i);
+            }
+#if !defined(BOOST_LOG_NO_THREADS)
+            catch (thread_interrupted&)
+            {
+                throw;
+            }
+#endif
+            catch (...)
+            {
+                // Skip the failed record and continue with the rest of the batch after the exception is handled
+                ++i;
+                BOOST_LOG_EXPR_IF_MT(boost::log::aux::shared_lock_guard< mutex_type > lock(m_Mutex);)
+                if (m_ExceptionHandler.empty())
+                    throw;
+                m_ExceptionHandler();
+            }
+        }
+    }
+
     //! Flushes record buffers in the backend (the actual implementation)
     template< typename BackendMutexT, typename BackendT >
     void flush_backend_impl(BackendMutexT& backend_mutex, BackendT& backend, mpl::true_)
@@ -251,6 +375,63 @@ private:
     void flush_backend_impl(BackendMutexT&, BackendT&, mpl::false_)
     {
     }
+
+    //! Notifies the backend that there are no more records ready for feeding (the actual implementation)
+    template< typename BackendMutexT, typename BackendT >
+    void notify_backend_idle_impl(BackendMutexT& backend_mutex, BackendT& backend, mpl::true_)
+    {
+        try
+        {
+            BOOST_LOG_EXPR_IF_MT(boost::log::aux::exclusive_lock_guard< BackendMutexT > lock(backend_mutex);)
+            backend.on_idle();
+        }
+#if !defined(BOOST_LOG_NO_THREADS)
+        catch (thread_interrupted&)
+        {
+            throw;
+        }
+#endif
+        catch (...)
+        {
+            BOOST_LOG_EXPR_IF_MT(boost::log::aux::shared_lock_guard< mutex_type > lock(m_Mutex);)
+            if (m_ExceptionHandler.empty())
+                throw;
+            m_ExceptionHandler();
+        }
+    }
+    //! Notifies the backend that there are no more records ready for feeding (stub for backends that don't want to know)
+    template< typename BackendMutexT, typename BackendT >
+    void notify_backend_idle_impl(BackendMutexT&, BackendT&, mpl::false_)
+    {
+    }
+
+    //! Waits for the fed records to be committed by the backend
+    template< typename BackendT >
+    void commit_backend_impl(BackendT& backend, mpl::true_)
+    {
+        try
+        {
+            backend.commit();
+        }
+#if !defined(BOOST_LOG_NO_THREADS)
+        catch (thread_interrupted&)
+        {
+            throw;
+        }
+#endif
+        catch (...)
+        {
+            BOOST_LOG_EXPR_IF_MT(boost::log::aux::shared_lock_guard< mutex_type > lock(m_Mutex);)
+            if (m_ExceptionHandler.empty())
+                throw;
+            m_ExceptionHandler();
+        }
+    }
+    //! Waits for the fed records to be committed by the backend (stub for backends that don't support committing)
+    template< typename BackendT >
+    void commit_backend_impl(BackendT&, mpl::false_)
+    {
+    }
 };
 
 //! A base class for a logging sink frontend with formatting support
@@ -278,6 +459,26 @@ protected:
 #endif
 
 private:
+    //! A batch of formatted log records to be fed to the backend
+    struct formatted_record_batch
+    {
+        record_view const* m_Records;
+        string_type const* m_Messages;
+
+        formatted_record_batch(record_view const* records, string_type const* messages) : m_Records(records), m_Messages(messages) {}
+
+        template< typename BackendT >
+        void consume(BackendT& backend, std::size_t count) const
+        {
+            backend.consume(m_Records, m_Messages, count);
+        }
+        template< typename BackendT >
+        void consume_one(BackendT& backend, std::size_t index) const
+        {
+            backend.consume(m_Records[index], m_Messages[index]);
+        }
+    };
+
     struct formatting_context
     {
 #if !defined(BOOST_LOG_NO_THREADS)
@@ -290,6 +491,8 @@ private:
         stream_type m_FormattingStream;
         //! Formatter functor
         formatter_type m_Formatter;
+        //! Formatted log records of the batch being fed
+        std::vector< string_type > m_FormattedBatch;
 
         formatting_context() :
 #if !defined(BOOST_LOG_NO_THREADS)
@@ -415,21 +618,49 @@ protected:
     template< typename BackendMutexT, typename BackendT >
     void feed_record(record_view const& rec, BackendMutexT& backend_mutex, BackendT& backend)
     {
-        formatting_context* context;
+        do_feed_record(rec, backend_mutex, backend);
+        this->commit_backend(backend);
+    }
 
+    //! Attempts to feeds log record to the backend, does not block if \a backend_mutex is locked
+    template< typename BackendMutexT, typename BackendT >
+    bool try_feed_record(record_view const& rec, BackendMutexT& backend_mutex, BackendT& backend)
+    {
 #if !defined(BOOST_LOG_NO_THREADS)
-        context = m_pContext.get();
-        if (!context || context->m_Version != m_Version)
+        unique_lock< BackendMutexT > lock;
+        try
         {
-            {
-                boost::log::aux::shared_lock_guard< mutex_type > lock(this->frontend_mutex());
-                context = new formatting_context(m_Version, m_Locale, m_Formatter);
-            }
-            m_pContext.reset(context);
+            unique_lock< BackendMutexT > tmp_lock(backend_mutex, try_to_lock);
+            if (!tmp_lock.owns_lock())
+                return false;
+            lock.swap(tmp_lock);
+        }
+        catch (thread_interrupted&)
+        {
+            throw;
+        }
+        catch (...)
+        {
+            boost::log::aux::shared_lock_guard< mutex_type > frontend_lock(this->frontend_mutex());
+            if (this->exception_handler().empty())
+                throw;
+            this->exception_handler()();
         }
-#else
-        context = &m_Context;
 #endif
+        // No need to lock anything in the do_feed_record method
+        boost::log::aux::fake_mutex m;
+        do_feed_record(rec, m, backend);
+        // The backend must be unlocked while the record is being committed
+        BOOST_LOG_EXPR_IF_MT(lock.unlock();)
+        this->commit_backend(backend);
+        return true;
+    }
+
+    //! Formats log record and feeds it to the backend without committing it
+    template< typename BackendMutexT, typename BackendT >
+    void do_feed_record(record_view const& rec, BackendMutexT& backend_mutex, BackendT& backend)
+    {
+        formatting_context* context = get_formatting_context();
 
         boost::log::aux::cleanup_guard< stream_type > cleanup1(context->m_FormattingStream);
         boost::log::aux::cleanup_guard< string_type > cleanup2(context->m_FormattedRecord);
@@ -459,35 +690,72 @@ protected:
         }
     }
 
-    //! Attempts to feeds log record to the backend, does not block if \a backend_mutex is locked
+    //! Formats a batch of log records and feeds them to the backend under a single lock of \a backend_mutex
     template< typename BackendMutexT, typename BackendT >
-    bool try_feed_record(record_view const& rec, BackendMutexT& backend_mutex, BackendT& backend)
+    void feed_batch(record_view* records, std::size_t count, BackendMutexT& backend_mutex, BackendT& backend)
     {
-#if !defined(BOOST_LOG_NO_THREADS)
-        unique_lock< BackendMutexT > lock;
-        try
+        formatting_context* context = get_formatting_context();
+        std::vector< string_type >& messages = context->m_FormattedBatch;
+        if (messages.size() < count)
+            messages.resize(count);
+
+        // Format all records first. Records that fail to be formatted are excluded from the batch.
+        std::size_t formatted_count = 0;
+        for (std::size_t i = 0; i < count; ++i)
         {
-            unique_lock< BackendMutexT > tmp_lock(backend_mutex, try_to_lock);
-            if (!tmp_lock.owns_lock())
-                return false;
-            lock.swap(tmp_lock);
-        }
-        catch (thread_interrupted&)
-        {
-            throw;
+            boost::log::aux::cleanup_guard< stream_type > cleanup1(context->m_FormattingStream);
+            boost::log::aux::cleanup_guard< string_type > cleanup2(context->m_FormattedRecord);
+
+            try
+            {
+                context->m_Formatter(records[i], context->m_FormattingStream);
+                context->m_FormattingStream.flush();
+
+                // Swapping the strings lets both keep their allocated storage between batches
+                context->m_FormattedRecord.swap(messages[formatted_count]);
+                if (formatted_count != i)
+                    records[formatted_count].swap(records[i]);
+                ++formatted_count;
+            }
+#if !defined(BOOST_LOG_NO_THREADS)
+            catch (thread_interrupted&)
+            {
+                throw;
+            }
+#endif
+            catch (...)
+            {
+                BOOST_LOG_EXPR_IF_MT(boost::log::aux::shared_lock_guard< mutex_type > lock(this->frontend_mutex());)
+                if (this->exception_handler().empty())
+                    throw;
+                this->exception_handler()();
+            }
         }
-        catch (...)
+
+        if (formatted_count > 0)
+            this->do_feed_batch(formatted_record_batch(records, &messages[0]), formatted_count, backend_mutex, backend);
+
+        this->commit_backend(backend);
+    }
+
+private:
+    //! Returns the formatting context for the current thread, updates it if the formatting settings have changed
+    formatting_context* get_formatting_context()
+    {
+#if !defined(BOOST_LOG_NO_THREADS)
+        formatting_context* context = m_pContext.get();
+        if (!context || context->m_Version != m_Version)
         {
-            boost::log::aux::shared_lock_guard< mutex_type > frontend_lock(this->frontend_mutex());
-            if (this->exception_handler().empty())
-                throw;
-            this->exception_handler()();
+            {
+                boost::log::aux::shared_lock_guard< mutex_type > lock(this->frontend_mutex());
+                context = new formatting_context(m_Version, m_Locale, m_Formatter);
+            }
+            m_pContext.reset(context);
         }
+        return context;
+#else
+        return &m_Context;
 #endif
-        // No need to lock anything in the feed_record method
-        boost::log::aux::fake_mutex m;
-        feed_record(rec, m, backend);
-        return true;
     }
 };
 
@@ -30,8 +30,12 @@
 #include <queue>
 #include <boost/thread/locks.hpp>
 #include <boost/thread/mutex.hpp>
-#include <boost/thread/condition_variable.hpp>
 #include <boost/log/core/record_view.hpp>
+#include <boost/log/detail/overflow_counters.hpp>
+#include <boost/log/detail/queue_waiter.hpp>
+#include <boost/log/sinks/queue_statistics.hpp>
+#include <boost/log/sinks/wait_strategy.hpp>
+#include <boost/log/keywords/wait_strategy.hpp>
 #include <boost/log/detail/header.hpp>
 
 namespace boost {
@@ -69,10 +73,12 @@ private:
 private:
     //! Synchronization primitive
     mutex_type m_mutex;
-    //! Condition to block the consuming thread on
-    condition_variable m_cond;
     //! Log record queue
     queue_type m_queue;
+    //! Implements the wait strategy of the consuming thread
+    boost::log::aux::locked_queue_waiter m_waiter;
+    //! Overflow statistics
+    boost::log::aux::overflow_counters m_overflow_counters;
     //! Interruption flag
     bool m_interruption_requested;
 
@@ -83,7 +89,9 @@ protected:
     }
     //! Initializing constructor
     template< typename ArgsT >
-    explicit bounded_fifo_queue(ArgsT const&) : m_interruption_requested(false)
+    explicit bounded_fifo_queue(ArgsT const& args) :
+        m_waiter(args[keywords::wait_strategy | wait_strategy()]),
+        m_interruption_requested(false)
     {
     }
 
@@ -94,13 +102,13 @@ protected:
         std::size_t size = m_queue.size();
         for (; size >= MaxQueueSizeV; size = m_queue.size())
         {
-            if (!overflow_strategy::on_overflow(rec, lock))
+            if (!m_overflow_counters.on_overflow(static_cast< overflow_strategy& >(*this), rec, lock))
                 return;
         }
 
         m_queue.push(rec);
         if (size == 0)
-            m_cond.notify_one();
+            m_waiter.notify();
     }
 
     //! Attempts to enqueue log record to the queue
@@ -116,7 +124,7 @@ protected:
             {
                 m_queue.push(rec);
                 if (size == 0)
-                    m_cond.notify_one();
+                    m_waiter.notify();
                 return true;
             }
         }
@@ -139,8 +147,8 @@ protected:
         {
             rec.swap(m_queue.front());
             m_queue.pop();
-            if (size == MaxQueueSizeV)
-                overflow_strategy::on_queue_space_available();
+            // Every dequeued record lets one blocked thread proceed, even if the queue was not full at this point
+            overflow_strategy::on_queue_space_available();
             return true;
         }
 
@@ -152,20 +160,20 @@ protected:
     {
         unique_lock< mutex_type > lock(m_mutex);
 
-        while (!m_interruption_requested)
+        for (unsigned int attempt = 0u; !m_interruption_requested; ++attempt)
         {
             const std::size_t size = m_queue.size();
             if (size > 0)
             {
                 rec.swap(m_queue.front());
                 m_queue.pop();
-                if (size == MaxQueueSizeV)
-                    overflow_strategy::on_queue_space_available();
+                // Every dequeued record lets one blocked thread proceed, even if the queue was not full at this point
+                overflow_strategy::on_queue_space_available();
                 return true;
             }
             else
             {
-                m_cond.wait(lock);
+                m_waiter.wait(lock, attempt);
             }
         }
         m_interruption_requested = false;
@@ -173,13 +181,20 @@ protected:
         return false;
     }
 
+    //! Adds the overflow statistics of the queue to \a stats
+    void get_overflow_statistics(queue_statistics& stats)
+    {
+        lock_guard< mutex_type > lock(m_mutex);
+        m_overflow_counters.get_statistics(stats);
+    }
+
     //! Wakes a thread possibly blocked in the \c dequeue method
     void interrupt_dequeue()
     {
         lock_guard< mutex_type > lock(m_mutex);
         m_interruption_requested = true;
         overflow_strategy::interrupt();
-        m_cond.notify_one();
+        m_waiter.interrupt();
     }
 };
 
@@ -0,0 +1,224 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   bounded_memory_fifo_queue.hpp
+ * \author Andrey Semashev
+ * \date   16.10.2013
+ *
+ * The header contains implementation of memory-bounded FIFO queueing strategy for
+ * the asynchronous sink frontend.
+ */
+
+#ifndef BOOST_LOG_SINKS_BOUNDED_MEMORY_FIFO_QUEUE_HPP_INCLUDED_
+#define BOOST_LOG_SINKS_BOUNDED_MEMORY_FIFO_QUEUE_HPP_INCLUDED_
+
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if defined(BOOST_LOG_NO_THREADS)
+#error Boost.Log: This header content is only supported in multithreaded environment
+#endif
+
+#include <cstddef>
+#include <queue>
+#include <utility>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/detail/overflow_counters.hpp>
+#include <boost/log/detail/queue_waiter.hpp>
+#include <boost/log/detail/record_footprint.hpp>
+#include <boost/log/sinks/queue_statistics.hpp>
+#include <boost/log/sinks/wait_strategy.hpp>
+#include <boost/log/keywords/wait_strategy.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace sinks {
+
+/*!
+ * \brief Memory-bounded FIFO log record queueing strategy
+ *
+ * The \c bounded_memory_fifo_queue class is intended to be used with
+ * the \c asynchronous_sink frontend as a log record queueing strategy.
+ *
+ * The strategy is similar to \c bounded_fifo_queue, except that the queue capacity is specified
+ * as the amount of memory the queued records may occupy, in bytes, rather than the number of records.
+ * The memory footprint of every record is estimated upon enqueueing. The estimate includes the length
+ * of the message and other string attribute values, as well as a fixed overhead per record and
+ * per attribute value. Memory owned by attribute values of other types is not accounted for.
+ *
+ * When enqueueing a record would exceed the capacity, the overflow handling strategy specified in
+ * the \c OverflowStrategyT template parameter is invoked, same as with \c bounded_fifo_queue.
+ * A record that is larger than the whole capacity is only accepted when the queue is empty.
+ *
+ * The log record queue imposes no ordering over the queued
+ * elements aside from the order in which they are enqueued.
+ */
+template< std::size_t MaxQueueMemoryV, typename OverflowStrategyT >
+class bounded_memory_fifo_queue :
+    private OverflowStrategyT
+{
+private:
+    typedef OverflowStrategyT overflow_strategy;
+    typedef std::queue< std::pair< record_view, std::size_t > > queue_type;
+    typedef boost::mutex mutex_type;
+
+private:
+    //! Synchronization primitive
+    mutex_type m_mutex;
+    //! Log record queue, along with the estimated record sizes
+    queue_type m_queue;
+    //! Estimated memory footprint of the queued records
+    std::size_t m_size;
+    //! Implements the wait strategy of the consuming thread
+    boost::log::aux::locked_queue_waiter m_waiter;
+    //! Overflow statistics
+    boost::log::aux::overflow_counters m_overflow_counters;
+    //! Interruption flag
+    bool m_interruption_requested;
+
+protected:
+    //! Default constructor
+    bounded_memory_fifo_queue() : m_size(0), m_interruption_requested(false)
+    {
+    }
+    //! Initializing constructor
+    template< typename ArgsT >
+    explicit bounded_memory_fifo_queue(ArgsT const& args) :
+        m_size(0),
+        m_waiter(args[keywords::wait_strategy | wait_strategy()]),
+        m_interruption_requested(false)
+    {
+    }
+
+    //! Enqueues log record to the queue
+    void enqueue(record_view const& rec)
+    {
+        const std::size_t footprint = boost::log::aux::estimate_record_footprint(rec);
+        unique_lock< mutex_type > lock(m_mutex);
+        while (!has_room(footprint))
+        {
+            if (!m_overflow_counters.on_overflow(static_cast< overflow_strategy& >(*this), rec, lock))
+                return;
+        }
+
+        push(rec, footprint);
+    }
+
+    //! Attempts to enqueue log record to the queue
+    bool try_enqueue(record_view const& rec)
+    {
+        const std::size_t footprint = boost::log::aux::estimate_record_footprint(rec);
+        unique_lock< mutex_type > lock(m_mutex, try_to_lock);
+        if (lock.owns_lock())
+        {
+            // Do not invoke the bounding strategy in case of overflow as it may block
+            if (has_room(footprint))
+            {
+                push(rec, footprint);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //! Attempts to dequeue a log record ready for processing from the queue, does not block if the queue is empty
+    bool try_dequeue_ready(record_view& rec)
+    {
+        return try_dequeue(rec);
+    }
+
+    //! Attempts to dequeue log record from the queue, does not block if the queue is empty
+    bool try_dequeue(record_view& rec)
+    {
+        lock_guard< mutex_type > lock(m_mutex);
+        return pop(rec);
+    }
+
+    //! Dequeues log record from the queue, blocks if the queue is empty
+    bool dequeue_ready(record_view& rec)
+    {
+        unique_lock< mutex_type > lock(m_mutex);
+
+        for (unsigned int attempt = 0u; !m_interruption_requested; ++attempt)
+        {
+            if (pop(rec))
+                return true;
+            else
+                m_waiter.wait(lock, attempt);
+        }
+        m_interruption_requested = false;
+
+        return false;
+    }
+
+    //! Adds the overflow statistics of the queue to \a stats
+    void get_overflow_statistics(queue_statistics& stats)
+    {
+        lock_guard< mutex_type > lock(m_mutex);
+        m_overflow_counters.get_statistics(stats);
+    }
+
+    //! Wakes a thread possibly blocked in the \c dequeue method
+    void interrupt_dequeue()
+    {
+        lock_guard< mutex_type > lock(m_mutex);
+        m_interruption_requested = true;
+        overflow_strategy::interrupt();
+        m_waiter.interrupt();
+    }
+
+private:
+    //! Checks if a record of the specified size fits into the queue. Must be called with the mutex locked.
+    bool has_room(std::size_t footprint) const
+    {
+        return m_queue.empty() || (m_size <= MaxQueueMemoryV && footprint <= MaxQueueMemoryV - m_size);
+    }
+
+    //! Puts the record to the queue. Must be called with the mutex locked.
+    void push(record_view const& rec, std::size_t footprint)
+    {
+        const bool was_empty = m_queue.empty();
+        m_queue.push(std::make_pair(rec, footprint));
+        m_size += footprint;
+        if (was_empty)
+            m_waiter.notify();
+    }
+
+    //! Extracts the record from the queue. Must be called with the mutex locked.
+    bool pop(record_view& rec)
+    {
+        if (m_queue.empty())
+            return false;
+
+        rec.swap(m_queue.front().first);
+        m_size -= m_queue.front().second;
+        m_queue.pop();
+
+        // A single dequeued record may free enough memory for any of the blocked threads
+        overflow_strategy::on_queue_space_available();
+        return true;
+    }
+};
+
+} // namespace sinks
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_SINKS_BOUNDED_MEMORY_FIFO_QUEUE_HPP_INCLUDED_
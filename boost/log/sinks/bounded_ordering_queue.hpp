@@ -41,6 +41,8 @@
 #include <boost/log/keywords/order.hpp>
 #include <boost/log/keywords/ordering_window.hpp>
 #include <boost/log/core/record_view.hpp>
+#include <boost/log/detail/overflow_counters.hpp>
+#include <boost/log/sinks/queue_statistics.hpp>
 #include <boost/log/detail/header.hpp>
 
 namespace boost {
@@ -144,10 +146,15 @@ private:
     condition_variable m_cond;
     //! Log record queue
     queue_type m_queue;
+    //! Overflow statistics
+    boost::log::aux::overflow_counters m_overflow_counters;
     //! Interruption flag
     bool m_interruption_requested;
 
 public:
+    //! The tag indicates that queued records become ready for processing with time
+    typedef void delayed_records_tag;
+
     /*!
      * Returns ordering window size specified during initialization
      */
@@ -189,7 +196,7 @@ protected:
         std::size_t size = m_queue.size();
         for (; size >= MaxQueueSizeV; size = m_queue.size())
         {
-            if (!overflow_strategy::on_overflow(rec, lock))
+            if (!m_overflow_counters.on_overflow(static_cast< overflow_strategy& >(*this), rec, lock))
                 return;
         }
 
@@ -233,8 +240,8 @@ protected:
                 // We got a new element
                 rec = elem.m_record;
                 m_queue.pop();
-                if (size == MaxQueueSizeV)
-                    overflow_strategy::on_queue_space_available();
+                // Every dequeued record lets one blocked thread proceed, even if the queue was not full at this point
+                overflow_strategy::on_queue_space_available();
                 return true;
             }
         }
@@ -252,8 +259,8 @@ protected:
             enqueued_record const& elem = m_queue.top();
             rec = elem.m_record;
             m_queue.pop();
-            if (size == MaxQueueSizeV)
-                overflow_strategy::on_queue_space_available();
+            // Every dequeued record lets one blocked thread proceed, even if the queue was not full at this point
+            overflow_strategy::on_queue_space_available();
             return true;
         }
 
@@ -277,8 +284,8 @@ protected:
                 {
                     rec = elem.m_record;
                     m_queue.pop();
-                    if (size == MaxQueueSizeV)
-                        overflow_strategy::on_queue_space_available();
+                    // Every dequeued record lets one blocked thread proceed, even if the queue was not full at this point
+                    overflow_strategy::on_queue_space_available();
                     return true;
                 }
                 else
@@ -297,6 +304,13 @@ protected:
         return false;
     }
 
+    //! Adds the overflow statistics of the queue to \a stats
+    void get_overflow_statistics(queue_statistics& stats)
+    {
+        lock_guard< mutex_type > lock(m_mutex);
+        m_overflow_counters.get_statistics(stats);
+    }
+
     //! Wakes a thread possibly blocked in the \c dequeue method
     void interrupt_dequeue()
     {
@@ -0,0 +1,465 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   bounded_severity_fifo_queue.hpp
+ * \author Andrey Semashev
+ * \date   15.10.2013
+ *
+ * The header contains implementation of bounded severity-aware FIFO queueing strategy for
+ * the asynchronous sink frontend.
+ */
+
+#ifndef BOOST_LOG_SINKS_BOUNDED_SEVERITY_FIFO_QUEUE_HPP_INCLUDED_
+#define BOOST_LOG_SINKS_BOUNDED_SEVERITY_FIFO_QUEUE_HPP_INCLUDED_
+
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if defined(BOOST_LOG_NO_THREADS)
+#error Boost.Log: This header content is only supported in multithreaded environment
+#endif
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include <utility>
+#include <boost/cstdint.hpp>
+#include <boost/move/utility.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/log/exceptions.hpp>
+#include <boost/log/core/record.hpp>
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/detail/overflow_counters.hpp>
+#include <boost/log/attributes/attribute_name.hpp>
+#include <boost/log/attributes/attribute_value_set.hpp>
+#include <boost/log/attributes/attribute_value_impl.hpp>
+#include <boost/log/attributes/value_extraction.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/detail/queue_waiter.hpp>
+#include <boost/log/sinks/drop_on_overflow.hpp>
+#include <boost/log/sinks/queue_statistics.hpp>
+#include <boost/log/sinks/wait_strategy.hpp>
+#include <boost/log/keywords/severity_attribute.hpp>
+#include <boost/log/keywords/severity_levels.hpp>
+#include <boost/log/keywords/wait_strategy.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace sinks {
+
+/*!
+ * \brief Bounded severity-aware FIFO log record queueing strategy
+ *
+ * The \c bounded_severity_fifo_queue class is intended to be used with
+ * the \c asynchronous_sink frontend as a log record queueing strategy.
+ *
+ * Like \c bounded_fifo_queue, the queue has a limited capacity specified by the \c MaxQueueSizeV
+ * template parameter and delivers records in the order in which they were enqueued. Unlike
+ * \c bounded_fifo_queue, the queue takes severity levels of the records into account when
+ * it overflows:
+ *
+ * \li Records are grouped into bands by their severity level. The level is extracted from the attribute
+ *     with the name specified with the \c severity_attribute named parameter of the frontend constructor,
+ *     "Severity" by default. The attribute value must be of type \c SeverityT, which should be an integral
+ *     or enum type. The number of bands is specified with the \c severity_levels named parameter, 8 by default.
+ *     Records with severity levels above the number of bands share the highest band, records with negative
+ *     or no severity levels go to the lowest band.
+ * \li Each band can be given a number of reserved queue slots with the \c set_reserved_capacity method.
+ *     The reserved slots can only be occupied by records of that band. The rest of the capacity is shared
+ *     by all bands.
+ * \li When a record does not fit into its band reservation and the shared capacity is exhausted, the oldest
+ *     record from the lowest band with severity level below the new record that occupies shared capacity is
+ *     evicted from the queue. If there is no such record, the overflow handling strategy specified in the
+ *     \c OverflowStrategyT template parameter is invoked, same as with \c bounded_fifo_queue.
+ *
+ * Records that were evicted or discarded by the overflow handling strategy are counted per severity level.
+ * The next time the feeding thread dequeues records, it will receive a record with a message listing
+ * the counters. That record is created by the queue itself, bypassing the logging core and filtering,
+ * and only contains the message and the severity level attribute. The severity level is set to
+ * the highest severity level of the lost records.
+ */
+template< std::size_t MaxQueueSizeV, typename SeverityT, typename OverflowStrategyT = drop_on_overflow >
+class bounded_severity_fifo_queue :
+    private OverflowStrategyT
+{
+public:
+    //! Severity level type
+    typedef SeverityT severity_level;
+
+private:
+    typedef OverflowStrategyT overflow_strategy;
+    typedef boost::mutex mutex_type;
+
+    //! Queued record along with its position in the enqueueing order
+    struct queued_record
+    {
+        record_view m_record;
+        uintmax_t m_sequence;
+
+        queued_record(record_view const& rec, uintmax_t seq) : m_record(rec), m_sequence(seq)
+        {
+        }
+    };
+
+    //! Records of a single severity level
+    struct band
+    {
+        //! Queued records
+        std::deque< queued_record > m_records;
+        //! The number of reserved queue slots
+        std::size_t m_reserved;
+        //! The number of records shed since the last report
+        uintmax_t m_shed;
+
+        band() : m_reserved(0), m_shed(0)
+        {
+        }
+    };
+
+    typedef std::vector< band > band_list;
+    typedef std::vector< std::pair< std::size_t, uintmax_t > > shed_counters;
+
+private:
+    //! Synchronization primitive
+    mutex_type m_mutex;
+    //! Severity level bands
+    band_list m_bands;
+    //! The name of the severity level attribute
+    const attribute_name m_severity_name;
+    //! Total number of queued records
+    std::size_t m_size;
+    //! Total number of reserved slots
+    std::size_t m_reserved_total;
+    //! The number of records that occupy the shared capacity
+    std::size_t m_shared_used;
+    //! Sequence number of the next enqueued record
+    uintmax_t m_next_sequence;
+    //! The flag is set when records were shed since the last report
+    bool m_shed_pending;
+    //! Implements the wait strategy of the consuming thread
+    boost::log::aux::locked_queue_waiter m_waiter;
+    //! Overflow statistics
+    boost::log::aux::overflow_counters m_overflow_counters;
+    //! Interruption flag
+    bool m_interruption_requested;
+
+public:
+    /*!
+     * Reserves \a count queue slots for records of severity level \a level. The reserved slots are taken
+     * out of the capacity shared by all severity levels. Setting zero removes the reservation.
+     *
+     * \throws setup_error If the total number of reserved slots exceeds the queue capacity.
+     */
+    void set_reserved_capacity(severity_level level, std::size_t count)
+    {
+        lock_guard< mutex_type > lock(m_mutex);
+        band& b = m_bands[get_band_index(level)];
+        const std::size_t reserved_total = m_reserved_total - b.m_reserved + count;
+        if (reserved_total > MaxQueueSizeV)
+            BOOST_LOG_THROW_DESCR(setup_error, "Reserved capacity exceeds the queue capacity");
+
+        b.m_reserved = count;
+        m_reserved_total = reserved_total;
+
+        m_shared_used = 0;
+        for (typename band_list::const_iterator it = m_bands.begin(), end = m_bands.end(); it != end; ++it)
+        {
+            if (it->m_records.size() > it->m_reserved)
+                m_shared_used += it->m_records.size() - it->m_reserved;
+        }
+
+        // There may be room for blocked threads now
+        overflow_strategy::on_queue_space_available();
+    }
+
+protected:
+    //! Default constructor
+    bounded_severity_fifo_queue() :
+        m_bands(8u),
+        m_severity_name("Severity"),
+        m_size(0),
+        m_reserved_total(0),
+        m_shared_used(0),
+        m_next_sequence(0),
+        m_shed_pending(false),
+        m_interruption_requested(false)
+    {
+    }
+    //! Initializing constructor
+    template< typename ArgsT >
+    explicit bounded_severity_fifo_queue(ArgsT const& args) :
+        m_bands(get_band_count(args[keywords::severity_levels | 8u])),
+        m_severity_name(args[keywords::severity_attribute | "Severity"]),
+        m_size(0),
+        m_reserved_total(0),
+        m_shared_used(0),
+        m_next_sequence(0),
+        m_shed_pending(false),
+        m_waiter(args[keywords::wait_strategy | wait_strategy()]),
+        m_interruption_requested(false)
+    {
+    }
+
+    //! Enqueues log record to the queue
+    void enqueue(record_view const& rec)
+    {
+        unique_lock< mutex_type > lock(m_mutex);
+        const std::size_t index = get_band_index(rec);
+        while (!has_room(index) && !evict_lower(index))
+        {
+            if (!m_overflow_counters.on_overflow(static_cast< overflow_strategy& >(*this), rec, lock))
+            {
+                record_shed(index);
+                return;
+            }
+        }
+
+        push(index, rec);
+    }
+
+    //! Attempts to enqueue log record to the queue
+    bool try_enqueue(record_view const& rec)
+    {
+        unique_lock< mutex_type > lock(m_mutex, try_to_lock);
+        if (lock.owns_lock())
+        {
+            // Do not invoke the bounding strategy in case of overflow as it may block
+            const std::size_t index = get_band_index(rec);
+            if (has_room(index) || evict_lower(index))
+            {
+                push(index, rec);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //! Attempts to dequeue a log record ready for processing from the queue, does not block if the queue is empty
+    bool try_dequeue_ready(record_view& rec)
+    {
+        return try_dequeue(rec);
+    }
+
+    //! Attempts to dequeue log record from the queue, does not block if the queue is empty
+    bool try_dequeue(record_view& rec)
+    {
+        unique_lock< mutex_type > lock(m_mutex);
+        if (m_shed_pending && make_shed_report(lock, rec))
+            return true;
+
+        return pop(rec);
+    }
+
+    //! Dequeues log record from the queue, blocks if the queue is empty
+    bool dequeue_ready(record_view& rec)
+    {
+        unique_lock< mutex_type > lock(m_mutex);
+
+        for (unsigned int attempt = 0u; !m_interruption_requested; ++attempt)
+        {
+            if (m_shed_pending && make_shed_report(lock, rec))
+                return true;
+
+            if (pop(rec))
+                return true;
+            else
+                m_waiter.wait(lock, attempt);
+        }
+        m_interruption_requested = false;
+
+        return false;
+    }
+
+    //! Adds the overflow statistics of the queue to \a stats
+    void get_overflow_statistics(queue_statistics& stats)
+    {
+        lock_guard< mutex_type > lock(m_mutex);
+        m_overflow_counters.get_statistics(stats);
+    }
+
+    //! Wakes a thread possibly blocked in the \c dequeue method
+    void interrupt_dequeue()
+    {
+        lock_guard< mutex_type > lock(m_mutex);
+        m_interruption_requested = true;
+        overflow_strategy::interrupt();
+        m_waiter.interrupt();
+    }
+
+private:
+    //! Returns the number of bands for the specified number of severity levels
+    static std::size_t get_band_count(unsigned int levels)
+    {
+        return levels > 0u ? static_cast< std::size_t >(levels) : static_cast< std::size_t >(1u);
+    }
+
+    //! Returns the band index for the severity level
+    std::size_t get_band_index(severity_level level) const
+    {
+        const intmax_t value = static_cast< intmax_t >(level);
+        if (value <= 0)
+            return 0u;
+        const std::size_t index = static_cast< std::size_t >(static_cast< uintmax_t >(value));
+        return index < m_bands.size() ? index : m_bands.size() - 1u;
+    }
+
+    //! Returns the band index for the record
+    std::size_t get_band_index(record_view const& rec) const
+    {
+        typename result_of::extract< severity_level >::type level = boost::log::extract< severity_level >(m_severity_name, rec);
+        return level ? get_band_index(level.get()) : static_cast< std::size_t >(0u);
+    }
+
+    //! Checks if there is room for a record of the specified band. Must be called with the mutex locked.
+    bool has_room(std::size_t index) const
+    {
+        band const& b = m_bands[index];
+        if (b.m_records.size() < b.m_reserved)
+            return true;
+
+        return m_shared_used < MaxQueueSizeV - m_reserved_total;
+    }
+
+    //! Evicts the oldest record of the lowest band below the specified one that occupies the shared capacity
+    bool evict_lower(std::size_t index)
+    {
+        for (std::size_t i = 0; i < index; ++i)
+        {
+            band& b = m_bands[i];
+            if (b.m_records.size() > b.m_reserved)
+            {
+                b.m_records.pop_front();
+                --m_size;
+                --m_shared_used;
+                m_overflow_counters.on_dropped(1u);
+                record_shed(i);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //! Counts a record that was lost. Must be called with the mutex locked.
+    void record_shed(std::size_t index)
+    {
+        ++m_bands[index].m_shed;
+        m_shed_pending = true;
+    }
+
+    //! Puts the record to the queue. Must be called with the mutex locked.
+    void push(std::size_t index, record_view const& rec)
+    {
+        band& b = m_bands[index];
+        if (b.m_records.size() >= b.m_reserved)
+            ++m_shared_used;
+        b.m_records.push_back(queued_record(rec, m_next_sequence++));
+        ++m_size;
+        if (m_size == 1)
+            m_waiter.notify();
+    }
+
+    //! Extracts the oldest record from the queue. Must be called with the mutex locked.
+    bool pop(record_view& rec)
+    {
+        if (m_size == 0)
+            return false;
+
+        band* oldest = NULL;
+        for (typename band_list::iterator it = m_bands.begin(), end = m_bands.end(); it != end; ++it)
+        {
+            if (!it->m_records.empty() && (!oldest || it->m_records.front().m_sequence < oldest->m_records.front().m_sequence))
+                oldest = &*it;
+        }
+
+        if (oldest->m_records.size() > oldest->m_reserved)
+            --m_shared_used;
+        rec.swap(oldest->m_records.front().m_record);
+        oldest->m_records.pop_front();
+        --m_size;
+
+        // Blocked threads may be waiting either for the shared capacity or for their band reservation
+        overflow_strategy::on_queue_space_available();
+        return true;
+    }
+
+    //! Creates a record with the number of shed records. Must be called with the mutex locked, temporarily unlocks it.
+    bool make_shed_report(unique_lock< mutex_type >& lock, record_view& rec)
+    {
+        shed_counters counters;
+        for (std::size_t i = 0, n = m_bands.size(); i < n; ++i)
+        {
+            band& b = m_bands[i];
+            if (b.m_shed > 0)
+            {
+                counters.push_back(std::make_pair(i, b.m_shed));
+                b.m_shed = 0;
+            }
+        }
+        m_shed_pending = false;
+
+        // Formatting the message may take time, do not hold the lock while creating the record
+        lock.unlock();
+        bool created = false;
+        try
+        {
+            created = create_shed_report(counters, rec);
+        }
+        catch (...)
+        {
+        }
+        lock.lock();
+
+        if (!created)
+        {
+            // Keep the counters for the next report, which is attempted on the next dequeue
+            for (typename shed_counters::const_iterator it = counters.begin(), end = counters.end(); it != end; ++it)
+                m_bands[it->first].m_shed += it->second;
+            m_shed_pending = true;
+        }
+
+        return created;
+    }
+
+    //! Creates a record with the number of shed records
+    bool create_shed_report(shed_counters const& counters, record_view& rec) const
+    {
+        attribute_value_set values(2u);
+        values.insert(m_severity_name, attributes::make_attribute_value(static_cast< severity_level >(counters.back().first)));
+
+        record r = boost::log::aux::make_detached_record(boost::move(values));
+
+        {
+            record_ostream strm(r);
+            strm << "Log records lost due to queue overflow:";
+            for (typename shed_counters::const_iterator it = counters.begin(), end = counters.end(); it != end; ++it)
+                strm << " severity " << it->first << ": " << it->second << ";";
+            strm.flush();
+        }
+
+        record_view(r.lock()).swap(rec);
+        return true;
+    }
+};
+
+} // namespace sinks
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_SINKS_BOUNDED_SEVERITY_FIFO_QUEUE_HPP_INCLUDED_
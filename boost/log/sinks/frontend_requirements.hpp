@@ -75,6 +75,27 @@ struct formatted_records {};
  */
 struct flushing {};
 
+/*!
+ * The sink backend is able to process multiple log records in a single call. The frontend may
+ * pass several records to the backend at once, if it has them readily available.
+ */
+struct batched_records {};
+
+/*!
+ * The sink backend supports committing the consumed log records. The frontend calls the \c commit method
+ * of the backend after feeding records and unlocking the backend, so that the threads that have fed records
+ * can wait for the commit concurrently.
+ */
+struct committing {};
+
+/*!
+ * The sink backend wants to be notified when the frontend has no more records ready for feeding.
+ * The asynchronous frontend calls the \c on_idle method of the backend after feeding records when its
+ * queue becomes empty, so that the backend can write out the data it has accumulated. Other frontends
+ * do not call the method.
+ */
+struct idle_notification {};
+
 #ifdef BOOST_LOG_DOXYGEN_PASS
 
 /*!
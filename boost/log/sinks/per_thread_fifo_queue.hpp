@@ -0,0 +1,185 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   per_thread_fifo_queue.hpp
+ * \author Andrey Semashev
+ * \date   12.10.2013
+ *
+ * The header contains implementation of per-thread FIFO queueing strategy for
+ * the asynchronous sink frontend.
+ */
+
+#ifndef BOOST_LOG_SINKS_PER_THREAD_FIFO_QUEUE_HPP_INCLUDED_
+#define BOOST_LOG_SINKS_PER_THREAD_FIFO_QUEUE_HPP_INCLUDED_
+
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if defined(BOOST_LOG_NO_THREADS)
+#error Boost.Log: This header content is only supported in multithreaded environment
+#endif
+
+#include <cstddef>
+#include <vector>
+#include <boost/atomic/atomic.hpp>
+#include <boost/log/detail/queue_waiter.hpp>
+#include <boost/log/detail/thread_lanes.hpp>
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/sinks/queue_statistics.hpp>
+#include <boost/log/sinks/wait_strategy.hpp>
+#include <boost/log/keywords/wait_strategy.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace sinks {
+
+/*!
+ * \brief Unbounded per-thread FIFO log record queueing strategy
+ *
+ * The \c per_thread_fifo_queue class is intended to be used with
+ * the \c asynchronous_sink frontend as a log record queueing strategy.
+ *
+ * Unlike \c unbounded_fifo_queue, this strategy does not have a single queue shared
+ * by all logging threads. Instead, every thread that emits log records lazily registers
+ * its own single producer single consumer lane upon the first enqueued record. Enqueueing
+ * a record is wait-free and does not contend with other logging threads. The feeding thread
+ * drains the lanes in a round-robin fashion, one record from each lane per turn. Lanes that belong
+ * to threads that have exited are reclaimed after all of their records are dequeued.
+ *
+ * The strategy preserves the order of records emitted by each particular thread. There is no
+ * ordering guarantee between records from different threads, not even the order in which they
+ * were enqueued. If ordering across threads is needed, use one of the ordering strategies.
+ *
+ * Like \c unbounded_fifo_queue, the queue has no limits and may grow uncontrollably if sink
+ * backends can't consume log records fast enough. The way the feeding thread waits for new records
+ * can be customized with the \c wait_strategy named parameter of the frontend constructor.
+ */
+class per_thread_fifo_queue
+{
+private:
+    typedef boost::log::aux::thread_lanes< record_view > lanes_type;
+    typedef lanes_type::lane_ptr lane_ptr;
+    typedef lanes_type::lane_list lane_list;
+
+private:
+    //! Lanes of the logging threads
+    lanes_type m_thread_lanes;
+    //! The lanes being drained by the feeding thread, only accessed by the feeding thread
+    lane_list m_lanes;
+    //! Index of the lane to be drained next
+    std::size_t m_next_lane;
+    //! Implementation of the wait strategy
+    boost::log::aux::queue_waiter m_waiter;
+    //! Interruption flag
+    boost::atomic< bool > m_interruption_requested;
+
+protected:
+    //! Default constructor
+    per_thread_fifo_queue() :
+        m_next_lane(0),
+        m_waiter(wait_strategy()),
+        m_interruption_requested(false)
+    {
+    }
+    //! Initializing constructor
+    template< typename ArgsT >
+    explicit per_thread_fifo_queue(ArgsT const& args) :
+        m_next_lane(0),
+        m_waiter(args[keywords::wait_strategy | wait_strategy()]),
+        m_interruption_requested(false)
+    {
+    }
+
+    //! Enqueues log record to the queue
+    void enqueue(record_view const& rec)
+    {
+        m_thread_lanes.current_queue().push(rec);
+        m_waiter.notify();
+    }
+
+    //! Attempts to enqueue log record to the queue
+    bool try_enqueue(record_view const& rec)
+    {
+        // Assume the call never blocks
+        enqueue(rec);
+        return true;
+    }
+
+    //! Attempts to dequeue a log record ready for processing from the queue, does not block if the queue is empty
+    bool try_dequeue_ready(record_view& rec)
+    {
+        return try_dequeue(rec);
+    }
+
+    //! Attempts to dequeue log record from the queue, does not block if the queue is empty
+    bool try_dequeue(record_view& rec)
+    {
+        if (m_thread_lanes.has_new_lanes())
+            m_thread_lanes.accept_new_lanes(m_lanes);
+
+        std::size_t lanes_left = m_lanes.size();
+        while (lanes_left > 0)
+        {
+            --lanes_left;
+            if (m_next_lane >= m_lanes.size())
+                m_next_lane = 0;
+
+            lane_ptr& l = m_lanes[m_next_lane];
+            const bool orphaned = lanes_type::is_orphaned(l);
+            if (l->m_queue.try_pop(rec))
+            {
+                ++m_next_lane;
+                return true;
+            }
+
+            if (orphaned)
+            {
+                // Reclaim the lane
+                l.swap(m_lanes.back());
+                m_lanes.pop_back();
+            }
+            else
+                ++m_next_lane;
+        }
+
+        return false;
+    }
+
+    //! Dequeues log record from the queue, blocks if the queue is empty
+    bool dequeue_ready(record_view& rec)
+    {
+        return m_waiter.wait_and_pop(*this, &per_thread_fifo_queue::try_dequeue, rec, m_interruption_requested);
+    }
+
+    //! Adds the overflow statistics of the queue to \a stats. The queue never overflows, so the method does nothing.
+    static void get_overflow_statistics(queue_statistics&)
+    {
+    }
+
+    //! Wakes a thread possibly blocked in the \c dequeue method
+    void interrupt_dequeue()
+    {
+        m_interruption_requested.store(true, boost::memory_order_release);
+        m_waiter.interrupt();
+    }
+};
+
+} // namespace sinks
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_SINKS_PER_THREAD_FIFO_QUEUE_HPP_INCLUDED_
@@ -0,0 +1,432 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   per_thread_ordering_queue.hpp
+ * \author Andrey Semashev
+ * \date   15.10.2013
+ *
+ * The header contains implementation of per-thread ordering queueing strategy for
+ * the asynchronous sink frontend.
+ */
+
+#ifndef BOOST_LOG_SINKS_PER_THREAD_ORDERING_QUEUE_HPP_INCLUDED_
+#define BOOST_LOG_SINKS_PER_THREAD_ORDERING_QUEUE_HPP_INCLUDED_
+
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if defined(BOOST_LOG_NO_THREADS)
+#error Boost.Log: This header content is only supported in multithreaded environment
+#endif
+
+#include <cstddef>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/atomic/atomic.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/log/detail/event.hpp>
+#include <boost/log/detail/timestamp.hpp>
+#include <boost/log/detail/thread_lanes.hpp>
+#include <boost/log/keywords/order.hpp>
+#include <boost/log/keywords/ordering_window.hpp>
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/sinks/queue_statistics.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace sinks {
+
+/*!
+ * \brief Unbounded per-thread ordering log record queueing strategy
+ *
+ * The \c per_thread_ordering_queue class is intended to be used with
+ * the \c asynchronous_sink frontend as a log record queueing strategy.
+ *
+ * The strategy provides properties similar to \c unbounded_ordering_queue:
+ *
+ * \li The queue has no size limits.
+ * \li The queue has a fixed latency window. This means that each log record put
+ *     into the queue will normally not be dequeued for a certain period of time.
+ * \li The queue performs record ordering within the latency window.
+ *     The ordering predicate can be specified in the \c OrderT template parameter.
+ *     Unlike \c unbounded_ordering_queue, the ordering is not stable: equivalent records emitted
+ *     by the same thread are delivered in the order they were emitted, but the relative order
+ *     of equivalent records emitted by different threads is unspecified.
+ *
+ * Unlike \c unbounded_ordering_queue, the strategy does not keep all records in a single heap. Instead,
+ * every logging thread appends records to its own single producer single consumer lane, which is a wait-free
+ * operation that does not contend with other threads. The feeding thread merges the lanes with a tournament
+ * tree, so that extracting a record costs O(log N) comparisons, where N is the number of logging threads,
+ * rather than O(log M) comparisons under a lock, where M is the number of queued records. The feeding thread
+ * does not poll the lanes it has found empty. Instead, a logging thread signals the feeding thread when it enqueues
+ * a record into such a lane, and the lanes of the terminated threads are reclaimed periodically.
+ *
+ * The strategy relies on the records emitted by every thread to be already ordered according to \c OrderT.
+ * This is the case for the most common orderings, e.g. by a record counter or a timestamp attribute.
+ * If records of a thread are not ordered, they will be delivered in the order they were emitted.
+ *
+ * The strategy does not support the \c wait_strategy named parameter of the frontend constructor. Since records
+ * are held back for the ordering window anyway, the feeding thread always blocks until either a new record
+ * is enqueued or the ordering window of the earliest queued record elapses.
+ */
+template< typename OrderT >
+class per_thread_ordering_queue
+{
+private:
+    //! Log record with enqueueing timestamp
+    struct enqueued_record
+    {
+        boost::log::aux::timestamp m_timestamp;
+        record_view m_record;
+
+        enqueued_record()
+        {
+        }
+        enqueued_record(enqueued_record const& that) : m_timestamp(that.m_timestamp), m_record(that.m_record)
+        {
+        }
+        explicit enqueued_record(record_view const& rec) :
+            m_timestamp(boost::log::aux::get_timestamp()),
+            m_record(rec)
+        {
+        }
+        enqueued_record& operator= (enqueued_record const& that)
+        {
+            m_timestamp = that.m_timestamp;
+            m_record = that.m_record;
+            return *this;
+        }
+    };
+
+    typedef boost::log::aux::thread_lanes< enqueued_record > lanes_type;
+    typedef typename lanes_type::lane_ptr lane_ptr;
+    typedef typename lanes_type::lane_list lane_list;
+
+    //! The first record of a lane, which competes in the tournament
+    struct lane_head
+    {
+        enqueued_record m_record;
+        bool m_present;
+
+        lane_head() : m_present(false)
+        {
+        }
+    };
+
+    typedef std::vector< lane_head > head_list;
+    typedef std::vector< std::size_t > tournament_tree;
+
+    //! Marks tree nodes with no competing records
+    enum { no_winner = ~static_cast< std::size_t >(0u) };
+    //! The number of updates of the lane heads between the scans for the lanes of the terminated threads
+    enum { reclaim_period = 1024u };
+
+private:
+    //! Ordering window duration, in milliseconds
+    const uint64_t m_ordering_window;
+    //! Ordering predicate
+    const OrderT m_order;
+    //! Lanes of the logging threads
+    lanes_type m_thread_lanes;
+    //! The lanes being merged by the feeding thread, only accessed by the feeding thread
+    lane_list m_lanes;
+    //! The parked lanes that have received new records, only accessed by the feeding thread
+    lane_list m_ready_lanes;
+    //! The first records of the lanes, only accessed by the feeding thread
+    head_list m_heads;
+    //! The tournament tree. Leaves are stored at indices starting from m_leaf_count, node 1 is the root.
+    tournament_tree m_tree;
+    //! The number of leaves in the tree
+    std::size_t m_leaf_count;
+    //! The number of updates of the lane heads since the last scan for the lanes of the terminated threads
+    unsigned int m_updates_since_reclaim;
+    //! The event to block the feeding thread on
+    boost::log::aux::event m_event;
+    //! Interruption flag
+    boost::atomic< bool > m_interruption_requested;
+
+public:
+    //! The tag indicates that queued records become ready for processing with time
+    typedef void delayed_records_tag;
+
+    /*!
+     * Returns ordering window size specified during initialization
+     */
+    posix_time::time_duration get_ordering_window() const
+    {
+        return posix_time::milliseconds(m_ordering_window);
+    }
+
+    /*!
+     * Returns default ordering window size.
+     * The default window size is specific to the operating system thread scheduling mechanism.
+     */
+    static posix_time::time_duration get_default_ordering_window()
+    {
+        // See the comment in unbounded_ordering_queue
+        return posix_time::milliseconds(30);
+    }
+
+protected:
+    //! Initializing constructor
+    template< typename ArgsT >
+    explicit per_thread_ordering_queue(ArgsT const& args) :
+        m_ordering_window(args[keywords::ordering_window || &per_thread_ordering_queue::get_default_ordering_window].total_milliseconds()),
+        m_order(args[keywords::order]),
+        m_leaf_count(0),
+        m_updates_since_reclaim(0u),
+        m_interruption_requested(false)
+    {
+    }
+
+    //! Enqueues log record to the queue
+    void enqueue(record_view const& rec)
+    {
+        m_thread_lanes.push(enqueued_record(rec));
+        m_event.set_signalled();
+    }
+
+    //! Attempts to enqueue log record to the queue
+    bool try_enqueue(record_view const& rec)
+    {
+        // Assume the call never blocks
+        enqueue(rec);
+        return true;
+    }
+
+    //! Attempts to dequeue a log record ready for processing from the queue, does not block if no log records are ready to be processed
+    bool try_dequeue_ready(record_view& rec)
+    {
+        const std::size_t winner = update_heads();
+        if (winner != no_winner && get_age(winner) >= m_ordering_window)
+        {
+            take_record(winner, rec);
+            return true;
+        }
+
+        return false;
+    }
+
+    //! Attempts to dequeue log record from the queue, does not block.
+    bool try_dequeue(record_view& rec)
+    {
+        const std::size_t winner = update_heads();
+        if (winner != no_winner)
+        {
+            take_record(winner, rec);
+            return true;
+        }
+
+        return false;
+    }
+
+    //! Dequeues log record from the queue, blocks if no log records are ready to be processed
+    bool dequeue_ready(record_view& rec)
+    {
+        while (!m_interruption_requested.load(boost::memory_order_acquire))
+        {
+            const std::size_t winner = update_heads();
+            if (winner != no_winner)
+            {
+                const uint64_t age = get_age(winner);
+                if (age >= m_ordering_window)
+                {
+                    take_record(winner, rec);
+                    return true;
+                }
+                else
+                {
+                    // Wait until the record becomes ready to be processed
+                    m_event.timed_wait(static_cast< unsigned int >(m_ordering_window - age));
+                }
+            }
+            else
+            {
+                // The queue is idle, which is a good time to release the lanes of the terminated threads.
+                // The last records of these threads may turn up during the scan, so look for the winner once again.
+                if (m_updates_since_reclaim > 0u && reclaim_orphaned_lanes())
+                {
+                    build_tree();
+                    continue;
+                }
+
+                // Wait for a record to come
+                m_event.wait();
+            }
+        }
+        m_interruption_requested.store(false, boost::memory_order_relaxed);
+
+        return false;
+    }
+
+    //! Adds the overflow statistics of the queue to \a stats. The queue never overflows, so the method does nothing.
+    static void get_overflow_statistics(queue_statistics&)
+    {
+    }
+
+    //! Wakes a thread possibly blocked in the \c dequeue method
+    void interrupt_dequeue()
+    {
+        m_interruption_requested.store(true, boost::memory_order_release);
+        m_event.set_signalled();
+    }
+
+private:
+    //! Returns the time since the record in the specified lane head was enqueued, in milliseconds
+    uint64_t get_age(std::size_t index) const
+    {
+        return static_cast< uint64_t >((boost::log::aux::get_timestamp() - m_heads[index].m_record.m_timestamp).milliseconds());
+    }
+
+    /*!
+     * Fetches the first records of the new lanes and the parked lanes that have received records, returns the winner
+     * of the tournament. The lanes that are found empty are parked and not polled until their threads signal new records.
+     */
+    std::size_t update_heads()
+    {
+        bool rebuild = false;
+        if (m_thread_lanes.has_new_lanes())
+        {
+            std::size_t i = m_lanes.size();
+            m_thread_lanes.accept_new_lanes(m_lanes);
+            m_heads.resize(m_lanes.size());
+            for (const std::size_t n = m_lanes.size(); i < n; ++i)
+            {
+                m_lanes[i]->m_index = i;
+                m_heads[i].m_present = lanes_type::try_pop_or_park(m_lanes[i], m_heads[i].m_record);
+            }
+            rebuild = true;
+        }
+
+        if (m_thread_lanes.has_ready_lanes())
+        {
+            m_thread_lanes.accept_ready_lanes(m_ready_lanes);
+            for (typename lane_list::const_iterator it = m_ready_lanes.begin(), end = m_ready_lanes.end(); it != end; ++it)
+            {
+                // Skip the lanes that have been reclaimed or already have a head
+                const std::size_t index = (*it)->m_index;
+                if (index < m_lanes.size() && m_lanes[index] == *it && !m_heads[index].m_present)
+                {
+                    m_heads[index].m_present = lanes_type::try_pop_or_park(m_lanes[index], m_heads[index].m_record);
+                    if (m_heads[index].m_present && !rebuild)
+                        replay(index);
+                }
+            }
+            m_ready_lanes.clear();
+        }
+
+        if (++m_updates_since_reclaim >= static_cast< unsigned int >(reclaim_period))
+            rebuild |= reclaim_orphaned_lanes();
+
+        if (rebuild)
+            build_tree();
+
+        return m_leaf_count > 0 ? m_tree[1] : static_cast< std::size_t >(no_winner);
+    }
+
+    //! Removes the empty lanes of the terminated threads. Returns \c true if the tree has to be rebuilt.
+    bool reclaim_orphaned_lanes()
+    {
+        m_updates_since_reclaim = 0u;
+
+        bool changed = false;
+        for (std::size_t i = 0; i < m_lanes.size();)
+        {
+            lane_head& head = m_heads[i];
+            if (!head.m_present && lanes_type::is_orphaned(m_lanes[i]))
+            {
+                changed = true;
+                // The last records of the thread may have been pushed after the lane was parked
+                head.m_present = m_lanes[i]->m_queue.try_pop(head.m_record);
+                if (!head.m_present)
+                {
+                    m_lanes[i].swap(m_lanes.back());
+                    m_lanes.pop_back();
+                    m_heads[i] = m_heads.back();
+                    m_heads.pop_back();
+                    if (i < m_lanes.size())
+                        m_lanes[i]->m_index = i;
+                    continue;
+                }
+            }
+            ++i;
+        }
+
+        return changed;
+    }
+
+    //! Extracts the record from the lane head and replaces it with the next record of the lane
+    void take_record(std::size_t index, record_view& rec)
+    {
+        lane_head& head = m_heads[index];
+        rec.swap(head.m_record.m_record);
+        head.m_record.m_record = record_view();
+        head.m_present = lanes_type::try_pop_or_park(m_lanes[index], head.m_record);
+        replay(index);
+    }
+
+    //! Selects the winner of a match between two lane heads
+    std::size_t match(std::size_t left, std::size_t right) const
+    {
+        if (left == no_winner)
+            return right;
+        if (right == no_winner)
+            return left;
+        // Ties are resolved in favor of the lane with the lower index, which does not reflect the order of enqueueing
+        return m_order(m_heads[right].m_record.m_record, m_heads[left].m_record.m_record) ? right : left;
+    }
+
+    //! Updates the tree after the head of the specified lane has changed
+    void replay(std::size_t index)
+    {
+        std::size_t node = m_leaf_count + index;
+        m_tree[node] = m_heads[index].m_present ? index : static_cast< std::size_t >(no_winner);
+        for (node /= 2u; node > 0u; node /= 2u)
+            m_tree[node] = match(m_tree[node * 2u], m_tree[node * 2u + 1u]);
+    }
+
+    //! Builds the tree from scratch
+    void build_tree()
+    {
+        const std::size_t lane_count = m_lanes.size();
+        if (lane_count == 0)
+        {
+            m_leaf_count = 0;
+            m_tree.clear();
+            return;
+        }
+
+        m_leaf_count = 1;
+        while (m_leaf_count < lane_count)
+            m_leaf_count *= 2u;
+
+        m_tree.assign(m_leaf_count * 2u, static_cast< std::size_t >(no_winner));
+        for (std::size_t i = 0; i < lane_count; ++i)
+        {
+            if (m_heads[i].m_present)
+                m_tree[m_leaf_count + i] = i;
+        }
+        for (std::size_t node = m_leaf_count - 1u; node > 0u; --node)
+            m_tree[node] = match(m_tree[node * 2u], m_tree[node * 2u + 1u]);
+    }
+};
+
+} // namespace sinks
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_SINKS_PER_THREAD_ORDERING_QUEUE_HPP_INCLUDED_
@@ -0,0 +1,88 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   queue_statistics.hpp
+ * \author Andrey Semashev
+ * \date   16.10.2013
+ *
+ * The header contains definition of the record queue statistics of the asynchronous sink frontend.
+ */
+
+#ifndef BOOST_LOG_SINKS_QUEUE_STATISTICS_HPP_INCLUDED_
+#define BOOST_LOG_SINKS_QUEUE_STATISTICS_HPP_INCLUDED_
+
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if defined(BOOST_LOG_NO_THREADS)
+#error Boost.Log: This header content is only supported in multithreaded environment
+#endif
+
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace sinks {
+
+/*!
+ * \brief Record queue statistics of the asynchronous sink frontend
+ *
+ * The structure is returned by the \c get_statistics method of the \c asynchronous_sink frontend.
+ * The counters are collected without stopping the logging threads or the feeding threads, so
+ * the values may be slightly inconsistent with each other.
+ */
+struct queue_statistics
+{
+    //! Total number of records passed to the queue by logging threads
+    uintmax_t enqueued_count;
+    //! Total number of records extracted from the queue and passed to the backend
+    uintmax_t dequeued_count;
+    //! Total number of records discarded or evicted from the queue due to overflow
+    uintmax_t dropped_count;
+    //! The number of records currently in the queue
+    uintmax_t depth;
+    /*!
+     * The maximum number of records observed in the queue. The depth is sampled every time the feeding
+     * thread extracts records from the queue and every time the statistics are requested.
+     */
+    uintmax_t max_depth;
+    //! Cumulative time logging threads spent blocked due to queue overflow
+    posix_time::time_duration producer_block_time;
+    //! Cumulative time feeding threads spent passing records to the backend
+    posix_time::time_duration feeding_busy_time;
+    //! Cumulative time feeding threads spent waiting for new records
+    posix_time::time_duration feeding_idle_time;
+
+    queue_statistics() :
+        enqueued_count(0),
+        dequeued_count(0),
+        dropped_count(0),
+        depth(0),
+        max_depth(0),
+        producer_block_time(0, 0, 0),
+        feeding_busy_time(0, 0, 0),
+        feeding_idle_time(0, 0, 0)
+    {
+    }
+};
+
+} // namespace sinks
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_SINKS_QUEUE_STATISTICS_HPP_INCLUDED_
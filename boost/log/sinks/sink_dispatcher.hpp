@@ -0,0 +1,224 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   sink_dispatcher.hpp
+ * \author Andrey Semashev
+ * \date   17.10.2013
+ *
+ * The header contains definition of the sink dispatcher, which feeds log records
+ * to the backends of multiple asynchronous sink frontends from a shared pool of threads.
+ */
+
+#ifndef BOOST_LOG_SINKS_SINK_DISPATCHER_HPP_INCLUDED_
+#define BOOST_LOG_SINKS_SINK_DISPATCHER_HPP_INCLUDED_
+
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if defined(BOOST_LOG_NO_THREADS)
+#error Boost.Log: This header content is only supported in multithreaded environment
+#endif
+
+#include <boost/atomic/atomic.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/log/sinks/thread_settings.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace sinks {
+
+/*!
+ * \brief Sink dispatcher
+ *
+ * The dispatcher runs a pool of threads that feed log records to the backends of multiple
+ * asynchronous sink frontends. The frontends are attached to the dispatcher with the \c dispatcher
+ * named parameter of the frontend constructor, in which case they do not create dedicated feeding threads.
+ *
+ * When log records are enqueued into a frontend, the frontend is put into the dispatcher ready list,
+ * if it is not there already. The dispatcher threads take frontends from the front of the list and feed
+ * one batch of records of the frontend to its backend. If there are more records in the frontend queue,
+ * the frontend is put to the end of the list, so that every frontend gets its fair share of the dispatcher threads.
+ * Every frontend is served by at most one dispatcher thread at a time.
+ *
+ * In addition, the dispatcher periodically puts the attached frontends that require polling into the ready list.
+ * This allows to feed records that become ready for processing after some time, which is the case with ordering
+ * queueing strategies. Frontends with other queueing strategies are only put into the ready list when records
+ * are enqueued.
+ *
+ * The dispatcher must not be destroyed while there are frontends attached to it. Frontends keep a reference
+ * to the dispatcher, so this is normally guaranteed if the dispatcher is managed by a \c shared_ptr.
+ *
+ * Derived classes may execute the dispatching work in threads other than the ones of the dispatcher. Such classes
+ * use the protected constructor, which does not start any threads, and override the \c on_client_ready method
+ * to arrange a call to \c serve_ready_client for every frontend put into the ready list. They are also responsible
+ * for calling \c poll_clients periodically.
+ */
+class sink_dispatcher
+{
+public:
+    /*!
+     * \brief Base class for the sink frontends served by the dispatcher
+     *
+     * \note This class is the implementation detail of the asynchronous sink frontend and should not be used directly.
+     */
+    class client
+    {
+        friend class sink_dispatcher;
+
+    private:
+        //! The dispatcher the client is attached to
+        sink_dispatcher* m_pDispatcher;
+        //! The flag indicates that the client has to be put into the ready list periodically
+        const bool m_Polled;
+        //! The flag indicates that the dispatcher has been notified of new records since the client was last taken from the ready list
+        boost::atomic< bool > m_NotificationPending;
+        //! The flag indicates that the client is in the ready list or is being served, protected by the dispatcher mutex
+        bool m_Scheduled;
+        //! The flag indicates that the client is being served by a dispatcher thread, protected by the dispatcher mutex
+        bool m_Serving;
+        //! The flag indicates that the client is attached to the dispatcher, protected by the dispatcher mutex
+        bool m_Attached;
+
+    public:
+        /*!
+         * Constructor
+         *
+         * \param polled If \c true, the dispatcher will periodically put the client into the ready list. This is needed
+         *               if the records of the client become ready for processing with time, without new records being enqueued.
+         */
+        explicit client(bool polled = false) :
+            m_pDispatcher(NULL),
+            m_Polled(polled),
+            m_NotificationPending(false),
+            m_Scheduled(false),
+            m_Serving(false),
+            m_Attached(false)
+        {
+        }
+
+        //! Notifies the dispatcher that new records have been enqueued. Called by the logging threads after every enqueued record.
+        BOOST_LOG_API void notify();
+
+    protected:
+        //! Destructor
+        ~client() {}
+
+        /*!
+         * Feeds a batch of ready records to the backend. Called by the dispatcher threads. The method should not throw.
+         * If it does, the exception is ignored and the client is not served until it notifies the dispatcher again.
+         *
+         * \return \c true if there may be more records ready for processing, \c false otherwise
+         */
+        virtual bool dispatch_records() = 0;
+
+    private:
+        client(client const&);
+        client& operator= (client const&);
+    };
+
+private:
+    struct implementation;
+
+private:
+    //! Pointer to the implementation
+    implementation* m_pImpl;
+
+public:
+    /*!
+     * Constructor. Starts the dispatcher threads.
+     *
+     * \param worker_count The number of dispatcher threads. If 0, one thread is started.
+     * \param poll_interval The interval of putting the attached frontends that require polling into the ready list.
+     *                      Special values disable polling.
+     * \param settings The settings of the dispatcher threads.
+     */
+    BOOST_LOG_API explicit sink_dispatcher(
+        unsigned int worker_count = 1u,
+        posix_time::time_duration const& poll_interval = posix_time::milliseconds(50),
+        thread_settings const& settings = thread_settings());
+    /*!
+     * Destructor. Stops the dispatcher threads.
+     *
+     * \pre No sink frontends are attached to the dispatcher.
+     */
+    BOOST_LOG_API virtual ~sink_dispatcher();
+
+    /*!
+     * Returns the number of dispatcher threads
+     */
+    BOOST_LOG_API unsigned int worker_count() const;
+    /*!
+     * Returns the interval of polling the attached sink frontends
+     */
+    BOOST_LOG_API posix_time::time_duration poll_interval() const;
+
+    /*!
+     * Attaches a sink frontend to the dispatcher. After this call the dispatcher threads start feeding records
+     * of the frontend to its backend.
+     *
+     * \note This method is intended to be used by the asynchronous sink frontend and should not be called directly.
+     */
+    BOOST_LOG_API void attach(client& c);
+    /*!
+     * Detaches a sink frontend from the dispatcher. If a dispatcher thread is feeding records of the frontend,
+     * the method blocks until it has finished.
+     *
+     * \note This method is intended to be used by the asynchronous sink frontend and should not be called directly.
+     */
+    BOOST_LOG_API void detach(client& c);
+
+protected:
+    /*!
+     * Constructor for derived classes that execute the dispatching work externally. Does not start any threads.
+     *
+     * \param poll_interval The interval of putting the attached frontends that require polling into the ready list.
+     *                      Special values disable polling.
+     */
+    BOOST_LOG_API explicit sink_dispatcher(posix_time::time_duration const& poll_interval);
+
+    /*!
+     * Takes a sink frontend from the front of the ready list and feeds one batch of its records to the backend.
+     * If the frontend has more records to process, it is put to the end of the ready list.
+     *
+     * \return \c true if a frontend was served, \c false if the ready list was empty
+     */
+    BOOST_LOG_API bool serve_ready_client();
+    /*!
+     * Puts the attached sink frontends that require polling and are not in the ready list yet into the ready list
+     */
+    BOOST_LOG_API void poll_clients();
+    /*!
+     * The method is called when a sink frontend is put into the ready list. The call is made
+     * with the internal lock held, so the method must not call other methods of the dispatcher.
+     * The default implementation wakes up one of the dispatcher threads.
+     */
+    BOOST_LOG_API virtual void on_client_ready();
+
+private:
+    //! Puts the client into the ready list
+    BOOST_LOG_API void schedule(client& c);
+
+    //  Copying prohibited
+    sink_dispatcher(sink_dispatcher const&);
+    sink_dispatcher& operator= (sink_dispatcher const&);
+};
+
+} // namespace sinks
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_SINKS_SINK_DISPATCHER_HPP_INCLUDED_
@@ -24,7 +24,10 @@
 #ifndef BOOST_LOG_WITHOUT_SYSLOG
 
 #include <string>
+#include <vector>
+#include <cstddef>
 #include <boost/shared_ptr.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/log/detail/asio_fwd.hpp>
 #include <boost/log/detail/light_function.hpp>
 #include <boost/log/detail/parameter_tools.hpp>
@@ -32,6 +35,7 @@
 #include <boost/log/sinks/syslog_constants.hpp>
 #include <boost/log/sinks/attribute_mapping.hpp>
 #include <boost/log/attributes/attribute_value_set.hpp>
+#include <boost/log/expressions/formatter.hpp>
 #include <boost/log/keywords/facility.hpp>
 #include <boost/log/keywords/use_impl.hpp>
 #include <boost/log/keywords/ident.hpp>
@@ -63,7 +67,12 @@ namespace syslog {
 #endif
 #endif
 #ifndef BOOST_LOG_NO_ASIO
-        udp_socket_based = 1        //!< Use UDP sockets, according to RFC3164
+        udp_socket_based = 1,       //!< Use UDP sockets, according to RFC3164
+        tcp_socket_based = 2        //!< Use a TCP connection, according to RFC5424 and RFC6587 octet counting framing
+#ifdef BOOST_LOG_USE_NATIVE_SYSLOG
+        ,
+        local_socket_based = 3      //!< Send datagrams directly to the local syslog socket, in the format of the native syslog API
+#endif
 #endif
     };
 
@@ -119,6 +128,59 @@ namespace syslog {
         }
     };
 
+    /*!
+     * \brief Structured data mapping
+     *
+     * The class builds RFC5424 structured data elements from the log record. Every parameter
+     * of an element is produced by a formatter, which typically outputs an attribute value.
+     * Parameters with empty values are omitted, as well as elements without parameters.
+     * The structured data is only sent by the TCP socket-based implementation of the backend.
+     */
+    class structured_data_mapping
+    {
+    public:
+        //! Function result type
+        typedef void result_type;
+
+    private:
+        //! Structured data parameter
+        struct parameter
+        {
+            std::string m_Name;
+            basic_formatter< char > m_Formatter;
+        };
+        //! Structured data element
+        struct element
+        {
+            std::string m_ID;
+            std::vector< parameter > m_Parameters;
+        };
+
+    private:
+        //! Structured data elements
+        std::vector< element > m_Elements;
+
+    public:
+        /*!
+         * Adds a parameter to the structured data element. The element is created if there is no element
+         * with the specified identifier yet.
+         *
+         * \param sd_id Structured data element identifier, e.g. "origin" or "request@32473"
+         * \param param_name Parameter name
+         * \param fmt The formatter that produces the parameter value
+         * \throws invalid_value if the element identifier or parameter name are not valid according to RFC5424
+         */
+        BOOST_LOG_API structured_data_mapping& add(std::string const& sd_id, std::string const& param_name, basic_formatter< char > const& fmt);
+
+        /*!
+         * Appends the structured data built from the log record to the string
+         *
+         * \param rec The log record
+         * \param sd The string to append the structured data to. Nothing is appended if all elements are empty.
+         */
+        BOOST_LOG_API void operator() (record_view const& rec, std::string& sd) const;
+    };
+
 } // namespace syslog
 
 /*!
@@ -131,6 +193,11 @@ namespace syslog {
  * as well, by calling the \c set_local_address method. By default syslog
  * packets will be sent from any local address available.
  *
+ * Alternatively, the backend can send log records over a persistent TCP connection,
+ * formatted according to RFC5424 and framed according to RFC6587 octet counting method.
+ * This allows larger messages and structured data. To do so one has to pass
+ * the <tt>use_impl = tcp_socket_based</tt> to the backend constructor.
+ *
  * It is safe to create several sink backends with the same local addresses -
  * the backends within the process will share the same socket. The same applies
  * to different processes that use the syslog backends to send records from
@@ -147,12 +214,25 @@ namespace syslog {
  * Obviously, the \c set_local_address and \c set_target_address
  * methods have no effect for native backends. Using <tt>use_impl = native</tt>
  * on platforms with no native support for POSIX syslog API will have no effect.
+ *
+ * The native syslog API serializes all calls on a process-wide lock. On the same
+ * systems the backend can instead send log records directly to the local syslog socket
+ * (\c /dev/log by default), in the same format the native API uses. To do so one has
+ * to pass the <tt>use_impl = local_socket_based</tt> to the backend constructor. Every
+ * such backend maintains its own connection to the socket, the socket path can be
+ * changed with the \c set_target_socket method.
  */
 class syslog_backend :
-    public basic_formatted_sink_backend< char >
+    public basic_formatted_sink_backend<
+        char,
+        combine_requirements< synchronized_feeding, flushing, batched_records, idle_notification >::type
+    >
 {
     //! Base type
-    typedef basic_formatted_sink_backend< char > base_type;
+    typedef basic_formatted_sink_backend<
+        char,
+        combine_requirements< synchronized_feeding, flushing, batched_records, idle_notification >::type
+    > base_type;
     //! Implementation type
     struct implementation;
 
@@ -164,6 +244,8 @@ public:
 
     //! Syslog severity level mapper type
     typedef boost::log::aux::light_function< syslog::level (record_view const&) > severity_mapper_type;
+    //! Syslog structured data mapper type
+    typedef boost::log::aux::light_function< void (record_view const&, std::string&) > structured_data_mapper_type;
 
 private:
     //! Pointer to the implementation
@@ -185,9 +267,15 @@ public:
      *                                   is available, it is equivalent to \c udp_socket_based.
      *                   \li \c udp_socket_based - Use the UDP socket-based implementation, conforming to
      *                                             RFC3164 protocol specification. This is the default.
+     *                   \li \c tcp_socket_based - Use the TCP socket-based implementation, conforming to
+     *                                             RFC5424 protocol specification with RFC6587 octet counting framing.
+     *                   \li \c local_socket_based - Send datagrams directly to the local syslog socket, if the native
+     *                                               syslog API is available.
      * \li \c ip_version - Specifies IP protocol version to use, in case if socket-based implementation
      *                     is used. Can be either \c v4 (the default one) or \c v6.
-     * \li \c ident - Process identification string. This parameter is only supported by native syslog implementation.
+     * \li \c ident - Process identification string. This parameter is only supported by native syslog
+     *                implementation, local socket-based implementation and TCP socket-based implementation,
+     *                which sends it as the application name.
      */
 #ifndef BOOST_LOG_DOXYGEN_PASS
     BOOST_LOG_PARAMETRIZED_CONSTRUCTORS_CALL(syslog_backend, construct)
@@ -206,6 +294,15 @@ public:
      */
     BOOST_LOG_API void set_severity_mapper(severity_mapper_type const& mapper);
 
+    /*!
+     * The method installs the function object that builds RFC5424 structured data from log records.
+     * The function object should append the complete structured data elements, including the brackets,
+     * to the string.
+     *
+     * \note Only has effect if the backend was constructed to use TCP sockets
+     */
+    BOOST_LOG_API void set_structured_data_mapper(structured_data_mapper_type const& mapper);
+
 #if !defined(BOOST_LOG_NO_ASIO)
 
     /*!
@@ -248,6 +345,71 @@ public:
      */
     BOOST_LOG_API void set_target_address(boost::asio::ip::address const& addr, unsigned short port = 514);
 
+    /*!
+     * The method sets the path to the local syslog socket where log records will be sent to.
+     * By default, \c /dev/log is used.
+     *
+     * \note Only has effect if the backend was constructed to use the local syslog socket
+     *
+     * \param path The path to the local syslog socket
+     */
+    BOOST_LOG_API void set_target_socket(std::string const& path);
+
+    /*!
+     * The method sets the maximum number of packets that are accumulated before sending. The accumulated
+     * packets are sent with as few system calls as possible (with \c sendmmsg on Linux). The packets are
+     * also sent when the asynchronous sink frontend has no more records ready (see \c on_idle), when the backend
+     * is flushed and when the batch latency expires.
+     *
+     * \note Does not have effect if the backend was constructed to use native syslog API
+     *
+     * \param size The maximum number of packets in a batch. Zero or one disable batching, which is the default.
+     */
+    BOOST_LOG_API void set_batch_size(std::size_t size);
+    /*!
+     * The method sets the maximum time the packets can be accumulated before sending. The latency is checked
+     * when new records are sent. With the asynchronous sink frontend, the accumulated packets are also sent when
+     * the frontend has no more records ready. With other frontends, if no records are sent, the accumulated
+     * packets are sent only when the backend is flushed.
+     *
+     * \note Does not have effect if the backend was constructed to use native syslog API
+     *
+     * \param latency The maximum time the packets can be kept before sending. If \c not_a_date_time,
+     *                the accumulated packets are sent only when the batch is full or on flushing.
+     */
+    BOOST_LOG_API void set_batch_latency(posix_time::time_duration const& latency);
+
+    /*!
+     * The method sets the maximum size of the messages that can be kept by the backend while the connection
+     * to the syslog server is not established or the server does not receive messages fast enough. Messages
+     * that do not fit are discarded. The backend never blocks on connecting or sending messages, except
+     * when flushed, and then no longer than the flush timeout.
+     *
+     * \note Only has effect if the backend was constructed to use TCP sockets
+     *
+     * \param size The maximum size of the kept messages, in bytes. By default, 1 MiB.
+     */
+    BOOST_LOG_API void set_max_backlog_size(std::size_t size);
+    /*!
+     * The method sets the time to wait before reconnecting after the connection to the syslog server
+     * could not be established.
+     *
+     * \note Only has effect if the backend was constructed to use TCP sockets
+     *
+     * \param interval The reconnection interval. By default, 1 second.
+     */
+    BOOST_LOG_API void set_reconnect_interval(posix_time::time_duration const& interval);
+    /*!
+     * The method sets the maximum time flushing the backend waits for the connection to the syslog server
+     * to be established and for the kept messages to be sent. The messages that could not be sent in time
+     * are kept until the next sending. This also limits the time the backend destructor may block.
+     *
+     * \note Only has effect if the backend was constructed to use TCP sockets
+     *
+     * \param timeout The flush timeout. A special value, such as \c not_a_date_time, is equivalent to zero. By default, 5 seconds.
+     */
+    BOOST_LOG_API void set_flush_timeout(posix_time::time_duration const& timeout);
+
 #endif // !defined(BOOST_LOG_NO_ASIO)
 
     /*!
@@ -255,6 +417,24 @@ public:
      */
     BOOST_LOG_API void consume(record_view const& rec, string_type const& formatted_message);
 
+    /*!
+     * The method passes a batch of formatted messages to the syslog API or sends them to a syslog server
+     */
+    BOOST_LOG_API void consume(record_view const* records, string_type const* formatted_messages, std::size_t count);
+
+    /*!
+     * The method sends the accumulated messages to the syslog server without waiting. The method is called
+     * by the asynchronous frontend when it has no more records ready, so that the messages are not delayed
+     * while the sink is idle.
+     */
+    BOOST_LOG_API void on_idle();
+
+    /*!
+     * The method sends the accumulated messages to the syslog server. If the backend uses TCP sockets,
+     * the method waits for the connection in progress to complete and for the messages to be sent.
+     */
+    BOOST_LOG_API void flush();
+
 private:
 #ifndef BOOST_LOG_DOXYGEN_PASS
     //! The method creates the backend implementation
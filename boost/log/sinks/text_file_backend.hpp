@@ -16,6 +16,8 @@
 #define BOOST_LOG_SINKS_TEXT_FILE_BACKEND_HPP_INCLUDED_
 
 #include <ios>
+#include <ctime>
+#include <cstddef>
 #include <string>
 #include <ostream>
 #include <boost/limits.hpp>
@@ -29,11 +31,21 @@
 #include <boost/log/keywords/max_size.hpp>
 #include <boost/log/keywords/min_free_space.hpp>
 #include <boost/log/keywords/target.hpp>
+#include <boost/log/keywords/background_collection.hpp>
+#include <boost/log/keywords/compression_level.hpp>
+#include <boost/log/keywords/manifest.hpp>
 #include <boost/log/keywords/file_name.hpp>
 #include <boost/log/keywords/open_mode.hpp>
 #include <boost/log/keywords/auto_flush.hpp>
 #include <boost/log/keywords/rotation_size.hpp>
 #include <boost/log/keywords/time_based_rotation.hpp>
+#include <boost/log/keywords/write_buffer_size.hpp>
+#include <boost/log/keywords/write_buffer_latency.hpp>
+#include <boost/log/keywords/write_buffer_count.hpp>
+#include <boost/log/keywords/output_mode.hpp>
+#include <boost/log/keywords/direct_io.hpp>
+#include <boost/log/keywords/durability.hpp>
+#include <boost/log/keywords/sync_latency.hpp>
 #include <boost/log/detail/config.hpp>
 #include <boost/log/detail/light_function.hpp>
 #include <boost/log/detail/parameter_tools.hpp>
@@ -61,6 +73,22 @@ enum scan_method
     scan_all        //!< Scan for all files in the directory
 };
 
+//! The enumeration of the file output modes
+enum output_mode
+{
+    stream_output,  //!< The file is written through a file stream
+    async_output,   //!< The file is written with multiple writes in flight, asynchronously where supported
+    mapped_output   //!< The file is preallocated and written through a memory mapping
+};
+
+//! The enumeration of the durability levels of the written log records
+enum durability
+{
+    no_durability,      //!< The records are written to the file when the buffers are full or flushed
+    flush_durability,   //!< Every record is written to the file, i.e. passed to the operating system
+    sync_durability     //!< Every record is written to the file and synchronized with the storage before the logging call returns
+};
+
 /*!
  * \brief Base class for file collectors
  *
@@ -129,7 +157,10 @@ namespace aux {
     BOOST_LOG_API shared_ptr< collector > make_collector(
         filesystem::path const& target_dir,
         uintmax_t max_size,
-        uintmax_t min_free_space
+        uintmax_t min_free_space,
+        bool background_collection,
+        int compression_level,
+        bool manifest
     );
     template< typename ArgsT >
     inline shared_ptr< collector > make_collector(ArgsT const& args)
@@ -137,7 +168,10 @@ namespace aux {
         return aux::make_collector(
             filesystem::path(args[keywords::target]),
             args[keywords::max_size | (std::numeric_limits< uintmax_t >::max)()],
-            args[keywords::min_free_space | static_cast< uintmax_t >(0)]);
+            args[keywords::min_free_space | static_cast< uintmax_t >(0)],
+            args[keywords::background_collection | false],
+            args[keywords::compression_level | 0],
+            args[keywords::manifest | false]);
     }
 
 } // namespace aux
@@ -159,6 +193,21 @@ inline shared_ptr< collector > make_collector(T1 const& a1, T2 const& a2, T3 con
 {
     return aux::make_collector((a1, a2, a3));
 }
+template< typename T1, typename T2, typename T3, typename T4 >
+inline shared_ptr< collector > make_collector(T1 const& a1, T2 const& a2, T3 const& a3, T4 const& a4)
+{
+    return aux::make_collector((a1, a2, a3, a4));
+}
+template< typename T1, typename T2, typename T3, typename T4, typename T5 >
+inline shared_ptr< collector > make_collector(T1 const& a1, T2 const& a2, T3 const& a3, T4 const& a4, T5 const& a5)
+{
+    return aux::make_collector((a1, a2, a3, a4, a5));
+}
+template< typename T1, typename T2, typename T3, typename T4, typename T5, typename T6 >
+inline shared_ptr< collector > make_collector(T1 const& a1, T2 const& a2, T3 const& a3, T4 const& a4, T5 const& a5, T6 const& a6)
+{
+    return aux::make_collector((a1, a2, a3, a4, a5, a6));
+}
 
 #else
 
@@ -190,6 +239,51 @@ inline shared_ptr< collector > make_collector(T1 const& a1, T2 const& a2, T3 con
  *                         the collector tries to maintain. If the threshold is exceeded, the oldest
  *                         file(s) is deleted to free space. The threshold is not maintained, if not
  *                         specified.
+ * \li \c background_collection - Specifies whether the stored files are processed in a background
+ *                                thread. If \c true, the \c store_file method only renames the file
+ *                                into the target directory, or, if the target directory is on a
+ *                                different device, renames the file to a temporary name in its
+ *                                current directory. Moving the file between devices and deleting old
+ *                                files is performed by the background thread, which is stopped when
+ *                                the collector is destroyed. Errors in the background thread are not
+ *                                reported. The thread retries storing the file a few times, and then
+ *                                keeps the file where it is, still counting it towards the
+ *                                thresholds. The temporary names of the files contain
+ *                                ".boost_log_pending.", so that if the application terminates before
+ *                                the files are stored, \c scan_for_files finds them and lets the
+ *                                background thread store them, or counts them towards the thresholds
+ *                                if the files are not processed in background. If the collector is
+ *                                requested more than once, the files are processed in background if
+ *                                it was requested at least once. By default, is \c false, unless
+ *                                compression is enabled. Not supported in single-threaded builds.
+ * \li \c compression_level - Specifies the gzip compression level, from 1 to 9, of the stored files.
+ *                            If specified, the stored files are compressed and the uncompressed
+ *                            files are deleted. The compressed files are named after the original
+ *                            files with the ".gz" suffix, and their compressed sizes are taken into
+ *                            account when maintaining the \c max_size and \c min_free_space
+ *                            thresholds. Compression implies background collection, except in
+ *                            single-threaded builds, where the files are compressed in the thread
+ *                            that rotates the file. If the collector is requested more than once,
+ *                            the highest level is used. By default, is 0, which means the files are
+ *                            not compressed. If the library is built with
+ *                            \c BOOST_LOG_WITHOUT_COMPRESSION, specifying a non-zero level results
+ *                            in \c setup_error exception.
+ * \li \c manifest - Specifies whether the collector maintains the manifest of the target directory.
+ *                   The manifest is a file named ".boost_log_manifest" in the target directory that
+ *                   lists the names, sizes and modification times of the files in the directory.
+ *                   When \c scan_for_files is called for the target directory and the directory has
+ *                   not been modified since the manifest was last updated, the files are looked up
+ *                   in the manifest instead of querying each file in the directory. Otherwise the
+ *                   directory is scanned and the manifest is rewritten. Once written, the manifest
+ *                   is updated as the collector stores and deletes files. Because the directory
+ *                   modification time has limited granularity, the manifest is not trusted if it was
+ *                   last updated too soon after the directory was modified. The collector tries to
+ *                   fix this when it is destroyed, which may delay the destruction by a few
+ *                   milliseconds. The manifest is removed and no longer maintained once the backend
+ *                   stores files that it writes to the target directory, because the directory is
+ *                   then modified after every update of the manifest. If the collector is requested
+ *                   more than once, the manifest is maintained if it was requested at least once. By
+ *                   default, is \c false.
  *
  * \return The file collector.
  */
@@ -206,7 +300,9 @@ shared_ptr< collector > make_collector(ArgsT... const& args);
  * \li rotation takes place on the specified day of every week, at the specified time
  * \li rotation takes place on the specified day of every month, at the specified time
  *
- * The time points are considered to be local time.
+ * The time points are considered to be local time. The predicate computes the deadline of the next rotation
+ * when it is first called and after each rotation, so that the check for the most part only compares the current
+ * system time with the deadline. The local time is only consulted when the deadline is reached.
  */
 class rotation_at_time_point
 {
@@ -225,7 +321,8 @@ private:
     unsigned char m_Day : 6;
     unsigned char m_Hour, m_Minute, m_Second;
 
-    mutable posix_time::ptime m_Previous;
+    mutable posix_time::ptime m_Next;
+    mutable std::time_t m_Deadline;
 
 public:
     /*!
@@ -269,11 +366,15 @@ public:
      * Checks if it's time to rotate the file
      */
     BOOST_LOG_API bool operator() () const;
+
+private:
+    //! Computes the local time of the next rotation after the specified local time
+    posix_time::ptime next_rotation_time(posix_time::ptime const& now) const;
 };
 
 /*!
  * The class represents the time interval of log file rotation. The log file will be rotated
- * after the specified time interval has passed.
+ * after the specified time interval has passed. The interval is measured with one second precision.
  */
 class rotation_at_time_interval
 {
@@ -282,7 +383,7 @@ public:
 
 private:
     posix_time::time_duration m_Interval;
-    mutable posix_time::ptime m_Previous;
+    mutable std::time_t m_Deadline;
 
 public:
     /*!
@@ -291,7 +392,8 @@ public:
      * \param interval The interval of the rotation, should be no less than 1 second
      */
     explicit rotation_at_time_interval(posix_time::time_duration const& interval) :
-        m_Interval(interval)
+        m_Interval(interval),
+        m_Deadline(0)
     {
         BOOST_ASSERT(!interval.is_special());
         BOOST_ASSERT(interval.total_seconds() > 0);
@@ -316,13 +418,13 @@ public:
 class text_file_backend :
     public basic_formatted_sink_backend<
         char,
-        combine_requirements< synchronized_feeding, flushing >::type
+        combine_requirements< synchronized_feeding, flushing, committing, idle_notification >::type
     >
 {
     //! Base type
     typedef basic_formatted_sink_backend<
         char,
-        combine_requirements< synchronized_feeding, flushing >::type
+        combine_requirements< synchronized_feeding, flushing, committing, idle_notification >::type
     > base_type;
 
 public:
@@ -341,6 +443,40 @@ public:
     //! Predicate that defines the time-based condition for file rotation
     typedef boost::log::aux::light_function< bool () > time_based_rotation_predicate;
 
+    /*!
+     * \brief The state of the write buffer of the backend
+     *
+     * The structure is returned by the \c get_write_buffer_statistics method of the backend.
+     */
+    struct write_buffer_statistics
+    {
+        //! The size of the write buffer, in characters. Zero if the buffer is disabled.
+        std::size_t capacity;
+        //! The number of characters currently held in the buffer
+        std::size_t size;
+        //! Total number of writes of the buffer contents to the file
+        uintmax_t write_count;
+        //! The number of writes made because the buffer was full
+        uintmax_t size_triggered_write_count;
+        //! The number of writes made because the latency deadline was reached
+        uintmax_t deadline_triggered_write_count;
+        //! The number of writes made because the frontend had no more records ready
+        uintmax_t idle_triggered_write_count;
+        //! Total number of characters written to the file through the buffer
+        uintmax_t written_characters;
+
+        write_buffer_statistics() :
+            capacity(0),
+            size(0),
+            write_count(0),
+            size_triggered_write_count(0),
+            deadline_triggered_write_count(0),
+            idle_triggered_write_count(0),
+            written_characters(0)
+        {
+        }
+    };
+
 private:
     //! \cond
 
@@ -378,6 +514,35 @@ public:
      *                              No time-based file rotations will be performed, if not specified.
      * \li \c auto_flush - Specifies a flag, whether or not to automatically flush the file after each
      *                     written log record. By default, is \c false.
+     * \li \c write_buffer_size - Specifies the size, in characters, of the write buffer. Formatted records
+     *                           are accumulated in the buffer and written to the file with a single write
+     *                           operation when the buffer is full. If not specified or zero, the records are
+     *                           written directly to the file stream.
+     * \li \c write_buffer_latency - Specifies the maximum time the records are kept in the write buffer.
+     *                              The buffered records are written to the file when a record is written
+     *                              after this time has passed since the first record was put into the buffer,
+     *                              and when the asynchronous frontend has no more records ready.
+     *                              If not specified, the buffer is only written when it is full or on flushing.
+     * \li \c output_mode - Specifies the way the file is written, see \c file::output_mode. In the \c async_output
+     *                     mode the file is written with several writes in flight, so that the backend does not
+     *                     wait for the previous writes to complete. On Linux the writes are performed with io_uring,
+     *                     if it is available. Otherwise the writes are performed synchronously. The mode is not
+     *                     supported on Windows, where the file is always written through a file stream.
+     *                     In the \c mapped_output mode the file is preallocated up to the rotation size (but no more
+     *                     than 256 MiB at a time) and the records are copied into the memory mapped file. The file is
+     *                     truncated to the actual size when it is closed. If the file cannot be preallocated or mapped,
+     *                     or on Windows, the file is written through a file stream.
+     *                     If not specified, \c stream_output is used.
+     * \li \c write_buffer_count - Specifies the number of buffers in the \c async_output mode. Each buffer has
+     *                            the size specified by \c write_buffer_size or 64 KiB, if the write buffer is not used.
+     *                            If not specified, 4 buffers are used.
+     * \li \c direct_io - Specifies whether the file should be opened with \c O_DIRECT in the \c async_output mode,
+     *                   bypassing the system file cache. If the file system does not support direct I/O, the flag
+     *                   is ignored. By default, is \c false.
+     * \li \c durability - Specifies the durability level of the written records, see \c set_durability.
+     *                    If not specified, \c no_durability is used.
+     * \li \c sync_latency - Specifies the maximum time the synchronization with the storage may be delayed
+     *                      in the \c sync_durability mode, see \c set_durability. By default, is zero.
      *
      * \note Read caution regarding file name pattern in the <tt>file::collector::scan_for_files</tt>
      *       documentation.
@@ -465,6 +630,57 @@ public:
      */
     BOOST_LOG_API void auto_flush(bool f = true);
 
+    /*!
+     * The method sets the size of the write buffer. The records already in the buffer are written to the file.
+     *
+     * \param size The size of the write buffer, in characters. If zero, the records are written directly to the file stream.
+     */
+    BOOST_LOG_API void set_write_buffer_size(std::size_t size);
+
+    /*!
+     * The method sets the maximum time the records are kept in the write buffer.
+     *
+     * \note The deadline is only checked when a record is written. With the asynchronous frontend the buffer is
+     *       also written when the frontend has no more records ready, see \c on_idle. With other frontends
+     *       the records may stay in the buffer longer if no records are written. Use \c flush to write
+     *       the buffered records to the file.
+     *
+     * \param latency The maximum latency. Special values, such as <tt>posix_time::pos_infin</tt>, disable the deadline.
+     */
+    BOOST_LOG_API void set_write_buffer_latency(posix_time::time_duration const& latency);
+
+    /*!
+     * The method sets the output mode. The mode takes effect when the next file is opened.
+     *
+     * \param mode The output mode
+     * \param buffer_count The number of buffers in the \c async_output mode
+     * \param direct_io If \c true, the file is written with direct I/O in the \c async_output mode, if possible
+     */
+    BOOST_LOG_API void set_output_mode(file::output_mode mode, unsigned int buffer_count = 4u, bool direct_io = false);
+
+    /*!
+     * The method sets the durability level of the written records.
+     *
+     * In the \c flush_durability mode every record is written to the file immediately, which makes it survive
+     * an application crash. In the \c sync_durability mode the file data is additionally synchronized with
+     * the storage, which makes the records survive a system crash. Synchronization is performed in the \c commit
+     * method, which the sink frontends call after feeding the record and unlocking the backend. A single
+     * synchronization covers all records written by the time it starts, so the threads that write records
+     * concurrently wait for a shared synchronization instead of performing one per record. The synchronization
+     * may be delayed by up to \a sync_latency to let more records be written before it.
+     *
+     * \note On Windows the \c sync_durability mode is equivalent to \c flush_durability.
+     *
+     * \param level The durability level
+     * \param sync_latency The maximum time the synchronization may be delayed in the \c sync_durability mode
+     */
+    BOOST_LOG_API void set_durability(file::durability level, posix_time::time_duration const& sync_latency = posix_time::time_duration(0, 0, 0));
+
+    /*!
+     * The method returns the current state of the write buffer
+     */
+    BOOST_LOG_API write_buffer_statistics get_write_buffer_statistics() const;
+
     /*!
      * Performs scanning of the target directory for log files that may have been left from
      * previous runs of the application. The found files are considered by the file collector
@@ -493,10 +709,24 @@ public:
     BOOST_LOG_API void consume(record_view const& rec, string_type const& formatted_message);
 
     /*!
-     * The method flushes the currently open log file
+     * The method writes the buffered records and flushes the currently open log file
      */
     BOOST_LOG_API void flush();
 
+    /*!
+     * The method writes the buffered records to the file, if the write buffer latency is set. The method is called
+     * by the asynchronous frontend when it has no more records ready, so that the records do not stay in the buffer
+     * while the sink is idle.
+     */
+    BOOST_LOG_API void on_idle();
+
+    /*!
+     * The method waits until the records written so far are synchronized with the storage, if the backend
+     * operates in the \c sync_durability mode. Unlike other methods of the backend, this method can be called
+     * concurrently with other methods.
+     */
+    BOOST_LOG_API void commit();
+
     /*!
      * The method rotates the file
      */
@@ -513,7 +743,14 @@ private:
             args[keywords::open_mode | (std::ios_base::trunc | std::ios_base::out)],
             args[keywords::rotation_size | (std::numeric_limits< uintmax_t >::max)()],
             args[keywords::time_based_rotation | time_based_rotation_predicate()],
-            args[keywords::auto_flush | false]);
+            args[keywords::auto_flush | false],
+            args[keywords::write_buffer_size | static_cast< std::size_t >(0u)],
+            args[keywords::write_buffer_latency | posix_time::time_duration(posix_time::pos_infin)],
+            args[keywords::output_mode | file::stream_output],
+            args[keywords::write_buffer_count | 4u],
+            args[keywords::direct_io | false],
+            args[keywords::durability | file::no_durability],
+            args[keywords::sync_latency | posix_time::time_duration(0, 0, 0)]);
     }
     //! Constructor implementation
     BOOST_LOG_API void construct(
@@ -521,7 +758,14 @@ private:
         std::ios_base::openmode mode,
         uintmax_t rotation_size,
         time_based_rotation_predicate const& time_based_rotation,
-        bool auto_flush);
+        bool auto_flush,
+        std::size_t write_buffer_size,
+        posix_time::time_duration const& write_buffer_latency,
+        file::output_mode output_mode,
+        unsigned int write_buffer_count,
+        bool direct_io,
+        file::durability durability,
+        posix_time::time_duration const& sync_latency);
 
     //! The method sets file name mask
     BOOST_LOG_API void set_file_name_pattern_internal(filesystem::path const& pattern);
@@ -17,16 +17,19 @@
 
 #include <ios>
 #include <string>
+#include <cstddef>
 #include <locale>
 #include <ostream>
 #include <boost/mpl/if.hpp>
 #include <boost/mpl/bool.hpp>
 #include <boost/type_traits/is_same.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/log/detail/config.hpp>
 #include <boost/log/detail/light_function.hpp>
 #include <boost/log/detail/cleanup_scope_guard.hpp>
 #include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/sinks/frontend_requirements.hpp>
 #include <boost/log/utility/formatting_ostream.hpp>
 #include <boost/log/detail/header.hpp>
 
@@ -131,12 +134,23 @@ namespace file {
  * The particular file is chosen upon each record's attribute values, which allows
  * to distribute records into individual files or to group records related to
  * some entity or process in a separate file.
+ *
+ * By default, the file is opened and closed for every record. The backend can be configured
+ * to keep a limited number of recently used files open, in which case the records are buffered
+ * and written to the files when the buffers are full, when the files are closed or when the backend
+ * is flushed.
  */
 class text_multifile_backend :
-    public basic_formatted_sink_backend< char >
+    public basic_formatted_sink_backend<
+        char,
+        combine_requirements< synchronized_feeding, flushing >::type
+    >
 {
     //! Base type
-    typedef basic_formatted_sink_backend< char > base_type;
+    typedef basic_formatted_sink_backend<
+        char,
+        combine_requirements< synchronized_feeding, flushing >::type
+    > base_type;
 
 public:
     //! Character type
@@ -178,11 +192,38 @@ public:
         set_file_name_composer_internal(composer);
     }
 
+    /*!
+     * The method sets the maximum number of files that are kept open. When a record has to be written
+     * to a file that is not open and the limit is reached, the least recently used file is closed.
+     *
+     * \param count The maximum number of open files. If 0, which is the default, the file is closed
+     *              after writing every record.
+     */
+    BOOST_LOG_API void set_max_open_files(std::size_t count);
+
+    /*!
+     * The method sets the time after which an open file that has not been written to is closed.
+     * The idle files are closed when records are written and when the backend is flushed.
+     * The timeout only has effect if the files are kept open, see \c set_max_open_files.
+     *
+     * \param timeout The idle timeout, must be positive. The timeout is rounded up to whole seconds.
+     *                If not specified or \c not_a_date_time, which is the default, the files are not
+     *                closed on timeout.
+     *
+     * \throw setup_error If \a timeout is zero or negative.
+     */
+    BOOST_LOG_API void set_idle_timeout(posix_time::time_duration const& timeout = posix_time::time_duration(date_time::not_a_date_time));
+
     /*!
      * The method writes the message to the sink
      */
     BOOST_LOG_API void consume(record_view const& rec, string_type const& formatted_message);
 
+    /*!
+     * The method writes the buffered data of all open files and closes the idle files
+     */
+    BOOST_LOG_API void flush();
+
 private:
 #ifndef BOOST_LOG_DOXYGEN_PASS
     //! The method sets the file name composer
@@ -16,6 +16,7 @@
 #define BOOST_LOG_SINKS_TEXT_OSTREAM_BACKEND_HPP_INCLUDED_
 
 #include <ostream>
+#include <cstddef>
 #include <boost/shared_ptr.hpp>
 #include <boost/log/detail/config.hpp>
 #include <boost/log/sinks/basic_sink_backend.hpp>
@@ -41,13 +42,13 @@ template< typename CharT >
 class basic_text_ostream_backend :
     public basic_formatted_sink_backend<
         CharT,
-        combine_requirements< synchronized_feeding, flushing >::type
+        combine_requirements< synchronized_feeding, flushing, batched_records >::type
     >
 {
     //! Base type
     typedef basic_formatted_sink_backend<
         CharT,
-        combine_requirements< synchronized_feeding, flushing >::type
+        combine_requirements< synchronized_feeding, flushing, batched_records >::type
     > base_type;
 
 public:
@@ -100,6 +101,12 @@ public:
      */
     BOOST_LOG_API void consume(record_view const& rec, string_type const& formatted_message);
 
+    /*!
+     * The method writes a batch of messages to the sink. If auto flush is enabled,
+     * the streams are flushed once after the whole batch is written.
+     */
+    BOOST_LOG_API void consume(record_view const* records, string_type const* formatted_messages, std::size_t count);
+
     /*!
      * The method flushes the associated streams
      */
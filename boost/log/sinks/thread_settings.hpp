@@ -0,0 +1,181 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   thread_settings.hpp
+ * \author Andrey Semashev
+ * \date   18.10.2013
+ *
+ * The header contains definition of the settings of the threads created by sink frontends
+ * and sink dispatchers.
+ */
+
+#ifndef BOOST_LOG_SINKS_THREAD_SETTINGS_HPP_INCLUDED_
+#define BOOST_LOG_SINKS_THREAD_SETTINGS_HPP_INCLUDED_
+
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if defined(BOOST_LOG_NO_THREADS)
+#error Boost.Log: This header content is only supported in multithreaded environment
+#endif
+
+#include <climits>
+#include <string>
+#include <vector>
+#include <boost/log/keywords/cpu_affinity.hpp>
+#include <boost/log/keywords/scheduling_policy.hpp>
+#include <boost/log/keywords/nice.hpp>
+#include <boost/log/keywords/thread_name.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace sinks {
+
+/*!
+ * \brief Settings of the record feeding threads
+ *
+ * The class describes the placement and scheduling of the threads that feed log records to sink backends.
+ * The settings can be specified with the following named parameters of the asynchronous sink frontend constructor:
+ *
+ * \li \c cpu_affinity - the set of CPUs the threads are allowed to run on. The set can be specified either as a vector
+ *     of CPU numbers or as a string with a comma-separated list of CPU numbers and ranges, e.g. "0-3,8".
+ * \li \c scheduling_policy - the scheduling policy of the threads, one of the \c scheduling_policy_type values.
+ * \li \c nice - the nice value of the threads. Higher values result in lower priority.
+ * \li \c thread_name - the name of the threads, as visible in debuggers and system tools. The name may be truncated
+ *     according to the system limits.
+ *
+ * The settings are applied by the threads themselves upon starting. Settings that are not supported by the operating
+ * system or fail to apply (e.g. due to insufficient privileges) are ignored, since the feeding threads have no way
+ * to report the failure. The \c apply method returns the result of applying the settings, which can be used
+ * to verify the settings in a thread created for this purpose. The CPU affinity and the nice value are supported on Linux and Windows,
+ * the scheduling policy on Linux and Windows (where the \c idle policy selects the idle thread priority), the thread name
+ * on Linux only.
+ */
+class thread_settings
+{
+public:
+    //! Scheduling policies
+    enum scheduling_policy_type
+    {
+        default_scheduling,     //!< The default policy of the system, the policy is not changed
+        batch_scheduling,       //!< The policy for non-interactive CPU-intensive threads (\c SCHED_BATCH on Linux)
+        idle_scheduling         //!< The policy for threads that only run when the system is otherwise idle (\c SCHED_IDLE on Linux)
+    };
+
+    //! The nice value that indicates that the nice value of the threads should not be changed
+    enum { no_nice = INT_MIN };
+
+private:
+    //! The CPUs to run on, empty if not restricted
+    std::vector< unsigned int > m_cpus;
+    //! Scheduling policy
+    scheduling_policy_type m_policy;
+    //! Nice value
+    int m_nice;
+    //! Thread name
+    std::string m_name;
+
+public:
+    /*!
+     * Default constructor. Constructs settings that do not change the thread properties.
+     */
+    thread_settings() : m_policy(default_scheduling), m_nice(no_nice)
+    {
+    }
+    /*!
+     * Constructs the settings from named parameters
+     */
+    template< typename ArgsT >
+    explicit thread_settings(ArgsT const& args) :
+        m_policy(args[keywords::scheduling_policy | default_scheduling]),
+        m_nice(args[keywords::nice | static_cast< int >(no_nice)]),
+        m_name(args[keywords::thread_name | std::string()])
+    {
+        set_cpu_affinity(args[keywords::cpu_affinity | std::vector< unsigned int >()]);
+    }
+
+    /*!
+     * Returns the CPUs the threads are allowed to run on. An empty set means the affinity is not restricted.
+     */
+    std::vector< unsigned int > const& cpu_affinity() const { return m_cpus; }
+    /*!
+     * Sets the CPUs the threads are allowed to run on
+     */
+    void set_cpu_affinity(std::vector< unsigned int > const& cpus) { m_cpus = cpus; }
+    /*!
+     * Sets the CPUs the threads are allowed to run on from a string with a comma-separated list
+     * of CPU numbers and ranges, e.g. "0-3,8". An empty string means the affinity is not restricted.
+     *
+     * \throw invalid_value If the string cannot be parsed or a CPU number exceeds the maximum number of CPUs
+     *                      supported by the system API (e.g. \c CPU_SETSIZE on Linux).
+     */
+    BOOST_LOG_API void set_cpu_affinity(std::string const& cpus);
+    /*!
+     * \overload
+     */
+    void set_cpu_affinity(const char* cpus) { set_cpu_affinity(std::string(cpus)); }
+
+    /*!
+     * Returns the scheduling policy
+     */
+    scheduling_policy_type scheduling_policy() const { return m_policy; }
+    /*!
+     * Sets the scheduling policy
+     */
+    void set_scheduling_policy(scheduling_policy_type policy) { m_policy = policy; }
+
+    /*!
+     * Returns the nice value or \c no_nice if the nice value is not changed
+     */
+    int nice() const { return m_nice; }
+    /*!
+     * Sets the nice value
+     */
+    void set_nice(int value) { m_nice = value; }
+
+    /*!
+     * Returns the thread name
+     */
+    std::string const& thread_name() const { return m_name; }
+    /*!
+     * Sets the thread name. An empty name means the thread name is not changed.
+     */
+    void set_thread_name(std::string const& name) { m_name = name; }
+
+    /*!
+     * Returns \c true if the settings do not change any thread properties
+     */
+    bool empty() const
+    {
+        return m_cpus.empty() && m_policy == default_scheduling && m_nice == static_cast< int >(no_nice) && m_name.empty();
+    }
+
+    /*!
+     * Applies the settings to the current thread. The method does not stop on failures, all settings
+     * that can be applied are applied.
+     *
+     * \return \c true if all settings were applied, \c false if some of the settings are not supported
+     *         or failed to apply. The feeding threads of the library ignore the result.
+     */
+    BOOST_LOG_API bool apply() const;
+};
+
+} // namespace sinks
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_SINKS_THREAD_SETTINGS_HPP_INCLUDED_
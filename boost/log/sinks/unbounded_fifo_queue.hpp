@@ -26,9 +26,13 @@
 #error Boost.Log: This header content is only supported in multithreaded environment
 #endif
 
-#include <boost/log/detail/event.hpp>
+#include <boost/atomic/atomic.hpp>
+#include <boost/log/detail/queue_waiter.hpp>
 #include <boost/log/detail/threadsafe_queue.hpp>
 #include <boost/log/core/record_view.hpp>
+#include <boost/log/sinks/queue_statistics.hpp>
+#include <boost/log/sinks/wait_strategy.hpp>
+#include <boost/log/keywords/wait_strategy.hpp>
 #include <boost/log/detail/header.hpp>
 
 namespace boost {
@@ -50,6 +54,9 @@ namespace sinks {
  * however if sink backends can't consume log records fast enough the queue
  * may grow uncontrollably. When this is an issue, it is recommended to
  * use one of the bounded strategies.
+ *
+ * The way the feeding thread waits for new records can be customized with the
+ * \c wait_strategy named parameter of the frontend constructor.
  */
 class unbounded_fifo_queue
 {
@@ -59,19 +66,21 @@ private:
 private:
     //! Thread-safe queue
     queue_type m_queue;
-    //! Event object to block on
-    boost::log::aux::event m_event;
+    //! Implementation of the wait strategy
+    boost::log::aux::queue_waiter m_waiter;
     //! Interruption flag
-    volatile bool m_interruption_requested; // TODO: make it atomic
+    boost::atomic< bool > m_interruption_requested;
 
 protected:
     //! Default constructor
-    unbounded_fifo_queue() : m_interruption_requested(false)
+    unbounded_fifo_queue() : m_waiter(wait_strategy()), m_interruption_requested(false)
     {
     }
     //! Initializing constructor
     template< typename ArgsT >
-    explicit unbounded_fifo_queue(ArgsT const&) : m_interruption_requested(false)
+    explicit unbounded_fifo_queue(ArgsT const& args) :
+        m_waiter(args[keywords::wait_strategy | wait_strategy()]),
+        m_interruption_requested(false)
     {
     }
 
@@ -79,7 +88,7 @@ protected:
     void enqueue(record_view const& rec)
     {
         m_queue.push(rec);
-        m_event.set_signalled();
+        m_waiter.notify();
     }
 
     //! Attempts to enqueue log record to the queue
@@ -105,29 +114,19 @@ protected:
     //! Dequeues log record from the queue, blocks if the queue is empty
     bool dequeue_ready(record_view& rec)
     {
-        // Try the fast way first
-        if (m_queue.try_pop(rec))
-            return true;
-
-        // Ok, we probably have to wait for new records
-        while (true)
-        {
-            m_event.wait();
-            if (m_interruption_requested)
-            {
-                m_interruption_requested = false;
-                return false;
-            }
-            if (m_queue.try_pop(rec))
-                return true;
-        }
+        return m_waiter.wait_and_pop(m_queue, &queue_type::try_pop, rec, m_interruption_requested);
+    }
+
+    //! Adds the overflow statistics of the queue to \a stats. The queue never overflows, so the method does nothing.
+    static void get_overflow_statistics(queue_statistics&)
+    {
     }
 
     //! Wakes a thread possibly blocked in the \c dequeue method
     void interrupt_dequeue()
     {
-        m_interruption_requested = true;
-        m_event.set_signalled();
+        m_interruption_requested.store(true, boost::memory_order_release);
+        m_waiter.interrupt();
     }
 };
 
@@ -40,6 +40,7 @@
 #include <boost/log/keywords/order.hpp>
 #include <boost/log/keywords/ordering_window.hpp>
 #include <boost/log/core/record_view.hpp>
+#include <boost/log/sinks/queue_statistics.hpp>
 #include <boost/log/detail/header.hpp>
 
 namespace boost {
@@ -144,6 +145,9 @@ private:
     bool m_interruption_requested;
 
 public:
+    //! The tag indicates that queued records become ready for processing with time
+    typedef void delayed_records_tag;
+
     /*!
      * Returns ordering window size specified during initialization
      */
@@ -268,6 +272,11 @@ protected:
         return false;
     }
 
+    //! Adds the overflow statistics of the queue to \a stats. The queue never overflows, so the method does nothing.
+    static void get_overflow_statistics(queue_statistics&)
+    {
+    }
+
     //! Wakes a thread possibly blocked in the \c dequeue method
     void interrupt_dequeue()
     {
@@ -0,0 +1,159 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   wait_strategy.hpp
+ * \author Andrey Semashev
+ * \date   14.10.2013
+ *
+ * The header contains definition of the wait strategy of the record feeding thread
+ * for the asynchronous sink frontend.
+ */
+
+#ifndef BOOST_LOG_SINKS_WAIT_STRATEGY_HPP_INCLUDED_
+#define BOOST_LOG_SINKS_WAIT_STRATEGY_HPP_INCLUDED_
+
+#include <boost/log/detail/config.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if defined(BOOST_LOG_NO_THREADS)
+#error Boost.Log: This header content is only supported in multithreaded environment
+#endif
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace sinks {
+
+/*!
+ * \brief Wait strategy of the record feeding thread
+ *
+ * The class describes how the record feeding thread of the asynchronous sink frontend waits
+ * for new log records when the record queue is empty. The following strategies are supported:
+ *
+ * \li \c block - the feeding thread blocks until a logging thread wakes it up. This is the default.
+ *     Every record enqueued while the feeding thread is blocked costs a system call to wake it up.
+ * \li \c busy_spin - the feeding thread spins constantly, polling the queue. Logging threads never
+ *     have to wake it up, which results in the lowest latency at the cost of occupying one CPU core.
+ * \li \c spin_then_yield - the feeding thread spins for the specified number of attempts, and then yields
+ *     its time slice to other threads between further attempts. Logging threads never have to wake it up.
+ * \li \c spin_then_block - the feeding thread spins for the specified number of attempts, and then blocks.
+ *     Logging threads only wake up the feeding thread when it is actually blocked.
+ * \li \c timed_batch - the feeding thread wakes up periodically, with the specified interval, and processes
+ *     all records accumulated since the previous wakeup. Logging threads never have to wake it up.
+ *
+ * The strategy can be specified with the \c wait_strategy named parameter of the asynchronous sink frontend constructor.
+ */
+class wait_strategy
+{
+public:
+    //! Wait strategy kinds
+    enum mode_type
+    {
+        block_mode,             //!< Block until woken up by logging threads
+        busy_spin_mode,         //!< Constantly poll the queue
+        spin_then_yield_mode,   //!< Poll the queue, yield the time slice after a number of attempts
+        spin_then_block_mode,   //!< Poll the queue, block after a number of attempts
+        timed_batch_mode        //!< Poll the queue periodically
+    };
+
+    //! Default number of spinning attempts
+    enum { default_spin_count = 1000u };
+
+private:
+    //! Wait strategy kind
+    mode_type m_mode;
+    //! The number of spinning attempts
+    unsigned int m_spin_count;
+    //! Polling interval for the timed batch strategy, in milliseconds
+    unsigned int m_interval;
+
+public:
+    /*!
+     * Default constructor. Constructs the blocking strategy.
+     */
+    wait_strategy() : m_mode(block_mode), m_spin_count(0u), m_interval(0u)
+    {
+    }
+
+    /*!
+     * Returns the strategy kind
+     */
+    mode_type mode() const { return m_mode; }
+    /*!
+     * Returns the number of spinning attempts before yielding or blocking
+     */
+    unsigned int spin_count() const { return m_spin_count; }
+    /*!
+     * Returns the polling interval of the timed batch strategy
+     */
+    posix_time::time_duration interval() const { return posix_time::milliseconds(m_interval); }
+    /*!
+     * Returns the polling interval of the timed batch strategy, in milliseconds
+     */
+    unsigned int interval_milliseconds() const { return m_interval; }
+
+    /*!
+     * Returns the blocking strategy
+     */
+    static wait_strategy block()
+    {
+        return wait_strategy();
+    }
+    /*!
+     * Returns the busy spinning strategy
+     */
+    static wait_strategy busy_spin()
+    {
+        return wait_strategy(busy_spin_mode, 0u, 0u);
+    }
+    /*!
+     * Returns the strategy that spins for \a spin_count attempts and then yields the time slice between attempts
+     */
+    static wait_strategy spin_then_yield(unsigned int spin_count = default_spin_count)
+    {
+        return wait_strategy(spin_then_yield_mode, spin_count, 0u);
+    }
+    /*!
+     * Returns the strategy that spins for \a spin_count attempts and then blocks
+     */
+    static wait_strategy spin_then_block(unsigned int spin_count = default_spin_count)
+    {
+        return wait_strategy(spin_then_block_mode, spin_count, 0u);
+    }
+    /*!
+     * Returns the strategy that polls the queue with the specified interval. The interval
+     * is rounded to milliseconds and cannot be less than one millisecond.
+     */
+    static wait_strategy timed_batch(posix_time::time_duration const& interval)
+    {
+        const posix_time::time_duration::tick_type ms = interval.total_milliseconds();
+        return wait_strategy(timed_batch_mode, 0u, ms > 0 ? static_cast< unsigned int >(ms) : 1u);
+    }
+
+private:
+    wait_strategy(mode_type mode, unsigned int spin_count, unsigned int interval) :
+        m_mode(mode), m_spin_count(spin_count), m_interval(interval)
+    {
+    }
+};
+
+} // namespace sinks
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_SINKS_WAIT_STRATEGY_HPP_INCLUDED_
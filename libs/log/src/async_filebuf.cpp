@@ -0,0 +1,664 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   async_filebuf.cpp
+ * \author Andrey Semashev
+ * \date   19.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#include "async_filebuf.hpp"
+
+#if defined(BOOST_LOG_HAS_ASYNC_FILEBUF)
+
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(__linux__) && defined(__GNUC__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define BOOST_LOG_ASYNC_FILEBUF_USE_IO_URING
+#endif
+#endif
+#endif
+
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+BOOST_LOG_ANONYMOUS_NAMESPACE {
+
+    //! The default alignment of the buffers for direct I/O
+    enum { default_block_size = 4096u };
+
+    //! Rounds the value up to the multiple of the block size
+    inline std::size_t round_up(std::size_t value, std::size_t block_size)
+    {
+        return (value + block_size - 1u) / block_size * block_size;
+    }
+
+} // namespace
+
+#if defined(BOOST_LOG_ASYNC_FILEBUF_USE_IO_URING)
+
+//! Minimal io_uring wrapper
+struct async_filebuf::ring
+{
+    //! The io_uring file descriptor
+    int fd;
+    //! Submission queue ring mapping
+    unsigned char* sq_ring;
+    std::size_t sq_ring_size;
+    //! Completion queue ring mapping, may be the same as the submission queue mapping
+    unsigned char* cq_ring;
+    std::size_t cq_ring_size;
+    //! Submission queue entries
+    struct io_uring_sqe* sqes;
+    std::size_t sqes_size;
+
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_cqe* cqes;
+
+    //! I/O vectors of the submitted writes, one per buffer
+    std::vector< struct iovec > iovecs;
+
+    //! Creates the ring, returns \c NULL if io_uring is not supported
+    static ring* create(std::size_t entries)
+    {
+        struct io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        const int fd = static_cast< int >(syscall(__NR_io_uring_setup, static_cast< unsigned int >(entries), &params));
+        if (fd < 0)
+            return NULL;
+
+        ring* p = new (std::nothrow) ring();
+        if (!p)
+        {
+            ::close(fd);
+            return NULL;
+        }
+
+        p->fd = fd;
+        p->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        p->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap && p->cq_ring_size > p->sq_ring_size)
+            p->sq_ring_size = p->cq_ring_size;
+
+        void* sq = mmap(NULL, p->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq == MAP_FAILED)
+        {
+            p->destroy();
+            return NULL;
+        }
+        p->sq_ring = static_cast< unsigned char* >(sq);
+
+        if (single_mmap)
+        {
+            p->cq_ring = p->sq_ring;
+        }
+        else
+        {
+            void* cq = mmap(NULL, p->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cq == MAP_FAILED)
+            {
+                p->destroy();
+                return NULL;
+            }
+            p->cq_ring = static_cast< unsigned char* >(cq);
+        }
+
+        p->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+        void* sqes = mmap(NULL, p->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+        {
+            p->destroy();
+            return NULL;
+        }
+        p->sqes = static_cast< struct io_uring_sqe* >(sqes);
+
+        p->sq_tail = reinterpret_cast< unsigned* >(p->sq_ring + params.sq_off.tail);
+        p->sq_mask = reinterpret_cast< unsigned* >(p->sq_ring + params.sq_off.ring_mask);
+        p->sq_array = reinterpret_cast< unsigned* >(p->sq_ring + params.sq_off.array);
+        p->cq_head = reinterpret_cast< unsigned* >(p->cq_ring + params.cq_off.head);
+        p->cq_tail = reinterpret_cast< unsigned* >(p->cq_ring + params.cq_off.tail);
+        p->cq_mask = reinterpret_cast< unsigned* >(p->cq_ring + params.cq_off.ring_mask);
+        p->cqes = reinterpret_cast< struct io_uring_cqe* >(p->cq_ring + params.cq_off.cqes);
+
+        try
+        {
+            p->iovecs.resize(entries);
+        }
+        catch (...)
+        {
+            p->destroy();
+            return NULL;
+        }
+
+        return p;
+    }
+
+    //! Releases the ring
+    void destroy()
+    {
+        if (sqes)
+            munmap(sqes, sqes_size);
+        if (cq_ring && cq_ring != sq_ring)
+            munmap(cq_ring, cq_ring_size);
+        if (sq_ring)
+            munmap(sq_ring, sq_ring_size);
+        ::close(fd);
+        delete this;
+    }
+
+    //! Submits a write request. Returns \c false if the request could not be submitted.
+    bool submit_write(int file_fd, std::size_t index, const char* data, std::size_t size, uint64_t offset)
+    {
+        struct iovec& iov = iovecs[index];
+        iov.iov_base = const_cast< char* >(data);
+        iov.iov_len = size;
+
+        // Only the writing thread accesses the submission queue tail, and there are never more requests than entries
+        const unsigned int tail = *sq_tail;
+        const unsigned int idx = tail & *sq_mask;
+        struct io_uring_sqe* sqe = &sqes[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_WRITEV;
+        sqe->fd = file_fd;
+        sqe->off = offset;
+        sqe->addr = reinterpret_cast< uintptr_t >(&iov);
+        sqe->len = 1u;
+        sqe->user_data = index;
+        sq_array[idx] = idx;
+        __atomic_store_n(sq_tail, tail + 1u, __ATOMIC_RELEASE);
+
+        while (true)
+        {
+            const int res = static_cast< int >(syscall(__NR_io_uring_enter, fd, 1u, 0u, 0u, NULL, 0u));
+            if (res >= 1)
+                return true;
+            if (res < 0 && errno == EINTR)
+                continue;
+
+            // Take the request back, it will be written synchronously
+            __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+            return false;
+        }
+    }
+
+    //! Extracts one completion, if available
+    bool peek(std::size_t& index, long& result)
+    {
+        const unsigned int head = *cq_head;
+        if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+            return false;
+
+        struct io_uring_cqe const& cqe = cqes[head & *cq_mask];
+        index = static_cast< std::size_t >(cqe.user_data);
+        result = cqe.res;
+        __atomic_store_n(cq_head, head + 1u, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    //! Waits for at least one completion
+    bool wait()
+    {
+        while (true)
+        {
+            const int res = static_cast< int >(syscall(__NR_io_uring_enter, fd, 0u, 1u, IORING_ENTER_GETEVENTS, NULL, 0u));
+            if (res >= 0)
+                return true;
+            if (errno != EINTR)
+                return false;
+        }
+    }
+
+private:
+    ring() :
+        fd(-1),
+        sq_ring(NULL),
+        sq_ring_size(0),
+        cq_ring(NULL),
+        cq_ring_size(0),
+        sqes(NULL),
+        sqes_size(0),
+        sq_tail(NULL),
+        sq_mask(NULL),
+        sq_array(NULL),
+        cq_head(NULL),
+        cq_tail(NULL),
+        cq_mask(NULL),
+        cqes(NULL)
+    {
+    }
+};
+
+#else // defined(BOOST_LOG_ASYNC_FILEBUF_USE_IO_URING)
+
+//! Dummy ring, asynchronous writes are not supported
+struct async_filebuf::ring
+{
+    static ring* create(std::size_t) { return NULL; }
+    void destroy() {}
+    bool submit_write(int, std::size_t, const char*, std::size_t, uint64_t) { return false; }
+    bool peek(std::size_t&, long&) { return false; }
+    bool wait() { return false; }
+};
+
+#endif // defined(BOOST_LOG_ASYNC_FILEBUF_USE_IO_URING)
+
+async_filebuf::async_filebuf() :
+    m_fd(-1),
+    m_current(0),
+    m_pending_count(0),
+    m_buffer_size(0),
+    m_block_size(1u),
+    m_direct(false),
+    m_failed(false),
+    m_ring(NULL)
+{
+}
+
+async_filebuf::~async_filebuf()
+{
+    close();
+}
+
+//! Opens the file
+bool async_filebuf::open(filesystem::path const& name, std::ios_base::openmode mode, std::size_t buffer_size, std::size_t buffer_count, bool direct_io)
+{
+    if (is_open())
+        return false;
+
+    int flags = O_CREAT;
+#if defined(O_CLOEXEC)
+    flags |= O_CLOEXEC;
+#endif
+    // O_APPEND is not used since it makes pwrite ignore the offset
+    const bool append = (mode & std::ios_base::app) != 0;
+    if (!append && (mode & std::ios_base::trunc) != 0)
+        flags |= O_TRUNC;
+
+#if defined(O_DIRECT)
+    if (direct_io)
+    {
+        // Reading is needed to load the incomplete last block of the file when appending
+        m_fd = ::open(name.c_str(), flags | O_RDWR | O_DIRECT, 0666);
+        m_direct = m_fd >= 0;
+    }
+#endif
+    if (m_fd < 0)
+        m_fd = ::open(name.c_str(), flags | O_WRONLY, 0666);
+    if (m_fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(m_fd, &st) != 0)
+    {
+        cleanup();
+        return false;
+    }
+
+    m_block_size = 1u;
+    std::size_t alignment = sizeof(void*);
+    if (m_direct)
+    {
+        m_block_size = st.st_blksize > 0 ? static_cast< std::size_t >(st.st_blksize) : static_cast< std::size_t >(default_block_size);
+        if (m_block_size < static_cast< std::size_t >(default_block_size) && default_block_size % m_block_size == 0)
+            m_block_size = default_block_size;
+        alignment = m_block_size;
+    }
+
+    if (buffer_count < 2u)
+        buffer_count = 2u;
+    m_buffer_size = round_up(buffer_size > 0u ? buffer_size : static_cast< std::size_t >(default_block_size), m_block_size);
+
+    try
+    {
+        m_buffers.reserve(buffer_count);
+        for (std::size_t i = 0; i < buffer_count; ++i)
+        {
+            void* p = NULL;
+            if (posix_memalign(&p, alignment, m_buffer_size) != 0)
+                throw std::bad_alloc();
+            buffer buf = { static_cast< char* >(p), 0u, 0u, false };
+            m_buffers.push_back(buf);
+        }
+    }
+    catch (...)
+    {
+        cleanup();
+        return false;
+    }
+
+    m_current = 0;
+    m_pending_count = 0;
+    m_failed = false;
+
+    buffer& cur = m_buffers[m_current];
+    cur.offset = append ? static_cast< uint64_t >(st.st_size) : 0u;
+    setp(cur.data, cur.data + m_buffer_size);
+
+    const std::size_t tail = static_cast< std::size_t >(cur.offset % m_block_size);
+    if (tail > 0)
+    {
+        // Load the incomplete last block of the file, it will be rewritten
+        cur.offset -= tail;
+        if (pread(m_fd, cur.data, m_block_size, static_cast< off_t >(cur.offset)) != static_cast< ssize_t >(tail))
+        {
+            cleanup();
+            return false;
+        }
+        pbump(static_cast< int >(tail));
+    }
+
+    m_ring = ring::create(buffer_count);
+
+    return true;
+}
+
+//! Writes the buffered data and closes the file
+bool async_filebuf::close()
+{
+    if (!is_open())
+        return true;
+
+    const bool result = sync() == 0;
+    cleanup();
+    return result;
+}
+
+//! Starts writing the buffered data
+void async_filebuf::submit()
+{
+    if (is_open() && pptr() != pbase())
+        submit_current(false);
+}
+
+//! Starts writing the current buffer and switches to the next free buffer
+void async_filebuf::submit_current(bool pad)
+{
+    buffer& cur = m_buffers[m_current];
+    const std::size_t filled = static_cast< std::size_t >(pptr() - pbase());
+    // With direct I/O only whole blocks can be written, the incomplete block is moved to the next buffer
+    const std::size_t complete = filled / m_block_size * m_block_size;
+    std::size_t size = complete;
+    if (pad && complete < filled)
+    {
+        size = round_up(filled, m_block_size);
+        std::memset(cur.data + filled, 0, size - filled);
+    }
+    if (size == 0)
+        return;
+
+    if (!m_failed)
+    {
+        cur.size = size;
+        if (m_ring && m_ring->submit_write(m_fd, m_current, cur.data, size, cur.offset))
+        {
+            cur.pending = true;
+            ++m_pending_count;
+        }
+        else if (!write_sync(cur.data, size, cur.offset))
+        {
+            m_failed = true;
+        }
+    }
+
+    // Find a free buffer
+    std::size_t next = m_current;
+    while (true)
+    {
+        for (std::size_t i = 1; i < m_buffers.size(); ++i)
+        {
+            const std::size_t index = (m_current + i) % m_buffers.size();
+            if (!m_buffers[index].pending)
+            {
+                next = index;
+                break;
+            }
+        }
+        if (next != m_current)
+            break;
+        wait_one();
+    }
+
+    buffer& nb = m_buffers[next];
+    nb.offset = cur.offset + complete;
+    const std::size_t tail = filled - complete;
+    if (tail > 0)
+        std::memcpy(nb.data, cur.data + complete, tail);
+
+    m_current = next;
+    setp(nb.data, nb.data + m_buffer_size);
+    pbump(static_cast< int >(tail));
+}
+
+//! Writes data synchronously
+bool async_filebuf::write_sync(const char* data, std::size_t size, uint64_t offset)
+{
+    while (size > 0)
+    {
+        const ssize_t res = pwrite(m_fd, data, size, static_cast< off_t >(offset));
+        if (res < 0)
+        {
+            if (errno == EINTR)
+                continue;
+#if defined(O_DIRECT)
+            if (errno == EINVAL && m_direct)
+            {
+                // The file system does not support direct I/O with this alignment, fall back to buffered writes
+                const int flags = fcntl(m_fd, F_GETFL);
+                if (flags != -1 && fcntl(m_fd, F_SETFL, flags & ~O_DIRECT) == 0)
+                {
+                    m_direct = false;
+                    continue;
+                }
+            }
+#endif
+            return false;
+        }
+        data += res;
+        size -= static_cast< std::size_t >(res);
+        offset += static_cast< uint64_t >(res);
+    }
+    return true;
+}
+
+//! Marks the write from the buffer as completed
+void async_filebuf::complete(std::size_t index, long result)
+{
+    if (index >= m_buffers.size() || !m_buffers[index].pending)
+        return;
+
+    buffer& buf = m_buffers[index];
+    buf.pending = false;
+    --m_pending_count;
+
+    if (result < 0)
+    {
+        // Retry synchronously, which also handles the lack of direct I/O support
+        if (!write_sync(buf.data, buf.size, buf.offset))
+            m_failed = true;
+    }
+    else if (static_cast< std::size_t >(result) < buf.size)
+    {
+        // Short write, write the rest synchronously
+        if (!write_sync(buf.data + result, buf.size - static_cast< std::size_t >(result), buf.offset + static_cast< uint64_t >(result)))
+            m_failed = true;
+    }
+}
+
+//! Waits for at least one pending write to complete
+void async_filebuf::wait_one()
+{
+    std::size_t index = 0;
+    long result = 0;
+    bool completed = false;
+    while (m_ring->peek(index, result))
+    {
+        complete(index, result);
+        completed = true;
+    }
+
+    if (!completed)
+    {
+        if (!m_ring->wait())
+        {
+            // Should never happen, but in case if it does, there is no way to find out when the writes complete
+            m_failed = true;
+            for (std::size_t i = 0; i < m_buffers.size(); ++i)
+                m_buffers[i].pending = false;
+            m_pending_count = 0;
+            return;
+        }
+
+        while (m_ring->peek(index, result))
+            complete(index, result);
+    }
+}
+
+//! Waits for all pending writes to complete
+void async_filebuf::wait_all()
+{
+    while (m_pending_count > 0)
+        wait_one();
+}
+
+int async_filebuf::sync()
+{
+    if (!is_open())
+        return -1;
+
+    const uint64_t size = m_buffers[m_current].offset + static_cast< uint64_t >(pptr() - pbase());
+    submit_current(true);
+    wait_all();
+
+    // The last block is padded whenever the block size is set up for direct I/O, even if the writes
+    // have fallen back to buffered I/O since then
+    if (m_block_size > 1u && !m_failed && size % m_block_size != 0)
+    {
+        // Remove the padding of the last block
+        if (ftruncate(m_fd, static_cast< off_t >(size)) != 0)
+            m_failed = true;
+    }
+
+    return m_failed ? -1 : 0;
+}
+
+async_filebuf::int_type async_filebuf::overflow(int_type c)
+{
+    if (!is_open())
+        return traits_type::eof();
+
+    if (pptr() == epptr())
+        submit_current(false);
+
+    if (m_failed)
+        return traits_type::eof();
+
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+        return c;
+    }
+
+    return traits_type::not_eof(c);
+}
+
+std::streamsize async_filebuf::xsputn(const char_type* s, std::streamsize n)
+{
+    if (!is_open())
+        return 0;
+
+    std::streamsize written = 0;
+    while (written < n)
+    {
+        std::streamsize room = static_cast< std::streamsize >(epptr() - pptr());
+        if (room == 0)
+        {
+            submit_current(false);
+            if (m_failed)
+                break;
+            room = static_cast< std::streamsize >(epptr() - pptr());
+        }
+
+        const std::streamsize size = (n - written) < room ? (n - written) : room;
+        std::memcpy(pptr(), s + written, static_cast< std::size_t >(size));
+        pbump(static_cast< int >(size));
+        written += size;
+    }
+
+    return written;
+}
+
+async_filebuf::pos_type async_filebuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    // Only reporting the current position is supported
+    if (!is_open() || off != 0 || dir != std::ios_base::cur || (which & std::ios_base::out) == 0)
+        return pos_type(off_type(-1));
+
+    return pos_type(static_cast< off_type >(m_buffers[m_current].offset + static_cast< uint64_t >(pptr() - pbase())));
+}
+
+//! Releases all resources
+void async_filebuf::cleanup()
+{
+    if (m_ring)
+    {
+        // Pending writes must complete before the buffers are released
+        if (m_pending_count > 0)
+            wait_all();
+        m_ring->destroy();
+        m_ring = NULL;
+    }
+
+    for (std::size_t i = 0; i < m_buffers.size(); ++i)
+        std::free(m_buffers[i].data);
+    m_buffers.clear();
+    setp(NULL, NULL);
+
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_direct = false;
+    m_pending_count = 0;
+}
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // defined(BOOST_LOG_HAS_ASYNC_FILEBUF)
@@ -0,0 +1,159 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   async_filebuf.hpp
+ * \author Andrey Semashev
+ * \date   19.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#ifndef BOOST_LOG_ASYNC_FILEBUF_HPP_INCLUDED_
+#define BOOST_LOG_ASYNC_FILEBUF_HPP_INCLUDED_
+
+#include <ios>
+#include <vector>
+#include <cstddef>
+#include <streambuf>
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/log/detail/config.hpp>
+#include <boost/log/detail/header.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if !defined(BOOST_WINDOWS)
+
+// The stream buffer is implemented on top of POSIX file API
+#define BOOST_LOG_HAS_ASYNC_FILEBUF
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+/*!
+ * \brief File stream buffer that keeps multiple writes in flight
+ *
+ * The stream buffer maintains several buffers of equal size. When the current buffer is filled, a write
+ * of its contents is started and writing continues to the next free buffer. On Linux the writes are
+ * performed asynchronously with io_uring, so the writing thread only blocks when all buffers are being written.
+ * If io_uring is not available, the writes are performed synchronously.
+ *
+ * The file can be opened with \c O_DIRECT, in which case the buffers are aligned and only whole blocks are written.
+ * The incomplete last block is kept in the buffer and is written padded when the stream buffer is synchronized,
+ * after which the file is truncated to the actual size.
+ */
+class async_filebuf :
+    public std::streambuf
+{
+private:
+    //! Buffer descriptor
+    struct buffer
+    {
+        //! Buffer storage
+        char* data;
+        //! The offset in the file that corresponds to the beginning of the buffer
+        uint64_t offset;
+        //! The number of bytes being written from the buffer
+        std::size_t size;
+        //! The flag indicates that the buffer is being written
+        bool pending;
+    };
+
+    struct ring;
+
+private:
+    //! File descriptor
+    int m_fd;
+    //! Buffers
+    std::vector< buffer > m_buffers;
+    //! The index of the buffer that is being filled
+    std::size_t m_current;
+    //! The number of buffers being written
+    std::size_t m_pending_count;
+    //! The size of each buffer
+    std::size_t m_buffer_size;
+    //! File block size for direct I/O, 1 otherwise
+    std::size_t m_block_size;
+    //! The flag indicates that the writes use O_DIRECT, cleared if the file system does not support direct I/O
+    bool m_direct;
+    //! The flag indicates that a write has failed
+    bool m_failed;
+    //! The io_uring instance, \c NULL if writes are synchronous
+    ring* m_ring;
+
+public:
+    async_filebuf();
+    ~async_filebuf();
+
+    /*!
+     * Opens the file
+     *
+     * \param name File name
+     * \param mode Open mode, only \c app and \c trunc flags are taken into account
+     * \param buffer_size The size of each buffer, will be rounded up to the file block size
+     * \param buffer_count The number of buffers, at least 2
+     * \param direct_io If \c true, the file will be opened with \c O_DIRECT, if possible
+     * \return \c true on success
+     */
+    bool open(filesystem::path const& name, std::ios_base::openmode mode, std::size_t buffer_size, std::size_t buffer_count, bool direct_io);
+    //! Writes the buffered data and closes the file. Returns \c false if some data could not be written.
+    bool close();
+    //! Returns \c true if the file is open
+    bool is_open() const { return m_fd >= 0; }
+    //! Returns \c true if the writes are performed asynchronously
+    bool is_async() const { return m_ring != NULL; }
+    //! Returns \c true if the file is written with direct I/O
+    bool is_direct() const { return m_direct; }
+
+    /*!
+     * Starts writing the buffered data without waiting for the write to complete. With direct I/O,
+     * the incomplete last block remains in the buffer.
+     */
+    void submit();
+
+protected:
+    int_type overflow(int_type c);
+    std::streamsize xsputn(const char_type* s, std::streamsize n);
+    int sync();
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which);
+
+private:
+    //! Starts writing the current buffer and switches to the next free buffer
+    void submit_current(bool pad);
+    //! Writes data synchronously
+    bool write_sync(const char* data, std::size_t size, uint64_t offset);
+    //! Waits for at least one pending write to complete
+    void wait_one();
+    //! Waits for all pending writes to complete
+    void wait_all();
+    //! Marks the write from the buffer as completed
+    void complete(std::size_t index, long result);
+    //! Releases all resources
+    void cleanup();
+
+    //  Copying prohibited
+    async_filebuf(async_filebuf const&);
+    async_filebuf& operator= (async_filebuf const&);
+};
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#endif // !defined(BOOST_WINDOWS)
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_ASYNC_FILEBUF_HPP_INCLUDED_
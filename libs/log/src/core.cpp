@@ -179,6 +179,19 @@ BOOST_LOG_API record_view record::lock()
     return record_view(impl);
 }
 
+namespace aux {
+
+//! Creates a log record with the specified attribute values, bypassing the logging core and its filters
+BOOST_LOG_API record make_detached_record(BOOST_RV_REF(attribute_value_set) values)
+{
+    record rec;
+    rec.m_impl = record_view::private_data::create(boost::move(values), 0u);
+    rec.m_impl->m_attribute_values.freeze();
+    return boost::move(rec);
+}
+
+} // namespace aux
+
 //! Logging system implementation
 struct core::implementation :
     public log::aux::lazy_singleton<
@@ -32,7 +32,12 @@
 #error Boost.Log internal error: BOOST_LOG_EVENT_USE_POSIX_SEMAPHORE must only be defined when atomic ops are available
 #endif
 #include <errno.h>
+#include <time.h>
 #include <semaphore.h>
+#if defined(__GLIBC__) && defined(__USE_GNU) && ((__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 30))
+// sem_clockwait allows to measure the timeout against the monotonic clock
+#define BOOST_LOG_EVENT_USE_SEM_CLOCKWAIT
+#endif
 
 #elif defined(BOOST_LOG_EVENT_USE_WINAPI)
 
@@ -43,6 +48,8 @@
 #else
 
 #include <boost/thread/locks.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 
 #endif
 
@@ -91,6 +98,55 @@ BOOST_LOG_API void sem_based_event::wait()
     BOOST_LOG_EVENT_RESET(m_state);
 }
 
+//! Waits for the object to become signalled for no longer than the specified time
+BOOST_LOG_API bool sem_based_event::timed_wait(unsigned int milliseconds)
+{
+    // The deadline is measured against the monotonic clock where possible so that adjustments
+    // of the system time don't shorten or prolong the wait. Otherwise the wait may be affected
+    // by the system time changes.
+#if defined(BOOST_LOG_EVENT_USE_SEM_CLOCKWAIT)
+    const clockid_t clock_id = CLOCK_MONOTONIC;
+#else
+    const clockid_t clock_id = CLOCK_REALTIME;
+#endif
+    struct timespec deadline;
+    if (clock_gettime(clock_id, &deadline) != 0)
+    {
+        BOOST_THROW_EXCEPTION(system::system_error(
+            errno, system::system_category(), "Failed to obtain current time"));
+    }
+    deadline.tv_sec += milliseconds / 1000u;
+    deadline.tv_nsec += static_cast< long >(milliseconds % 1000u) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        ++deadline.tv_sec;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    while (true)
+    {
+#if defined(BOOST_LOG_EVENT_USE_SEM_CLOCKWAIT)
+        if (sem_clockwait(&m_semaphore, clock_id, &deadline) != 0)
+#else
+        if (sem_timedwait(&m_semaphore, &deadline) != 0)
+#endif
+        {
+            const int err = errno;
+            if (err == ETIMEDOUT)
+                return false;
+            else if (err != EINTR)
+            {
+                BOOST_THROW_EXCEPTION(system::system_error(
+                    err, system::system_category(), "Failed to block on the semaphore"));
+            }
+        }
+        else
+            break;
+    }
+    BOOST_LOG_EVENT_RESET(m_state);
+    return true;
+}
+
 //! Sets the object to a signalled state
 BOOST_LOG_API void sem_based_event::set_signalled()
 {
@@ -140,6 +196,24 @@ BOOST_LOG_API void winapi_based_event::wait()
     const_cast< volatile boost::uint32_t& >(m_state) = 0;
 }
 
+//! Waits for the object to become signalled for no longer than the specified time
+BOOST_LOG_API bool winapi_based_event::timed_wait(unsigned int milliseconds)
+{
+    if (const_cast< volatile boost::uint32_t& >(m_state) == 0)
+    {
+        const DWORD res = WaitForSingleObject(m_event, milliseconds);
+        if (res == WAIT_TIMEOUT)
+            return false;
+        else if (res != 0)
+        {
+            BOOST_THROW_EXCEPTION(system::system_error(
+                GetLastError(), system::system_category(), "Failed to block on Windows event"));
+        }
+    }
+    const_cast< volatile boost::uint32_t& >(m_state) = 0;
+    return true;
+}
+
 //! Sets the object to a signalled state
 BOOST_LOG_API void winapi_based_event::set_signalled()
 {
@@ -177,6 +251,20 @@ BOOST_LOG_API void generic_event::wait()
     m_state = false;
 }
 
+//! Waits for the object to become signalled for no longer than the specified time
+BOOST_LOG_API bool generic_event::timed_wait(unsigned int milliseconds)
+{
+    const boost::system_time deadline = boost::get_system_time() + posix_time::milliseconds(milliseconds);
+    boost::unique_lock< boost::mutex > lock(m_mutex);
+    while (!m_state)
+    {
+        if (!m_cond.timed_wait(lock, deadline))
+            return false;
+    }
+    m_state = false;
+    return true;
+}
+
 //! Sets the object to a signalled state
 BOOST_LOG_API void generic_event::set_signalled()
 {
@@ -0,0 +1,146 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   file_compression.cpp
+ * \author Andrey Semashev
+ * \date   27.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#include "file_compression.hpp"
+
+#if !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+
+#include <cstring>
+#include <ios>
+#include <vector>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/log/exceptions.hpp>
+#include <zlib.h>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+BOOST_LOG_ANONYMOUS_NAMESPACE {
+
+//! The size of the input and output buffers
+enum { compression_buffer_size = 64u * 1024u };
+
+//! The class releases zlib stream resources on destruction
+class deflate_stream
+{
+private:
+    z_stream m_stream;
+    bool m_initialized;
+
+public:
+    explicit deflate_stream(int level) : m_initialized(false)
+    {
+        std::memset(&m_stream, 0, sizeof(m_stream));
+        // The window size increased by 16 selects the gzip format
+        if (deflateInit2(&m_stream, level, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            BOOST_LOG_THROW_DESCR(system_error, "Failed to initialize file compression");
+        m_initialized = true;
+    }
+    ~deflate_stream()
+    {
+        if (m_initialized)
+            deflateEnd(&m_stream);
+    }
+
+    z_stream& get() { return m_stream; }
+
+private:
+    //  Copying prohibited
+    deflate_stream(deflate_stream const&);
+    deflate_stream& operator= (deflate_stream const&);
+};
+
+//! Compresses the file contents
+void compress_stream(filesystem::ifstream& in, filesystem::ofstream& out, int level)
+{
+    deflate_stream stream(level);
+    z_stream& strm = stream.get();
+
+    // The buffers are too large to be allocated on the stack of the thread that stores the file
+    std::vector< char > buffers(compression_buffer_size * 2u);
+    char* const in_buffer = &buffers[0];
+    char* const out_buffer = in_buffer + compression_buffer_size;
+    int flush = Z_NO_FLUSH;
+    do
+    {
+        in.read(in_buffer, compression_buffer_size);
+        if (in.bad())
+            BOOST_LOG_THROW_DESCR(system_error, "Failed to read the file being compressed");
+        strm.next_in = reinterpret_cast< Bytef* >(in_buffer);
+        strm.avail_in = static_cast< uInt >(in.gcount());
+        if (in.eof())
+            flush = Z_FINISH;
+
+        do
+        {
+            strm.next_out = reinterpret_cast< Bytef* >(out_buffer);
+            strm.avail_out = compression_buffer_size;
+            const int res = deflate(&strm, flush);
+            if (res == Z_STREAM_ERROR)
+                BOOST_LOG_THROW_DESCR(system_error, "Failed to compress the file");
+            out.write(out_buffer, static_cast< std::streamsize >(compression_buffer_size - strm.avail_out));
+            if (!out.good())
+                BOOST_LOG_THROW_DESCR(system_error, "Failed to write the compressed file");
+        }
+        while (strm.avail_out == 0);
+    }
+    while (flush != Z_FINISH);
+}
+
+} // namespace
+
+const char compressed_file_suffix[4] = ".gz";
+
+//! Compresses the file into the gzip format
+void compress_file(filesystem::path const& from, filesystem::path const& to, int level)
+{
+    filesystem::ifstream in(from, std::ios_base::in | std::ios_base::binary);
+    if (!in.is_open())
+        BOOST_LOG_THROW_DESCR(system_error, "Failed to open the file to compress");
+
+    filesystem::ofstream out(to, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+    if (!out.is_open())
+        BOOST_LOG_THROW_DESCR(system_error, "Failed to create the compressed file");
+
+    try
+    {
+        compress_stream(in, out, level);
+        out.close();
+        if (out.fail())
+            BOOST_LOG_THROW_DESCR(system_error, "Failed to write the compressed file");
+    }
+    catch (...)
+    {
+        out.close();
+        system::error_code ec;
+        filesystem::remove(to, ec);
+        throw;
+    }
+}
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // !defined(BOOST_LOG_WITHOUT_COMPRESSION)
@@ -0,0 +1,60 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   file_compression.hpp
+ * \author Andrey Semashev
+ * \date   27.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#ifndef BOOST_LOG_FILE_COMPRESSION_HPP_INCLUDED_
+#define BOOST_LOG_FILE_COMPRESSION_HPP_INCLUDED_
+
+#include <boost/filesystem/path.hpp>
+#include <boost/log/detail/config.hpp>
+#include <boost/log/detail/header.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+//! The suffix that is appended to the names of the compressed files
+extern const char compressed_file_suffix[4];
+
+/*!
+ * Compresses the file into the gzip format
+ *
+ * \param from The file to compress
+ * \param to The compressed file to create, the existing file is overwritten
+ * \param level Compression level, from 1 to 9
+ *
+ * \b Throws: \c system_error if the files cannot be read or written or compression fails.
+ * The partially written compressed file is removed on failure.
+ */
+void compress_file(filesystem::path const& from, filesystem::path const& to, int level);
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#endif // !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_FILE_COMPRESSION_HPP_INCLUDED_
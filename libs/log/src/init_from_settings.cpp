@@ -253,7 +253,15 @@ protected:
         if (!async)
             p = init_formatter(boost::make_shared< sinks::synchronous_sink< backend_t > >(backend), params, is_formatting_t());
         else
-            p = init_formatter(boost::make_shared< sinks::asynchronous_sink< backend_t > >(backend), params, is_formatting_t());
+        {
+            sinks::thread_settings thread_settings = parse_thread_settings(params);
+            p = init_formatter(boost::make_shared< sinks::asynchronous_sink< backend_t > >(
+                backend,
+                keywords::cpu_affinity = thread_settings.cpu_affinity(),
+                keywords::scheduling_policy = thread_settings.scheduling_policy(),
+                keywords::nice = thread_settings.nice(),
+                keywords::thread_name = thread_settings.thread_name()), params, is_formatting_t());
+        }
 #else
         // When multithreading is disabled we always use the unlocked sink frontend
         p = init_formatter(boost::make_shared< sinks::unlocked_sink< backend_t > >(backend), params, is_formatting_t());
@@ -265,6 +273,41 @@ protected:
     }
 
 private:
+#if !defined(BOOST_LOG_NO_THREADS)
+    //! The function extracts the settings of the record feeding threads of asynchronous sinks
+    static sinks::thread_settings parse_thread_settings(settings_section const& params)
+    {
+        sinks::thread_settings thread_settings;
+
+        if (optional< string_type > cpus_param = params["CPUAffinity"])
+            thread_settings.set_cpu_affinity(log::aux::to_narrow(cpus_param.get()));
+
+        if (optional< string_type > policy_param = params["SchedulingPolicy"])
+        {
+            string_type const& value = policy_param.get();
+            if (value == constants::scheduling_default())
+                thread_settings.set_scheduling_policy(sinks::thread_settings::default_scheduling);
+            else if (value == constants::scheduling_batch())
+                thread_settings.set_scheduling_policy(sinks::thread_settings::batch_scheduling);
+            else if (value == constants::scheduling_idle())
+                thread_settings.set_scheduling_policy(sinks::thread_settings::idle_scheduling);
+            else
+            {
+                BOOST_LOG_THROW_DESCR(invalid_value,
+                    "The scheduling policy \"" + log::aux::to_narrow(value) + "\" is not supported");
+            }
+        }
+
+        if (optional< string_type > nice_param = params["Nice"])
+            thread_settings.set_nice(param_cast_to_int< int >("Nice", nice_param.get()));
+
+        if (optional< string_type > name_param = params["ThreadName"])
+            thread_settings.set_thread_name(log::aux::to_narrow(name_param.get()));
+
+        return thread_settings;
+    }
+#endif // !defined(BOOST_LOG_NO_THREADS)
+
     //! The function initializes formatter for the sinks that support formatting
     template< typename SinkT >
     static shared_ptr< SinkT > init_formatter(shared_ptr< SinkT > const& sink, settings_section const& params, mpl::true_)
@@ -383,6 +426,65 @@ public:
             backend->auto_flush(param_cast_to_bool("AutoFlush", auto_flush_param.get()));
         }
 
+        // Write buffer
+        if (optional< string_type > write_buffer_size_param = params["WriteBufferSize"])
+        {
+            backend->set_write_buffer_size(param_cast_to_int< std::size_t >("WriteBufferSize", write_buffer_size_param.get()));
+        }
+        if (optional< string_type > write_buffer_latency_param = params["WriteBufferLatency"])
+        {
+            backend->set_write_buffer_latency(
+                posix_time::milliseconds(param_cast_to_int< unsigned int >("WriteBufferLatency", write_buffer_latency_param.get())));
+        }
+
+        // Output mode
+        if (optional< string_type > output_mode_param = params["OutputMode"])
+        {
+            sinks::file::output_mode mode = sinks::file::stream_output;
+            string_type const& value = output_mode_param.get();
+            if (value == constants::output_mode_async())
+                mode = sinks::file::async_output;
+            else if (value == constants::output_mode_mapped())
+                mode = sinks::file::mapped_output;
+            else if (value != constants::output_mode_stream())
+            {
+                BOOST_LOG_THROW_DESCR(invalid_value,
+                    "File output mode \"" + boost::log::aux::to_narrow(value) + "\" is not supported");
+            }
+
+            unsigned int buffer_count = 4u;
+            if (optional< string_type > buffer_count_param = params["WriteBufferCount"])
+                buffer_count = param_cast_to_int< unsigned int >("WriteBufferCount", buffer_count_param.get());
+
+            bool direct_io = false;
+            if (optional< string_type > direct_io_param = params["DirectIO"])
+                direct_io = param_cast_to_bool("DirectIO", direct_io_param.get());
+
+            backend->set_output_mode(mode, buffer_count, direct_io);
+        }
+
+        // Durability
+        if (optional< string_type > durability_param = params["Durability"])
+        {
+            sinks::file::durability level = sinks::file::no_durability;
+            string_type const& value = durability_param.get();
+            if (value == constants::durability_flush())
+                level = sinks::file::flush_durability;
+            else if (value == constants::durability_sync())
+                level = sinks::file::sync_durability;
+            else if (value != constants::durability_none())
+            {
+                BOOST_LOG_THROW_DESCR(invalid_value,
+                    "File durability level \"" + boost::log::aux::to_narrow(value) + "\" is not supported");
+            }
+
+            posix_time::time_duration sync_latency(0, 0, 0);
+            if (optional< string_type > sync_latency_param = params["SyncLatency"])
+                sync_latency = posix_time::milliseconds(param_cast_to_int< unsigned int >("SyncLatency", sync_latency_param.get()));
+
+            backend->set_durability(level, sync_latency);
+        }
+
         // Append
         if (optional< string_type > append_param = params["Append"])
         {
@@ -406,10 +508,28 @@ public:
             if (optional< string_type > min_space_param = params["MinFreeSpace"])
                 space = param_cast_to_int< uintmax_t >("MinFreeSpace", min_space_param.get());
 
+            // Background collection
+            bool background_collection = false;
+            if (optional< string_type > background_param = params["BackgroundCollection"])
+                background_collection = param_cast_to_bool("BackgroundCollection", background_param.get());
+
+            // Compression
+            int compression_level = 0;
+            if (optional< string_type > compression_param = params["CompressionLevel"])
+                compression_level = param_cast_to_int< int >("CompressionLevel", compression_param.get());
+
+            // Manifest
+            bool manifest = false;
+            if (optional< string_type > manifest_param = params["Manifest"])
+                manifest = param_cast_to_bool("Manifest", manifest_param.get());
+
             backend->set_file_collector(sinks::file::make_collector(
                 keywords::target = target_dir,
                 keywords::max_size = max_size,
-                keywords::min_free_space = space));
+                keywords::min_free_space = space,
+                keywords::background_collection = background_collection,
+                keywords::compression_level = compression_level,
+                keywords::manifest = manifest));
 
             // Scan for log files
             if (optional< string_type > scan_param = params["ScanForFiles"])
@@ -451,7 +571,31 @@ public:
     {
         // Construct the backend
         typedef sinks::syslog_backend backend_t;
-        shared_ptr< backend_t > backend = boost::make_shared< backend_t >();
+        shared_ptr< backend_t > backend;
+
+#if !defined(BOOST_LOG_NO_ASIO)
+        if (optional< string_type > transport_param = params["Transport"])
+        {
+            string_type const& value = transport_param.get();
+            if (value == constants::syslog_transport_udp())
+                backend = boost::make_shared< backend_t >(keywords::use_impl = sinks::syslog::udp_socket_based);
+            else if (value == constants::syslog_transport_tcp())
+                backend = boost::make_shared< backend_t >(keywords::use_impl = sinks::syslog::tcp_socket_based);
+#ifdef BOOST_LOG_USE_NATIVE_SYSLOG
+            else if (value == constants::syslog_transport_local())
+                backend = boost::make_shared< backend_t >(keywords::use_impl = sinks::syslog::local_socket_based);
+#endif // BOOST_LOG_USE_NATIVE_SYSLOG
+            else
+            {
+                BOOST_LOG_THROW_DESCR(invalid_value,
+                    "Syslog transport \"" + boost::log::aux::to_narrow(value) + "\" is not supported");
+            }
+        }
+        else
+#endif // !defined(BOOST_LOG_NO_ASIO)
+        {
+            backend = boost::make_shared< backend_t >();
+        }
 
         // For now we use only the default level mapping. Will add support for configuration later.
         backend->set_severity_mapper(sinks::syslog::direct_severity_mapping< >(log::aux::default_attribute_names::severity()));
@@ -463,6 +607,35 @@ public:
 
         if (optional< string_type > target_address_param = params["TargetAddress"])
             backend->set_target_address(param_cast_to_address("TargetAddress", target_address_param.get()));
+
+        if (optional< string_type > target_socket_param = params["TargetSocket"])
+            backend->set_target_socket(log::aux::to_narrow(target_socket_param.get()));
+
+        // Setup packet batching
+        if (optional< string_type > batch_size_param = params["BatchSize"])
+            backend->set_batch_size(param_cast_to_int< std::size_t >("BatchSize", batch_size_param.get()));
+
+        if (optional< string_type > batch_latency_param = params["BatchLatency"])
+        {
+            backend->set_batch_latency(
+                posix_time::milliseconds(param_cast_to_int< unsigned int >("BatchLatency", batch_latency_param.get())));
+        }
+
+        // Setup the connection to the syslog server
+        if (optional< string_type > max_backlog_size_param = params["MaxBacklogSize"])
+            backend->set_max_backlog_size(param_cast_to_int< std::size_t >("MaxBacklogSize", max_backlog_size_param.get()));
+
+        if (optional< string_type > reconnect_interval_param = params["ReconnectInterval"])
+        {
+            backend->set_reconnect_interval(
+                posix_time::milliseconds(param_cast_to_int< unsigned int >("ReconnectInterval", reconnect_interval_param.get())));
+        }
+
+        if (optional< string_type > flush_timeout_param = params["FlushTimeout"])
+        {
+            backend->set_flush_timeout(
+                posix_time::milliseconds(param_cast_to_int< unsigned int >("FlushTimeout", flush_timeout_param.get())));
+        }
 #endif // !defined(BOOST_LOG_NO_ASIO)
 
         return base_type::init_sink(backend, params);
@@ -0,0 +1,260 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   mapped_filebuf.cpp
+ * \author Andrey Semashev
+ * \date   20.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#include "mapped_filebuf.hpp"
+
+#if defined(BOOST_LOG_HAS_MAPPED_FILEBUF)
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+BOOST_LOG_ANONYMOUS_NAMESPACE {
+
+//! Finds the end of the data in the file, skipping the trailing zero bytes of the preallocated space left after a crash. Returns \c false on error.
+bool find_data_end(int fd, uint64_t& size)
+{
+    std::vector< char > buf(65536u);
+    while (size > 0)
+    {
+        const std::size_t chunk = size < buf.size() ? static_cast< std::size_t >(size) : buf.size();
+        const ssize_t res = pread(fd, &buf[0], chunk, static_cast< off_t >(size - chunk));
+        if (res < 0 && errno == EINTR)
+            continue;
+        if (res != static_cast< ssize_t >(chunk))
+            return false;
+
+        for (std::size_t i = chunk; i > 0u; --i, --size)
+        {
+            if (buf[i - 1u] != '\0')
+                return true;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+mapped_filebuf::mapped_filebuf() :
+    m_fd(-1),
+    m_region(NULL),
+    m_region_size(0),
+    m_region_offset(0),
+    m_failed(false)
+{
+}
+
+mapped_filebuf::~mapped_filebuf()
+{
+    close();
+}
+
+//! Opens the file
+bool mapped_filebuf::open(filesystem::path const& name, std::ios_base::openmode mode, std::size_t region_size)
+{
+    if (is_open())
+        return false;
+
+    // The file has to be opened for reading and writing in order to map it
+    int flags = O_RDWR | O_CREAT;
+#if defined(O_CLOEXEC)
+    flags |= O_CLOEXEC;
+#endif
+    const bool append = (mode & std::ios_base::app) != 0;
+    if (!append && (mode & std::ios_base::trunc) != 0)
+        flags |= O_TRUNC;
+
+    m_fd = ::open(name.c_str(), flags, 0666);
+    if (m_fd < 0)
+        return false;
+
+    uint64_t offset = 0;
+    if (append)
+    {
+        struct stat st;
+        if (fstat(m_fd, &st) != 0)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+            return false;
+        }
+        // If the application crashed while writing the file, the file was not truncated to the written data
+        offset = static_cast< uint64_t >(st.st_size);
+        if (!find_data_end(m_fd, offset))
+        {
+            ::close(m_fd);
+            m_fd = -1;
+            return false;
+        }
+    }
+
+    const long page_size_value = sysconf(_SC_PAGESIZE);
+    const std::size_t page_size = page_size_value > 0 ? static_cast< std::size_t >(page_size_value) : static_cast< std::size_t >(4096u);
+    if (region_size < page_size)
+        region_size = page_size;
+    m_region_size = (region_size + page_size - 1u) / page_size * page_size;
+    m_failed = false;
+
+    // The region has to start at a page boundary
+    const std::size_t in_page = static_cast< std::size_t >(offset % page_size);
+    if (!map_region(offset - in_page))
+    {
+        // Restore the original size of the file in case if it was extended, nothing can be done if this fails
+        const int res = ftruncate(m_fd, static_cast< off_t >(offset));
+        (void)res;
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    pbump(static_cast< int >(in_page));
+
+    return true;
+}
+
+//! Truncates the file to the size of the written data and closes the file
+bool mapped_filebuf::close()
+{
+    if (!is_open())
+        return true;
+
+    const uint64_t written = size();
+    unmap_region();
+
+    bool result = !m_failed;
+    if (ftruncate(m_fd, static_cast< off_t >(written)) != 0)
+        result = false;
+    ::close(m_fd);
+    m_fd = -1;
+
+    return result;
+}
+
+//! Preallocates the file space and maps the region at the specified offset
+bool mapped_filebuf::map_region(uint64_t offset)
+{
+    // Preallocate the file space, so that writing to the mapping never fails due to the lack of space.
+    // If the file system does not support preallocation, the file is not mapped. Extending the file
+    // with ftruncate instead would create a sparse file, and writing to the mapping would raise SIGBUS
+    // if the file system runs out of space.
+    if (posix_fallocate(m_fd, static_cast< off_t >(offset), static_cast< off_t >(m_region_size)) != 0)
+        return false;
+
+    void* p = mmap(NULL, m_region_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, static_cast< off_t >(offset));
+    if (p == MAP_FAILED)
+        return false;
+
+    m_region = static_cast< char* >(p);
+    m_region_offset = offset;
+    setp(m_region, m_region + m_region_size);
+    return true;
+}
+
+//! Unmaps the current region
+void mapped_filebuf::unmap_region()
+{
+    if (m_region)
+    {
+        m_region_offset = size();
+        munmap(m_region, m_region_size);
+        m_region = NULL;
+        setp(NULL, NULL);
+    }
+}
+
+int mapped_filebuf::sync()
+{
+    // The written data is already in the system file cache
+    return (!is_open() || m_failed) ? -1 : 0;
+}
+
+mapped_filebuf::int_type mapped_filebuf::overflow(int_type c)
+{
+    if (!is_open() || m_failed)
+        return traits_type::eof();
+
+    if (pptr() == epptr())
+    {
+        const uint64_t offset = size();
+        unmap_region();
+        if (!map_region(offset))
+        {
+            m_failed = true;
+            return traits_type::eof();
+        }
+    }
+
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+        return c;
+    }
+
+    return traits_type::not_eof(c);
+}
+
+std::streamsize mapped_filebuf::xsputn(const char_type* s, std::streamsize n)
+{
+    std::streamsize written = 0;
+    while (written < n)
+    {
+        std::streamsize room = static_cast< std::streamsize >(epptr() - pptr());
+        if (room == 0)
+        {
+            if (traits_type::eq_int_type(overflow(traits_type::eof()), traits_type::eof()))
+                break;
+            room = static_cast< std::streamsize >(epptr() - pptr());
+        }
+
+        const std::streamsize size = (n - written) < room ? (n - written) : room;
+        std::memcpy(pptr(), s + written, static_cast< std::size_t >(size));
+        pbump(static_cast< int >(size));
+        written += size;
+    }
+
+    return written;
+}
+
+mapped_filebuf::pos_type mapped_filebuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    // Only reporting the current position is supported
+    if (!is_open() || off != 0 || dir != std::ios_base::cur || (which & std::ios_base::out) == 0)
+        return pos_type(off_type(-1));
+
+    return pos_type(static_cast< off_type >(size()));
+}
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // defined(BOOST_LOG_HAS_MAPPED_FILEBUF)
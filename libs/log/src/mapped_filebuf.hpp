@@ -0,0 +1,113 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   mapped_filebuf.hpp
+ * \author Andrey Semashev
+ * \date   20.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#ifndef BOOST_LOG_MAPPED_FILEBUF_HPP_INCLUDED_
+#define BOOST_LOG_MAPPED_FILEBUF_HPP_INCLUDED_
+
+#include <ios>
+#include <cstddef>
+#include <streambuf>
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/log/detail/config.hpp>
+#include <boost/log/detail/header.hpp>
+
+#ifdef BOOST_LOG_HAS_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if !defined(BOOST_WINDOWS)
+
+// The stream buffer is implemented on top of POSIX memory mapping API
+#define BOOST_LOG_HAS_MAPPED_FILEBUF
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+/*!
+ * \brief File stream buffer that writes the file through a memory mapping
+ *
+ * The file is preallocated and mapped in regions of a fixed size. The written data is copied
+ * directly into the mapped region, so no system calls are made until the region is filled.
+ * When the region is filled, the file is extended by another region, which is mapped in place of the filled one.
+ * When the file is closed, it is truncated to the size of the written data.
+ */
+class mapped_filebuf :
+    public std::streambuf
+{
+private:
+    //! File descriptor
+    int m_fd;
+    //! The mapped region
+    char* m_region;
+    //! The size of the mapped region
+    std::size_t m_region_size;
+    //! The offset in the file that corresponds to the beginning of the mapped region
+    uint64_t m_region_offset;
+    //! The flag indicates that the file could not be extended or mapped
+    bool m_failed;
+
+public:
+    mapped_filebuf();
+    ~mapped_filebuf();
+
+    /*!
+     * Opens the file
+     *
+     * \param name File name
+     * \param mode Open mode, only \c app and \c trunc flags are taken into account. In the \c app mode, the zero bytes
+     *             at the end of the file are overwritten, since they are the preallocated space left after a crash.
+     * \param region_size The size of the file regions to preallocate and map, will be rounded up to the page size
+     * \return \c true on success
+     */
+    bool open(filesystem::path const& name, std::ios_base::openmode mode, std::size_t region_size);
+    //! Truncates the file to the size of the written data and closes the file. Returns \c false on failure.
+    bool close();
+    //! Returns \c true if the file is open
+    bool is_open() const { return m_fd >= 0; }
+
+protected:
+    int_type overflow(int_type c);
+    std::streamsize xsputn(const char_type* s, std::streamsize n);
+    int sync();
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which);
+
+private:
+    //! Preallocates the file space and maps the region at the specified offset. Fails if the file system does not support preallocation.
+    bool map_region(uint64_t offset);
+    //! Unmaps the current region
+    void unmap_region();
+    //! Returns the size of the written data
+    uint64_t size() const { return m_region_offset + static_cast< uint64_t >(pptr() - pbase()); }
+
+    //  Copying prohibited
+    mapped_filebuf(mapped_filebuf const&);
+    mapped_filebuf& operator= (mapped_filebuf const&);
+};
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#endif // !defined(BOOST_WINDOWS)
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_MAPPED_FILEBUF_HPP_INCLUDED_
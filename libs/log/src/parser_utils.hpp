@@ -111,6 +111,20 @@ struct char_constants< char >
     static const char_type* registration_on_demand() { return "OnDemand"; }
     static const char_type* registration_forced() { return "Forced"; }
 
+    static const char_type* scheduling_default() { return "Default"; }
+    static const char_type* scheduling_batch() { return "Batch"; }
+    static const char_type* scheduling_idle() { return "Idle"; }
+
+    static const char_type* output_mode_stream() { return "Stream"; }
+    static const char_type* output_mode_async() { return "Async"; }
+    static const char_type* output_mode_mapped() { return "Mapped"; }
+    static const char_type* durability_none() { return "None"; }
+    static const char_type* durability_flush() { return "Flush"; }
+    static const char_type* durability_sync() { return "Sync"; }
+    static const char_type* syslog_transport_udp() { return "UDP"; }
+    static const char_type* syslog_transport_tcp() { return "TCP"; }
+    static const char_type* syslog_transport_local() { return "Local"; }
+
     static const char_type* text_file_destination() { return "TextFile"; }
     static const char_type* console_destination() { return "Console"; }
     static const char_type* syslog_destination() { return "Syslog"; }
@@ -227,6 +241,20 @@ struct char_constants< wchar_t >
     static const char_type* registration_on_demand() { return L"OnDemand"; }
     static const char_type* registration_forced() { return L"Forced"; }
 
+    static const char_type* scheduling_default() { return L"Default"; }
+    static const char_type* scheduling_batch() { return L"Batch"; }
+    static const char_type* scheduling_idle() { return L"Idle"; }
+
+    static const char_type* output_mode_stream() { return L"Stream"; }
+    static const char_type* output_mode_async() { return L"Async"; }
+    static const char_type* output_mode_mapped() { return L"Mapped"; }
+    static const char_type* durability_none() { return L"None"; }
+    static const char_type* durability_flush() { return L"Flush"; }
+    static const char_type* durability_sync() { return L"Sync"; }
+    static const char_type* syslog_transport_udp() { return L"UDP"; }
+    static const char_type* syslog_transport_tcp() { return L"TCP"; }
+    static const char_type* syslog_transport_local() { return L"Local"; }
+
     static const char_type* text_file_destination() { return L"TextFile"; }
     static const char_type* console_destination() { return L"Console"; }
     static const char_type* syslog_destination() { return L"Syslog"; }
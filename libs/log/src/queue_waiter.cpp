@@ -0,0 +1,58 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   queue_waiter.cpp
+ * \author Andrey Semashev
+ * \date   14.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#include <boost/log/detail/config.hpp>
+
+#ifndef BOOST_LOG_NO_THREADS
+
+#include <boost/thread/thread.hpp>
+#include <boost/log/detail/queue_waiter.hpp>
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define BOOST_LOG_QUEUE_WAITER_PAUSE() __asm__ __volatile__("pause;")
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_AMD64))
+extern "C" void _mm_pause(void);
+#pragma intrinsic(_mm_pause)
+#define BOOST_LOG_QUEUE_WAITER_PAUSE() _mm_pause()
+#else
+#define BOOST_LOG_QUEUE_WAITER_PAUSE()
+#endif
+
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+//! Performs one step of waiting for a queue element without blocking
+BOOST_LOG_API void spin_wait(sinks::wait_strategy const& strategy, unsigned int attempt)
+{
+    if (strategy.mode() == sinks::wait_strategy::spin_then_yield_mode && attempt >= strategy.spin_count())
+        boost::this_thread::yield();
+    else
+        BOOST_LOG_QUEUE_WAITER_PAUSE();
+}
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_NO_THREADS
@@ -0,0 +1,83 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   record_footprint.cpp
+ * \author Andrey Semashev
+ * \date   16.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#include <string>
+#include <boost/log/detail/record_footprint.hpp>
+#include <boost/log/attributes/attribute_value_set.hpp>
+#include <boost/log/attributes/value_visitation.hpp>
+#include <boost/log/utility/string_literal_fwd.hpp>
+#include <boost/log/utility/type_dispatch/standard_types.hpp>
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+BOOST_LOG_ANONYMOUS_NAMESPACE {
+
+    //! Approximate size of the record implementation, including the reference counter, the attribute value set and the list of accepting sinks
+    const std::size_t record_overhead = 16u * sizeof(void*);
+    //! Approximate size of an attribute value, including the attribute value set node and the value implementation
+    const std::size_t attribute_value_overhead = 8u * sizeof(void*);
+
+    //! The visitor accumulates the size of string attribute values
+    struct string_footprint
+    {
+        typedef void result_type;
+
+        explicit string_footprint(std::size_t& size) : m_size(size)
+        {
+        }
+
+        template< typename CharT, typename TraitsT, typename AllocatorT >
+        void operator() (std::basic_string< CharT, TraitsT, AllocatorT > const& value) const
+        {
+            m_size += value.capacity() * sizeof(CharT);
+        }
+
+        template< typename CharT, typename TraitsT >
+        void operator() (basic_string_literal< CharT, TraitsT > const&) const
+        {
+            // String literals refer to static storage
+        }
+
+    private:
+        std::size_t& m_size;
+    };
+
+} // namespace
+
+//! Returns an estimate of the memory occupied by the log record
+BOOST_LOG_API std::size_t estimate_record_footprint(record_view const& rec)
+{
+    attribute_value_set const& values = rec.attribute_values();
+    std::size_t size = record_overhead + values.size() * attribute_value_overhead;
+
+    string_footprint visitor(size);
+    for (attribute_value_set::const_iterator it = values.begin(), end = values.end(); it != end; ++it)
+        it->second.visit< string_types >(visitor);
+
+    return size;
+}
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
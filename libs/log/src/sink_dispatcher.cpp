@@ -0,0 +1,348 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   sink_dispatcher.cpp
+ * \author Andrey Semashev
+ * \date   17.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ *
+ * Logging threads only lock the dispatcher mutex when the notification flag of the client is not set.
+ * The dispatcher thread clears the flag before feeding records of the client. Both sides issue
+ * a sequentially consistent fence between updating the record queue or the flag and checking the other one,
+ * which guarantees that records enqueued after the feeding has started are not left unnoticed. The flag
+ * itself is only accessed with relaxed operations, it is always modified with the dispatcher mutex locked.
+ */
+
+#include <boost/log/detail/config.hpp>
+
+#ifndef BOOST_LOG_NO_THREADS
+
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/atomic/atomic.hpp>
+#include <boost/atomic/fences.hpp>
+#include <boost/log/sinks/sink_dispatcher.hpp>
+
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace sinks {
+
+//! Sink dispatcher implementation
+struct sink_dispatcher::implementation
+{
+    typedef std::vector< client* > client_list;
+    typedef std::deque< client* > ready_list;
+
+    //! The dispatcher that owns the implementation
+    sink_dispatcher* const m_pOwner;
+    //! Synchronization mutex
+    boost::mutex m_Mutex;
+    //! The condition is signalled when clients are put into the ready list or the dispatcher is being stopped
+    condition_variable m_ReadyCond;
+    //! The condition is signalled when a client has been served
+    condition_variable m_ServedCond;
+    //! Attached clients
+    client_list m_Clients;
+    //! The clients that have records to be fed
+    ready_list m_Ready;
+    //! The interval of polling all attached clients
+    const posix_time::time_duration m_PollInterval;
+    //! The time of the next polling
+    system_time m_NextPollTime;
+    //! The flag indicates that the dispatcher threads have to stop
+    bool m_StopRequested;
+    //! Dispatcher threads
+    thread_group m_Workers;
+    //! The number of dispatcher threads
+    unsigned int m_WorkerCount;
+
+    implementation(sink_dispatcher* owner, posix_time::time_duration const& poll_interval) :
+        m_pOwner(owner),
+        m_PollInterval(poll_interval),
+        m_NextPollTime(get_system_time() + poll_interval),
+        m_StopRequested(false),
+        m_WorkerCount(0)
+    {
+    }
+
+    //! Puts the client to the end of the ready list. Must be called with the mutex locked.
+    void enqueue_ready(client& c)
+    {
+        m_Ready.push_back(&c);
+        c.m_Scheduled = true;
+        try
+        {
+            m_pOwner->on_client_ready();
+        }
+        catch (...)
+        {
+            m_Ready.pop_back();
+            c.m_Scheduled = false;
+            throw;
+        }
+    }
+
+    //! Puts the attached clients that require polling and are not scheduled yet into the ready list. Must be called with the mutex locked.
+    void poll_clients()
+    {
+        for (client_list::iterator it = m_Clients.begin(), end = m_Clients.end(); it != end; ++it)
+        {
+            client* c = *it;
+            if (c->m_Polled && !c->m_Scheduled)
+                enqueue_ready(*c);
+        }
+        if (!m_PollInterval.is_special())
+            m_NextPollTime = get_system_time() + m_PollInterval;
+    }
+
+    //! Removes the client from the dispatcher. Must be called with the mutex locked.
+    void remove_client(client& c)
+    {
+        c.m_Attached = false;
+        client_list::iterator it = std::find(m_Clients.begin(), m_Clients.end(), &c);
+        if (it != m_Clients.end())
+            m_Clients.erase(it);
+        ready_list::iterator ready_it = std::find(m_Ready.begin(), m_Ready.end(), &c);
+        if (ready_it != m_Ready.end())
+            m_Ready.erase(ready_it);
+        c.m_Scheduled = false;
+    }
+
+    //! Feeds records of the client taken from the ready list. Must be called with the mutex locked, the mutex is locked upon return.
+    void serve(client& c, unique_lock< boost::mutex >& lock)
+    {
+        c.m_Serving = true;
+        c.m_NotificationPending.store(false, boost::memory_order_relaxed);
+        lock.unlock();
+
+        boost::atomic_thread_fence(boost::memory_order_seq_cst);
+
+        bool more_records = false, failed = false;
+        try
+        {
+            more_records = c.dispatch_records();
+        }
+        catch (...)
+        {
+            // The client is supposed to handle its errors. Do not let the exception terminate the dispatcher thread,
+            // the client will be served again when it is notified.
+            failed = true;
+        }
+
+        lock.lock();
+        c.m_Serving = false;
+        if (!c.m_Attached)
+        {
+            // The client is being detached
+            m_ServedCond.notify_all();
+        }
+        else if (failed)
+        {
+            c.m_NotificationPending.store(false, boost::memory_order_relaxed);
+            c.m_Scheduled = false;
+        }
+        else if (more_records || c.m_NotificationPending.load(boost::memory_order_relaxed))
+        {
+            m_Ready.push_back(&c);
+            m_pOwner->on_client_ready();
+        }
+        else
+        {
+            c.m_Scheduled = false;
+        }
+    }
+
+    //! The dispatcher thread function
+    void run_thread(thread_settings const& settings)
+    {
+        settings.apply();
+        run();
+    }
+
+    //! The dispatching loop
+    void run()
+    {
+        unique_lock< boost::mutex > lock(m_Mutex);
+        while (!m_StopRequested)
+        {
+            if (!m_PollInterval.is_special() && get_system_time() >= m_NextPollTime)
+                poll_clients();
+
+            if (m_Ready.empty())
+            {
+                if (!m_PollInterval.is_special())
+                    m_ReadyCond.timed_wait(lock, m_NextPollTime);
+                else
+                    m_ReadyCond.wait(lock);
+                continue;
+            }
+
+            client* c = m_Ready.front();
+            m_Ready.pop_front();
+            serve(*c, lock);
+        }
+    }
+};
+
+//! Notifies the dispatcher that new records have been enqueued
+BOOST_LOG_API void sink_dispatcher::client::notify()
+{
+    boost::atomic_thread_fence(boost::memory_order_seq_cst);
+    if (!m_NotificationPending.load(boost::memory_order_relaxed))
+        m_pDispatcher->schedule(*this);
+}
+
+//! Constructor
+BOOST_LOG_API sink_dispatcher::sink_dispatcher(unsigned int worker_count, posix_time::time_duration const& poll_interval, thread_settings const& settings) :
+    m_pImpl(new implementation(this, poll_interval))
+{
+    if (worker_count == 0u)
+        worker_count = 1u;
+
+    try
+    {
+        for (unsigned int i = 0; i < worker_count; ++i)
+        {
+            m_pImpl->m_Workers.create_thread(boost::bind(&implementation::run_thread, m_pImpl, settings));
+            ++m_pImpl->m_WorkerCount;
+        }
+    }
+    catch (...)
+    {
+        {
+            lock_guard< boost::mutex > lock(m_pImpl->m_Mutex);
+            m_pImpl->m_StopRequested = true;
+            m_pImpl->m_ReadyCond.notify_all();
+        }
+        m_pImpl->m_Workers.join_all();
+        delete m_pImpl;
+        throw;
+    }
+}
+
+//! Constructor for dispatchers that execute the dispatching work externally
+BOOST_LOG_API sink_dispatcher::sink_dispatcher(posix_time::time_duration const& poll_interval) :
+    m_pImpl(new implementation(this, poll_interval))
+{
+}
+
+//! Destructor
+BOOST_LOG_API sink_dispatcher::~sink_dispatcher()
+{
+    {
+        lock_guard< boost::mutex > lock(m_pImpl->m_Mutex);
+        m_pImpl->m_StopRequested = true;
+        m_pImpl->m_ReadyCond.notify_all();
+    }
+    m_pImpl->m_Workers.join_all();
+    delete m_pImpl;
+}
+
+//! Returns the number of dispatcher threads
+BOOST_LOG_API unsigned int sink_dispatcher::worker_count() const
+{
+    return m_pImpl->m_WorkerCount;
+}
+
+//! Attaches a sink frontend to the dispatcher
+BOOST_LOG_API void sink_dispatcher::attach(client& c)
+{
+    lock_guard< boost::mutex > lock(m_pImpl->m_Mutex);
+    if (!c.m_Attached)
+    {
+        m_pImpl->m_Clients.push_back(&c);
+        c.m_pDispatcher = this;
+        c.m_Attached = true;
+        try
+        {
+            // Feed the records that may have been enqueued before attaching
+            if (!c.m_Scheduled)
+                m_pImpl->enqueue_ready(c);
+        }
+        catch (...)
+        {
+            m_pImpl->remove_client(c);
+            throw;
+        }
+    }
+}
+
+//! Detaches a sink frontend from the dispatcher
+BOOST_LOG_API void sink_dispatcher::detach(client& c)
+{
+    unique_lock< boost::mutex > lock(m_pImpl->m_Mutex);
+    if (c.m_Attached)
+    {
+        m_pImpl->remove_client(c);
+        while (c.m_Serving)
+            m_pImpl->m_ServedCond.wait(lock);
+    }
+}
+
+//! Puts the client into the ready list
+BOOST_LOG_API void sink_dispatcher::schedule(client& c)
+{
+    lock_guard< boost::mutex > lock(m_pImpl->m_Mutex);
+    c.m_NotificationPending.store(true, boost::memory_order_relaxed);
+    if (c.m_Attached && !c.m_Scheduled)
+        m_pImpl->enqueue_ready(c);
+}
+
+//! Returns the interval of polling the attached sink frontends
+BOOST_LOG_API posix_time::time_duration sink_dispatcher::poll_interval() const
+{
+    return m_pImpl->m_PollInterval;
+}
+
+//! Feeds records of the sink frontend at the front of the ready list
+BOOST_LOG_API bool sink_dispatcher::serve_ready_client()
+{
+    unique_lock< boost::mutex > lock(m_pImpl->m_Mutex);
+    if (m_pImpl->m_Ready.empty())
+        return false;
+
+    client* c = m_pImpl->m_Ready.front();
+    m_pImpl->m_Ready.pop_front();
+    m_pImpl->serve(*c, lock);
+    return true;
+}
+
+//! Puts all attached sink frontends into the ready list
+BOOST_LOG_API void sink_dispatcher::poll_clients()
+{
+    lock_guard< boost::mutex > lock(m_pImpl->m_Mutex);
+    m_pImpl->poll_clients();
+}
+
+//! Wakes up a dispatcher thread
+BOOST_LOG_API void sink_dispatcher::on_client_ready()
+{
+    m_pImpl->m_ReadyCond.notify_one();
+}
+
+} // namespace sinks
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_NO_THREADS
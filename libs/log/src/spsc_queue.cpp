@@ -0,0 +1,193 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   spsc_queue.cpp
+ * \author Andrey Semashev
+ * \date   12.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ *
+ * The lock-free implementation publishes nodes with a store-release to the \c next pointer
+ * of the current tail and observes them with a load-acquire on the consumer side. Since only
+ * one thread ever modifies each end of the list, no read-modify-write operations are needed.
+ */
+
+#include <boost/log/detail/spsc_queue.hpp>
+
+#ifndef BOOST_LOG_NO_THREADS
+
+#include <stdlib.h>
+#include <new>
+#include <boost/assert.hpp>
+#include <boost/atomic/atomic.hpp>
+#include <boost/throw_exception.hpp>
+#include <boost/log/detail/alignas.hpp>
+
+#if defined(BOOST_HAS_UNISTD_H)
+#include <unistd.h> // _POSIX_VERSION
+#endif
+
+#if defined(BOOST_HAS_STDINT_H)
+#include <stdint.h> // uintptr_t
+#else
+// MSVC defines integer types here
+#include <stddef.h> // uintptr_t
+#endif
+
+#if defined(__APPLE__) || defined(__APPLE_CC__) || defined(macintosh)
+#include <AvailabilityMacros.h>
+#if defined(MAC_OS_X_VERSION_MIN_REQUIRED) && (MAC_OS_X_VERSION_MIN_REQUIRED >= 1060)
+// Mac OS X 10.6 and later have posix_memalign
+#define BOOST_LOG_HAS_POSIX_MEMALIGN 1
+#endif
+#elif (defined(_POSIX_VERSION) && (_POSIX_VERSION >= 200112L)) || (defined(_XOPEN_SOURCE) && (_XOPEN_SOURCE >= 600))
+#define BOOST_LOG_HAS_POSIX_MEMALIGN 1
+#endif
+
+#if defined(BOOST_WINDOWS)
+#include <malloc.h> // _aligned_malloc, _aligned_free
+#endif
+
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace aux {
+
+//! Single producer single consumer queue implementation
+class spsc_queue_impl_generic :
+    public spsc_queue_impl
+{
+private:
+    //! A pointer to either end of the queue, padded to avoid false sharing between the producer and the consumer
+    struct BOOST_LOG_ALIGNAS(64) pointer
+    {
+        node_base* node;
+        unsigned char padding[128U - sizeof(node_base*) % 128U];
+    };
+
+private:
+    //! Pointer to the beginning of the queue, only accessed by the consumer
+    pointer m_Head;
+    //! Pointer to the end of the queue, only accessed by the producer
+    pointer m_Tail;
+    //! The flag is set if the producer will not push any more elements
+    boost::atomic< bool > m_Closed;
+
+public:
+    explicit spsc_queue_impl_generic(node_base* first_node) : m_Closed(false)
+    {
+        first_node->next.store(NULL, boost::memory_order_relaxed);
+        m_Head.node = m_Tail.node = first_node;
+    }
+
+    node_base* reset_last_node()
+    {
+        BOOST_ASSERT(m_Head.node == m_Tail.node);
+        node_base* p = m_Head.node;
+        m_Head.node = m_Tail.node = NULL;
+        return p;
+    }
+
+    bool unsafe_empty()
+    {
+        return m_Head.node->next.load(boost::memory_order_acquire) == NULL;
+    }
+
+    void push(node_base* p)
+    {
+        p->next.store(NULL, boost::memory_order_relaxed);
+        m_Tail.node->next.store(p, boost::memory_order_release);
+        m_Tail.node = p;
+    }
+
+    bool try_pop(node_base*& node_to_free, node_base*& node_with_value)
+    {
+        node_base* next = m_Head.node->next.load(boost::memory_order_acquire);
+        if (next)
+        {
+            node_to_free = m_Head.node;
+            node_with_value = m_Head.node = next;
+            return true;
+        }
+        else
+            return false;
+    }
+
+    void close()
+    {
+        // The release semantics make the pushed elements visible before the flag
+        m_Closed.store(true, boost::memory_order_release);
+    }
+
+    bool is_closed()
+    {
+        return m_Closed.load(boost::memory_order_acquire);
+    }
+
+private:
+    // Copying and assignment are closed
+    spsc_queue_impl_generic(spsc_queue_impl_generic const&);
+    spsc_queue_impl_generic& operator= (spsc_queue_impl_generic const&);
+};
+
+BOOST_LOG_API spsc_queue_impl* spsc_queue_impl::create(node_base* first_node)
+{
+    return new spsc_queue_impl_generic(first_node);
+}
+
+BOOST_LOG_API void* spsc_queue_impl::operator new (std::size_t size)
+{
+    void* p = NULL;
+
+#if defined(BOOST_LOG_HAS_POSIX_MEMALIGN)
+    if (posix_memalign(&p, 64, size) || !p)
+        BOOST_THROW_EXCEPTION(std::bad_alloc());
+    return p;
+#elif defined(BOOST_WINDOWS)
+    p = _aligned_malloc(size, 64);
+    if (!p)
+        BOOST_THROW_EXCEPTION(std::bad_alloc());
+#else
+    p = malloc(size + 64);
+    if (!p)
+        BOOST_THROW_EXCEPTION(std::bad_alloc());
+    unsigned char* q = static_cast< unsigned char* >(p) + 64;
+    q = (unsigned char*)((uintptr_t)q & (~(uintptr_t)63));
+    const unsigned char diff = q - static_cast< unsigned char* >(p);
+    p = q;
+    *--q = diff;
+#endif
+
+    return p;
+}
+
+BOOST_LOG_API void spsc_queue_impl::operator delete (void* p, std::size_t)
+{
+#if defined(BOOST_LOG_HAS_POSIX_MEMALIGN)
+    free(p);
+#elif defined(BOOST_WINDOWS)
+    _aligned_free(p);
+#else
+    unsigned char* q = static_cast< unsigned char* >(p);
+    const unsigned char diff = *--q;
+    free(static_cast< unsigned char* >(p) - diff);
+#endif
+}
+
+} // namespace aux
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_NO_THREADS
@@ -18,28 +18,46 @@
 #include "windows_version.hpp"
 #include <boost/log/detail/config.hpp>
 #include <memory>
+#include <vector>
+#include <cerrno>
+#include <cstring>
 #include <algorithm>
 #include <stdexcept>
+#include <boost/array.hpp>
 #include <boost/limits.hpp>
 #include <boost/assert.hpp>
 #include <boost/weak_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/bind.hpp>
 #include <boost/throw_exception.hpp>
 #if !defined(BOOST_LOG_NO_ASIO)
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/socket_base.hpp>
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/udp.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/placeholders.hpp>
 #include <boost/asio/ip/address.hpp>
 #include <boost/asio/ip/host_name.hpp>
+#include <boost/asio/local/datagram_protocol.hpp>
+#if defined(BOOST_WINDOWS)
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
 #endif
 #include <boost/system/error_code.hpp>
+#include <boost/system/system_error.hpp>
 #include <boost/date_time/c_time.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <ctime>
 #include <boost/log/sinks/syslog_backend.hpp>
 #include <boost/log/detail/singleton.hpp>
 #include <boost/log/detail/snprintf.hpp>
+#include <boost/log/detail/process_id.hpp>
+#include <boost/log/attributes/current_process_name.hpp>
+#include <boost/log/utility/formatting_ostream.hpp>
 #include <boost/log/exceptions.hpp>
 #if !defined(BOOST_LOG_NO_THREADS)
 #include <boost/thread/locks.hpp>
@@ -50,6 +68,14 @@
 #include <syslog.h>
 #endif // BOOST_LOG_USE_NATIVE_SYSLOG
 
+#if !defined(BOOST_LOG_NO_ASIO) && defined(__linux__) && defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 14))
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+// Multiple datagrams can be sent with a single system call
+#define BOOST_LOG_HAS_SENDMMSG
+#endif
+
 #include <boost/log/detail/header.hpp>
 
 namespace boost {
@@ -79,6 +105,97 @@ namespace syslog {
         return static_cast< facility >(fac);
     }
 
+BOOST_LOG_ANONYMOUS_NAMESPACE {
+
+    //! The function checks that the string is a valid structured data name (SD-NAME in RFC5424)
+    inline bool is_valid_sd_name(std::string const& name)
+    {
+        if (name.empty() || name.size() > 32u)
+            return false;
+        for (std::string::const_iterator it = name.begin(), end = name.end(); it != end; ++it)
+        {
+            const char c = *it;
+            if (c < 33 || c > 126 || c == '=' || c == ']' || c == '"')
+                return false;
+        }
+        return true;
+    }
+
+    //! The function appends the structured data parameter value to the string, escaping the special characters
+    inline void append_sd_value(std::string& sd, std::string const& value)
+    {
+        for (std::string::const_iterator it = value.begin(), end = value.end(); it != end; ++it)
+        {
+            const char c = *it;
+            if (c == '"' || c == '\\' || c == ']')
+                sd.push_back('\\');
+            sd.push_back(c);
+        }
+    }
+
+} // namespace
+
+    //! Adds a parameter to the structured data element
+    BOOST_LOG_API structured_data_mapping& structured_data_mapping::add(std::string const& sd_id, std::string const& param_name, basic_formatter< char > const& fmt)
+    {
+        if (!is_valid_sd_name(sd_id))
+            BOOST_LOG_THROW_DESCR(invalid_value, "Invalid syslog structured data element identifier: \"" + sd_id + "\"");
+        if (!is_valid_sd_name(param_name))
+            BOOST_LOG_THROW_DESCR(invalid_value, "Invalid syslog structured data parameter name: \"" + param_name + "\"");
+
+        std::vector< element >::iterator it = m_Elements.begin(), end = m_Elements.end();
+        while (it != end && it->m_ID != sd_id)
+            ++it;
+        if (it == end)
+        {
+            m_Elements.push_back(element());
+            it = m_Elements.end() - 1;
+            it->m_ID = sd_id;
+        }
+
+        parameter param;
+        param.m_Name = param_name;
+        param.m_Formatter = fmt;
+        it->m_Parameters.push_back(param);
+
+        return *this;
+    }
+
+    //! Appends the structured data built from the log record to the string
+    BOOST_LOG_API void structured_data_mapping::operator() (record_view const& rec, std::string& sd) const
+    {
+        std::string value;
+        basic_formatting_ostream< char > strm(value);
+        for (std::vector< element >::const_iterator it = m_Elements.begin(), end = m_Elements.end(); it != end; ++it)
+        {
+            const std::size_t element_start = sd.size();
+            sd.push_back('[');
+            sd.append(it->m_ID);
+
+            bool has_parameters = false;
+            for (std::vector< parameter >::const_iterator param = it->m_Parameters.begin(), param_end = it->m_Parameters.end(); param != param_end; ++param)
+            {
+                param->m_Formatter(rec, strm);
+                strm.flush();
+                if (!value.empty())
+                {
+                    sd.push_back(' ');
+                    sd.append(param->m_Name);
+                    sd.append("=\"", 2u);
+                    append_sd_value(sd, value);
+                    sd.push_back('"');
+                    value.clear();
+                    has_parameters = true;
+                }
+            }
+
+            if (has_parameters)
+                sd.push_back(']');
+            else
+                sd.resize(element_start);
+        }
+    }
+
 } // namespace syslog
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -91,6 +208,10 @@ struct syslog_backend::implementation
 #endif // BOOST_LOG_USE_NATIVE_SYSLOG
 #if !defined(BOOST_LOG_NO_ASIO)
     struct udp_socket_based;
+    struct tcp_socket_based;
+#if defined(BOOST_LOG_USE_NATIVE_SYSLOG)
+    struct local_socket_based;
+#endif // defined(BOOST_LOG_USE_NATIVE_SYSLOG)
 #endif
 
     //! Level mapper
@@ -108,7 +229,15 @@ struct syslog_backend::implementation
     virtual ~implementation() {}
 
     //! The method sends the formatted message to the syslog host
-    virtual void send(syslog::level lev, string_type const& formatted_message) = 0;
+    virtual void send(record_view const& rec, syslog::level lev, string_type const& formatted_message) = 0;
+    //! The method is called when the frontend has no more records ready
+    virtual void on_idle() {}
+    //! The method sends the accumulated messages to the syslog host
+    virtual void flush() {}
+    //! The method sets the maximum number of messages that are accumulated before sending
+    virtual void set_batch_size(std::size_t) {}
+    //! The method sets the maximum time the messages can be accumulated before sending
+    virtual void set_batch_latency(posix_time::time_duration const&) {}
 };
 
 
@@ -175,7 +304,7 @@ struct syslog_backend::implementation::native :
     }
 
     //! The method sends the formatted message to the syslog host
-    void send(syslog::level lev, string_type const& formatted_message)
+    void send(record_view const&, syslog::level lev, string_type const& formatted_message)
     {
         int native_level;
         switch (lev)
@@ -312,8 +441,14 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
             m_Socket.close(ec);
         }
 
-        //! The method sends the syslog message to the specified endpoint
-        void send_message(int pri, const char* local_host_name, asio::ip::udp::endpoint const& target, const char* message);
+        //! The method sends the syslog packet, which is composed of the buffers, to the specified endpoint
+        template< typename ConstBufferSequenceT >
+        void send_packet(asio::ip::udp::endpoint const& target, ConstBufferSequenceT const& buffers)
+        {
+            m_Socket.send_to(buffers, target);
+        }
+        //! The method sends the formatted packets to the specified endpoint. The packets are stored one after another in \a packets.
+        void send_packets(asio::ip::udp::endpoint const& target, const char* packets, std::size_t const* sizes, std::size_t count);
 
     private:
         syslog_udp_socket(syslog_udp_socket const&);
@@ -357,38 +492,265 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
         }
     };
 
-    //! The method sends the syslog message to the specified endpoint
-    void syslog_udp_socket::send_message(
-        int pri, const char* local_host_name, asio::ip::udp::endpoint const& target, const char* message)
+    //! The maximum size of the syslog packet, mandated in RFC3164
+    const std::size_t max_packet_size = 1024u;
+
+    //! The number of syslog levels
+    const unsigned int syslog_level_count = 8u;
+
+    //! The class renders the RFC3164 packet header. The parts of the header that only change once per second are cached.
+    class rfc3164_header
     {
-        std::time_t t = std::time(NULL);
-        std::tm ts;
-        std::tm* time_stamp = boost::date_time::c_time::localtime(&t, &ts);
+    private:
+        //! The time stamp format
+        const char* m_TimeStampFormat;
+        //! The part of the header after the time stamp
+        std::string m_Tail;
+        //! The maximum packet size
+        std::size_t m_MaxPacketSize;
+        //! The time of the cached time stamp
+        std::time_t m_Time;
+        //! The cached time stamp, followed by the rest of the header
+        std::string m_TimeStamp;
+        //! The priority prefixes for every syslog level
+        std::string m_Priorities[syslog_level_count];
 
-        // Month will have to be injected separately, as involving locale won't do here
-        static const char months[12][4] =
+    public:
+        /*!
+         * Constructor
+         *
+         * \param facility The facility
+         * \param priority_format The format of the priority, receives the priority value
+         * \param time_stamp_format The format of the time stamp, receives the month name, day, hours, minutes and seconds
+         * \param tail The part of the header after the time stamp
+         * \param max_packet_size The maximum size of the packet, including the header
+         */
+        rfc3164_header(int facility, const char* priority_format, const char* time_stamp_format, std::string const& tail, std::size_t max_packet_size) :
+            m_TimeStampFormat(time_stamp_format),
+            m_Tail(tail),
+            m_MaxPacketSize(max_packet_size),
+            m_Time(static_cast< std::time_t >(-1))
         {
-            "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
-        };
+            for (unsigned int i = 0; i < syslog_level_count; ++i)
+            {
+                char buf[16];
+                const int size = boost::log::aux::snprintf(buf, sizeof(buf), priority_format, facility | static_cast< int >(i));
+                m_Priorities[i].assign(buf, static_cast< std::size_t >(size));
+            }
+        }
+
+        //! The method renders the time stamp, if the current time is different from the cached one
+        void update()
+        {
+            const std::time_t t = std::time(NULL);
+            if (t == m_Time)
+                return;
+
+            std::tm ts;
+            std::tm* time_stamp = boost::date_time::c_time::localtime(&t, &ts);
+
+            // Month will have to be injected separately, as involving locale won't do here
+            static const char months[12][4] =
+            {
+                "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+            };
+
+            char buf[32];
+            const int size = boost::log::aux::snprintf
+            (
+                buf,
+                sizeof(buf),
+                m_TimeStampFormat,
+                months[time_stamp->tm_mon],
+                time_stamp->tm_mday,
+                time_stamp->tm_hour,
+                time_stamp->tm_min,
+                time_stamp->tm_sec
+            );
+            m_TimeStamp.assign(buf, static_cast< std::size_t >(size));
+            m_TimeStamp.append(m_Tail);
+
+            if (m_TimeStamp.size() > m_MaxPacketSize - m_Priorities[0].size())
+                m_TimeStamp.resize(m_MaxPacketSize - m_Priorities[0].size());
+
+            m_Time = t;
+        }
+
+        //! Returns the priority prefix for the level
+        std::string const& priority(syslog::level lev) const
+        {
+            BOOST_ASSERT(static_cast< unsigned int >(lev) < syslog_level_count);
+            return m_Priorities[static_cast< unsigned int >(lev)];
+        }
+        //! Returns the time stamp, followed by the rest of the header
+        std::string const& time_stamp() const { return m_TimeStamp; }
+
+        //! Returns the size of the message that fits into the packet along with the header
+        std::size_t max_message_size(syslog::level lev) const
+        {
+            return m_MaxPacketSize - priority(lev).size() - m_TimeStamp.size();
+        }
+    };
+
+    //! The class accumulates the datagrams that are sent with as few system calls as possible
+    class packet_batch
+    {
+    private:
+        //! The maximum number of packets to accumulate before sending, 0 or 1 if packets are sent immediately
+        std::size_t m_MaxSize;
+        //! The maximum time the packets are accumulated before sending
+        posix_time::time_duration m_Latency;
+        //! The time when the accumulated packets have to be sent
+        posix_time::ptime m_Deadline;
+        //! The accumulated packets, stored one after another
+        std::vector< char > m_Packets;
+        //! The sizes of the accumulated packets
+        std::vector< std::size_t > m_Sizes;
+
+    public:
+        //! Default constructor
+        packet_batch() : m_MaxSize(0), m_Latency(posix_time::not_a_date_time)
+        {
+        }
+
+        //! Returns \c true if the packets are accumulated rather than sent immediately
+        bool enabled() const { return m_MaxSize > 1u; }
+        //! Returns \c true if there are no accumulated packets
+        bool empty() const { return m_Sizes.empty(); }
+        //! Returns the number of accumulated packets
+        std::size_t count() const { return m_Sizes.size(); }
+        //! Returns the accumulated packets, stored one after another
+        const char* packets() const { return &m_Packets[0]; }
+        //! Returns the sizes of the accumulated packets
+        std::size_t const* sizes() const { return &m_Sizes[0]; }
+
+        /*!
+         * The method assembles the packet from the header and the message directly in the batch.
+         * Returns \c true if the batch is full or its latency has expired, so the packets have to be sent.
+         */
+        bool append(std::string const& priority, std::string const& time_stamp, const char* message, std::size_t message_size)
+        {
+            const bool deadline_set = !m_Sizes.empty();
+            const std::size_t packet_size = priority.size() + time_stamp.size() + message_size;
+            const std::size_t offset = m_Packets.size();
+            m_Packets.resize(offset + packet_size);
+            char* p = &m_Packets[offset];
+            std::memcpy(p, priority.data(), priority.size());
+            p += priority.size();
+            std::memcpy(p, time_stamp.data(), time_stamp.size());
+            p += time_stamp.size();
+            std::memcpy(p, message, message_size);
+            m_Sizes.push_back(packet_size);
+
+            if (m_Sizes.size() >= m_MaxSize)
+                return true;
+
+            if (!m_Latency.is_special())
+            {
+                posix_time::ptime now = posix_time::microsec_clock::universal_time();
+                if (!deadline_set)
+                    m_Deadline = now + m_Latency;
+                else if (now >= m_Deadline)
+                    return true;
+            }
+
+            return false;
+        }
+
+        //! Removes the accumulated packets, the storage is retained for the next batch
+        void clear()
+        {
+            m_Packets.clear();
+            m_Sizes.clear();
+        }
+
+        //! Changes the maximum number of packets. Returns \c true if batching is disabled, so the accumulated packets have to be sent.
+        bool set_max_size(std::size_t size)
+        {
+            m_MaxSize = size;
+            if (size <= 1u)
+                return true;
+            m_Sizes.reserve(size);
+            return false;
+        }
 
-        // The packet size is mandated in RFC3164, plus one for the terminating zero
-        char packet[1025];
-        std::size_t packet_size = boost::log::aux::snprintf
-        (
-            packet,
-            sizeof(packet),
-            "<%d> %s % 2d %02d:%02d:%02d %s %s",
-            pri,
-            months[time_stamp->tm_mon],
-            time_stamp->tm_mday,
-            time_stamp->tm_hour,
-            time_stamp->tm_min,
-            time_stamp->tm_sec,
-            local_host_name,
-            message
-        );
-
-        m_Socket.send_to(asio::buffer(packet, packet_size), target);
+        //! Changes the latency, the deadline of the accumulated packets is counted from now
+        void set_latency(posix_time::time_duration const& latency)
+        {
+            m_Latency = latency;
+            if (!m_Sizes.empty() && !latency.is_special())
+                m_Deadline = posix_time::microsec_clock::universal_time() + latency;
+        }
+    };
+
+#if defined(BOOST_LOG_HAS_SENDMMSG)
+    /*!
+     * The function sends the packets, which are stored one after another, through the socket with as few system calls as possible.
+     * Returns the number of packets sent, which is less than \a count if an error occurred.
+     */
+    std::size_t send_datagrams(
+        int fd, const void* target, std::size_t target_size, const char* packets, std::size_t const* sizes, std::size_t count, system::error_code& ec)
+    {
+        // The number of datagrams sent with a single call is limited, so that the headers fit on the stack
+        enum { max_batch = 64 };
+        mmsghdr msgs[max_batch];
+        iovec iovs[max_batch];
+        std::size_t total_sent = 0;
+        while (total_sent < count)
+        {
+            const std::size_t left = count - total_sent;
+            const std::size_t n = left < static_cast< std::size_t >(max_batch) ? left : static_cast< std::size_t >(max_batch);
+            const char* p = packets;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                iovs[i].iov_base = const_cast< char* >(p);
+                iovs[i].iov_len = sizes[i];
+                p += sizes[i];
+
+                std::memset(&msgs[i], 0, sizeof(msgs[i]));
+                msgs[i].msg_hdr.msg_name = const_cast< void* >(target);
+                msgs[i].msg_hdr.msg_namelen = static_cast< socklen_t >(target_size);
+                msgs[i].msg_hdr.msg_iov = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            const int sent = ::sendmmsg(fd, msgs, static_cast< unsigned int >(n), 0);
+            if (sent <= 0)
+            {
+                const int err = errno;
+                if (sent < 0 && err == EINTR)
+                    continue;
+                ec.assign(sent < 0 ? err : EIO, system::system_category());
+                break;
+            }
+
+            // Not all packets may have been sent
+            for (int i = 0; i < sent; ++i)
+                packets += sizes[i];
+            sizes += sent;
+            total_sent += static_cast< std::size_t >(sent);
+        }
+
+        return total_sent;
+    }
+#endif // defined(BOOST_LOG_HAS_SENDMMSG)
+
+    //! The method sends the formatted packets to the specified endpoint
+    void syslog_udp_socket::send_packets(
+        asio::ip::udp::endpoint const& target, const char* packets, std::size_t const* sizes, std::size_t count)
+    {
+#if defined(BOOST_LOG_HAS_SENDMMSG)
+        system::error_code ec;
+        send_datagrams(m_Socket.native_handle(), target.data(), target.size(), packets, sizes, count, ec);
+        if (ec)
+            BOOST_THROW_EXCEPTION(system::system_error(ec, "Failed to send syslog packets"));
+#else
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            m_Socket.send_to(asio::buffer(packets, sizes[i]), target);
+            packets += sizes[i];
+        }
+#endif // defined(BOOST_LOG_HAS_SENDMMSG)
     }
 
 } // namespace
@@ -404,12 +766,18 @@ struct syslog_backend::implementation::udp_socket_based :
     std::auto_ptr< syslog_udp_socket > m_pSocket;
     //! The target host to send packets to
     asio::ip::udp::endpoint m_TargetHost;
+    //! The packet header renderer
+    rfc3164_header m_Header;
+    //! The packets to be sent
+    packet_batch m_Batch;
 
     //! Constructor
     explicit udp_socket_based(syslog::facility const& fac, asio::ip::udp const& protocol) :
         implementation(fac),
         m_Protocol(protocol),
-        m_pService(syslog_udp_service::get())
+        m_pService(syslog_udp_service::get()),
+        // The packet size is mandated in RFC3164
+        m_Header(this->m_Facility, "<%d> ", "%s % 2d %02d:%02d:%02d ", m_pService->m_LocalHostName + ' ', max_packet_size)
     {
         if (m_Protocol == asio::ip::udp::v4())
         {
@@ -426,22 +794,729 @@ struct syslog_backend::implementation::udp_socket_based :
     }
 
     //! The method sends the formatted message to the syslog host
-    void send(syslog::level lev, string_type const& formatted_message)
+    void send(record_view const&, syslog::level lev, string_type const& formatted_message)
+    {
+        m_Header.update();
+        std::string const& priority = m_Header.priority(lev);
+        std::string const& time_stamp = m_Header.time_stamp();
+        const std::size_t max_message_size = m_Header.max_message_size(lev);
+        const std::size_t message_size = formatted_message.size() < max_message_size ? formatted_message.size() : max_message_size;
+
+        if (!m_Batch.enabled())
+        {
+            // Send the packet directly from the header and the message
+            boost::array< asio::const_buffer, 3u > buffers =
+            {{
+                asio::buffer(priority.data(), priority.size()),
+                asio::buffer(time_stamp.data(), time_stamp.size()),
+                asio::buffer(formatted_message.data(), message_size)
+            }};
+            socket().send_packet(m_TargetHost, buffers);
+        }
+        else if (m_Batch.append(priority, time_stamp, formatted_message.data(), message_size))
+        {
+            flush();
+        }
+    }
+
+    //! The method sends the accumulated packets when the frontend has no more records ready
+    void on_idle()
+    {
+        flush();
+    }
+
+    //! The method sends the accumulated packets to the syslog host
+    void flush()
+    {
+        if (!m_Batch.empty())
+        {
+            // The packets are discarded even if sending fails, so that the failed batch is not sent again
+            try
+            {
+                socket().send_packets(m_TargetHost, m_Batch.packets(), m_Batch.sizes(), m_Batch.count());
+            }
+            catch (...)
+            {
+                m_Batch.clear();
+                throw;
+            }
+            m_Batch.clear();
+        }
+    }
+
+    //! Changes the batch size, sends the accumulated packets if batching is disabled
+    void set_batch_size(std::size_t size)
+    {
+        if (m_Batch.set_max_size(size))
+            flush();
+    }
+
+    //! Changes the maximum time the packets are accumulated before sending
+    void set_batch_latency(posix_time::time_duration const& latency)
+    {
+        m_Batch.set_latency(latency);
+    }
+
+    //! Creates a new socket bound to the local address
+    void set_local_address(asio::ip::udp::endpoint const& local_address)
+    {
+        // The accumulated packets are sent from the previous local address
+        flush();
+        m_pSocket.reset(new syslog_udp_socket(m_pService->m_IOService, m_Protocol, local_address));
+    }
+
+private:
+    //! Returns the socket, creates one bound to any local address if not created yet
+    syslog_udp_socket& socket()
     {
         if (!m_pSocket.get())
         {
             asio::ip::udp::endpoint any_local_address;
             m_pSocket.reset(new syslog_udp_socket(m_pService->m_IOService, m_Protocol, any_local_address));
         }
+        return *m_pSocket;
+    }
+};
+
+BOOST_LOG_ANONYMOUS_NAMESPACE {
+
+    //! The function returns the end of the octet counting frame that starts at the specified position of the buffer
+    inline std::size_t frame_end(std::string const& buf, std::size_t pos)
+    {
+        std::size_t size = 0;
+        for (; buf[pos] != ' '; ++pos)
+            size = size * 10u + static_cast< std::size_t >(buf[pos] - '0');
+        return pos + 1u + size;
+    }
+
+    //! The function returns the string if it is not empty and NILVALUE otherwise, limiting the string length and replacing non-printable characters
+    inline std::string make_header_field(std::string const& str, std::size_t max_size)
+    {
+        if (str.empty())
+            return "-";
+        std::string field(str, 0u, max_size);
+        for (std::string::iterator it = field.begin(), end = field.end(); it != end; ++it)
+        {
+            if (*it < 33 || *it > 126)
+                *it = '_';
+        }
+        return field;
+    }
+
+    //! The function writes the decimal representation of the number so that it ends at the specified position, returns the position of the first digit
+    inline char* format_decimal(char* end, std::size_t n)
+    {
+        do
+        {
+            *--end = static_cast< char >('0' + n % 10u);
+            n /= 10u;
+        }
+        while (n > 0u);
+        return end;
+    }
+
+    //! The class renders the RFC5424 message header. The parts of the header that only change once per second are cached.
+    class rfc5424_header
+    {
+    private:
+        //! The position of the fractional seconds in the time stamp
+        enum { fraction_pos = sizeof("YYYY-MM-DDThh:mm:ss.") - 1u, fraction_size = 6u };
+
+    private:
+        //! The fields of the header after the time stamp
+        std::string m_Tail;
+        //! The start of the second of the cached time stamp
+        posix_time::ptime m_Second;
+        //! The cached time stamp, followed by the header fields after it
+        std::string m_TimeStamp;
+        //! The priority and version prefixes for every syslog level
+        std::string m_Priorities[syslog_level_count];
+
+    public:
+        //! Constructor
+        rfc5424_header(int facility, std::string const& app_name) :
+            m_Second(posix_time::not_a_date_time)
+        {
+            for (unsigned int i = 0; i < syslog_level_count; ++i)
+            {
+                char buf[16];
+                const int size = boost::log::aux::snprintf(buf, sizeof(buf), "<%d>1 ", facility | static_cast< int >(i));
+                m_Priorities[i].assign(buf, static_cast< std::size_t >(size));
+            }
+
+            // The header fields other than the time stamp do not change
+            boost::system::error_code err;
+            char pid[std::numeric_limits< unsigned long >::digits10 + 2];
+            boost::log::aux::snprintf(pid, sizeof(pid), "%lu", static_cast< unsigned long >(boost::log::aux::this_process::get_id().native_id()));
+            m_Tail.push_back(' ');
+            m_Tail.append(make_header_field(asio::ip::host_name(err), 255u));
+            m_Tail.push_back(' ');
+            m_Tail.append(make_header_field(app_name, 48u));
+            m_Tail.push_back(' ');
+            m_Tail.append(pid);
+            m_Tail.append(" - ", 3u);
+        }
+
+        //! The method renders the time stamp for the specified time
+        void update(posix_time::ptime const& now)
+        {
+            posix_time::time_duration since = now - m_Second;
+            if (m_Second.is_special() || since.is_negative() || since >= posix_time::seconds(1))
+            {
+                gregorian::date::ymd_type ymd = now.date().year_month_day();
+                posix_time::time_duration tod = now.time_of_day();
+                char buf[32];
+                const int size = boost::log::aux::snprintf
+                (
+                    buf,
+                    sizeof(buf),
+                    "%04u-%02u-%02uT%02u:%02u:%02u.000000Z",
+                    static_cast< unsigned int >(ymd.year),
+                    static_cast< unsigned int >(ymd.month),
+                    static_cast< unsigned int >(ymd.day),
+                    static_cast< unsigned int >(tod.hours()),
+                    static_cast< unsigned int >(tod.minutes()),
+                    static_cast< unsigned int >(tod.seconds())
+                );
+                m_TimeStamp.assign(buf, static_cast< std::size_t >(size));
+                m_TimeStamp.append(m_Tail);
+
+                m_Second = posix_time::ptime(now.date(), posix_time::time_duration(tod.hours(), tod.minutes(), tod.seconds()));
+                since = now - m_Second;
+            }
+
+            char* const fraction = &m_TimeStamp[fraction_pos];
+            std::memset(fraction, '0', fraction_size);
+            format_decimal(fraction + fraction_size, static_cast< std::size_t >(since.total_microseconds()));
+        }
+
+        //! Returns the priority and version prefix for the level
+        std::string const& priority(syslog::level lev) const
+        {
+            BOOST_ASSERT(static_cast< unsigned int >(lev) < syslog_level_count);
+            return m_Priorities[static_cast< unsigned int >(lev)];
+        }
+        //! Returns the time stamp, followed by the header fields after it
+        std::string const& time_stamp() const { return m_TimeStamp; }
+    };
+
+} // namespace
+
+struct syslog_backend::implementation::tcp_socket_based :
+    public implementation
+{
+    //! Connection states
+    enum connection_state
+    {
+        disconnected,
+        connecting,
+        connected
+    };
+
+    //! The IO service that runs the connection operations of this backend
+    asio::io_service m_IOService;
+    //! Protocol to be used
+    asio::ip::tcp m_Protocol;
+    //! The socket, if the connection is being established or is established
+    std::auto_ptr< asio::ip::tcp::socket > m_pSocket;
+    //! The connection state
+    connection_state m_State;
+    //! The target host to connect to
+    asio::ip::tcp::endpoint m_TargetHost;
+    //! The local address to connect from
+    asio::ip::tcp::endpoint m_LocalAddress;
+    //! The flag indicates that the socket has to be bound to the local address
+    bool m_BindLocalAddress;
+    //! The time when the connection may be attempted again
+    posix_time::ptime m_NextConnectTime;
+    //! The time to wait before reconnecting after a failed connection attempt
+    posix_time::time_duration m_ReconnectInterval;
+    //! The maximum time flushing waits for the connection to be established and the messages to be sent
+    posix_time::time_duration m_FlushTimeout;
+
+    //! The message header renderer
+    rfc5424_header m_Header;
+    //! Structured data mapper
+    structured_data_mapper_type m_StructuredDataMapper;
+    //! The buffer for the structured data of the message being sent
+    std::string m_StructuredData;
+
+    //! The framed messages to be sent
+    std::string m_Buffer;
+    //! The number of bytes of the buffer that have been sent
+    std::size_t m_SentSize;
+    //! The start of the first frame in the buffer that has not been sent completely
+    std::size_t m_FrameStart;
+    //! The maximum number of bytes in the buffer that have not been sent
+    std::size_t m_MaxBacklogSize;
+
+    //! The maximum number of messages to accumulate before sending, 0 or 1 if messages are sent immediately
+    std::size_t m_BatchSize;
+    //! The number of messages accumulated since the last sending
+    std::size_t m_PendingCount;
+    //! The maximum time the messages are accumulated before sending
+    posix_time::time_duration m_BatchLatency;
+    //! The time when the accumulated messages have to be sent
+    posix_time::ptime m_BatchDeadline;
+
+    //! Constructor
+    explicit tcp_socket_based(syslog::facility const& fac, asio::ip::tcp const& protocol, std::string const& ident) :
+        implementation(fac),
+        m_Protocol(protocol),
+        m_State(disconnected),
+        m_BindLocalAddress(false),
+        m_NextConnectTime(posix_time::min_date_time),
+        m_ReconnectInterval(posix_time::seconds(1)),
+        m_FlushTimeout(posix_time::seconds(5)),
+        m_Header(this->m_Facility, ident),
+        m_SentSize(0),
+        m_FrameStart(0),
+        m_MaxBacklogSize(1024u * 1024u),
+        m_BatchSize(0),
+        m_PendingCount(0),
+        m_BatchLatency(posix_time::not_a_date_time)
+    {
+        if (m_Protocol == asio::ip::tcp::v4())
+            m_TargetHost = asio::ip::tcp::endpoint(asio::ip::address_v4(0x7F000001), 514); // 127.0.0.1:514
+        else
+            m_TargetHost = asio::ip::tcp::endpoint(asio::ip::address_v6::loopback(), 514); // ::1, port 514
 
-        m_pSocket->send_message(
-            this->m_Facility | static_cast< int >(lev),
-            m_pService->m_LocalHostName.c_str(),
-            m_TargetHost,
-            formatted_message.c_str());
+    }
+
+    //! The method sends the formatted message to the syslog host
+    void send(record_view const& rec, syslog::level lev, string_type const& formatted_message)
+    {
+        posix_time::ptime now = posix_time::microsec_clock::universal_time();
+
+        // Build the RFC5424 header: <PRI>VERSION TIMESTAMP HOSTNAME APP-NAME PROCID MSGID
+        m_Header.update(now);
+        std::string const& priority = m_Header.priority(lev);
+        std::string const& time_stamp = m_Header.time_stamp();
+
+        m_StructuredData.clear();
+        if (!m_StructuredDataMapper.empty())
+            m_StructuredDataMapper(rec, m_StructuredData);
+
+        std::size_t message_size = priority.size() + time_stamp.size() +
+            (m_StructuredData.empty() ? 1u : m_StructuredData.size());
+        if (!formatted_message.empty())
+            message_size += 1u + formatted_message.size();
+
+        // Frame the message: MSG-LEN SP SYSLOG-MSG
+        char frame_header[std::numeric_limits< std::size_t >::digits10 + 3];
+        char* const frame_header_end = frame_header + sizeof(frame_header);
+        frame_header_end[-1] = ' ';
+        const char* const frame_header_begin = format_decimal(frame_header_end - 1, message_size);
+        const std::size_t frame_header_size = static_cast< std::size_t >(frame_header_end - frame_header_begin);
+
+        const std::size_t backlog_size = m_Buffer.size() - m_SentSize;
+        if (backlog_size > 0u && backlog_size + frame_header_size + message_size > m_MaxBacklogSize)
+        {
+            // The server does not keep up or is not available, discard the message rather than block
+            return;
+        }
+
+        m_Buffer.append(frame_header_begin, frame_header_size);
+        m_Buffer.append(priority);
+        m_Buffer.append(time_stamp);
+        if (m_StructuredData.empty())
+            m_Buffer.push_back('-');
+        else
+            m_Buffer.append(m_StructuredData);
+        if (!formatted_message.empty())
+        {
+            m_Buffer.push_back(' ');
+            m_Buffer.append(formatted_message);
+        }
+
+        if (m_BatchSize <= 1u || ++m_PendingCount >= m_BatchSize)
+        {
+            send_buffer(false);
+        }
+        else if (!m_BatchLatency.is_special())
+        {
+            if (m_PendingCount == 1u)
+                m_BatchDeadline = now + m_BatchLatency;
+            else if (now >= m_BatchDeadline)
+                send_buffer(false);
+        }
+    }
+
+    //! The method sends the accumulated messages when the frontend has no more records ready
+    void on_idle()
+    {
+        send_buffer(false);
+    }
+
+    //! The method sends the accumulated messages, waiting for the connection in progress and the sending to complete no longer than the flush timeout
+    void flush()
+    {
+        send_buffer(true);
+    }
+
+    //! Changes the batch size, sends the accumulated messages if batching is disabled
+    void set_batch_size(std::size_t size)
+    {
+        m_BatchSize = size;
+        if (size <= 1u)
+            send_buffer(false);
+    }
+
+    //! Changes the maximum time the messages are accumulated before sending
+    void set_batch_latency(posix_time::time_duration const& latency)
+    {
+        m_BatchLatency = latency;
+        if (m_PendingCount > 0u && !latency.is_special())
+            m_BatchDeadline = posix_time::microsec_clock::universal_time() + latency;
+    }
+
+    //! Changes the target host, the connection is reestablished on the next sending
+    void set_target_host(asio::ip::tcp::endpoint const& target)
+    {
+        m_TargetHost = target;
+        drop_connection(posix_time::ptime(posix_time::min_date_time));
+    }
+
+    //! Changes the local address, the connection is reestablished on the next sending
+    void set_local_address(asio::ip::tcp::endpoint const& local_address)
+    {
+        m_LocalAddress = local_address;
+        m_BindLocalAddress = true;
+        drop_connection(posix_time::ptime(posix_time::min_date_time));
+    }
+
+private:
+    //! The method sends the accumulated messages, if the connection is established. If \a wait is \c true, waits until the flush timeout expires.
+    void send_buffer(bool wait)
+    {
+        m_PendingCount = 0;
+
+        posix_time::ptime deadline;
+        if (wait)
+            deadline = posix_time::microsec_clock::universal_time() + m_FlushTimeout;
+
+        if (m_State != connected)
+        {
+            if (m_State == disconnected)
+            {
+                if (posix_time::microsec_clock::universal_time() < m_NextConnectTime)
+                    return;
+                start_connecting();
+            }
+
+            // Complete the connection, if possible
+            m_IOService.reset();
+            m_IOService.poll();
+            while (wait && m_State == connecting && wait_writable(deadline))
+            {
+                m_IOService.reset();
+                m_IOService.poll();
+            }
+
+            if (m_State != connected)
+                return;
+        }
+
+        boost::system::error_code err;
+        while (m_SentSize < m_Buffer.size())
+        {
+            const std::size_t size = m_pSocket->write_some(asio::buffer(m_Buffer.data() + m_SentSize, m_Buffer.size() - m_SentSize), err);
+            if (err)
+            {
+                if (err == asio::error::would_block || err == asio::error::try_again)
+                {
+                    if (wait && wait_writable(deadline))
+                        continue;
+                    break;
+                }
+                if (err == asio::error::interrupted)
+                    continue;
+
+                // The connection is lost, reconnect immediately on the next sending
+                drop_connection(posix_time::ptime(posix_time::min_date_time));
+                break;
+            }
+            m_SentSize += size;
+        }
+
+        compact_buffer();
+    }
+
+    //! The method waits until the socket becomes writable or the deadline expires. Returns \c false if the deadline has expired.
+    bool wait_writable(posix_time::ptime const& deadline)
+    {
+        const posix_time::time_duration::tick_type timeout = (deadline - posix_time::microsec_clock::universal_time()).total_milliseconds();
+        if (timeout <= 0)
+            return false;
+
+        const int timeout_ms = static_cast< int >((std::min)(timeout, static_cast< posix_time::time_duration::tick_type >((std::numeric_limits< int >::max)())));
+        const asio::ip::tcp::socket::native_handle_type handle = m_pSocket->native_handle();
+#if defined(BOOST_WINDOWS)
+        // A failed connection attempt is reported in the exception set
+        fd_set write_set, except_set;
+        FD_ZERO(&write_set);
+        FD_SET(handle, &write_set);
+        FD_ZERO(&except_set);
+        FD_SET(handle, &except_set);
+        timeval tv;
+        tv.tv_sec = timeout_ms / 1000;
+        tv.tv_usec = (timeout_ms % 1000) * 1000;
+        ::select(0, NULL, &write_set, &except_set, &tv);
+#else
+        pollfd fd = {};
+        fd.fd = handle;
+        fd.events = POLLOUT;
+        // Errors and signal interruptions are handled by the caller on the following socket operation
+        ::poll(&fd, 1, timeout_ms);
+#endif
+        return true;
+    }
+
+    //! The method starts connecting to the target host
+    void start_connecting()
+    {
+        boost::system::error_code err;
+        m_pSocket.reset(new asio::ip::tcp::socket(m_IOService));
+        m_pSocket->open(m_Protocol, err);
+        if (!err && m_BindLocalAddress)
+        {
+            m_pSocket->set_option(asio::socket_base::reuse_address(true), err);
+            m_pSocket->bind(m_LocalAddress, err);
+        }
+
+        if (err)
+        {
+            drop_connection(posix_time::microsec_clock::universal_time() + m_ReconnectInterval);
+            return;
+        }
+
+        m_State = connecting;
+        m_pSocket->async_connect(m_TargetHost, boost::bind(&tcp_socket_based::on_connected, this, asio::placeholders::error));
+    }
+
+    //! The connection completion handler
+    void on_connected(boost::system::error_code const& err)
+    {
+        // The connection attempt was cancelled by closing the socket, which may have been replaced since then
+        if (err == asio::error::operation_aborted)
+            return;
+
+        if (err)
+        {
+            drop_connection(posix_time::microsec_clock::universal_time() + m_ReconnectInterval);
+            return;
+        }
+
+        boost::system::error_code ec;
+        m_pSocket->non_blocking(true, ec);
+        m_State = connected;
+    }
+
+    //! The method closes the connection, if any, and sets the time of the next connection attempt
+    void drop_connection(posix_time::ptime const& next_connect_time)
+    {
+        if (m_pSocket.get())
+        {
+            boost::system::error_code err;
+            m_pSocket->close(err);
+            m_pSocket.reset();
+        }
+        m_State = disconnected;
+        m_NextConnectTime = next_connect_time;
+
+        // The rest of the partially sent message cannot be sent over a new connection
+        if (m_SentSize > m_FrameStart)
+        {
+            std::size_t end = m_FrameStart;
+            while ((end = frame_end(m_Buffer, end)) < m_SentSize) {}
+            m_SentSize = end;
+            m_FrameStart = end;
+        }
+    }
+
+    //! The method removes the sent messages from the buffer
+    void compact_buffer()
+    {
+        if (m_SentSize == m_Buffer.size())
+        {
+            m_Buffer.clear();
+            m_SentSize = 0;
+            m_FrameStart = 0;
+        }
+        else if (m_SentSize >= 65536u && m_SentSize >= m_Buffer.size() / 2u)
+        {
+            // Remove the completely sent messages
+            std::size_t end;
+            while ((end = frame_end(m_Buffer, m_FrameStart)) <= m_SentSize)
+                m_FrameStart = end;
+            m_Buffer.erase(0u, m_FrameStart);
+            m_SentSize -= m_FrameStart;
+            m_FrameStart = 0;
+        }
     }
 };
 
+#if defined(BOOST_LOG_USE_NATIVE_SYSLOG)
+
+struct syslog_backend::implementation::local_socket_based :
+    public implementation
+{
+    //! The IO service of the socket
+    asio::io_service m_IOService;
+    //! The socket
+    asio::local::datagram_protocol::socket m_Socket;
+    //! The path to the local syslog socket
+    std::string m_SocketPath;
+    //! The packet header renderer
+    rfc3164_header m_Header;
+    //! The packets to be sent
+    packet_batch m_Batch;
+
+    //! Constructor
+    local_socket_based(syslog::facility const& fac, std::string const& ident) :
+        implementation(fac),
+        m_Socket(m_IOService),
+        m_SocketPath("/dev/log"),
+        // The same header as the one the native syslog API produces, the packet size is only limited by the socket
+        m_Header(this->m_Facility, "<%d>", "%s %2d %02d:%02d:%02d ", (ident.empty() ? boost::log::aux::get_process_name() : ident) + ": ", (std::numeric_limits< std::size_t >::max)())
+    {
+    }
+
+    //! The method sends the formatted message to the syslog daemon
+    void send(record_view const&, syslog::level lev, string_type const& formatted_message)
+    {
+        m_Header.update();
+        std::string const& priority = m_Header.priority(lev);
+        std::string const& time_stamp = m_Header.time_stamp();
+
+        if (!m_Batch.enabled())
+        {
+            // Send the packet directly from the header and the message
+            boost::array< asio::const_buffer, 3u > buffers =
+            {{
+                asio::buffer(priority.data(), priority.size()),
+                asio::buffer(time_stamp.data(), time_stamp.size()),
+                asio::buffer(formatted_message.data(), formatted_message.size())
+            }};
+
+            // Like the native syslog API, the message is discarded if it cannot be sent
+            if (connect())
+            {
+                boost::system::error_code err;
+                m_Socket.send(buffers, 0, err);
+                // The syslog daemon may have been restarted, reconnect and try once again
+                if (err && reconnect())
+                    m_Socket.send(buffers, 0, err);
+            }
+        }
+        else if (m_Batch.append(priority, time_stamp, formatted_message.data(), formatted_message.size()))
+        {
+            flush();
+        }
+    }
+
+    //! The method sends the accumulated packets when the frontend has no more records ready
+    void on_idle()
+    {
+        flush();
+    }
+
+    //! The method sends the accumulated packets to the syslog daemon
+    void flush()
+    {
+        if (m_Batch.empty())
+            return;
+
+        if (connect())
+        {
+            const char* packets = m_Batch.packets();
+            std::size_t const* sizes = m_Batch.sizes();
+            std::size_t count = m_Batch.count();
+            boost::system::error_code err;
+            const std::size_t sent = send_packets(packets, sizes, count, err);
+            if (err && reconnect())
+            {
+                // The syslog daemon may have been restarted, try once again to send the rest of the packets
+                for (std::size_t i = 0; i < sent; ++i)
+                    packets += sizes[i];
+                send_packets(packets, sizes + sent, count - sent, err);
+            }
+        }
+
+        // Like the native syslog API, the packets that could not be sent are discarded
+        m_Batch.clear();
+    }
+
+    //! Changes the batch size, sends the accumulated packets if batching is disabled
+    void set_batch_size(std::size_t size)
+    {
+        if (m_Batch.set_max_size(size))
+            flush();
+    }
+
+    //! Changes the maximum time the packets are accumulated before sending
+    void set_batch_latency(posix_time::time_duration const& latency)
+    {
+        m_Batch.set_latency(latency);
+    }
+
+    //! Changes the path to the syslog socket
+    void set_socket_path(std::string const& path)
+    {
+        // The accumulated packets are intended for the previous socket
+        flush();
+        m_SocketPath = path;
+        boost::system::error_code err;
+        m_Socket.close(err);
+    }
+
+private:
+    //! Connects the socket, if not connected yet. Returns \c true if the socket is connected.
+    bool connect()
+    {
+        if (m_Socket.is_open())
+            return true;
+
+        boost::system::error_code err;
+        m_Socket.open(asio::local::datagram_protocol(), err);
+        if (!err)
+        {
+            m_Socket.connect(asio::local::datagram_protocol::endpoint(m_SocketPath), err);
+            if (!err)
+                return true;
+            m_Socket.close(err);
+        }
+        return false;
+    }
+
+    //! Closes and connects the socket again. Returns \c true if the socket is connected.
+    bool reconnect()
+    {
+        boost::system::error_code err;
+        m_Socket.close(err);
+        return connect();
+    }
+
+    //! Sends the packets through the connected socket, returns the number of packets sent
+    std::size_t send_packets(const char* packets, std::size_t const* sizes, std::size_t count, boost::system::error_code& err)
+    {
+#if defined(BOOST_LOG_HAS_SENDMMSG)
+        return send_datagrams(m_Socket.native_handle(), NULL, 0u, packets, sizes, count, err);
+#else
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            m_Socket.send(asio::buffer(packets, sizes[i]), 0, err);
+            if (err)
+                return i;
+            packets += sizes[i];
+        }
+        return count;
+#endif // defined(BOOST_LOG_HAS_SENDMMSG)
+    }
+};
+
+#endif // defined(BOOST_LOG_USE_NATIVE_SYSLOG)
+
 #endif // !defined(BOOST_LOG_NO_ASIO)
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -455,6 +1530,15 @@ BOOST_LOG_API syslog_backend::syslog_backend()
 //! Destructor
 BOOST_LOG_API syslog_backend::~syslog_backend()
 {
+    try
+    {
+        // Send the accumulated messages
+        m_pImpl->flush();
+    }
+    catch (...)
+    {
+    }
+
     delete m_pImpl;
 }
 
@@ -464,14 +1548,51 @@ BOOST_LOG_API void syslog_backend::set_severity_mapper(severity_mapper_type cons
     m_pImpl->m_LevelMapper = mapper;
 }
 
+//! The method installs the function object that builds structured data from log records
+BOOST_LOG_API void syslog_backend::set_structured_data_mapper(structured_data_mapper_type const& mapper)
+{
+#if !defined(BOOST_LOG_NO_ASIO)
+    typedef implementation::tcp_socket_based tcp_socket_based_impl;
+    if (tcp_socket_based_impl* impl = dynamic_cast< tcp_socket_based_impl* >(m_pImpl))
+    {
+        impl->m_StructuredDataMapper = mapper;
+    }
+#endif // !defined(BOOST_LOG_NO_ASIO)
+}
+
 //! The method writes the message to the sink
 BOOST_LOG_API void syslog_backend::consume(record_view const& rec, string_type const& formatted_message)
 {
     m_pImpl->send(
+        rec,
         m_pImpl->m_LevelMapper.empty() ? syslog::info : m_pImpl->m_LevelMapper(rec),
         formatted_message);
 }
 
+//! The method writes a batch of messages to the sink
+BOOST_LOG_API void syslog_backend::consume(record_view const* records, string_type const* formatted_messages, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        m_pImpl->send(
+            records[i],
+            m_pImpl->m_LevelMapper.empty() ? syslog::info : m_pImpl->m_LevelMapper(records[i]),
+            formatted_messages[i]);
+    }
+}
+
+//! The method sends the accumulated messages when the frontend has no more records ready
+BOOST_LOG_API void syslog_backend::on_idle()
+{
+    m_pImpl->on_idle();
+}
+
+//! The method sends the accumulated messages
+BOOST_LOG_API void syslog_backend::flush()
+{
+    m_pImpl->flush();
+}
+
 
 //! The method creates the backend implementation
 BOOST_LOG_API void syslog_backend::construct(syslog::facility fac, syslog::impl_types use_impl, ip_versions ip_version, std::string const& ident)
@@ -486,6 +1607,32 @@ BOOST_LOG_API void syslog_backend::construct(syslog::facility fac, syslog::impl_
 #endif // BOOST_LOG_USE_NATIVE_SYSLOG
 
 #if !defined(BOOST_LOG_NO_ASIO)
+#ifdef BOOST_LOG_USE_NATIVE_SYSLOG
+    if (use_impl == syslog::local_socket_based)
+    {
+        typedef implementation::local_socket_based local_socket_based_impl;
+        m_pImpl = new local_socket_based_impl(fac, ident);
+        return;
+    }
+#endif // BOOST_LOG_USE_NATIVE_SYSLOG
+
+    if (use_impl == syslog::tcp_socket_based)
+    {
+        typedef implementation::tcp_socket_based tcp_socket_based_impl;
+        switch (ip_version)
+        {
+        case v4:
+            m_pImpl = new tcp_socket_based_impl(fac, asio::ip::tcp::v4(), ident);
+            break;
+        case v6:
+            m_pImpl = new tcp_socket_based_impl(fac, asio::ip::tcp::v6(), ident);
+            break;
+        default:
+            BOOST_LOG_THROW_DESCR(setup_error, "Incorrect IP version specified");
+        }
+        return;
+    }
+
     typedef implementation::udp_socket_based udp_socket_based_impl;
     switch (ip_version)
     {
@@ -524,7 +1671,23 @@ BOOST_LOG_API void syslog_backend::set_local_address(std::string const& addr, un
             local_address = *impl->m_pService->m_HostNameResolver.resolve(q);
         }
 
-        impl->m_pSocket.reset(new syslog_udp_socket(impl->m_pService->m_IOService, impl->m_Protocol, local_address));
+        impl->set_local_address(local_address);
+    }
+    else
+    {
+        typedef implementation::tcp_socket_based tcp_socket_based_impl;
+        if (tcp_socket_based_impl* impl = dynamic_cast< tcp_socket_based_impl* >(m_pImpl))
+        {
+            char service_name[std::numeric_limits< int >::digits10 + 3];
+            boost::log::aux::snprintf(service_name, sizeof(service_name), "%d", static_cast< int >(port));
+            asio::ip::tcp::resolver::query q(
+                impl->m_Protocol,
+                addr,
+                service_name,
+                asio::ip::resolver_query_base::address_configured | asio::ip::resolver_query_base::passive);
+            asio::ip::tcp::resolver resolver(impl->m_IOService);
+            impl->set_local_address(*resolver.resolve(q));
+        }
     }
 #else
     // Boost.ASIO requires threads for the host name resolver,
@@ -538,8 +1701,13 @@ BOOST_LOG_API void syslog_backend::set_local_address(boost::asio::ip::address co
     typedef implementation::udp_socket_based udp_socket_based_impl;
     if (udp_socket_based_impl* impl = dynamic_cast< udp_socket_based_impl* >(m_pImpl))
     {
-        impl->m_pSocket.reset(new syslog_udp_socket(
-            impl->m_pService->m_IOService, impl->m_Protocol, asio::ip::udp::endpoint(addr, port)));
+        impl->set_local_address(asio::ip::udp::endpoint(addr, port));
+    }
+    else
+    {
+        typedef implementation::tcp_socket_based tcp_socket_based_impl;
+        if (tcp_socket_based_impl* impl = dynamic_cast< tcp_socket_based_impl* >(m_pImpl))
+            impl->set_local_address(asio::ip::tcp::endpoint(addr, port));
     }
 }
 
@@ -560,8 +1728,22 @@ BOOST_LOG_API void syslog_backend::set_target_address(std::string const& addr, u
             remote_address = *impl->m_pService->m_HostNameResolver.resolve(q);
         }
 
+        // The accumulated packets are intended for the previous target
+        impl->flush();
         impl->m_TargetHost = remote_address;
     }
+    else
+    {
+        typedef implementation::tcp_socket_based tcp_socket_based_impl;
+        if (tcp_socket_based_impl* impl = dynamic_cast< tcp_socket_based_impl* >(m_pImpl))
+        {
+            char service_name[std::numeric_limits< int >::digits10 + 3];
+            boost::log::aux::snprintf(service_name, sizeof(service_name), "%d", static_cast< int >(port));
+            asio::ip::tcp::resolver::query q(impl->m_Protocol, addr, service_name, asio::ip::resolver_query_base::address_configured);
+            asio::ip::tcp::resolver resolver(impl->m_IOService);
+            impl->set_target_host(*resolver.resolve(q));
+        }
+    }
 #else
     // Boost.ASIO requires threads for the host name resolver,
     // so without threads wi simply assume the string already contains IP address
@@ -574,8 +1756,70 @@ BOOST_LOG_API void syslog_backend::set_target_address(boost::asio::ip::address c
     typedef implementation::udp_socket_based udp_socket_based_impl;
     if (udp_socket_based_impl* impl = dynamic_cast< udp_socket_based_impl* >(m_pImpl))
     {
+        // The accumulated packets are intended for the previous target
+        impl->flush();
         impl->m_TargetHost = asio::ip::udp::endpoint(addr, port);
     }
+    else
+    {
+        typedef implementation::tcp_socket_based tcp_socket_based_impl;
+        if (tcp_socket_based_impl* impl = dynamic_cast< tcp_socket_based_impl* >(m_pImpl))
+            impl->set_target_host(asio::ip::tcp::endpoint(addr, port));
+    }
+}
+
+//! The method sets the maximum number of packets that are accumulated before sending
+BOOST_LOG_API void syslog_backend::set_batch_size(std::size_t size)
+{
+    m_pImpl->set_batch_size(size);
+}
+
+//! The method sets the maximum time the packets can be accumulated before sending
+BOOST_LOG_API void syslog_backend::set_batch_latency(posix_time::time_duration const& latency)
+{
+    m_pImpl->set_batch_latency(latency);
+}
+
+//! The method sets the path to the local syslog socket
+BOOST_LOG_API void syslog_backend::set_target_socket(std::string const& path)
+{
+#ifdef BOOST_LOG_USE_NATIVE_SYSLOG
+    typedef implementation::local_socket_based local_socket_based_impl;
+    if (local_socket_based_impl* impl = dynamic_cast< local_socket_based_impl* >(m_pImpl))
+    {
+        impl->set_socket_path(path);
+    }
+#endif // BOOST_LOG_USE_NATIVE_SYSLOG
+}
+
+//! The method sets the maximum size of the messages kept while the syslog server is not available
+BOOST_LOG_API void syslog_backend::set_max_backlog_size(std::size_t size)
+{
+    typedef implementation::tcp_socket_based tcp_socket_based_impl;
+    if (tcp_socket_based_impl* impl = dynamic_cast< tcp_socket_based_impl* >(m_pImpl))
+    {
+        impl->m_MaxBacklogSize = size;
+    }
+}
+
+//! The method sets the time to wait before reconnecting to the syslog server
+BOOST_LOG_API void syslog_backend::set_reconnect_interval(posix_time::time_duration const& interval)
+{
+    typedef implementation::tcp_socket_based tcp_socket_based_impl;
+    if (tcp_socket_based_impl* impl = dynamic_cast< tcp_socket_based_impl* >(m_pImpl))
+    {
+        impl->m_ReconnectInterval = interval;
+    }
+}
+
+//! The method sets the maximum time to wait for the connection and sending to complete on flushing
+BOOST_LOG_API void syslog_backend::set_flush_timeout(posix_time::time_duration const& timeout)
+{
+    typedef implementation::tcp_socket_based tcp_socket_based_impl;
+    if (tcp_socket_based_impl* impl = dynamic_cast< tcp_socket_based_impl* >(m_pImpl))
+    {
+        impl->m_FlushTimeout = timeout.is_special() ? posix_time::time_duration(0, 0, 0) : timeout;
+    }
 }
 
 #endif // !defined(BOOST_LOG_NO_ASIO)
@@ -20,9 +20,13 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstddef>
+#include <map>
+#include <set>
 #include <list>
+#include <deque>
 #include <memory>
 #include <string>
+#include <vector>
 #include <locale>
 #include <ostream>
 #include <sstream>
@@ -58,10 +62,26 @@
 #include <boost/log/attributes/time_traits.hpp>
 #include <boost/log/sinks/text_file_backend.hpp>
 #include <boost/log/sinks/text_multifile_backend.hpp>
+#include "async_filebuf.hpp"
+#include "mapped_filebuf.hpp"
+#include "file_compression.hpp"
+
+#if !defined(BOOST_WINDOWS_API)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+// The written data can be synchronized with the storage
+#define BOOST_LOG_HAS_FILE_SYNC
+#endif // !defined(BOOST_WINDOWS_API)
 
 #if !defined(BOOST_LOG_NO_THREADS)
 #include <boost/thread/locks.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/thread/condition_variable.hpp>
 #endif // !defined(BOOST_LOG_NO_THREADS)
 
 #include <boost/log/detail/header.hpp>
@@ -76,6 +96,49 @@ namespace sinks {
 
 BOOST_LOG_ANONYMOUS_NAMESPACE {
 
+#if defined(BOOST_LOG_HAS_FILE_SYNC)
+
+    //! Synchronizes the file data with the storage. Returns zero on success or the error code.
+    inline int sync_file_data(int fd)
+    {
+#if defined(__APPLE__)
+        // fdatasync is not available on Mac OS X
+        if (fsync(fd) != 0)
+#else
+        if (fdatasync(fd) != 0)
+#endif
+            return errno;
+        return 0;
+    }
+
+#endif // defined(BOOST_LOG_HAS_FILE_SYNC)
+
+#if !defined(BOOST_WINDOWS_API)
+
+    //! Copies the file contents to a new file
+    inline void copy_file_contents(
+        filesystem::path const& from,
+        filesystem::path const& to)
+    {
+        if (filesystem::exists(to))
+            BOOST_THROW_EXCEPTION(filesystem::filesystem_error("Failed to copy file", from, to, system::errc::make_error_code(system::errc::file_exists)));
+
+        filesystem::ifstream src(from, std::ios_base::in | std::ios_base::binary);
+        filesystem::ofstream dst(to, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+        if (!src.is_open() || !dst.is_open())
+            BOOST_THROW_EXCEPTION(filesystem::filesystem_error("Failed to open file for copying", from, to, system::errc::make_error_code(system::errc::io_error)));
+
+        std::vector< char > buffer(65536u);
+        while (src.read(&buffer[0], static_cast< std::streamsize >(buffer.size())) || src.gcount() > 0)
+            dst.write(&buffer[0], src.gcount());
+
+        dst.close();
+        if (src.bad() || dst.fail())
+            BOOST_THROW_EXCEPTION(filesystem::filesystem_error("Failed to copy file", from, to, system::errc::make_error_code(system::errc::io_error)));
+    }
+
+#endif // !defined(BOOST_WINDOWS_API)
+
     //! A possible Boost.Filesystem extension - renames or moves the file to the target storage
     inline void move_file(
         filesystem::path const& from,
@@ -95,7 +158,33 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
             if (e.code().value() == system::errc::cross_device_link)
             {
                 // Attempt to manually move the file instead
-                filesystem::copy_file(from, to);
+                try
+                {
+                    try
+                    {
+                        filesystem::copy_file(from, to);
+                    }
+                    catch (system::system_error& copy_error)
+                    {
+                        // Some implementations of copy_file use system calls that cannot copy files between file systems
+                        if (copy_error.code().value() != system::errc::cross_device_link)
+                            throw;
+
+                        system::error_code ec;
+                        filesystem::remove(to, ec);
+                        copy_file_contents(from, to);
+                    }
+                }
+                catch (system::system_error& copy_error)
+                {
+                    // Do not leave a partial copy, the move may be retried
+                    if (copy_error.code().value() != system::errc::file_exists)
+                    {
+                        system::error_code ec;
+                        filesystem::remove(to, ec);
+                    }
+                    throw;
+                }
                 filesystem::remove(from);
             }
             else
@@ -104,6 +193,73 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
 #endif
     }
 
+    //! The name of the file collector manifest in the target directory
+    const char manifest_file_name[] = ".boost_log_manifest";
+    //! The first line of the manifest, which identifies the manifest format
+    const char manifest_header[] = "boost_log_manifest 3";
+    //! The marker that separates the original file name from the unique suffix in the temporary names of the files waiting to be stored
+    const char pending_file_marker[] = ".boost_log_pending.";
+
+#if !defined(BOOST_LOG_NO_THREADS)
+    //! The number of attempts the background thread makes to store a file
+    const unsigned int max_store_attempts = 3u;
+    //! The delay between the attempts to store a file, in milliseconds
+    const unsigned int store_retry_delay = 1000u;
+#endif // !defined(BOOST_LOG_NO_THREADS)
+
+    //! Returns the last modification time of the file with the best precision available, or 0 if the file does not exist
+    inline uintmax_t modification_time(filesystem::path const& p)
+    {
+#if defined(BOOST_WINDOWS_API)
+        system::error_code ec;
+        const std::time_t t = filesystem::last_write_time(p, ec);
+        return ec ? static_cast< uintmax_t >(0) : static_cast< uintmax_t >(t);
+#else
+        struct stat st;
+        if (::stat(p.c_str(), &st) != 0)
+            return 0;
+#if defined(__APPLE__)
+        return static_cast< uintmax_t >(st.st_mtimespec.tv_sec) * 1000000000u + static_cast< uintmax_t >(st.st_mtimespec.tv_nsec);
+#else
+        return static_cast< uintmax_t >(st.st_mtim.tv_sec) * 1000000000u + static_cast< uintmax_t >(st.st_mtim.tv_nsec);
+#endif
+#endif
+    }
+
+    //! Returns the current time in the units of \c modification_time
+    inline uintmax_t current_modification_time()
+    {
+        const posix_time::time_duration since_epoch =
+            posix_time::microsec_clock::universal_time() - posix_time::ptime(gregorian::date(1970, 1, 1));
+#if defined(BOOST_WINDOWS_API)
+        return static_cast< uintmax_t >(since_epoch.total_seconds());
+#else
+        return static_cast< uintmax_t >(since_epoch.total_microseconds()) * 1000u;
+#endif
+    }
+
+    //! Returns the time during which a directory modification may not change the specified modification time of the directory
+    inline uintmax_t modification_time_granularity(uintmax_t time)
+    {
+#if defined(BOOST_WINDOWS_API)
+        // The time is in seconds, and FAT has two seconds resolution
+        return 2u;
+#else
+        // File systems with one or two seconds resolution don't report nanoseconds. Otherwise the time is taken from
+        // the coarse kernel clock, which advances in ticks of a few milliseconds.
+        return (time % 1000000000u) == 0u ? static_cast< uintmax_t >(2000000000u) : static_cast< uintmax_t >(50000000u);
+#endif
+    }
+
+    //! Returns the time that remains until a directory modification will change the specified modification time of the directory
+    inline uintmax_t modification_time_settle_delay(uintmax_t time)
+    {
+        const uintmax_t now = current_modification_time(), granularity = modification_time_granularity(time);
+        if (now < time)
+            return granularity + 1u; // the clock has been adjusted
+        return now - time > granularity ? static_cast< uintmax_t >(0u) : granularity + 1u - (now - time);
+    }
+
     typedef filesystem::path::string_type path_string_type;
     typedef path_string_type::value_type path_char_type;
 
@@ -468,6 +624,41 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
             return false;
     }
 
+    //! Makes the temporary name of the file that waits to be stored by the background thread
+    path_string_type make_pending_file_name(path_string_type const& file_name)
+    {
+        path_string_type temp_name = file_name;
+        temp_name.append(pending_file_marker, pending_file_marker + sizeof(pending_file_marker) - 1u);
+        temp_name.append(filesystem::unique_path().native());
+        return temp_name;
+    }
+
+    //! Extracts the original file name from the temporary name of the file that waits to be stored. Returns \c false if the name is not temporary.
+    bool parse_pending_file_name(path_string_type const& temp_name, path_string_type& file_name)
+    {
+        const path_string_type marker(pending_file_marker, pending_file_marker + sizeof(pending_file_marker) - 1u);
+        const path_string_type::size_type pos = temp_name.rfind(marker);
+        if (pos == path_string_type::npos || pos == 0u)
+            return false;
+        file_name.assign(temp_name, 0u, pos);
+        return true;
+    }
+
+    //! The function matches the compressed file name and the pattern
+    bool match_compressed_pattern(path_string_type const& file_name, path_string_type const& pattern, unsigned int& file_counter)
+    {
+#if !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+        const path_string_type::size_type suffix_size = sizeof(aux::compressed_file_suffix) - 1u;
+        if (file_name.size() > suffix_size &&
+            std::equal(aux::compressed_file_suffix, aux::compressed_file_suffix + suffix_size, file_name.end() - suffix_size))
+        {
+            return match_pattern(path_string_type(file_name.begin(), file_name.end() - suffix_size), pattern, file_counter);
+        }
+#endif // !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+
+        return false;
+    }
+
 
     class file_collector_repository;
 
@@ -495,6 +686,29 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
         //! The string type compatible with the universal path type
         typedef filesystem::path::string_type path_string_type;
 
+#if !defined(BOOST_LOG_NO_THREADS)
+        //! A file waiting to be stored by the background thread
+        struct pending_file
+        {
+            //! The temporary name of the file that has to be moved to the target directory, empty if the file is already there
+            filesystem::path m_Source;
+            //! The name of the file in the target directory
+            filesystem::path m_Path;
+            //! Compression level, 0 if the file is not compressed
+            int m_CompressionLevel;
+            //! The number of failed attempts to store the file
+            unsigned int m_Attempts;
+            //! The time of the next attempt to store the file, if the previous attempt failed
+            system_time m_RetryTime;
+
+            pending_file() : m_CompressionLevel(0), m_Attempts(0u)
+            {
+            }
+        };
+        //! A queue of the files waiting to be stored
+        typedef std::deque< pending_file > pending_list;
+#endif // !defined(BOOST_LOG_NO_THREADS)
+
     private:
         //! A reference to the repository this collector belongs to
         shared_ptr< file_collector_repository > m_pRepository;
@@ -508,6 +722,18 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
         uintmax_t m_MaxSize;
         //! Free space lower limit
         uintmax_t m_MinFreeSpace;
+        //! Compression level of the stored files, 0 if the files are not compressed
+        int m_CompressionLevel;
+        //! The flag indicates that the collector maintains the manifest of the target directory
+        bool m_UseManifest;
+        //! The flag indicates that the manifest has been written by the collector and has to be updated when files are stored or deleted
+        bool m_ManifestValid;
+        //! The number of records in the manifest, which is written in the trailer after every update
+        std::size_t m_ManifestRecordCount;
+        //! The flag indicates that the manifest is not used because files are written to the target directory while the stored files are updated
+        bool m_ManifestDisabled;
+        //! The flag indicates that the manifest was last updated too soon after the directory was modified, so the manifest will be rejected
+        bool m_ManifestOutdated;
         //! The current path at the point when the collector is created
         /*
          * The special member is required to calculate absolute paths with no
@@ -522,13 +748,31 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
         //! Total size of the stored files
         uintmax_t m_TotalSize;
 
+#if !defined(BOOST_LOG_NO_THREADS)
+        //! The mutex protects the queue of the files waiting to be stored
+        mutex m_PendingMutex;
+        //! The condition is signalled when files are queued or the background thread has to stop
+        condition_variable m_PendingCond;
+        //! The files waiting to be stored by the background thread
+        pending_list m_PendingFiles;
+        //! The temporary names of the files waiting to be stored or being stored by the background thread
+        std::set< filesystem::path > m_PendingSources;
+        //! The flag indicates that the background thread has to stop
+        bool m_StopRequested;
+        //! The background thread, not started if the files are stored synchronously
+        thread m_Worker;
+#endif // !defined(BOOST_LOG_NO_THREADS)
+
     public:
         //! Constructor
         file_collector(
             shared_ptr< file_collector_repository > const& repo,
             filesystem::path const& target_dir,
             uintmax_t max_size,
-            uintmax_t min_free_space);
+            uintmax_t min_free_space,
+            bool background_collection,
+            int compression_level,
+            bool manifest);
 
         //! Destructor
         ~file_collector();
@@ -541,7 +785,7 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
             file::scan_method method, filesystem::path const& pattern, unsigned int* counter);
 
         //! The function updates storage restrictions
-        void update(uintmax_t max_size, uintmax_t min_free_space);
+        void update(uintmax_t max_size, uintmax_t min_free_space, bool background_collection, int compression_level, bool manifest);
 
         //! The function checks if the directory is governed by this collector
         bool is_governed(filesystem::path const& dir) const
@@ -555,6 +799,50 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
         {
             return filesystem::absolute(p, m_BasePath);
         }
+        //! Returns the name of the file in the target directory that does not conflict with existing files
+        filesystem::path make_target_path(path_string_type const& file_name, bool compressed) const;
+        //! Deletes the oldest files to free space for the file of the specified size. Must be called with the mutex locked.
+        void delete_old_files(uintmax_t size);
+        //! Compresses the file into the storage
+        void store_compressed_file(filesystem::path const& src_path, file_info& info, int compression_level);
+        //! Adds the stored file to the list. Must be called with the mutex locked.
+        void add_file(file_info const& info);
+        //! Finds the files left under temporary names by the background thread of a previous run. Must be called with the mutex locked.
+        uintmax_t scan_pending_files(
+            filesystem::path const& dir, file::scan_method method, path_string_type const& mask, unsigned int* counter, file_list& files, uintmax_t& total_size);
+
+        //! Reads the list of files in the target directory from the manifest. Returns \c false if the manifest is missing, damaged or outdated.
+        bool read_manifest(file_list& files);
+        //! Parses the manifest. Returns \c false if the manifest is missing or damaged.
+        bool parse_manifest(file_list& files, std::size_t& record_count, uintmax_t& dir_time);
+        //! Records the directory modification time in the manifest that was last updated too soon after the directory was modified
+        void settle_manifest();
+        //! Scans the target directory for files and rewrites the manifest
+        void build_manifest(file_list& files);
+        //! Writes the manifest that lists the specified files
+        void write_manifest(file_list const& files);
+        //! Appends the records to the manifest
+        void append_to_manifest(std::string const& records);
+        //! Writes the records followed by the trailer to the manifest opened in the specified mode
+        void write_manifest_update(std::string const& records, std::ios_base::openmode mode);
+        //! Stops maintaining the manifest and removes it from the target directory
+        void disable_manifest();
+        //! Formats the manifest record of the stored file
+        static void format_manifest_record(std::string& records, char op, file_info const& info);
+
+#if !defined(BOOST_LOG_NO_THREADS)
+        //! Starts the background thread, if not started yet
+        void start_worker();
+        //! Renames the file to a temporary name in its directory, so that the backend does not overwrite it before it is stored
+        void move_to_pending(filesystem::path const& src_path, filesystem::path const& src_dir, path_string_type const& file_name, pending_file& file);
+        //! The background thread function
+        void run_worker();
+        //! Stores the file queued for the background thread
+        void store_pending_file(pending_file const& file);
+        //! Adds the file that could not be stored to the list, so that it is still subject to the storage limits
+        void add_unstored_file(pending_file const& file);
+#endif // !defined(BOOST_LOG_NO_THREADS)
+
         //! Acquires file name string from the path
         static path_string_type filename_string(filesystem::path const& p)
         {
@@ -594,7 +882,7 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
     public:
         //! Finds or creates a file collector
         shared_ptr< file::collector > get_collector(
-            filesystem::path const& target_dir, uintmax_t max_size, uintmax_t min_free_space);
+            filesystem::path const& target_dir, uintmax_t max_size, uintmax_t min_free_space, bool background_collection, int compression_level, bool manifest);
 
         //! Removes the file collector from the list
         void remove_collector(file_collector* p);
@@ -612,67 +900,199 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
         shared_ptr< file_collector_repository > const& repo,
         filesystem::path const& target_dir,
         uintmax_t max_size,
-        uintmax_t min_free_space
+        uintmax_t min_free_space,
+        bool background_collection,
+        int compression_level,
+        bool manifest
     ) :
         m_pRepository(repo),
         m_MaxSize(max_size),
         m_MinFreeSpace(min_free_space),
+        m_CompressionLevel(compression_level),
+        m_UseManifest(manifest),
+        m_ManifestValid(false),
+        m_ManifestRecordCount(0),
+        m_ManifestDisabled(false),
+        m_ManifestOutdated(false),
         m_BasePath(filesystem::current_path()),
         m_TotalSize(0)
+#if !defined(BOOST_LOG_NO_THREADS)
+        , m_StopRequested(false)
+#endif // !defined(BOOST_LOG_NO_THREADS)
     {
         m_StorageDir = make_absolute(target_dir);
         filesystem::create_directories(m_StorageDir);
+
+#if !defined(BOOST_LOG_NO_THREADS)
+        // Compression takes too long to be done in the thread that rotates the file
+        if (background_collection || compression_level > 0)
+            start_worker();
+#endif // !defined(BOOST_LOG_NO_THREADS)
     }
 
     //! Destructor
     file_collector::~file_collector()
     {
+#if !defined(BOOST_LOG_NO_THREADS)
+        if (m_Worker.joinable())
+        {
+            // Let the background thread store the pending files
+            {
+                lock_guard< mutex > lock(m_PendingMutex);
+                m_StopRequested = true;
+                m_PendingCond.notify_one();
+            }
+            m_Worker.join();
+        }
+#endif // !defined(BOOST_LOG_NO_THREADS)
+
+        if (m_ManifestValid && m_ManifestOutdated)
+        {
+            try
+            {
+                settle_manifest();
+            }
+            catch (...)
+            {
+                // The manifest will be rebuilt on the next run
+            }
+        }
+
         m_pRepository->remove_collector(this);
     }
 
     //! The function stores the specified file in the storage
     void file_collector::store_file(filesystem::path const& src_path)
     {
-        // Let's construct the new file name
-        file_info info;
-        info.m_TimeStamp = filesystem::last_write_time(src_path);
-        info.m_Size = filesystem::file_size(src_path);
-
         path_string_type file_name = filename_string(src_path);
-        info.m_Path = m_StorageDir / file_name;
 
         // Check if the file is already in the target directory
         filesystem::path src_dir = src_path.has_parent_path() ?
                             filesystem::system_complete(src_path.parent_path()) :
                             m_BasePath;
         const bool is_in_target_dir = filesystem::equivalent(src_dir, m_StorageDir);
-        if (!is_in_target_dir)
+
+        int compression_level;
+        {
+            BOOST_LOG_EXPR_IF_MT(lock_guard< mutex > lock(m_Mutex);)
+            compression_level = m_CompressionLevel;
+        }
+
+        filesystem::path target_path = (is_in_target_dir && compression_level == 0) ?
+            m_StorageDir / file_name : make_target_path(file_name, compression_level > 0);
+
+        // The backend writes its files to the target directory, so the directory is modified after every update of the manifest and the manifest
+        // would be rejected on every run. In background mode, the directory modification time recorded in the manifest could also include
+        // the creation of a file that is not listed in the manifest, so the manifest would not be rejected if the application crashed.
+        // The directory is scanned instead.
+        if (is_in_target_dir)
+            disable_manifest();
+
+#if !defined(BOOST_LOG_NO_THREADS)
+        bool background_collection;
         {
-            if (filesystem::exists(info.m_Path))
+            lock_guard< mutex > lock(m_PendingMutex);
+            background_collection = m_Worker.joinable();
+        }
+
+        if (background_collection)
+        {
+            pending_file file;
+            file.m_Path = target_path;
+            file.m_CompressionLevel = compression_level;
+            if (compression_level > 0)
+            {
+                // The file will be compressed by the background thread, move it aside so that the backend does not overwrite it
+                move_to_pending(src_path, src_dir, file_name, file);
+            }
+            else if (!is_in_target_dir)
             {
-                // If the file already exists, try to mangle the file name
-                // to ensure there's no conflict. I'll need to make this customizable some day.
-                file_counter_formatter formatter(file_name.size(), 5);
-                unsigned int n = 0;
-                do
+                // Renaming the file within the file system is cheap, moving the file to another file system is left to the background thread
+                system::error_code ec;
+                filesystem::rename(src_path, target_path, ec);
+                if (ec)
                 {
-                    path_string_type alt_file_name = formatter(file_name, n++);
-                    info.m_Path = m_StorageDir / alt_file_name;
+                    if (ec.value() != system::errc::cross_device_link)
+                        BOOST_THROW_EXCEPTION(filesystem_error("Failed to move file to the target directory", src_path, target_path, ec));
+
+                    // The file has to be renamed anyway, so that the backend does not overwrite it
+                    move_to_pending(src_path, src_dir, file_name, file);
                 }
-                while (filesystem::exists(info.m_Path) && n < (std::numeric_limits< unsigned int >::max)());
             }
 
-            // The directory should have been created in constructor, but just in case it got deleted since then...
-            filesystem::create_directories(m_StorageDir);
+            lock_guard< mutex > lock(m_PendingMutex);
+            m_PendingFiles.push_back(file);
+            m_PendingCond.notify_one();
+            return;
+        }
+#endif // !defined(BOOST_LOG_NO_THREADS)
+
+        file_info info;
+        info.m_TimeStamp = filesystem::last_write_time(src_path);
+        info.m_Path = target_path;
+
+#if !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+        if (compression_level > 0)
+        {
+            store_compressed_file(src_path, info, compression_level);
+            return;
         }
+#endif // !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+
+        info.m_Size = filesystem::file_size(src_path);
 
         BOOST_LOG_EXPR_IF_MT(lock_guard< mutex > lock(m_Mutex);)
 
+        delete_old_files(info.m_Size);
+
+        if (!is_in_target_dir)
+        {
+            // Move/rename the file to the target storage
+            move_file(src_path, info.m_Path);
+        }
+
+        add_file(info);
+    }
+
+    //! Returns the name of the file in the target directory that does not conflict with existing files
+    filesystem::path file_collector::make_target_path(path_string_type const& file_name, bool compressed) const
+    {
+        path_string_type suffix;
+#if !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+        if (compressed)
+            suffix.assign(aux::compressed_file_suffix, aux::compressed_file_suffix + sizeof(aux::compressed_file_suffix) - 1u);
+#endif // !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+
+        filesystem::path target_path = m_StorageDir / (file_name + suffix);
+        if (filesystem::exists(target_path))
+        {
+            // If the file already exists, try to mangle the file name
+            // to ensure there's no conflict. I'll need to make this customizable some day.
+            file_counter_formatter formatter(file_name.size(), 5);
+            unsigned int n = 0;
+            do
+            {
+                path_string_type alt_file_name = formatter(file_name, n++);
+                target_path = m_StorageDir / (alt_file_name + suffix);
+            }
+            while (filesystem::exists(target_path) && n < (std::numeric_limits< unsigned int >::max)());
+        }
+
+        // The directory should have been created in constructor, but just in case it got deleted since then...
+        filesystem::create_directories(m_StorageDir);
+
+        return target_path;
+    }
+
+    //! Deletes the oldest files to free space for the file of the specified size
+    void file_collector::delete_old_files(uintmax_t size)
+    {
         // Check if an old file should be erased
         uintmax_t free_space = m_MinFreeSpace ? filesystem::space(m_StorageDir).available : static_cast< uintmax_t >(0);
+        std::string manifest_records;
         file_list::iterator it = m_Files.begin(), end = m_Files.end();
         while (it != end &&
-            (m_TotalSize + info.m_Size > m_MaxSize || (m_MinFreeSpace && m_MinFreeSpace > free_space)))
+            (m_TotalSize + size > m_MaxSize || (m_MinFreeSpace && m_MinFreeSpace > free_space)))
         {
             file_info& old_info = *it;
             if (filesystem::exists(old_info.m_Path) && filesystem::is_regular_file(old_info.m_Path))
@@ -685,6 +1105,8 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
                     if (m_MinFreeSpace)
                         free_space = filesystem::space(m_StorageDir).available;
                     m_TotalSize -= old_info.m_Size;
+                    if (m_ManifestValid)
+                        format_manifest_record(manifest_records, '-', old_info);
                     m_Files.erase(it++);
                 }
                 catch (system::system_error&)
@@ -697,119 +1119,705 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
             {
                 // If it's not a file or is absent, just remove it from the list
                 m_TotalSize -= old_info.m_Size;
+                if (m_ManifestValid)
+                    format_manifest_record(manifest_records, '-', old_info);
                 m_Files.erase(it++);
             }
         }
 
-        if (!is_in_target_dir)
-        {
-            // Move/rename the file to the target storage
-            move_file(src_path, info.m_Path);
-        }
+        if (!manifest_records.empty())
+            append_to_manifest(manifest_records);
+    }
 
+    //! Adds the stored file to the list
+    void file_collector::add_file(file_info const& info)
+    {
         m_Files.push_back(info);
         m_TotalSize += info.m_Size;
+
+        if (m_ManifestValid)
+        {
+            std::string manifest_records;
+            format_manifest_record(manifest_records, '+', info);
+            append_to_manifest(manifest_records);
+        }
     }
 
-    //! Scans the target directory for the files that have already been stored
-    uintmax_t file_collector::scan_for_files(
-        file::scan_method method, filesystem::path const& pattern, unsigned int* counter)
+#if !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+
+    //! Compresses the file into the storage
+    void file_collector::store_compressed_file(filesystem::path const& src_path, file_info& info, int compression_level)
     {
-        uintmax_t file_count = 0;
-        if (method != file::no_scan)
+        // Compression may take a while, so it is done without holding the lock
+        aux::compress_file(src_path, info.m_Path, compression_level);
+        // Preserve the original file time, which is used to order the files when scanning
+        filesystem::last_write_time(info.m_Path, info.m_TimeStamp);
+        filesystem::remove(src_path);
+        info.m_Size = filesystem::file_size(info.m_Path);
+
+        BOOST_LOG_EXPR_IF_MT(lock_guard< mutex > lock(m_Mutex);)
+
+        delete_old_files(info.m_Size);
+
+        add_file(info);
+    }
+
+#endif // !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+
+#if !defined(BOOST_LOG_NO_THREADS)
+
+    //! Starts the background thread, if not started yet
+    void file_collector::start_worker()
+    {
+        lock_guard< mutex > lock(m_PendingMutex);
+        if (!m_Worker.joinable())
+            thread(boost::bind(&file_collector::run_worker, this)).swap(m_Worker);
+    }
+
+    //! Renames the file to a temporary name in its directory, so that the backend does not overwrite it before it is stored
+    void file_collector::move_to_pending(filesystem::path const& src_path, filesystem::path const& src_dir, path_string_type const& file_name, pending_file& file)
+    {
+        // The temporary name has a recognizable form, so that scan_for_files can find the file if the application terminates before the file is stored.
+        // The name is registered before renaming, so that scan_for_files does not take the file for one left by a previous run.
+        file.m_Source = src_dir / make_pending_file_name(file_name);
         {
-            filesystem::path dir = m_StorageDir;
-            path_string_type mask;
-            if (method == file::scan_matching)
-            {
-                mask = filename_string(pattern);
-                if (pattern.has_parent_path())
-                    dir = make_absolute(pattern.parent_path());
-            }
-            else
+            lock_guard< mutex > lock(m_PendingMutex);
+            m_PendingSources.insert(file.m_Source);
+        }
+
+        try
+        {
+            filesystem::rename(src_path, file.m_Source);
+        }
+        catch (...)
+        {
+            lock_guard< mutex > lock(m_PendingMutex);
+            m_PendingSources.erase(file.m_Source);
+            throw;
+        }
+    }
+
+    //! The background thread function
+    void file_collector::run_worker()
+    {
+        unique_lock< mutex > lock(m_PendingMutex);
+        while (true)
+        {
+            if (m_PendingFiles.empty())
             {
-                counter = NULL;
+                if (m_StopRequested)
+                    break;
+                m_PendingCond.wait(lock);
+                continue;
             }
 
-            if (filesystem::exists(dir) && filesystem::is_directory(dir))
+            if (m_PendingFiles.front().m_Attempts > 0u && !m_StopRequested)
             {
-                BOOST_LOG_EXPR_IF_MT(lock_guard< mutex > lock(m_Mutex);)
+                // The previous attempt to store the file failed, give the problem a chance to go away
+                const system_time retry_time = m_PendingFiles.front().m_RetryTime;
+                if (get_system_time() < retry_time)
+                {
+                    m_PendingCond.timed_wait(lock, retry_time);
+                    continue;
+                }
+            }
 
-                if (counter)
-                    *counter = 0;
+            pending_file file = m_PendingFiles.front();
+            m_PendingFiles.pop_front();
+            lock.unlock();
 
-                file_list files;
-                filesystem::directory_iterator it(dir), end;
-                uintmax_t total_size = 0;
-                for (; it != end; ++it)
+            bool stored = false;
+            try
+            {
+                store_pending_file(file);
+                stored = true;
+            }
+            catch (...)
+            {
+                // There is no one to report the error to. The file is left where it is and storing is retried later.
+                if (++file.m_Attempts >= max_store_attempts)
                 {
-                    file_info info;
-                    info.m_Path = *it;
-                    if (filesystem::is_regular_file(info.m_Path))
+                    try
+                    {
+                        add_unstored_file(file);
+                    }
+                    catch (...)
                     {
-                        // Check that there are no duplicates in the resulting list
-                        struct local
-                        {
-                            static bool equivalent(filesystem::path const& left, file_info const& right)
-                            {
-                                return filesystem::equivalent(left, right.m_Path);
-                            }
-                        };
-                        if (std::find_if(m_Files.begin(), m_Files.end(),
-                            boost::bind(&local::equivalent, boost::cref(info.m_Path), _1)) == m_Files.end())
-                        {
-                            // Check that the file name matches the pattern
-                            unsigned int file_number = 0;
-                            if (method != file::scan_matching ||
-                                match_pattern(filename_string(info.m_Path), mask, file_number))
-                            {
-                                info.m_Size = filesystem::file_size(info.m_Path);
-                                total_size += info.m_Size;
-                                info.m_TimeStamp = filesystem::last_write_time(info.m_Path);
-                                files.push_back(info);
-                                ++file_count;
-
-                                if (counter && file_number >= *counter)
-                                    *counter = file_number + 1;
-                            }
-                        }
                     }
                 }
+            }
 
-                // Sort files chronologically
-                m_Files.splice(m_Files.end(), files);
-                m_TotalSize += total_size;
-                m_Files.sort(boost::bind(&file_info::m_TimeStamp, _1) < boost::bind(&file_info::m_TimeStamp, _2));
+            lock.lock();
+
+            if (!stored && file.m_Attempts < max_store_attempts)
+            {
+                // Retry before storing the files queued after this one, so that the files are stored in order
+                file.m_RetryTime = get_system_time() + posix_time::milliseconds(store_retry_delay);
+                m_PendingFiles.push_front(file);
+            }
+            else if (!file.m_Source.empty())
+            {
+                m_PendingSources.erase(file.m_Source);
             }
         }
-
-        return file_count;
     }
 
-    //! The function updates storage restrictions
-    void file_collector::update(uintmax_t max_size, uintmax_t min_free_space)
+    //! Stores the file queued for the background thread
+    void file_collector::store_pending_file(pending_file const& file)
     {
-        BOOST_LOG_EXPR_IF_MT(lock_guard< mutex > lock(m_Mutex);)
+        file_info info;
+        filesystem::path const& current_path = file.m_Source.empty() ? file.m_Path : file.m_Source;
+        info.m_TimeStamp = filesystem::last_write_time(current_path);
+        info.m_Path = file.m_Path;
 
-        m_MaxSize = (std::min)(m_MaxSize, max_size);
-        m_MinFreeSpace = (std::max)(m_MinFreeSpace, min_free_space);
-    }
+        if (!file.m_Source.empty() && filesystem::exists(info.m_Path))
+        {
+            // The target name was taken while the file was waiting in the queue
+            path_string_type file_name = filename_string(file.m_Path);
+#if !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+            if (file.m_CompressionLevel > 0)
+                file_name.resize(file_name.size() - (sizeof(aux::compressed_file_suffix) - 1u));
+#endif // !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+            info.m_Path = make_target_path(file_name, file.m_CompressionLevel > 0);
+        }
 
+#if !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+        if (file.m_CompressionLevel > 0)
+        {
+            store_compressed_file(file.m_Source, info, file.m_CompressionLevel);
+            return;
+        }
+#endif // !defined(BOOST_LOG_WITHOUT_COMPRESSION)
 
-    //! Finds or creates a file collector
-    shared_ptr< file::collector > file_collector_repository::get_collector(
-        filesystem::path const& target_dir, uintmax_t max_size, uintmax_t min_free_space)
-    {
-        BOOST_LOG_EXPR_IF_MT(lock_guard< mutex > lock(m_Mutex);)
+        info.m_Size = filesystem::file_size(current_path);
 
-        file_collectors::iterator it = std::find_if(m_Collectors.begin(), m_Collectors.end(),
+        lock_guard< mutex > lock(m_Mutex);
+
+        delete_old_files(info.m_Size);
+
+        if (!file.m_Source.empty())
+            move_file(file.m_Source, info.m_Path);
+
+        // The file may have been found by scan_for_files while waiting in the queue
+        struct local
+        {
+            static bool same_path(filesystem::path const& left, file_info const& right)
+            {
+                return left == right.m_Path;
+            }
+        };
+        if (std::find_if(m_Files.begin(), m_Files.end(), boost::bind(&local::same_path, boost::cref(info.m_Path), _1)) == m_Files.end())
+            add_file(info);
+    }
+
+    //! Adds the file that could not be stored to the list, so that it is still subject to the storage limits
+    void file_collector::add_unstored_file(pending_file const& file)
+    {
+        file_info info;
+        info.m_Path = file.m_Source.empty() ? file.m_Path : file.m_Source;
+
+        system::error_code ec;
+        info.m_Size = filesystem::file_size(info.m_Path, ec);
+        if (ec)
+            return; // the file is gone
+        info.m_TimeStamp = filesystem::last_write_time(info.m_Path);
+
+        lock_guard< mutex > lock(m_Mutex);
+
+        // The file may have been found by scan_for_files
+        struct local
+        {
+            static bool same_path(filesystem::path const& left, file_info const& right)
+            {
+                return left == right.m_Path;
+            }
+        };
+        if (std::find_if(m_Files.begin(), m_Files.end(), boost::bind(&local::same_path, boost::cref(info.m_Path), _1)) != m_Files.end())
+            return;
+
+        delete_old_files(info.m_Size);
+
+        if (file.m_Source.empty())
+        {
+            add_file(info);
+        }
+        else
+        {
+            // The file is not in the target directory, so it is not recorded in the manifest. The file name is unique,
+            // so the record of its deletion will not affect the stored files.
+            m_Files.push_back(info);
+            m_TotalSize += info.m_Size;
+        }
+    }
+
+#endif // !defined(BOOST_LOG_NO_THREADS)
+
+    //! Scans the target directory for the files that have already been stored
+    uintmax_t file_collector::scan_for_files(
+        file::scan_method method, filesystem::path const& pattern, unsigned int* counter)
+    {
+        uintmax_t file_count = 0;
+        if (method != file::no_scan)
+        {
+            filesystem::path dir = m_StorageDir;
+            path_string_type mask;
+            if (method == file::scan_matching)
+            {
+                mask = filename_string(pattern);
+                if (pattern.has_parent_path())
+                    dir = make_absolute(pattern.parent_path());
+            }
+            else
+            {
+                counter = NULL;
+            }
+
+            if (filesystem::exists(dir) && filesystem::is_directory(dir))
+            {
+                BOOST_LOG_EXPR_IF_MT(lock_guard< mutex > lock(m_Mutex);)
+
+                if (counter)
+                    *counter = 0;
+
+                file_list files;
+                uintmax_t total_size = 0;
+                file_count += scan_pending_files(dir, method, mask, counter, files, total_size);
+
+                if (m_UseManifest && !m_ManifestDisabled && filesystem::equivalent(dir, m_StorageDir))
+                {
+                    // The manifest lists the files in the target directory, so that the files don't have to be queried one by one
+                    file_list stored_files;
+                    if (!read_manifest(stored_files))
+                        build_manifest(stored_files);
+
+                    std::set< filesystem::path > known_files;
+                    for (file_list::const_iterator it = m_Files.begin(), end = m_Files.end(); it != end; ++it)
+                        known_files.insert(it->m_Path);
+
+                    for (file_list::const_iterator it = stored_files.begin(), end = stored_files.end(); it != end; ++it)
+                    {
+                        if (known_files.find(it->m_Path) == known_files.end())
+                        {
+                            // Check that the file name matches the pattern
+                            unsigned int file_number = 0;
+                            if (method != file::scan_matching ||
+                                match_pattern(filename_string(it->m_Path), mask, file_number) ||
+                                match_compressed_pattern(filename_string(it->m_Path), mask, file_number))
+                            {
+                                total_size += it->m_Size;
+                                files.push_back(*it);
+                                ++file_count;
+
+                                if (counter && file_number >= *counter)
+                                    *counter = file_number + 1;
+                            }
+                        }
+                    }
+                }
+                else
+                {
+                    const filesystem::path manifest_name(manifest_file_name);
+                    filesystem::directory_iterator it(dir), end;
+                    for (; it != end; ++it)
+                    {
+                        file_info info;
+                        info.m_Path = *it;
+                        path_string_type original_name;
+                        if (filesystem::is_regular_file(info.m_Path) && info.m_Path.filename() != manifest_name &&
+                            !parse_pending_file_name(filename_string(info.m_Path), original_name))
+                        {
+                            // Check that there are no duplicates in the resulting list
+                            struct local
+                            {
+                                static bool equivalent(filesystem::path const& left, file_info const& right)
+                                {
+                                    return filesystem::equivalent(left, right.m_Path);
+                                }
+                            };
+                            if (std::find_if(m_Files.begin(), m_Files.end(),
+                                boost::bind(&local::equivalent, boost::cref(info.m_Path), _1)) == m_Files.end())
+                            {
+                                // Check that the file name matches the pattern
+                                unsigned int file_number = 0;
+                                if (method != file::scan_matching ||
+                                    match_pattern(filename_string(info.m_Path), mask, file_number) ||
+                                    match_compressed_pattern(filename_string(info.m_Path), mask, file_number))
+                                {
+                                    info.m_Size = filesystem::file_size(info.m_Path);
+                                    total_size += info.m_Size;
+                                    info.m_TimeStamp = filesystem::last_write_time(info.m_Path);
+                                    files.push_back(info);
+                                    ++file_count;
+
+                                    if (counter && file_number >= *counter)
+                                        *counter = file_number + 1;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                // Sort files chronologically
+                m_Files.splice(m_Files.end(), files);
+                m_TotalSize += total_size;
+                m_Files.sort(boost::bind(&file_info::m_TimeStamp, _1) < boost::bind(&file_info::m_TimeStamp, _2));
+            }
+        }
+
+        return file_count;
+    }
+
+    //! Finds the files left under temporary names by the background thread of a previous run
+    uintmax_t file_collector::scan_pending_files(
+        filesystem::path const& dir, file::scan_method method, path_string_type const& mask, unsigned int* counter, file_list& files, uintmax_t& total_size)
+    {
+#if !defined(BOOST_LOG_NO_THREADS)
+        lock_guard< mutex > lock(m_PendingMutex);
+        const bool background_collection = m_Worker.joinable();
+#endif // !defined(BOOST_LOG_NO_THREADS)
+
+        uintmax_t file_count = 0;
+        filesystem::directory_iterator it(dir), end;
+        for (; it != end; ++it)
+        {
+            const filesystem::path temp_path = *it;
+            path_string_type file_name;
+            if (!parse_pending_file_name(filename_string(temp_path), file_name) || !filesystem::is_regular_file(temp_path))
+                continue;
+
+            unsigned int file_number = 0;
+            if (method == file::scan_matching &&
+                !match_pattern(file_name, mask, file_number) &&
+                !match_compressed_pattern(file_name, mask, file_number))
+            {
+                continue;
+            }
+
+#if !defined(BOOST_LOG_NO_THREADS)
+            // Skip the files that are being stored by this collector
+            if (m_PendingSources.find(temp_path) != m_PendingSources.end())
+                continue;
+#endif // !defined(BOOST_LOG_NO_THREADS)
+
+            // Skip the files that could not be stored and were already counted
+            struct local
+            {
+                static bool equivalent(filesystem::path const& left, file_info const& right)
+                {
+                    return filesystem::equivalent(left, right.m_Path);
+                }
+            };
+            if (std::find_if(m_Files.begin(), m_Files.end(), boost::bind(&local::equivalent, boost::cref(temp_path), _1)) != m_Files.end())
+                continue;
+
+            if (counter && file_number >= *counter)
+                *counter = file_number + 1;
+            ++file_count;
+
+#if !defined(BOOST_LOG_NO_THREADS)
+            if (background_collection)
+            {
+                // Let the background thread finish storing the file
+                pending_file file;
+                file.m_Source = temp_path;
+                file.m_CompressionLevel = m_CompressionLevel;
+                file.m_Path = make_target_path(file_name, file.m_CompressionLevel > 0);
+                m_PendingSources.insert(temp_path);
+                m_PendingFiles.push_back(file);
+                m_PendingCond.notify_one();
+                continue;
+            }
+#endif // !defined(BOOST_LOG_NO_THREADS)
+
+            // The file is left where it is but is still subject to the storage limits
+            file_info info;
+            info.m_Path = temp_path;
+            info.m_Size = filesystem::file_size(temp_path);
+            info.m_TimeStamp = filesystem::last_write_time(temp_path);
+            total_size += info.m_Size;
+            files.push_back(info);
+        }
+
+        return file_count;
+    }
+
+    //! Reads the list of files in the target directory from the manifest
+    bool file_collector::read_manifest(file_list& files)
+    {
+        std::size_t record_count = 0;
+        uintmax_t dir_time = 0;
+        if (!parse_manifest(files, record_count, dir_time))
+            return false;
+
+        // The manifest is outdated if the directory has been modified after the manifest was last updated.
+        // The time is zero if the manifest was updated too soon after the directory was modified to tell that.
+        if (dir_time == 0u || modification_time(m_StorageDir) != dir_time)
+        {
+            files.clear();
+            return false;
+        }
+
+        // Compact the manifest if it mostly consists of the records of the deleted files
+        if (record_count > files.size() * 2u + 64u)
+        {
+            write_manifest(files);
+        }
+        else
+        {
+            m_ManifestRecordCount = record_count;
+            m_ManifestValid = true;
+            m_ManifestOutdated = false;
+        }
+
+        return true;
+    }
+
+    //! Parses the manifest
+    bool file_collector::parse_manifest(file_list& files, std::size_t& record_count, uintmax_t& dir_time)
+    {
+        filesystem::ifstream strm(m_StorageDir / manifest_file_name, std::ios_base::in | std::ios_base::binary);
+        std::string line;
+        if (!strm.is_open() || !std::getline(strm, line) || line != manifest_header)
+            return false;
+
+        typedef std::map< std::string, file_info > file_index;
+        file_index index;
+        record_count = 0;
+        dir_time = 0;
+        bool complete = false;
+        while (std::getline(strm, line))
+        {
+            // The last record may be incomplete if the application crashed while updating the manifest
+            if (strm.eof())
+                return false;
+
+            // Every update of the manifest ends with the trailer "= <number of records> <directory modification time>".
+            // If the application crashed while updating the manifest, the trailer is missing or the number of records does not match.
+            complete = false;
+            if (line.size() > 2u && line[0] == '=' && line[1] == ' ')
+            {
+                std::istringstream trailer(line.substr(2u));
+                std::size_t count = 0;
+                if (!(trailer >> count >> dir_time) || !trailer.eof() || count != record_count)
+                    return false;
+                complete = true;
+                continue;
+            }
+
+            // Records have the form "+ <size> <timestamp> <file name>" for the stored files and "- <file name>" for the deleted ones
+            if (line.size() > 2u && line[0] == '-' && line[1] == ' ')
+            {
+                index.erase(line.substr(2u));
+            }
+            else if (line.size() > 2u && line[0] == '+' && line[1] == ' ')
+            {
+                std::istringstream record(line.substr(2u));
+                file_info info;
+                std::time_t timestamp = 0;
+                std::string file_name;
+                if (!(record >> info.m_Size >> timestamp) || record.get() != ' ' || !std::getline(record, file_name) || file_name.empty())
+                    return false;
+                info.m_TimeStamp = timestamp;
+                info.m_Path = m_StorageDir / file_name;
+                index[file_name] = info;
+            }
+            else
+                return false;
+
+            ++record_count;
+        }
+
+        if (strm.bad() || !complete)
+            return false;
+
+        for (file_index::const_iterator it = index.begin(), end = index.end(); it != end; ++it)
+            files.push_back(it->second);
+
+        return true;
+    }
+
+    //! Records the directory modification time in the manifest that was last updated too soon after the directory was modified
+    void file_collector::settle_manifest()
+    {
+        uintmax_t dir_time = modification_time(m_StorageDir);
+        uintmax_t delay = modification_time_settle_delay(dir_time);
+        if (delay > 0u)
+        {
+#if !defined(BOOST_LOG_NO_THREADS) && !defined(BOOST_WINDOWS_API)
+            // Waiting out the coarse clock tick is cheaper than scanning the directory on the next run
+            if (delay > 100000000u)
+                return;
+            this_thread::sleep(posix_time::microseconds(static_cast< long >(delay / 1000u + 1u)));
+            if (modification_time(m_StorageDir) != dir_time)
+                return;
+#else
+            return;
+#endif
+        }
+
+        // The directory may have been modified by someone else in the same tick after the manifest was updated, so check that
+        // the directory contains exactly the files listed in the manifest. Any later modification changes the modification time.
+        file_list files;
+        std::size_t record_count = 0;
+        uintmax_t manifest_dir_time = 0;
+        if (!parse_manifest(files, record_count, manifest_dir_time) || record_count != m_ManifestRecordCount)
+            return;
+
+        std::set< filesystem::path > listed_files;
+        for (file_list::const_iterator it = files.begin(), end = files.end(); it != end; ++it)
+            listed_files.insert(it->m_Path.filename());
+
+        const filesystem::path manifest_name(manifest_file_name);
+        std::size_t file_count = 0;
+        filesystem::directory_iterator it(m_StorageDir), end;
+        for (; it != end; ++it)
+        {
+            const filesystem::path file_name = it->path().filename();
+            path_string_type original_name;
+            if (file_name == manifest_name || parse_pending_file_name(file_name.native(), original_name) || !filesystem::is_regular_file(it->path()))
+                continue;
+            if (listed_files.find(file_name) == listed_files.end())
+                return;
+            ++file_count;
+        }
+        if (file_count != listed_files.size() || modification_time(m_StorageDir) != dir_time)
+            return;
+
+        // Appending the trailer does not modify the directory
+        std::ostringstream trailer;
+        trailer << "= " << record_count << ' ' << dir_time << '\n';
+        const std::string trailer_str = trailer.str();
+        filesystem::ofstream strm(m_StorageDir / manifest_file_name, std::ios_base::out | std::ios_base::app | std::ios_base::binary);
+        strm.write(trailer_str.data(), static_cast< std::streamsize >(trailer_str.size()));
+        strm.close();
+        m_ManifestOutdated = strm.fail();
+    }
+
+    //! Scans the target directory for files and rewrites the manifest
+    void file_collector::build_manifest(file_list& files)
+    {
+        const filesystem::path manifest_name(manifest_file_name);
+        filesystem::directory_iterator it(m_StorageDir), end;
+        for (; it != end; ++it)
+        {
+            file_info info;
+            info.m_Path = *it;
+            path_string_type original_name;
+            if (filesystem::is_regular_file(info.m_Path) && info.m_Path.filename() != manifest_name &&
+                !parse_pending_file_name(filename_string(info.m_Path), original_name))
+            {
+                info.m_Size = filesystem::file_size(info.m_Path);
+                info.m_TimeStamp = filesystem::last_write_time(info.m_Path);
+                files.push_back(info);
+            }
+        }
+
+        write_manifest(files);
+    }
+
+    //! Writes the manifest that lists the specified files
+    void file_collector::write_manifest(file_list const& files)
+    {
+        std::string records = manifest_header;
+        records.push_back('\n');
+        for (file_list::const_iterator it = files.begin(), end = files.end(); it != end; ++it)
+            format_manifest_record(records, '+', *it);
+        m_ManifestRecordCount = files.size();
+
+        // The manifest is rewritten in place, so that the target directory is not modified unless the manifest is created
+        write_manifest_update(records, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+    }
+
+    //! Appends the records to the manifest
+    void file_collector::append_to_manifest(std::string const& records)
+    {
+        m_ManifestRecordCount += static_cast< std::size_t >(std::count(records.begin(), records.end(), '\n'));
+        write_manifest_update(records, std::ios_base::out | std::ios_base::app | std::ios_base::binary);
+    }
+
+    //! Writes the records followed by the trailer to the manifest opened in the specified mode
+    void file_collector::write_manifest_update(std::string const& records, std::ios_base::openmode mode)
+    {
+        filesystem::ofstream strm(m_StorageDir / manifest_file_name, mode);
+        strm.write(records.data(), static_cast< std::streamsize >(records.size()));
+
+        // The directory modification time is taken after the manifest is opened, which may have created the file.
+        // Writing to the manifest does not modify the directory, so the manifest stays valid until the directory is modified.
+        // However, the modification time has limited granularity, and a modification in the same tick would go unnoticed.
+        // Unless the tick has passed, zero is recorded instead, which makes the manifest outdated.
+        const uintmax_t dir_time = modification_time(m_StorageDir);
+        m_ManifestOutdated = modification_time_settle_delay(dir_time) > 0u;
+        std::ostringstream trailer;
+        trailer << "= " << m_ManifestRecordCount << ' ' << (m_ManifestOutdated ? static_cast< uintmax_t >(0u) : dir_time) << '\n';
+        const std::string trailer_str = trailer.str();
+        strm.write(trailer_str.data(), static_cast< std::streamsize >(trailer_str.size()));
+        strm.close();
+
+        // If the manifest could not be updated, it will be rejected as incomplete or outdated
+        m_ManifestValid = !strm.fail();
+    }
+
+    //! Stops maintaining the manifest and removes it from the target directory
+    void file_collector::disable_manifest()
+    {
+        BOOST_LOG_EXPR_IF_MT(lock_guard< mutex > lock(m_Mutex);)
+
+        if (m_UseManifest && !m_ManifestDisabled)
+        {
+            m_ManifestDisabled = true;
+            m_ManifestValid = false;
+            system::error_code ec;
+            filesystem::remove(m_StorageDir / manifest_file_name, ec);
+        }
+    }
+
+    //! Formats the manifest record of the stored file
+    void file_collector::format_manifest_record(std::string& records, char op, file_info const& info)
+    {
+        std::string file_name = info.m_Path.filename().string();
+        records.push_back(op);
+        records.push_back(' ');
+        if (op == '+')
+        {
+            std::ostringstream strm;
+            strm << info.m_Size << ' ' << info.m_TimeStamp << ' ';
+            records.append(strm.str());
+        }
+        records.append(file_name);
+        records.push_back('\n');
+    }
+
+    //! The function updates storage restrictions
+    void file_collector::update(uintmax_t max_size, uintmax_t min_free_space, bool background_collection, int compression_level, bool manifest)
+    {
+        BOOST_LOG_EXPR_IF_MT(lock_guard< mutex > lock(m_Mutex);)
+
+        m_MaxSize = (std::min)(m_MaxSize, max_size);
+        m_MinFreeSpace = (std::max)(m_MinFreeSpace, min_free_space);
+        m_CompressionLevel = (std::max)(m_CompressionLevel, compression_level);
+        m_UseManifest = m_UseManifest || manifest;
+
+#if !defined(BOOST_LOG_NO_THREADS)
+        if (background_collection || compression_level > 0)
+            start_worker();
+#endif // !defined(BOOST_LOG_NO_THREADS)
+    }
+
+
+    //! Finds or creates a file collector
+    shared_ptr< file::collector > file_collector_repository::get_collector(
+        filesystem::path const& target_dir, uintmax_t max_size, uintmax_t min_free_space, bool background_collection, int compression_level, bool manifest)
+    {
+        BOOST_LOG_EXPR_IF_MT(lock_guard< mutex > lock(m_Mutex);)
+
+        file_collectors::iterator it = std::find_if(m_Collectors.begin(), m_Collectors.end(),
             boost::bind(&file_collector::is_governed, _1, boost::cref(target_dir)));
         shared_ptr< file_collector > p;
         if (it != m_Collectors.end()) try
         {
             // This may throw if the collector is being currently destroyed
             p = it->shared_from_this();
-            p->update(max_size, min_free_space);
+            p->update(max_size, min_free_space, background_collection, compression_level, manifest);
         }
         catch (bad_weak_ptr&)
         {
@@ -818,7 +1826,7 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
         if (!p)
         {
             p = boost::make_shared< file_collector >(
-                file_collector_repository::get(), target_dir, max_size, min_free_space);
+                file_collector_repository::get(), target_dir, max_size, min_free_space, background_collection, compression_level, manifest);
             m_Collectors.push_back(*p);
         }
 
@@ -855,6 +1863,26 @@ BOOST_LOG_ANONYMOUS_NAMESPACE {
         }
     }
 
+    //! Removes the "." and ".." elements from the absolute path, so that equivalent names of the same file compare equal
+    filesystem::path normalize_path(filesystem::path const& p)
+    {
+        filesystem::path result;
+        for (filesystem::path::iterator it = p.begin(), end = p.end(); it != end; ++it)
+        {
+            if (*it == ".")
+                continue;
+            if (*it == "..")
+            {
+                // The parent of the root directory is the root directory itself
+                if (result.has_relative_path())
+                    result.remove_filename();
+                continue;
+            }
+            result /= *it;
+        }
+        return result;
+    }
+
 } // namespace
 
 namespace file {
@@ -865,9 +1893,19 @@ namespace aux {
     BOOST_LOG_API shared_ptr< collector > make_collector(
         filesystem::path const& target_dir,
         uintmax_t max_size,
-        uintmax_t min_free_space)
+        uintmax_t min_free_space,
+        bool background_collection,
+        int compression_level,
+        bool manifest)
     {
-        return file_collector_repository::get()->get_collector(target_dir, max_size, min_free_space);
+        if (compression_level < 0 || compression_level > 9)
+            BOOST_LOG_THROW_DESCR(setup_error, "Log file compression level must be in range from 0 to 9");
+#if defined(BOOST_LOG_WITHOUT_COMPRESSION)
+        if (compression_level > 0)
+            BOOST_LOG_THROW_DESCR(setup_error, "Log file compression is not supported");
+#endif // defined(BOOST_LOG_WITHOUT_COMPRESSION)
+
+        return file_collector_repository::get()->get_collector(target_dir, max_size, min_free_space, background_collection, compression_level, manifest);
     }
 
 } // namespace aux
@@ -883,7 +1921,8 @@ BOOST_LOG_API rotation_at_time_point::rotation_at_time_point(
     m_Hour(hour),
     m_Minute(minute),
     m_Second(second),
-    m_Previous(date_time::not_a_date_time)
+    m_Next(date_time::not_a_date_time),
+    m_Deadline(0)
 {
     check_time_point_validity(hour, minute, second);
 }
@@ -900,7 +1939,8 @@ BOOST_LOG_API rotation_at_time_point::rotation_at_time_point(
     m_Hour(hour),
     m_Minute(minute),
     m_Second(second),
-    m_Previous(date_time::not_a_date_time)
+    m_Next(date_time::not_a_date_time),
+    m_Deadline(0)
 {
     check_time_point_validity(hour, minute, second);
 }
@@ -917,7 +1957,8 @@ BOOST_LOG_API rotation_at_time_point::rotation_at_time_point(
     m_Hour(hour),
     m_Minute(minute),
     m_Second(second),
-    m_Previous(date_time::not_a_date_time)
+    m_Next(date_time::not_a_date_time),
+    m_Deadline(0)
 {
     check_time_point_validity(hour, minute, second);
 }
@@ -925,91 +1966,100 @@ BOOST_LOG_API rotation_at_time_point::rotation_at_time_point(
 //! Checks if it's time to rotate the file
 BOOST_LOG_API bool rotation_at_time_point::operator()() const
 {
+    const std::time_t now = std::time(NULL);
+    if (now < m_Deadline)
+        return false;
+
+    // The deadline is reached. Check the local time, as it may have shifted relative to the system time since the deadline was set.
+    std::tm local_tm;
+    posix_time::ptime local_now = posix_time::ptime_from_tm(*date_time::c_time::localtime(&now, &local_tm));
+
     bool result = false;
+    if (m_Next.is_special())
+    {
+        m_Next = next_rotation_time(local_now);
+    }
+    else if (local_now >= m_Next)
+    {
+        result = true;
+        m_Next = next_rotation_time(local_now);
+    }
+
+    // The local time offset may change before the rotation (e.g. on DST transition), so the deadline has to be
+    // the system time that corresponds to the local time of the next rotation rather than now plus the local time difference
+    std::tm next_tm = posix_time::to_tm(m_Next);
+    next_tm.tm_isdst = -1;
+    const std::time_t next = std::mktime(&next_tm);
+    if (next != static_cast< std::time_t >(-1))
+        m_Deadline = next;
+    else
+        m_Deadline = now + static_cast< std::time_t >((m_Next - local_now).total_seconds());
+
+    return result;
+}
+
+//! Computes the local time of the next rotation after the specified local time
+posix_time::ptime rotation_at_time_point::next_rotation_time(posix_time::ptime const& now) const
+{
     posix_time::time_duration rotation_time(
         static_cast< posix_time::time_duration::hour_type >(m_Hour),
         static_cast< posix_time::time_duration::min_type >(m_Minute),
         static_cast< posix_time::time_duration::sec_type >(m_Second));
-    posix_time::ptime now = posix_time::second_clock::local_time();
 
-    if (m_Previous.is_special())
-    {
-        m_Previous = now;
-        return false;
-    }
-
-    const bool time_of_day_passed = rotation_time.total_seconds() <= m_Previous.time_of_day().total_seconds();
+    const bool time_of_day_passed = rotation_time.total_seconds() <= now.time_of_day().total_seconds();
+    gregorian::date now_date = now.date(), next_date = now_date;
     switch (m_DayKind)
     {
-    case not_specified:
-        {
-            // The rotation takes place every day at the specified time
-            gregorian::date previous_date = m_Previous.date();
-            if (time_of_day_passed)
-                previous_date += gregorian::days(1);
-            posix_time::ptime next(previous_date, rotation_time);
-            result = (now >= next);
-        }
-        break;
-
     case weekday:
         {
             // The rotation takes place on the specified week day at the specified time
-            gregorian::date previous_date = m_Previous.date(), next_date = previous_date;
-            int weekday = m_Day, previous_weekday = static_cast< int >(previous_date.day_of_week().as_number());
-            next_date += gregorian::days(weekday - previous_weekday);
-            if (weekday < previous_weekday || (weekday == previous_weekday && time_of_day_passed))
+            int weekday = m_Day, now_weekday = static_cast< int >(now_date.day_of_week().as_number());
+            next_date += gregorian::days(weekday - now_weekday);
+            if (weekday < now_weekday || (weekday == now_weekday && time_of_day_passed))
             {
                 next_date += gregorian::weeks(1);
             }
-
-            posix_time::ptime next(next_date, rotation_time);
-            result = (now >= next);
         }
         break;
 
     case monthday:
         {
             // The rotation takes place on the specified day of month at the specified time
-            gregorian::date previous_date = m_Previous.date();
             gregorian::date::day_type monthday = static_cast< gregorian::date::day_type >(m_Day),
-                previous_monthday = previous_date.day();
-            gregorian::date next_date(previous_date.year(), previous_date.month(), monthday);
-            if (monthday < previous_monthday || (monthday == previous_monthday && time_of_day_passed))
+                now_monthday = now_date.day();
+            next_date = gregorian::date(now_date.year(), now_date.month(), monthday);
+            if (monthday < now_monthday || (monthday == now_monthday && time_of_day_passed))
             {
                 next_date += gregorian::months(1);
             }
-
-            posix_time::ptime next(next_date, rotation_time);
-            result = (now >= next);
         }
         break;
 
     default:
+        // The rotation takes place every day at the specified time
+        if (time_of_day_passed)
+            next_date += gregorian::days(1);
         break;
     }
 
-    if (result)
-        m_Previous = now;
-
-    return result;
+    return posix_time::ptime(next_date, rotation_time);
 }
 
 //! Checks if it's time to rotate the file
 BOOST_LOG_API bool rotation_at_time_interval::operator()() const
 {
-    bool result = false;
-    posix_time::ptime now = posix_time::second_clock::universal_time();
-    if (m_Previous.is_special())
-    {
-        m_Previous = now;
+    const std::time_t now = std::time(NULL);
+    if (now < m_Deadline)
         return false;
-    }
 
-    result = (now - m_Previous) >= m_Interval;
+    // The first call only starts the interval
+    const bool result = m_Deadline != 0;
 
-    if (result)
-        m_Previous = now;
+    // The clock has one second precision, so the fractional part of the interval is rounded up
+    std::time_t interval = static_cast< std::time_t >(m_Interval.total_seconds());
+    if (m_Interval.fractional_seconds() > 0)
+        ++interval;
+    m_Deadline = now + interval;
 
     return result;
 }
@@ -1039,6 +2089,18 @@ struct text_file_backend::implementation
     filesystem::path m_FileName;
     //! File stream
     filesystem::ofstream m_File;
+#if defined(BOOST_LOG_HAS_ASYNC_FILEBUF)
+    //! File stream buffer for the asynchronous output mode
+    boost::log::aux::async_filebuf m_AsyncFileBuf;
+    //! File stream for the asynchronous output mode
+    stream_type m_AsyncFile;
+#endif
+#if defined(BOOST_LOG_HAS_MAPPED_FILEBUF)
+    //! File stream buffer for the memory mapped output mode
+    boost::log::aux::mapped_filebuf m_MappedFileBuf;
+    //! File stream for the memory mapped output mode
+    stream_type m_MappedFile;
+#endif
     //! Characters written
     uintmax_t m_CharactersWritten;
 
@@ -1056,13 +2118,361 @@ struct text_file_backend::implementation
     //! The flag shows if every written record should be flushed
     bool m_AutoFlush;
 
-    implementation(uintmax_t rotation_size, bool auto_flush) :
+    //! Write buffer
+    string_type m_WriteBuffer;
+    //! The size of the write buffer, zero if the buffer is disabled
+    std::size_t m_WriteBufferSize;
+    //! The maximum time the records are kept in the write buffer
+    posix_time::time_duration m_WriteBufferLatency;
+    //! The time when the buffered records have to be written to the file
+    posix_time::ptime m_WriteBufferDeadline;
+    //! Write buffer statistics
+    write_buffer_statistics m_WriteBufferStats;
+
+    //! Output mode
+    file::output_mode m_OutputMode;
+    //! The number of buffers in the asynchronous output mode
+    unsigned int m_WriteBufferCount;
+    //! The flag indicates that direct I/O should be used in the asynchronous output mode
+    bool m_DirectIO;
+
+    //! Durability level
+    file::durability m_Durability;
+#if defined(BOOST_LOG_HAS_FILE_SYNC)
+    //! The flag indicates that the records have to be synchronized with the storage on commit. Can be read without locking.
+    volatile bool m_SyncOnCommit;
+    //! The maximum time the synchronization can be delayed to let more records be written
+    posix_time::time_duration m_SyncLatency;
+#if !defined(BOOST_LOG_NO_THREADS)
+    //! The mutex protects the synchronization state below
+    mutex m_SyncMutex;
+    //! The condition is signalled when a synchronization completes
+    condition_variable m_SyncCond;
+    //! The flag indicates that one of the threads is synchronizing the file
+    bool m_SyncInProgress;
+#endif
+    //! The file descriptor used to synchronize the current file, or -1
+    int m_SyncFd;
+    //! The number of records written with the sync durability
+    uintmax_t m_WrittenCount;
+    //! The number of written records that are known to be synchronized with the storage
+    uintmax_t m_SyncedCount;
+#endif // defined(BOOST_LOG_HAS_FILE_SYNC)
+
+    implementation(
+        uintmax_t rotation_size,
+        bool auto_flush,
+        std::size_t write_buffer_size,
+        posix_time::time_duration const& write_buffer_latency,
+        file::output_mode output_mode,
+        unsigned int write_buffer_count,
+        bool direct_io,
+        file::durability durability,
+        posix_time::time_duration const& sync_latency
+    ) :
         m_FileOpenMode(std::ios_base::trunc | std::ios_base::out),
         m_FileCounter(0),
+#if defined(BOOST_LOG_HAS_ASYNC_FILEBUF)
+        m_AsyncFile(&m_AsyncFileBuf),
+#endif
+#if defined(BOOST_LOG_HAS_MAPPED_FILEBUF)
+        m_MappedFile(&m_MappedFileBuf),
+#endif
         m_CharactersWritten(0),
         m_FileRotationSize(rotation_size),
-        m_AutoFlush(auto_flush)
+        m_AutoFlush(auto_flush),
+        m_WriteBufferSize(0),
+        m_WriteBufferLatency(write_buffer_latency),
+        m_OutputMode(output_mode),
+        m_WriteBufferCount(write_buffer_count),
+        m_DirectIO(direct_io),
+        m_Durability(durability)
+#if defined(BOOST_LOG_HAS_FILE_SYNC)
+        , m_SyncOnCommit(durability == file::sync_durability),
+        m_SyncLatency(sync_latency),
+#if !defined(BOOST_LOG_NO_THREADS)
+        m_SyncInProgress(false),
+#endif
+        m_SyncFd(-1),
+        m_WrittenCount(0),
+        m_SyncedCount(0)
+#endif // defined(BOOST_LOG_HAS_FILE_SYNC)
+    {
+        set_write_buffer_size(write_buffer_size);
+    }
+
+#if defined(BOOST_LOG_HAS_FILE_SYNC)
+    ~implementation()
+    {
+        if (m_SyncFd >= 0)
+            ::close(m_SyncFd);
+    }
+#endif // defined(BOOST_LOG_HAS_FILE_SYNC)
+
+    //! Returns the stream of the currently open file
+    stream_type& file()
+    {
+#if defined(BOOST_LOG_HAS_ASYNC_FILEBUF)
+        if (m_AsyncFileBuf.is_open())
+            return m_AsyncFile;
+#endif
+#if defined(BOOST_LOG_HAS_MAPPED_FILEBUF)
+        if (m_MappedFileBuf.is_open())
+            return m_MappedFile;
+#endif
+        return m_File;
+    }
+
+    //! Returns \c true if the file is open
+    bool is_open() const
+    {
+#if defined(BOOST_LOG_HAS_ASYNC_FILEBUF)
+        if (m_AsyncFileBuf.is_open())
+            return true;
+#endif
+#if defined(BOOST_LOG_HAS_MAPPED_FILEBUF)
+        if (m_MappedFileBuf.is_open())
+            return true;
+#endif
+        return m_File.is_open();
+    }
+
+    //! Opens the file according to the output mode. Returns \c true on success.
+    bool open_file()
+    {
+#if defined(BOOST_LOG_HAS_ASYNC_FILEBUF)
+        if (m_OutputMode == file::async_output)
+        {
+            // The I/O buffers are filled with chunks of up to the write buffer size
+            const std::size_t buffer_size = m_WriteBufferSize > 0 ? m_WriteBufferSize : static_cast< std::size_t >(65536u);
+            return m_AsyncFileBuf.open(m_FileName, m_FileOpenMode, buffer_size, m_WriteBufferCount, m_DirectIO);
+        }
+#endif
+#if defined(BOOST_LOG_HAS_MAPPED_FILEBUF)
+        if (m_OutputMode == file::mapped_output)
+        {
+            // Preallocate the whole file up to the rotation size, if it is reasonable
+            const uintmax_t max_region_size = 256u * 1024u * 1024u;
+            const std::size_t region_size = static_cast< std::size_t >(m_FileRotationSize < max_region_size ? m_FileRotationSize : max_region_size);
+            if (m_MappedFileBuf.open(m_FileName, m_FileOpenMode, region_size))
+                return true;
+            // Fall back to the file stream if the file cannot be preallocated or mapped
+        }
+#endif
+        m_File.open(m_FileName, m_FileOpenMode);
+        return m_File.is_open();
+    }
+
+    //! Closes the file
+    void close_file()
+    {
+#if defined(BOOST_LOG_HAS_ASYNC_FILEBUF)
+        if (m_AsyncFileBuf.is_open())
+        {
+            m_AsyncFileBuf.close();
+            m_AsyncFile.clear();
+            return;
+        }
+#endif
+#if defined(BOOST_LOG_HAS_MAPPED_FILEBUF)
+        if (m_MappedFileBuf.is_open())
+        {
+            m_MappedFileBuf.close();
+            m_MappedFile.clear();
+            return;
+        }
+#endif
+        m_File.close();
+        m_File.clear();
+    }
+
+    //! Writes the buffered records and flushes the file
+    void flush_file()
+    {
+        write_buffer();
+        file().flush();
+    }
+
+#if defined(BOOST_LOG_HAS_FILE_SYNC)
+    //! Opens the descriptor for synchronizing the newly opened file
+    void open_sync_file()
+    {
+        int flags = O_RDONLY;
+#if defined(O_CLOEXEC)
+        flags |= O_CLOEXEC;
+#endif
+        const int fd = ::open(m_FileName.c_str(), flags);
+        if (fd < 0)
+        {
+            const int err = errno;
+            filesystem_error e(
+                "Failed to open file for synchronization",
+                m_FileName,
+                system::error_code(err, system::system_category()));
+            BOOST_THROW_EXCEPTION(e);
+        }
+
+        BOOST_LOG_EXPR_IF_MT(lock_guard< mutex > lock(m_SyncMutex);)
+        m_SyncFd = fd;
+    }
+
+    //! Synchronizes the records written to the file being closed and releases the descriptor. Returns zero on success or the error code.
+    int close_sync_file()
+    {
+#if !defined(BOOST_LOG_NO_THREADS)
+        unique_lock< mutex > lock(m_SyncMutex);
+        while (m_SyncInProgress)
+            m_SyncCond.wait(lock);
+#endif
+
+        int err = 0;
+        if (m_SyncFd >= 0)
+        {
+            // The records are considered synchronized even if the synchronization fails, the error is reported by the current thread
+            if (m_SyncedCount != m_WrittenCount)
+                err = sync_file_data(m_SyncFd);
+            ::close(m_SyncFd);
+            m_SyncFd = -1;
+            m_SyncedCount = m_WrittenCount;
+            BOOST_LOG_EXPR_IF_MT(m_SyncCond.notify_all();)
+        }
+        return err;
+    }
+
+    //! Throws an exception that indicates the failure to synchronize the file. The file name is not used as it may be changed concurrently.
+    static void throw_sync_error(int err)
     {
+        system::system_error e(
+            system::error_code(err, system::system_category()),
+            "Failed to synchronize the log file with the storage");
+        BOOST_THROW_EXCEPTION(e);
+    }
+
+    //! Counts the record written to the file in the sync durability mode
+    void record_written()
+    {
+        BOOST_LOG_EXPR_IF_MT(lock_guard< mutex > lock(m_SyncMutex);)
+        ++m_WrittenCount;
+    }
+
+    //! Waits until all records written so far are synchronized with the storage
+    void commit()
+    {
+#if !defined(BOOST_LOG_NO_THREADS)
+        unique_lock< mutex > lock(m_SyncMutex);
+        const uintmax_t target = m_WrittenCount;
+        while (m_SyncedCount < target)
+        {
+            if (m_SyncInProgress)
+            {
+                // Another thread is synchronizing the file, its synchronization may cover our records
+                m_SyncCond.wait(lock);
+                continue;
+            }
+
+            // Synchronize the file on behalf of all threads that have written records so far
+            m_SyncInProgress = true;
+            const posix_time::time_duration latency = m_SyncLatency;
+            if (latency > posix_time::time_duration(0, 0, 0))
+            {
+                // Let other threads write more records that will be covered by this synchronization
+                lock.unlock();
+                boost::this_thread::sleep(latency);
+                lock.lock();
+            }
+
+            const uintmax_t written = m_WrittenCount;
+            const int fd = m_SyncFd;
+            lock.unlock();
+            const int err = sync_file_data(fd);
+            lock.lock();
+
+            m_SyncInProgress = false;
+            if (err == 0 && m_SyncedCount < written)
+                m_SyncedCount = written;
+            m_SyncCond.notify_all();
+
+            if (err != 0)
+                throw_sync_error(err);
+        }
+#else
+        if (m_SyncedCount < m_WrittenCount)
+        {
+            const int err = sync_file_data(m_SyncFd);
+            if (err != 0)
+                throw_sync_error(err);
+            m_SyncedCount = m_WrittenCount;
+        }
+#endif
+    }
+#endif // defined(BOOST_LOG_HAS_FILE_SYNC)
+
+    //! Changes the size of the write buffer
+    void set_write_buffer_size(std::size_t size)
+    {
+        write_buffer();
+        m_WriteBufferSize = size;
+        m_WriteBufferStats.capacity = size;
+        string_type buf;
+        if (size > 0)
+            buf.reserve(size);
+        m_WriteBuffer.swap(buf);
+    }
+
+    //! Puts the formatted record into the write buffer
+    void buffer_record(string_type const& formatted_message)
+    {
+        typedef file_char_traits< string_type::value_type > traits_t;
+
+        if (!m_WriteBuffer.empty() && m_WriteBuffer.size() + formatted_message.size() + 1u > m_WriteBufferSize)
+        {
+            // The record does not fit, write the buffer to avoid reallocation
+            ++m_WriteBufferStats.size_triggered_write_count;
+            write_buffer();
+        }
+
+        const bool deadline_set = !m_WriteBuffer.empty();
+        m_WriteBuffer.append(formatted_message);
+        m_WriteBuffer.push_back(traits_t::newline);
+
+        if (m_WriteBuffer.size() >= m_WriteBufferSize)
+        {
+            ++m_WriteBufferStats.size_triggered_write_count;
+            write_buffer();
+        }
+        else if (!m_WriteBufferLatency.is_special())
+        {
+            posix_time::ptime now = posix_time::microsec_clock::universal_time();
+            if (!deadline_set)
+            {
+                m_WriteBufferDeadline = now + m_WriteBufferLatency;
+            }
+            else if (now >= m_WriteBufferDeadline)
+            {
+                ++m_WriteBufferStats.deadline_triggered_write_count;
+                write_buffer();
+            }
+        }
+    }
+
+    //! Writes the buffered records to the file
+    void write_buffer()
+    {
+        if (!m_WriteBuffer.empty())
+        {
+            // Writing a chunk of data larger than the stream buffer results in a single write operation that bypasses the stream buffer
+            stream_type& strm = file();
+            strm.write(m_WriteBuffer.data(), static_cast< std::streamsize >(m_WriteBuffer.size()));
+#if defined(BOOST_LOG_HAS_ASYNC_FILEBUF)
+            if (m_AsyncFileBuf.is_open())
+                m_AsyncFileBuf.submit(); // start writing without waiting for completion
+            else
+#endif
+                strm.flush();
+            ++m_WriteBufferStats.write_count;
+            m_WriteBufferStats.written_characters += m_WriteBuffer.size();
+            m_WriteBuffer.clear();
+        }
     }
 };
 
@@ -1078,7 +2488,7 @@ BOOST_LOG_API text_file_backend::~text_file_backend()
     try
     {
         // Attempt to put the temporary file into storage
-        if (m_pImpl->m_File.is_open() && m_pImpl->m_CharactersWritten > 0)
+        if (m_pImpl->is_open() && m_pImpl->m_CharactersWritten > 0)
             rotate_file();
     }
     catch (...)
@@ -1094,9 +2504,16 @@ BOOST_LOG_API void text_file_backend::construct(
     std::ios_base::openmode mode,
     uintmax_t rotation_size,
     time_based_rotation_predicate const& time_based_rotation,
-    bool auto_flush)
+    bool auto_flush,
+    std::size_t write_buffer_size,
+    posix_time::time_duration const& write_buffer_latency,
+    file::output_mode output_mode,
+    unsigned int write_buffer_count,
+    bool direct_io,
+    file::durability durability,
+    posix_time::time_duration const& sync_latency)
 {
-    m_pImpl = new implementation(rotation_size, auto_flush);
+    m_pImpl = new implementation(rotation_size, auto_flush, write_buffer_size, write_buffer_latency, output_mode, write_buffer_count, direct_io, durability, sync_latency);
     set_file_name_pattern_internal(pattern);
     set_time_based_rotation(time_based_rotation);
     set_open_mode(mode);
@@ -1120,6 +2537,51 @@ BOOST_LOG_API void text_file_backend::auto_flush(bool f)
     m_pImpl->m_AutoFlush = f;
 }
 
+//! Sets the size of the write buffer
+BOOST_LOG_API void text_file_backend::set_write_buffer_size(std::size_t size)
+{
+    m_pImpl->set_write_buffer_size(size);
+}
+
+//! Sets the maximum time the records are kept in the write buffer
+BOOST_LOG_API void text_file_backend::set_write_buffer_latency(posix_time::time_duration const& latency)
+{
+    m_pImpl->m_WriteBufferLatency = latency;
+    if (!m_pImpl->m_WriteBuffer.empty() && !latency.is_special())
+        m_pImpl->m_WriteBufferDeadline = posix_time::microsec_clock::universal_time() + latency;
+}
+
+//! Sets the output mode
+BOOST_LOG_API void text_file_backend::set_output_mode(file::output_mode mode, unsigned int buffer_count, bool direct_io)
+{
+    m_pImpl->m_OutputMode = mode;
+    m_pImpl->m_WriteBufferCount = buffer_count;
+    m_pImpl->m_DirectIO = direct_io;
+}
+
+//! Sets the durability level of the written records
+BOOST_LOG_API void text_file_backend::set_durability(file::durability level, posix_time::time_duration const& sync_latency)
+{
+    m_pImpl->m_Durability = level;
+#if defined(BOOST_LOG_HAS_FILE_SYNC)
+    {
+        BOOST_LOG_EXPR_IF_MT(lock_guard< mutex > lock(m_pImpl->m_SyncMutex);)
+        m_pImpl->m_SyncLatency = sync_latency;
+    }
+    m_pImpl->m_SyncOnCommit = level == file::sync_durability;
+#else
+    (void)sync_latency;
+#endif // defined(BOOST_LOG_HAS_FILE_SYNC)
+}
+
+//! Returns the current state of the write buffer
+BOOST_LOG_API text_file_backend::write_buffer_statistics text_file_backend::get_write_buffer_statistics() const
+{
+    write_buffer_statistics stats = m_pImpl->m_WriteBufferStats;
+    stats.size = m_pImpl->m_WriteBuffer.size();
+    return stats;
+}
+
 //! The method writes the message to the sink
 BOOST_LOG_API void text_file_backend::consume(record_view const& rec, string_type const& formatted_message)
 {
@@ -1127,25 +2589,24 @@ BOOST_LOG_API void text_file_backend::consume(record_view const& rec, string_typ
     if
     (
         (
-            m_pImpl->m_File.is_open() &&
+            m_pImpl->is_open() &&
             (
                 m_pImpl->m_CharactersWritten + formatted_message.size() >= m_pImpl->m_FileRotationSize ||
                 (!m_pImpl->m_TimeBasedRotation.empty() && m_pImpl->m_TimeBasedRotation())
             )
         ) ||
-        !m_pImpl->m_File.good()
+        !m_pImpl->file().good()
     )
     {
         rotate_file();
     }
 
-    if (!m_pImpl->m_File.is_open())
+    if (!m_pImpl->is_open())
     {
         m_pImpl->m_FileName = m_pImpl->m_StorageDir / m_pImpl->m_FileNameGenerator(m_pImpl->m_FileCounter++);
 
         filesystem::create_directories(m_pImpl->m_FileName.parent_path());
-        m_pImpl->m_File.open(m_pImpl->m_FileName, m_pImpl->m_FileOpenMode);
-        if (!m_pImpl->m_File.is_open())
+        if (!m_pImpl->open_file())
         {
             filesystem_error err(
                 "Failed to open file for writing",
@@ -1155,25 +2616,65 @@ BOOST_LOG_API void text_file_backend::consume(record_view const& rec, string_typ
         }
 
         if (!m_pImpl->m_OpenHandler.empty())
-            m_pImpl->m_OpenHandler(m_pImpl->m_File);
+            m_pImpl->m_OpenHandler(m_pImpl->file());
 
-        m_pImpl->m_CharactersWritten = static_cast< std::streamoff >(m_pImpl->m_File.tellp());
+        m_pImpl->m_CharactersWritten = static_cast< std::streamoff >(m_pImpl->file().tellp());
     }
 
-    m_pImpl->m_File.write(formatted_message.data(), static_cast< std::streamsize >(formatted_message.size()));
-    m_pImpl->m_File.put(traits_t::newline);
+    if (m_pImpl->m_WriteBufferSize > 0)
+    {
+        m_pImpl->buffer_record(formatted_message);
+        m_pImpl->m_CharactersWritten += formatted_message.size() + 1;
 
-    m_pImpl->m_CharactersWritten += formatted_message.size() + 1;
+        if (m_pImpl->m_AutoFlush || m_pImpl->m_Durability != file::no_durability)
+            m_pImpl->flush_file();
+    }
+    else
+    {
+        stream_type& strm = m_pImpl->file();
+        strm.write(formatted_message.data(), static_cast< std::streamsize >(formatted_message.size()));
+        strm.put(traits_t::newline);
+
+        m_pImpl->m_CharactersWritten += formatted_message.size() + 1;
 
-    if (m_pImpl->m_AutoFlush)
-        m_pImpl->m_File.flush();
+        if (m_pImpl->m_AutoFlush || m_pImpl->m_Durability != file::no_durability)
+            strm.flush();
+    }
+
+#if defined(BOOST_LOG_HAS_FILE_SYNC)
+    if (m_pImpl->m_Durability == file::sync_durability)
+    {
+        if (m_pImpl->m_SyncFd < 0)
+            m_pImpl->open_sync_file();
+        m_pImpl->record_written();
+    }
+#endif // defined(BOOST_LOG_HAS_FILE_SYNC)
+}
+
+//! The method waits until the written records are synchronized with the storage
+BOOST_LOG_API void text_file_backend::commit()
+{
+#if defined(BOOST_LOG_HAS_FILE_SYNC)
+    if (m_pImpl->m_SyncOnCommit)
+        m_pImpl->commit();
+#endif // defined(BOOST_LOG_HAS_FILE_SYNC)
 }
 
 //! The method flushes the currently open log file
 BOOST_LOG_API void text_file_backend::flush()
 {
-    if (m_pImpl->m_File.is_open())
-        m_pImpl->m_File.flush();
+    if (m_pImpl->is_open())
+        m_pImpl->flush_file();
+}
+
+//! The method writes the buffered records when the frontend has no more records ready
+BOOST_LOG_API void text_file_backend::on_idle()
+{
+    if (!m_pImpl->m_WriteBuffer.empty() && !m_pImpl->m_WriteBufferLatency.is_special())
+    {
+        ++m_pImpl->m_WriteBufferStats.idle_triggered_write_count;
+        m_pImpl->write_buffer();
+    }
 }
 
 //! The method sets file name mask
@@ -1252,13 +2753,21 @@ BOOST_LOG_API void text_file_backend::set_file_name_pattern_internal(filesystem:
 //! The method rotates the file
 BOOST_LOG_API void text_file_backend::rotate_file()
 {
+    // The buffered records must go to the file being closed, before the footer written by the close handler
+    m_pImpl->write_buffer();
     if (!m_pImpl->m_CloseHandler.empty())
-        m_pImpl->m_CloseHandler(m_pImpl->m_File);
-    m_pImpl->m_File.close();
-    m_pImpl->m_File.clear();
+        m_pImpl->m_CloseHandler(m_pImpl->file());
+    m_pImpl->close_file();
     m_pImpl->m_CharactersWritten = 0;
+#if defined(BOOST_LOG_HAS_FILE_SYNC)
+    const int sync_err = m_pImpl->close_sync_file();
+#endif // defined(BOOST_LOG_HAS_FILE_SYNC)
     if (!!m_pImpl->m_pFileCollector)
         m_pImpl->m_pFileCollector->store_file(m_pImpl->m_FileName);
+#if defined(BOOST_LOG_HAS_FILE_SYNC)
+    if (sync_err != 0)
+        m_pImpl->throw_sync_error(sync_err);
+#endif // defined(BOOST_LOG_HAS_FILE_SYNC)
 }
 
 //! The method sets the file open mode
@@ -1310,6 +2819,36 @@ BOOST_LOG_API uintmax_t text_file_backend::scan_for_files(file::scan_method meth
 //! Sink implementation data
 struct text_multifile_backend::implementation
 {
+    //! An open file
+    struct open_file :
+        public intrusive::list_base_hook< intrusive::link_mode< intrusive::safe_link > >
+    {
+        //! The absolute normalized file name
+        const filesystem::path m_FileName;
+        //! File stream
+        filesystem::ofstream m_File;
+        //! The time when the file was last written to
+        std::time_t m_LastUsed;
+
+        explicit open_file(filesystem::path const& file_name) : m_FileName(file_name), m_LastUsed(0)
+        {
+        }
+    };
+    //! The list of open files, the most recently used file goes first
+    typedef intrusive::list< open_file, intrusive::constant_time_size< true > > open_file_list;
+    //! The index of open files
+    typedef std::map< filesystem::path, open_file* > open_file_map;
+
+    //! The deleter of the open files
+    struct open_file_deleter
+    {
+        typedef void result_type;
+        void operator() (open_file* p) const
+        {
+            delete p;
+        }
+    };
+
     //! File name composer
     file_name_composer_type m_FileNameComposer;
     //! Base path for absolute path composition
@@ -1317,15 +2856,78 @@ struct text_multifile_backend::implementation
     //! File stream
     filesystem::ofstream m_File;
 
+    //! The maximum number of open files, 0 if files are closed after every record
+    std::size_t m_MaxOpenFiles;
+    //! The time, in seconds, after which the idle files are closed, 0 if not limited
+    std::time_t m_IdleTimeout;
+    //! Open files
+    open_file_list m_OpenFiles;
+    //! Open files index
+    open_file_map m_OpenFileMap;
+
     implementation() :
-        m_BasePath(filesystem::current_path())
+        m_BasePath(filesystem::current_path()),
+        m_MaxOpenFiles(0),
+        m_IdleTimeout(0)
     {
     }
 
-    //! Makes relative path absolute with respect to the base path
+    ~implementation()
+    {
+        close_files(0);
+    }
+
+    //! Makes relative path absolute with respect to the base path and normalizes it
     filesystem::path make_absolute(filesystem::path const& p)
     {
-        return filesystem::absolute(p, m_BasePath);
+        return normalize_path(filesystem::absolute(p, m_BasePath));
+    }
+
+    //! Returns the open file, opens the file if needed. Returns \c NULL if the file could not be opened.
+    open_file* get_file(filesystem::path const& composed_name)
+    {
+        // Different names of the same file must not open separate streams
+        const filesystem::path file_name = make_absolute(composed_name);
+        open_file_map::iterator it = m_OpenFileMap.find(file_name);
+        if (it != m_OpenFileMap.end())
+        {
+            open_file* p = it->second;
+            m_OpenFiles.splice(m_OpenFiles.begin(), m_OpenFiles, m_OpenFiles.iterator_to(*p));
+            return p;
+        }
+
+        close_files(m_MaxOpenFiles - 1u);
+
+        filesystem::create_directories(file_name.parent_path());
+        std::auto_ptr< open_file > p(new open_file(file_name));
+        p->m_File.open(file_name, std::ios_base::out | std::ios_base::app);
+        if (!p->m_File.is_open())
+            return NULL;
+
+        m_OpenFileMap.insert(open_file_map::value_type(file_name, p.get()));
+        m_OpenFiles.push_front(*p);
+        return p.release();
+    }
+
+    //! Closes the specified file
+    void close_file(open_file* p)
+    {
+        m_OpenFileMap.erase(p->m_FileName);
+        m_OpenFiles.erase_and_dispose(m_OpenFiles.iterator_to(*p), open_file_deleter());
+    }
+
+    //! Closes the least recently used files so that no more than the specified number of files are left open
+    void close_files(std::size_t count)
+    {
+        while (m_OpenFiles.size() > count)
+            close_file(&m_OpenFiles.back());
+    }
+
+    //! Closes the files that have not been written to since the specified time
+    void close_idle_files(std::time_t now)
+    {
+        while (!m_OpenFiles.empty() && now - m_OpenFiles.back().m_LastUsed >= m_IdleTimeout)
+            close_file(&m_OpenFiles.back());
     }
 };
 
@@ -1346,24 +2948,91 @@ BOOST_LOG_API void text_multifile_backend::set_file_name_composer_internal(file_
     m_pImpl->m_FileNameComposer = composer;
 }
 
+//! The method sets the maximum number of files that are kept open
+BOOST_LOG_API void text_multifile_backend::set_max_open_files(std::size_t count)
+{
+    m_pImpl->m_MaxOpenFiles = count;
+    m_pImpl->close_files(count);
+}
+
+//! The method sets the time after which an open file that has not been written to is closed
+BOOST_LOG_API void text_multifile_backend::set_idle_timeout(posix_time::time_duration const& timeout)
+{
+    if (timeout.is_special())
+    {
+        m_pImpl->m_IdleTimeout = 0;
+    }
+    else
+    {
+        if (timeout.is_negative() || timeout.ticks() == 0)
+            BOOST_LOG_THROW_DESCR(setup_error, "Log file idle timeout must be positive");
+
+        // Idle files are detected with a one second precision, round the timeout up
+        posix_time::time_duration::sec_type seconds = timeout.total_seconds();
+        if (timeout.fractional_seconds() > 0)
+            ++seconds;
+        m_pImpl->m_IdleTimeout = static_cast< std::time_t >(seconds);
+    }
+}
+
 //! The method writes the message to the sink
 BOOST_LOG_API void text_multifile_backend::consume(record_view const& rec, string_type const& formatted_message)
 {
     typedef file_char_traits< string_type::value_type > traits_t;
     if (!m_pImpl->m_FileNameComposer.empty())
     {
-        filesystem::path file_name = m_pImpl->make_absolute(m_pImpl->m_FileNameComposer(rec));
-        filesystem::create_directories(file_name.parent_path());
-        m_pImpl->m_File.open(file_name, std::ios_base::out | std::ios_base::app);
-        if (m_pImpl->m_File.is_open())
+        if (m_pImpl->m_MaxOpenFiles == 0)
+        {
+            filesystem::path file_name = m_pImpl->make_absolute(m_pImpl->m_FileNameComposer(rec));
+            filesystem::create_directories(file_name.parent_path());
+            m_pImpl->m_File.open(file_name, std::ios_base::out | std::ios_base::app);
+            if (m_pImpl->m_File.is_open())
+            {
+                m_pImpl->m_File.write(formatted_message.data(), static_cast< std::streamsize >(formatted_message.size()));
+                m_pImpl->m_File.put(traits_t::newline);
+                m_pImpl->m_File.close();
+            }
+        }
+        else
         {
-            m_pImpl->m_File.write(formatted_message.data(), static_cast< std::streamsize >(formatted_message.size()));
-            m_pImpl->m_File.put(traits_t::newline);
-            m_pImpl->m_File.close();
+            implementation::open_file* p = m_pImpl->get_file(m_pImpl->m_FileNameComposer(rec));
+            if (p)
+            {
+                p->m_File.write(formatted_message.data(), static_cast< std::streamsize >(formatted_message.size()));
+                p->m_File.put(traits_t::newline);
+                if (!p->m_File.good())
+                {
+                    // Reopen the file on the next record
+                    m_pImpl->close_file(p);
+                }
+                else
+                {
+                    // The time is also recorded without the idle timeout, in case if the timeout is set later
+                    const std::time_t now = std::time(NULL);
+                    p->m_LastUsed = now;
+                    if (m_pImpl->m_IdleTimeout > 0)
+                        m_pImpl->close_idle_files(now);
+                }
+            }
         }
     }
 }
 
+//! The method writes the buffered data of all open files and closes the idle files
+BOOST_LOG_API void text_multifile_backend::flush()
+{
+    if (m_pImpl->m_IdleTimeout > 0)
+        m_pImpl->close_idle_files(std::time(NULL));
+
+    implementation::open_file_list::iterator it = m_pImpl->m_OpenFiles.begin(), end = m_pImpl->m_OpenFiles.end();
+    while (it != end)
+    {
+        implementation::open_file* p = &*it++;
+        if (!p->m_File.flush().good())
+            m_pImpl->close_file(p);
+    }
+}
+
 } // namespace sinks
 
 BOOST_LOG_CLOSE_NAMESPACE // namespace log
@@ -106,6 +106,26 @@ BOOST_LOG_API void basic_text_ostream_backend< CharT >::consume(record_view cons
     }
 }
 
+//! The method writes a batch of messages to the sink
+template< typename CharT >
+BOOST_LOG_API void basic_text_ostream_backend< CharT >::consume(record_view const*, string_type const* messages, std::size_t count)
+{
+    typename implementation::ostream_sequence::const_iterator
+        it = m_pImpl->m_Streams.begin(), end = m_pImpl->m_Streams.end();
+    for (; it != end; ++it)
+    {
+        register stream_type* const strm = it->get();
+        for (std::size_t i = 0; i < count && strm->good(); ++i)
+        {
+            strm->write(messages[i].data(), static_cast< std::streamsize >(messages[i].size()));
+            strm->put(static_cast< char_type >('\n'));
+        }
+
+        if (m_pImpl->m_fAutoFlush && strm->good())
+            strm->flush();
+    }
+}
+
 //! The method flushes the associated streams
 template< typename CharT >
 BOOST_LOG_API void basic_text_ostream_backend< CharT >::flush()
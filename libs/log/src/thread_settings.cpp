@@ -0,0 +1,241 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   thread_settings.cpp
+ * \author Andrey Semashev
+ * \date   18.10.2013
+ *
+ * \brief  This header is the Boost.Log library implementation, see the library documentation
+ *         at http://www.boost.org/libs/log/doc/log.html.
+ */
+
+#include <boost/log/detail/config.hpp>
+
+#ifndef BOOST_LOG_NO_THREADS
+
+#include <string>
+#include <vector>
+#include <boost/log/exceptions.hpp>
+#include <boost/log/sinks/thread_settings.hpp>
+
+#if defined(BOOST_WINDOWS)
+
+#define WIN32_LEAN_AND_MEAN
+#include "windows_version.hpp"
+#include <windows.h>
+#include <climits>
+
+//! The number of CPUs that can be specified in the affinity mask
+#define BOOST_LOG_MAX_CPU_COUNT (sizeof(DWORD_PTR) * CHAR_BIT)
+
+#elif defined(__linux__)
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+//! The number of CPUs that can be specified in the affinity mask
+#define BOOST_LOG_MAX_CPU_COUNT CPU_SETSIZE
+
+#else
+
+// The affinity is not supported, only limit the size of the CPU list
+#define BOOST_LOG_MAX_CPU_COUNT 1024
+
+#endif
+
+#include <boost/log/detail/header.hpp>
+
+namespace boost {
+
+BOOST_LOG_OPEN_NAMESPACE
+
+namespace sinks {
+
+BOOST_LOG_ANONYMOUS_NAMESPACE {
+
+    //! Skips spaces in the string
+    inline void skip_spaces(std::string::const_iterator& it, std::string::const_iterator end)
+    {
+        while (it != end && (*it == ' ' || *it == '\t'))
+            ++it;
+    }
+
+    //! Parses a CPU number
+    inline bool parse_cpu_number(std::string::const_iterator& it, std::string::const_iterator end, unsigned int& cpu)
+    {
+        skip_spaces(it, end);
+        if (it == end || *it < '0' || *it > '9')
+            return false;
+
+        cpu = 0;
+        for (; it != end && *it >= '0' && *it <= '9'; ++it)
+        {
+            const unsigned int next = cpu * 10u + static_cast< unsigned int >(*it - '0');
+            if (next / 10u != cpu)
+                return false;
+            cpu = next;
+        }
+        skip_spaces(it, end);
+        return true;
+    }
+
+} // namespace
+
+//! Sets the CPUs the threads are allowed to run on from a string
+BOOST_LOG_API void thread_settings::set_cpu_affinity(std::string const& cpus)
+{
+    std::vector< unsigned int > result;
+    std::string::const_iterator it = cpus.begin(), end = cpus.end();
+    skip_spaces(it, end);
+    while (it != end)
+    {
+        unsigned int first = 0, last = 0;
+        if (!parse_cpu_number(it, end, first))
+            BOOST_LOG_THROW_DESCR(invalid_value, "Invalid CPU list: \"" + cpus + "\"");
+
+        last = first;
+        if (it != end && *it == '-')
+        {
+            ++it;
+            if (!parse_cpu_number(it, end, last) || last < first)
+                BOOST_LOG_THROW_DESCR(invalid_value, "Invalid CPU list: \"" + cpus + "\"");
+        }
+
+        // This also limits the size of the list in case of huge ranges
+        if (last >= static_cast< unsigned int >(BOOST_LOG_MAX_CPU_COUNT))
+            BOOST_LOG_THROW_DESCR(invalid_value, "CPU number is out of range in the CPU list: \"" + cpus + "\"");
+
+        for (unsigned int cpu = first; cpu <= last; ++cpu)
+            result.push_back(cpu);
+
+        if (it != end)
+        {
+            if (*it != ',')
+                BOOST_LOG_THROW_DESCR(invalid_value, "Invalid CPU list: \"" + cpus + "\"");
+            ++it;
+            skip_spaces(it, end);
+            if (it == end)
+                BOOST_LOG_THROW_DESCR(invalid_value, "Invalid CPU list: \"" + cpus + "\"");
+        }
+    }
+
+    m_cpus.swap(result);
+}
+
+//! Applies the settings to the current thread
+BOOST_LOG_API bool thread_settings::apply() const
+{
+    bool result = true;
+
+#if defined(BOOST_WINDOWS)
+
+    HANDLE thread = GetCurrentThread();
+    if (!m_cpus.empty())
+    {
+        DWORD_PTR mask = 0;
+        for (std::vector< unsigned int >::const_iterator it = m_cpus.begin(), end = m_cpus.end(); it != end; ++it)
+        {
+            if (*it < sizeof(DWORD_PTR) * CHAR_BIT)
+                mask |= static_cast< DWORD_PTR >(1u) << *it;
+        }
+        if (mask == 0 || !SetThreadAffinityMask(thread, mask))
+            result = false;
+    }
+
+    if (m_policy == idle_scheduling)
+    {
+        if (!SetThreadPriority(thread, THREAD_PRIORITY_IDLE))
+            result = false;
+    }
+    else if (m_nice != static_cast< int >(no_nice))
+    {
+        // Map the nice value range [-20, 19] onto the thread priorities
+        int priority = THREAD_PRIORITY_NORMAL;
+        if (m_nice >= 10)
+            priority = THREAD_PRIORITY_LOWEST;
+        else if (m_nice > 0)
+            priority = THREAD_PRIORITY_BELOW_NORMAL;
+        else if (m_nice <= -10)
+            priority = THREAD_PRIORITY_HIGHEST;
+        else if (m_nice < 0)
+            priority = THREAD_PRIORITY_ABOVE_NORMAL;
+        if (!SetThreadPriority(thread, priority))
+            result = false;
+    }
+    else if (m_policy == batch_scheduling)
+    {
+        // There is no equivalent of the batch scheduling policy on Windows
+        result = false;
+    }
+
+    if (!m_name.empty())
+        result = false;
+
+#elif defined(__linux__)
+
+    pthread_t thread = pthread_self();
+    if (!m_cpus.empty())
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        bool has_cpus = false;
+        for (std::vector< unsigned int >::const_iterator it = m_cpus.begin(), end = m_cpus.end(); it != end; ++it)
+        {
+            if (*it < static_cast< unsigned int >(CPU_SETSIZE))
+            {
+                CPU_SET(*it, &set);
+                has_cpus = true;
+            }
+        }
+        if (!has_cpus || pthread_setaffinity_np(thread, sizeof(set), &set) != 0)
+            result = false;
+    }
+
+    if (m_policy != default_scheduling)
+    {
+        struct sched_param param = {};
+        param.sched_priority = 0;
+        if (pthread_setschedparam(thread, m_policy == idle_scheduling ? SCHED_IDLE : SCHED_BATCH, &param) != 0)
+            result = false;
+    }
+
+    // On Linux the nice value is a per-thread attribute
+    if (m_nice != static_cast< int >(no_nice))
+    {
+        if (setpriority(PRIO_PROCESS, static_cast< id_t >(syscall(SYS_gettid)), m_nice) != 0)
+            result = false;
+    }
+
+    if (!m_name.empty())
+    {
+        // The name is limited to 16 characters, including the terminating zero
+        if (pthread_setname_np(thread, m_name.substr(0, 15).c_str()) != 0)
+            result = false;
+    }
+
+#else
+
+    result = empty();
+
+#endif
+
+    return result;
+}
+
+} // namespace sinks
+
+BOOST_LOG_CLOSE_NAMESPACE // namespace log
+
+} // namespace boost
+
+#include <boost/log/detail/footer.hpp>
+
+#endif // BOOST_LOG_NO_THREADS
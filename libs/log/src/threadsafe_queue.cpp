@@ -19,6 +19,15 @@
  *
  * The lock-free version of the mentioned algorithms contain a race condition and therefore
  * were not included here.
+ *
+ * The nodes released by the consumer are pushed to a lock-free stack. Producers never pop
+ * nodes from the stack one by one but rather take the whole stack at once, when their cache
+ * of free nodes is exhausted. This makes the stack immune to the ABA problem.
+ *
+ * Every producer thread has its own cache of free nodes, so producers don't contend with each other
+ * when they take nodes from their caches. When a producer thread terminates, the nodes left in its cache
+ * are pushed back to the stack. The caches are registered in a list which is only accessed when a thread
+ * pushes to the queue for the first time, when it terminates and when the queue is destroyed.
  */
 
 #include <boost/log/detail/threadsafe_queue.hpp>
@@ -27,9 +36,16 @@
 
 #include <stdlib.h>
 #include <new>
+#include <memory>
+#include <vector>
+#include <algorithm>
 #include <boost/assert.hpp>
 #include <boost/static_assert.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
 #include <boost/throw_exception.hpp>
+#include <boost/atomic/atomic.hpp>
+#include <boost/thread/tss.hpp>
 #include <boost/type_traits/alignment_of.hpp>
 #include <boost/log/detail/spin_mutex.hpp>
 #include <boost/log/detail/locks.hpp>
@@ -76,6 +92,9 @@ private:
     //! Mutex type to be used
     typedef spin_mutex mutex_type;
 
+    //! The maximum number of nodes in the stack of the recycled nodes
+    enum { max_recycled_nodes = 1024 };
+
     /*!
      * A structure that contains a pointer to the node and the associated mutex.
      * The alignment below allows to eliminate false sharing, it should be not less than CPU cache line size (which is assumed to be 64 bytes in most cases).
@@ -90,21 +109,75 @@ private:
         unsigned char padding[128U - (sizeof(node_base*) + sizeof(mutex_type)) % 128U];
     };
 
+    //! A structure that contains the top of the stack of the recycled nodes. The alignment serves the same purpose as in \c pointer.
+    struct BOOST_LOG_ALIGNAS(64) atomic_pointer
+    {
+        //! Pointer to the top of the stack
+        boost::atomic< node_base* > node;
+        //  See the comment in \c pointer
+        unsigned char padding[128U - sizeof(boost::atomic< node_base* >) % 128U];
+    };
+
+    struct cache_registry;
+
+    //! The cache of free nodes of a producer thread
+    struct node_cache
+    {
+        //! The list of free nodes, only accessed by the owning thread, or with the registry lock held after the queue is destroyed
+        node_base* m_Nodes;
+        //! The registry the cache belongs to
+        const shared_ptr< cache_registry > m_pRegistry;
+
+        explicit node_cache(shared_ptr< cache_registry > const& reg) : m_Nodes(NULL), m_pRegistry(reg)
+        {
+        }
+    };
+
+    //! The list of the producer caches. The registry outlives the queue if producer threads still have their caches.
+    struct cache_registry
+    {
+        //! Synchronization mutex
+        mutex_type m_Mutex;
+        //! The queue, or \c NULL if it is destroyed
+        threadsafe_queue_impl_generic* m_pQueue;
+        //! The caches of the producer threads
+        std::vector< node_cache* > m_Caches;
+
+        explicit cache_registry(threadsafe_queue_impl_generic* queue) : m_pQueue(queue)
+        {
+        }
+    };
+
 private:
     //! Pointer to the beginning of the queue
     pointer m_Head;
     //! Pointer to the end of the queue
     pointer m_Tail;
+    //! Pointer to the top of the stack of nodes recycled by the consumer
+    atomic_pointer m_RecycledNodes;
+    //! The upper bound of the number of nodes the consumer has pushed to the stack since it was last taken, only accessed by the consumer
+    std::size_t m_RecycledCount;
+    //! The registry of the producer caches
+    const shared_ptr< cache_registry > m_pRegistry;
+    //! The cache of the current producer thread
+    thread_specific_ptr< node_cache > m_pCache;
 
 public:
-    explicit threadsafe_queue_impl_generic(node_base* first_node)
+    explicit threadsafe_queue_impl_generic(node_base* first_node) :
+        m_RecycledCount(0),
+        m_pRegistry(boost::make_shared< cache_registry >(this)),
+        m_pCache(&threadsafe_queue_impl_generic::release_cache)
     {
         set_next(first_node, NULL);
         m_Head.node = m_Tail.node = first_node;
+        m_RecycledNodes.node.store(NULL, boost::memory_order_relaxed);
     }
 
     ~threadsafe_queue_impl_generic()
     {
+        // The caches of the threads that are still running are released when the threads terminate
+        exclusive_lock_guard< mutex_type > _(m_pRegistry->m_Mutex);
+        m_pRegistry->m_pQueue = NULL;
     }
 
     node_base* reset_last_node()
@@ -143,7 +216,139 @@ public:
             return false;
     }
 
+    node_base* get_free_node()
+    {
+        node_cache* cache = current_cache();
+        node_base* p = cache->m_Nodes;
+        if (!p)
+        {
+            // Replenish the cache with the nodes recycled by the consumer
+            p = take_recycled_nodes();
+            if (!p)
+                return NULL;
+        }
+        cache->m_Nodes = get_next(p);
+        return p;
+    }
+
+    node_base* release_cached_node()
+    {
+        exclusive_lock_guard< mutex_type > _(m_pRegistry->m_Mutex);
+        for (std::vector< node_cache* >::const_iterator it = m_pRegistry->m_Caches.begin(), end = m_pRegistry->m_Caches.end(); it != end; ++it)
+        {
+            node_cache* cache = *it;
+            node_base* p = cache->m_Nodes;
+            if (p)
+            {
+                cache->m_Nodes = get_next(p);
+                return p;
+            }
+        }
+
+        // No other threads use the queue at this point
+        node_base* p = m_RecycledNodes.node.load(boost::memory_order_acquire);
+        if (p)
+            m_RecycledNodes.node.store(get_next(p), boost::memory_order_relaxed);
+        return p;
+    }
+
+    bool recycle_node(node_base* p)
+    {
+        // The stack may have been taken by a producer since the last call, in which case the stack
+        // is empty and the counter can be reset. Otherwise the counter is the upper bound of the stack size.
+        node_base* top = m_RecycledNodes.node.load(boost::memory_order_relaxed);
+        do
+        {
+            if (top && m_RecycledCount >= static_cast< std::size_t >(max_recycled_nodes))
+                return false;
+            set_next(p, top);
+        }
+        while (!m_RecycledNodes.node.compare_exchange_weak(top, p, boost::memory_order_release, boost::memory_order_relaxed));
+        m_RecycledCount = top ? m_RecycledCount + 1u : static_cast< std::size_t >(1u);
+        return true;
+    }
+
 private:
+    //! Returns the cache of the current thread, registers a new cache if needed
+    node_cache* current_cache()
+    {
+        node_cache* cache = m_pCache.get();
+        // The thread may still have a cache of a queue that was destroyed and
+        // occupied the same memory location. Such caches refer to a different registry.
+        if (!cache || cache->m_pRegistry != m_pRegistry)
+            cache = register_cache();
+        return cache;
+    }
+
+    //! Creates and registers a new cache for the current thread
+    node_cache* register_cache()
+    {
+        std::auto_ptr< node_cache > cache(new node_cache(m_pRegistry));
+        {
+            exclusive_lock_guard< mutex_type > _(m_pRegistry->m_Mutex);
+            m_pRegistry->m_Caches.push_back(cache.get());
+        }
+        try
+        {
+            m_pCache.reset(cache.get());
+        }
+        catch (...)
+        {
+            exclusive_lock_guard< mutex_type > _(m_pRegistry->m_Mutex);
+            unregister_cache(*m_pRegistry, cache.get());
+            throw;
+        }
+        return cache.release();
+    }
+
+    //! Returns the nodes of the terminating thread to the stack of the recycled nodes and destroys its cache
+    static void release_cache(node_cache* cache)
+    {
+        {
+            cache_registry& reg = *cache->m_pRegistry;
+            exclusive_lock_guard< mutex_type > _(reg.m_Mutex);
+            unregister_cache(reg, cache);
+            // If the queue is destroyed, the nodes have already been released by the queue destructor
+            if (reg.m_pQueue && cache->m_Nodes)
+                reg.m_pQueue->return_nodes(cache->m_Nodes);
+        }
+        delete cache;
+    }
+
+    //! Removes the cache from the registry. Must be called with the registry lock held.
+    static void unregister_cache(cache_registry& reg, node_cache* cache)
+    {
+        std::vector< node_cache* >::iterator it = std::find(reg.m_Caches.begin(), reg.m_Caches.end(), cache);
+        if (it != reg.m_Caches.end())
+            reg.m_Caches.erase(it);
+    }
+
+    //! Pushes the list of nodes to the stack of the recycled nodes
+    void return_nodes(node_base* first)
+    {
+        node_base* last = first;
+        for (node_base* next = get_next(last); next; next = get_next(last))
+            last = next;
+
+        // Pushing a list is immune to the ABA problem just as pushing a single node is
+        node_base* top = m_RecycledNodes.node.load(boost::memory_order_relaxed);
+        do
+        {
+            set_next(last, top);
+        }
+        while (!m_RecycledNodes.node.compare_exchange_weak(top, first, boost::memory_order_release, boost::memory_order_relaxed));
+    }
+
+    //! Takes the whole stack of the recycled nodes
+    node_base* take_recycled_nodes()
+    {
+        // Avoid writing to the shared cache line if the stack is empty
+        if (!m_RecycledNodes.node.load(boost::memory_order_relaxed))
+            return NULL;
+        // The acquire ordering pairs with the release ordering of the pushes and makes the links between the nodes visible
+        return m_RecycledNodes.node.exchange(NULL, boost::memory_order_acquire);
+    }
+
     // Copying and assignment are closed
     threadsafe_queue_impl_generic(threadsafe_queue_impl_generic const&);
     threadsafe_queue_impl_generic& operator= (threadsafe_queue_impl_generic const&);
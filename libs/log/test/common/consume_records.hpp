@@ -0,0 +1,47 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   consume_records.hpp
+ * \author Andrey Semashev
+ * \date   19.10.2013
+ *
+ * \brief  This header contains helper functions that pass log records with messages directly to a sink.
+ */
+
+#ifndef BOOST_LOG_TESTS_CONSUME_RECORDS_HPP_INCLUDED_
+#define BOOST_LOG_TESTS_CONSUME_RECORDS_HPP_INCLUDED_
+
+#include <string>
+#include <boost/lexical_cast.hpp>
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/attributes/constant.hpp>
+#include <boost/log/attributes/attribute_set.hpp>
+#include "make_record.hpp"
+
+//! Creates a log record with the message and the specified attributes
+inline boost::log::record_view make_message_record_view(std::string const& message, boost::log::attribute_set src_attrs = boost::log::attribute_set())
+{
+    src_attrs["Message"] = boost::log::attributes::constant< std::string >(message);
+    return make_record_view(src_attrs);
+}
+
+//! Passes numbered messages "<prefix><number>" to the sink, returns the messages, each followed by a new line
+template< typename SinkT >
+std::string consume_records(SinkT& sink, unsigned int count, std::string const& prefix = std::string("record "), boost::log::attribute_set const& src_attrs = boost::log::attribute_set())
+{
+    std::string messages;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const std::string message = prefix + boost::lexical_cast< std::string >(i);
+        sink.consume(make_message_record_view(message, src_attrs));
+        messages += message;
+        messages.push_back('\n');
+    }
+    return messages;
+}
+
+#endif // BOOST_LOG_TESTS_CONSUME_RECORDS_HPP_INCLUDED_
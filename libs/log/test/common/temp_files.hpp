@@ -0,0 +1,54 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   temp_files.hpp
+ * \author Andrey Semashev
+ * \date   19.10.2013
+ *
+ * \brief  This header contains helpers for the tests that work with temporary files.
+ */
+
+#ifndef BOOST_LOG_TESTS_TEMP_FILES_HPP_INCLUDED_
+#define BOOST_LOG_TESTS_TEMP_FILES_HPP_INCLUDED_
+
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <boost/system/error_code.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+
+//! Generates a unique path in the specified directory
+inline boost::filesystem::path make_temp_path(boost::filesystem::path const& parent = boost::filesystem::temp_directory_path())
+{
+    return parent / boost::filesystem::unique_path("boost_log_test_%%%%-%%%%-%%%%");
+}
+
+//! Creates a unique directory for the test files and removes it on destruction
+struct temp_directory
+{
+    boost::filesystem::path m_Path;
+
+    explicit temp_directory(boost::filesystem::path const& parent = boost::filesystem::temp_directory_path()) : m_Path(make_temp_path(parent))
+    {
+        boost::filesystem::create_directories(m_Path);
+    }
+    ~temp_directory()
+    {
+        boost::system::error_code err;
+        boost::filesystem::remove_all(m_Path, err);
+    }
+};
+
+//! Reads the whole file
+inline std::string read_file(boost::filesystem::path const& path)
+{
+    std::ifstream file(path.string().c_str(), std::ios_base::in | std::ios_base::binary);
+    return std::string(std::istreambuf_iterator< char >(file), std::istreambuf_iterator< char >());
+}
+
+#endif // BOOST_LOG_TESTS_TEMP_FILES_HPP_INCLUDED_
@@ -0,0 +1,233 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   sink_async_frontend.cpp
+ * \author Andrey Semashev
+ * \date   19.10.2013
+ *
+ * \brief  This header contains tests for the record feeding of the asynchronous sink frontend.
+ */
+
+#define BOOST_TEST_MODULE sink_async_frontend
+
+#include <boost/log/detail/config.hpp>
+
+#if !defined(BOOST_LOG_NO_THREADS)
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/utility/formatting_ostream.hpp>
+#include <boost/log/utility/value_ref.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/sinks/frontend_requirements.hpp>
+#include <boost/log/keywords/batch_size.hpp>
+#include <boost/log/keywords/start_thread.hpp>
+#include <boost/log/keywords/feeding_threads.hpp>
+#include <boost/log/keywords/ordered_commit.hpp>
+#include "consume_records.hpp"
+
+namespace logging = boost::log;
+namespace sinks = logging::sinks;
+namespace expr = logging::expressions;
+namespace keywords = logging::keywords;
+
+namespace {
+
+enum config
+{
+    RECORD_COUNT = 100,
+    BATCH_SIZE = 16,
+    FEEDING_THREAD_COUNT = 4,
+    POOL_RECORD_COUNT = 2000,
+    POOL_BATCH_SIZE = 4
+};
+
+//! The backend collects formatted messages and the sizes of the batches it receives
+class batching_backend :
+    public sinks::basic_formatted_sink_backend<
+        char,
+        sinks::combine_requirements< sinks::synchronized_feeding, sinks::batched_records >::type
+    >
+{
+public:
+    std::string m_Messages;
+    std::vector< std::size_t > m_BatchSizes;
+
+    void consume(logging::record_view const&, string_type const& message)
+    {
+        m_BatchSizes.push_back(1u);
+        append(message);
+    }
+
+    void consume(logging::record_view const*, string_type const* messages, std::size_t count)
+    {
+        m_BatchSizes.push_back(count);
+        for (std::size_t i = 0; i < count; ++i)
+            append(messages[i]);
+    }
+
+private:
+    void append(string_type const& message)
+    {
+        m_Messages += message;
+        m_Messages.push_back('\n');
+    }
+};
+
+//! The backend collects formatted messages one by one
+class collecting_backend :
+    public sinks::basic_formatted_sink_backend< char, sinks::synchronized_feeding >
+{
+public:
+    std::string m_Messages;
+
+    void consume(logging::record_view const&, string_type const& message)
+    {
+        m_Messages += message;
+        m_Messages.push_back('\n');
+    }
+};
+
+//! The backend collects formatted messages and throws when it receives the "fail" message
+class failing_backend :
+    public sinks::basic_formatted_sink_backend< char, sinks::synchronized_feeding >
+{
+public:
+    std::string m_Messages;
+
+    void consume(logging::record_view const&, string_type const& message)
+    {
+        if (message == "fail")
+            throw std::runtime_error("backend failure");
+        m_Messages += message;
+        m_Messages.push_back('\n');
+    }
+};
+
+//! Formats the message, slowly for every tenth record, so that the threads of the feeding pool finish formatting out of order
+void slow_format(logging::record_view const& rec, logging::formatting_ostream& strm)
+{
+    logging::value_ref< std::string > message = logging::extract< std::string >("Message", rec);
+    if (message && message.get()[message.get().size() - 1u] == '0')
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    strm << message;
+}
+
+//! Runs the feeding loop of the sink and records whether it has terminated with the backend exception
+template< typename SinkT >
+void run_sink(SinkT& sink, bool& failed)
+{
+    try
+    {
+        sink.run();
+    }
+    catch (std::runtime_error&)
+    {
+        failed = true;
+    }
+}
+
+} // namespace
+
+// The test checks that a backend supporting batches receives the queued records in batches of the configured size
+BOOST_AUTO_TEST_CASE(batched_consume)
+{
+    typedef sinks::asynchronous_sink< batching_backend > sink_t;
+    boost::shared_ptr< batching_backend > backend = boost::make_shared< batching_backend >();
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(backend, keywords::start_thread = false, keywords::batch_size = static_cast< unsigned int >(BATCH_SIZE));
+    sink->set_formatter(expr::stream << expr::smessage);
+
+    const std::string expected = consume_records(*sink, RECORD_COUNT);
+    sink->feed_records();
+
+    BOOST_CHECK_EQUAL(backend->m_Messages, expected);
+    BOOST_REQUIRE(!backend->m_BatchSizes.empty());
+    BOOST_CHECK_EQUAL(*std::max_element(backend->m_BatchSizes.begin(), backend->m_BatchSizes.end()), static_cast< std::size_t >(BATCH_SIZE));
+    // All records were queued before feeding, so only the last batch may be incomplete
+    BOOST_CHECK_EQUAL(backend->m_BatchSizes.size(), static_cast< std::size_t >((RECORD_COUNT + BATCH_SIZE - 1) / BATCH_SIZE));
+}
+
+// The test checks that the records of a batch are passed one by one to a backend that does not support batches
+BOOST_AUTO_TEST_CASE(per_record_consume)
+{
+    typedef sinks::asynchronous_sink< collecting_backend > sink_t;
+    boost::shared_ptr< collecting_backend > backend = boost::make_shared< collecting_backend >();
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(backend, keywords::start_thread = false, keywords::batch_size = static_cast< unsigned int >(BATCH_SIZE));
+    sink->set_formatter(expr::stream << expr::smessage);
+
+    const std::string expected = consume_records(*sink, RECORD_COUNT);
+    sink->feed_records();
+
+    BOOST_CHECK_EQUAL(backend->m_Messages, expected);
+}
+
+// The test checks that the feeding thread pool commits the batches to the backend in the queue order if ordered commit is requested
+BOOST_AUTO_TEST_CASE(feeding_pool_ordered_commit)
+{
+    typedef sinks::asynchronous_sink< collecting_backend > sink_t;
+    boost::shared_ptr< collecting_backend > backend = boost::make_shared< collecting_backend >();
+    // The pool is run by the dedicated feeding thread, which flush() and stop() wait for even if it has not started feeding yet
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(backend,
+        keywords::feeding_threads = static_cast< unsigned int >(FEEDING_THREAD_COUNT),
+        keywords::ordered_commit = true,
+        keywords::batch_size = static_cast< unsigned int >(POOL_BATCH_SIZE));
+    sink->set_formatter(&slow_format);
+
+    const std::string expected = consume_records(*sink, POOL_RECORD_COUNT);
+    sink->flush();
+    sink->stop();
+
+    BOOST_CHECK(backend->m_Messages == expected);
+}
+
+// The test checks that an exception thrown by the backend in any thread of the feeding thread pool is rethrown from run()
+BOOST_AUTO_TEST_CASE(feeding_pool_backend_failure)
+{
+    typedef sinks::asynchronous_sink< failing_backend > sink_t;
+    boost::shared_ptr< failing_backend > backend = boost::make_shared< failing_backend >();
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(backend,
+        keywords::start_thread = false,
+        keywords::feeding_threads = static_cast< unsigned int >(FEEDING_THREAD_COUNT),
+        keywords::batch_size = static_cast< unsigned int >(POOL_BATCH_SIZE));
+    sink->set_formatter(expr::stream << expr::smessage);
+
+    // Repeat the failure, so that it likely happens in different threads of the pool
+    for (unsigned int i = 0; i < 10u; ++i)
+    {
+        bool failed = false;
+        boost::thread feeding_thread(boost::bind(&run_sink< sink_t >, boost::ref(*sink), boost::ref(failed)));
+
+        consume_records(*sink, RECORD_COUNT);
+        sink->consume(make_message_record_view("fail"));
+        feeding_thread.join();
+
+        BOOST_REQUIRE(failed);
+    }
+
+    // The pool has been stopped by the failure, the records left in the queue are fed by flush()
+    sink->consume(make_message_record_view("accepted"));
+    sink->flush();
+    BOOST_CHECK(backend->m_Messages.find("accepted\n") != std::string::npos);
+
+    // Without the pool running, the backend exception is rethrown from flush()
+    sink->consume(make_message_record_view("fail"));
+    BOOST_CHECK_THROW(sink->flush(), std::runtime_error);
+}
+
+#endif // !defined(BOOST_LOG_NO_THREADS)
@@ -0,0 +1,501 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   sink_async_queues.cpp
+ * \author Andrey Semashev
+ * \date   19.10.2013
+ *
+ * \brief  This header contains tests for the record queueing strategies of the asynchronous sink frontend.
+ */
+
+#define BOOST_TEST_MODULE sink_async_queues
+
+#include <boost/log/detail/config.hpp>
+
+#if !defined(BOOST_LOG_NO_THREADS)
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <functional>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/log/attributes/counter.hpp>
+#include <boost/log/attributes/constant.hpp>
+#include <boost/log/attributes/attribute_set.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/keywords/order.hpp>
+#include <boost/log/keywords/ordering_window.hpp>
+#include <boost/log/keywords/start_thread.hpp>
+#include <boost/log/keywords/severity_levels.hpp>
+#include <boost/log/keywords/collect_statistics.hpp>
+#include <boost/log/utility/record_ordering.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/sinks/unbounded_fifo_queue.hpp>
+#include <boost/log/sinks/bounded_fifo_queue.hpp>
+#include <boost/log/sinks/bounded_memory_fifo_queue.hpp>
+#include <boost/log/sinks/bounded_severity_fifo_queue.hpp>
+#include <boost/log/sinks/per_thread_fifo_queue.hpp>
+#include <boost/log/sinks/per_thread_ordering_queue.hpp>
+#include <boost/log/sinks/block_on_overflow.hpp>
+#include <boost/log/sinks/drop_on_overflow.hpp>
+#include <boost/log/sinks/wait_strategy.hpp>
+#include <boost/log/sinks/queue_statistics.hpp>
+#include <boost/log/keywords/wait_strategy.hpp>
+#include "consume_records.hpp"
+
+namespace logging = boost::log;
+namespace attrs = logging::attributes;
+namespace sinks = logging::sinks;
+namespace expr = logging::expressions;
+namespace keywords = logging::keywords;
+
+namespace {
+
+enum config
+{
+    THREAD_COUNT = 4,
+    RECORD_COUNT = 1000
+};
+
+//! The backend collects formatted messages
+class collecting_backend :
+    public sinks::basic_formatted_sink_backend< char, sinks::synchronized_feeding >
+{
+public:
+    std::vector< std::string > m_Messages;
+
+    void consume(logging::record_view const&, string_type const& message)
+    {
+        m_Messages.push_back(message);
+    }
+};
+
+//! The backend that takes some time to process every record
+class slow_backend :
+    public sinks::basic_formatted_sink_backend< char, sinks::synchronized_feeding >
+{
+public:
+    void consume(logging::record_view const&, string_type const&)
+    {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+};
+
+//! The user-defined queueing strategy that only implements the members required by the frontend
+class custom_fifo_queue
+{
+private:
+    boost::mutex m_Mutex;
+    std::deque< logging::record_view > m_Queue;
+
+protected:
+    template< typename ArgsT >
+    explicit custom_fifo_queue(ArgsT const&) {}
+
+    void enqueue(logging::record_view const& rec)
+    {
+        boost::lock_guard< boost::mutex > lock(m_Mutex);
+        m_Queue.push_back(rec);
+    }
+    bool try_enqueue(logging::record_view const& rec)
+    {
+        enqueue(rec);
+        return true;
+    }
+    bool try_dequeue_ready(logging::record_view& rec)
+    {
+        boost::lock_guard< boost::mutex > lock(m_Mutex);
+        if (m_Queue.empty())
+            return false;
+        rec = m_Queue.front();
+        m_Queue.pop_front();
+        return true;
+    }
+    bool try_dequeue(logging::record_view& rec)
+    {
+        return try_dequeue_ready(rec);
+    }
+    bool dequeue_ready(logging::record_view& rec)
+    {
+        return try_dequeue_ready(rec);
+    }
+    void interrupt_dequeue() {}
+};
+
+//! Passes messages "<thread> <number>" to the sink
+template< typename SinkT >
+void consume_thread_records(SinkT& sink, unsigned int thread_index)
+{
+    consume_records(sink, RECORD_COUNT, boost::lexical_cast< std::string >(thread_index) + " ");
+}
+
+//! Passes messages "<number>" with the shared counter attribute to the sink
+template< typename SinkT >
+void consume_ordered_records(SinkT& sink, attrs::counter< unsigned int > const& counter)
+{
+    logging::attribute_set record_attrs;
+    record_attrs["RecordID"] = counter;
+    consume_records(sink, RECORD_COUNT, std::string(), record_attrs);
+}
+
+//! Passes the message with the severity level to the sink
+template< typename SinkT >
+void consume_severity_record(SinkT& sink, int level, std::string const& message)
+{
+    logging::attribute_set record_attrs;
+    record_attrs["Severity"] = attrs::constant< int >(level);
+    sink.consume(make_message_record_view(message, record_attrs));
+}
+
+//! Waits until the feeding thread passes the specified number of messages to the backend, returns the number of passed messages
+template< typename SinkT >
+std::size_t wait_for_messages(SinkT& sink, std::size_t count)
+{
+    const boost::system_time deadline = boost::get_system_time() + boost::posix_time::seconds(10);
+    std::size_t delivered = 0;
+    while ((delivered = sink.locked_backend()->m_Messages.size()) < count && boost::get_system_time() < deadline)
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    return delivered;
+}
+
+//! Runs the function in several threads and waits for them to complete
+template< typename FunT >
+void run_threads(FunT const& fun)
+{
+    boost::thread_group group;
+    try
+    {
+        for (unsigned int i = 0; i < THREAD_COUNT; ++i)
+            group.create_thread(boost::bind(fun, i));
+        group.join_all();
+    }
+    catch (...)
+    {
+        group.interrupt_all();
+        group.join_all();
+        throw;
+    }
+}
+
+//! Checks that the feeding thread waiting with the strategy picks up all records without being flushed
+template< typename QueueT >
+void check_wait_strategy(sinks::wait_strategy const& strategy)
+{
+    typedef sinks::asynchronous_sink< collecting_backend, QueueT > sink_t;
+    boost::shared_ptr< collecting_backend > backend = boost::make_shared< collecting_backend >();
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(backend, keywords::wait_strategy = strategy);
+    sink->set_formatter(expr::stream << expr::smessage);
+
+    // Let the feeding thread find the queue empty and start waiting
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    run_threads(boost::bind(&consume_thread_records< sink_t >, boost::ref(*sink), _1));
+
+    const std::size_t delivered = wait_for_messages(*sink, static_cast< std::size_t >(THREAD_COUNT * RECORD_COUNT));
+    sink->stop();
+
+    BOOST_CHECK_EQUAL(delivered, static_cast< std::size_t >(THREAD_COUNT * RECORD_COUNT));
+}
+
+//! Checks the wait strategy with all FIFO queueing strategies
+void check_wait_strategy(sinks::wait_strategy const& strategy)
+{
+    check_wait_strategy< sinks::unbounded_fifo_queue >(strategy);
+    check_wait_strategy< sinks::per_thread_fifo_queue >(strategy);
+    check_wait_strategy< sinks::bounded_fifo_queue< 100u, sinks::block_on_overflow > >(strategy);
+    check_wait_strategy< sinks::bounded_memory_fifo_queue< 16384u, sinks::block_on_overflow > >(strategy);
+    check_wait_strategy< sinks::bounded_severity_fifo_queue< 100u, int, sinks::block_on_overflow > >(strategy);
+}
+
+} // namespace
+
+// The test checks that the feeding thread busy spinning on the empty queue picks up all records
+BOOST_AUTO_TEST_CASE(wait_strategy_spin)
+{
+    check_wait_strategy(sinks::wait_strategy::busy_spin());
+}
+
+// The test checks that the feeding thread yielding between attempts to dequeue records picks up all records
+BOOST_AUTO_TEST_CASE(wait_strategy_yield)
+{
+    check_wait_strategy(sinks::wait_strategy::spin_then_yield(100u));
+}
+
+// The test checks that the blocked feeding thread is woken up by the logging threads
+BOOST_AUTO_TEST_CASE(wait_strategy_block)
+{
+    check_wait_strategy(sinks::wait_strategy::block());
+    check_wait_strategy(sinks::wait_strategy::spin_then_block(100u));
+}
+
+// The test checks that the feeding thread polling the queue periodically picks up all records
+BOOST_AUTO_TEST_CASE(wait_strategy_timed)
+{
+    check_wait_strategy(sinks::wait_strategy::timed_batch(boost::posix_time::milliseconds(10)));
+}
+
+// The test checks that the per-thread FIFO queue delivers all records and preserves the order of records of every thread
+BOOST_AUTO_TEST_CASE(per_thread_fifo_order)
+{
+    typedef sinks::asynchronous_sink< collecting_backend, sinks::per_thread_fifo_queue > sink_t;
+    boost::shared_ptr< collecting_backend > backend = boost::make_shared< collecting_backend >();
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(backend);
+    sink->set_formatter(expr::stream << expr::smessage);
+
+    run_threads(boost::bind(&consume_thread_records< sink_t >, boost::ref(*sink), _1));
+    // The lanes of the terminated threads have to be drained and reclaimed
+    sink->flush();
+    sink->stop();
+
+    BOOST_REQUIRE_EQUAL(backend->m_Messages.size(), static_cast< std::size_t >(THREAD_COUNT * RECORD_COUNT));
+    std::vector< unsigned int > next(THREAD_COUNT, 0u);
+    for (std::size_t i = 0, n = backend->m_Messages.size(); i < n; ++i)
+    {
+        std::string const& message = backend->m_Messages[i];
+        const std::size_t pos = message.find(' ');
+        const unsigned int thread_index = boost::lexical_cast< unsigned int >(message.substr(0, pos));
+        BOOST_REQUIRE_LT(thread_index, static_cast< unsigned int >(THREAD_COUNT));
+        BOOST_REQUIRE_EQUAL(boost::lexical_cast< unsigned int >(message.substr(pos + 1)), next[thread_index]);
+        ++next[thread_index];
+    }
+}
+
+// The test checks that the severity-aware queue evicts lower severity records first and reports the lost records
+BOOST_AUTO_TEST_CASE(bounded_severity_eviction)
+{
+    typedef sinks::asynchronous_sink< collecting_backend, sinks::bounded_severity_fifo_queue< 4, int > > sink_t;
+    boost::shared_ptr< collecting_backend > backend = boost::make_shared< collecting_backend >();
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(backend, keywords::severity_levels = 4u, keywords::start_thread = false);
+    sink->set_formatter(expr::stream << expr::smessage);
+
+    for (unsigned int i = 0; i < 4; ++i)
+        consume_severity_record(*sink, 0, "low " + boost::lexical_cast< std::string >(i));
+    consume_severity_record(*sink, 3, "high 0");
+    consume_severity_record(*sink, 3, "high 1");
+    sink->flush();
+
+    BOOST_REQUIRE_EQUAL(backend->m_Messages.size(), 5u);
+    BOOST_CHECK_EQUAL(backend->m_Messages[0], "Log records lost due to queue overflow: severity 0: 2;");
+    BOOST_CHECK_EQUAL(backend->m_Messages[1], "low 2");
+    BOOST_CHECK_EQUAL(backend->m_Messages[2], "low 3");
+    BOOST_CHECK_EQUAL(backend->m_Messages[3], "high 0");
+    BOOST_CHECK_EQUAL(backend->m_Messages[4], "high 1");
+}
+
+// The test checks that the reserved capacity of a severity level is not taken by other levels
+BOOST_AUTO_TEST_CASE(bounded_severity_reservation)
+{
+    typedef sinks::asynchronous_sink< collecting_backend, sinks::bounded_severity_fifo_queue< 4, int > > sink_t;
+    boost::shared_ptr< collecting_backend > backend = boost::make_shared< collecting_backend >();
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(backend, keywords::severity_levels = 4u, keywords::start_thread = false);
+    sink->set_formatter(expr::stream << expr::smessage);
+    sink->set_reserved_capacity(1, 2u);
+
+    // The higher severity records cannot evict the reserved records of a lower severity level
+    for (unsigned int i = 0; i < 2; ++i)
+        consume_severity_record(*sink, 1, "reserved " + boost::lexical_cast< std::string >(i));
+    for (unsigned int i = 0; i < 3; ++i)
+        consume_severity_record(*sink, 2, "shared " + boost::lexical_cast< std::string >(i));
+    sink->flush();
+
+    BOOST_REQUIRE_EQUAL(backend->m_Messages.size(), 5u);
+    BOOST_CHECK_EQUAL(backend->m_Messages[0], "Log records lost due to queue overflow: severity 2: 1;");
+    BOOST_CHECK_EQUAL(backend->m_Messages[1], "reserved 0");
+    BOOST_CHECK_EQUAL(backend->m_Messages[2], "reserved 1");
+    BOOST_CHECK_EQUAL(backend->m_Messages[3], "shared 0");
+    BOOST_CHECK_EQUAL(backend->m_Messages[4], "shared 1");
+
+    BOOST_CHECK_THROW(sink->set_reserved_capacity(2, 3u), logging::setup_error);
+}
+
+// The test checks that severity levels out of the configured range are mapped to the boundary levels
+BOOST_AUTO_TEST_CASE(bounded_severity_out_of_range)
+{
+    typedef sinks::asynchronous_sink< collecting_backend, sinks::bounded_severity_fifo_queue< 2, int > > sink_t;
+    boost::shared_ptr< collecting_backend > backend = boost::make_shared< collecting_backend >();
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(backend, keywords::severity_levels = 4u, keywords::start_thread = false);
+    sink->set_formatter(expr::stream << expr::smessage);
+
+    consume_severity_record(*sink, -100, "negative");
+    consume_severity_record(*sink, 1000000000, "large");
+    // The record of the highest band evicts the record of the lowest band
+    consume_severity_record(*sink, 3, "highest");
+    sink->flush();
+
+    BOOST_REQUIRE_EQUAL(backend->m_Messages.size(), 3u);
+    BOOST_CHECK_EQUAL(backend->m_Messages[0], "Log records lost due to queue overflow: severity 0: 1;");
+    BOOST_CHECK_EQUAL(backend->m_Messages[1], "large");
+    BOOST_CHECK_EQUAL(backend->m_Messages[2], "highest");
+}
+
+// The test checks that the per-thread ordering queue delivers the records in the order of the record counter
+BOOST_AUTO_TEST_CASE(per_thread_ordering_order)
+{
+    typedef sinks::asynchronous_sink<
+        collecting_backend,
+        sinks::per_thread_ordering_queue< logging::attribute_value_ordering< unsigned int, std::less< unsigned int > > >
+    > sink_t;
+    boost::shared_ptr< collecting_backend > backend = boost::make_shared< collecting_backend >();
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(
+        backend,
+        keywords::order = logging::make_attr_ordering("RecordID", std::less< unsigned int >()),
+        keywords::start_thread = false);
+    sink->set_formatter(expr::stream << expr::attr< unsigned int >("RecordID"));
+
+    attrs::counter< unsigned int > counter;
+    run_threads(boost::bind(&consume_ordered_records< sink_t >, boost::ref(*sink), boost::cref(counter)));
+    sink->flush();
+
+    BOOST_REQUIRE_EQUAL(backend->m_Messages.size(), static_cast< std::size_t >(THREAD_COUNT * RECORD_COUNT));
+    for (std::size_t i = 0, n = backend->m_Messages.size(); i < n; ++i)
+        BOOST_REQUIRE_EQUAL(boost::lexical_cast< unsigned int >(backend->m_Messages[i]), static_cast< unsigned int >(i));
+}
+
+// The test checks that the per-thread ordering queue picks up the records of a lane the feeding thread has found empty before
+BOOST_AUTO_TEST_CASE(per_thread_ordering_parked_lane)
+{
+    typedef sinks::asynchronous_sink<
+        collecting_backend,
+        sinks::per_thread_ordering_queue< logging::attribute_value_ordering< unsigned int, std::less< unsigned int > > >
+    > sink_t;
+    boost::shared_ptr< collecting_backend > backend = boost::make_shared< collecting_backend >();
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(
+        backend,
+        keywords::order = logging::make_attr_ordering("RecordID", std::less< unsigned int >()),
+        keywords::ordering_window = boost::posix_time::milliseconds(1));
+    sink->set_formatter(expr::stream << expr::attr< unsigned int >("RecordID"));
+
+    logging::attribute_set record_attrs;
+    record_attrs["RecordID"] = attrs::counter< unsigned int >();
+    for (unsigned int i = 1; i <= 10u; ++i)
+    {
+        // The feeding thread drains and parks the lane of this thread, the next records must be signalled while the thread is still running
+        consume_records(*sink, 100u, std::string(), record_attrs);
+        BOOST_REQUIRE_EQUAL(wait_for_messages(*sink, i * 100u), static_cast< std::size_t >(i * 100u));
+    }
+    sink->stop();
+
+    for (std::size_t i = 0, n = backend->m_Messages.size(); i < n; ++i)
+        BOOST_REQUIRE_EQUAL(boost::lexical_cast< unsigned int >(backend->m_Messages[i]), static_cast< unsigned int >(i));
+}
+
+// The test checks that the memory-bounded queue limits the size of the queued records rather than their number
+BOOST_AUTO_TEST_CASE(bounded_memory_capacity)
+{
+    typedef sinks::asynchronous_sink< collecting_backend, sinks::bounded_memory_fifo_queue< 16 * 1024, sinks::drop_on_overflow > > sink_t;
+    boost::shared_ptr< collecting_backend > backend = boost::make_shared< collecting_backend >();
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(backend, keywords::start_thread = false);
+    sink->set_formatter(expr::stream << expr::smessage);
+
+    const std::string large(1024, 'x');
+    for (unsigned int i = 0; i < 100; ++i)
+        sink->consume(make_message_record_view(large));
+    // Small records still fit into the queue when large ones don't
+    const std::string small(8, 'y');
+    for (unsigned int i = 0; i < 10; ++i)
+        sink->consume(make_message_record_view(small));
+    sink->flush();
+
+    const std::size_t large_count = std::count(backend->m_Messages.begin(), backend->m_Messages.end(), large);
+    const std::size_t small_count = std::count(backend->m_Messages.begin(), backend->m_Messages.end(), small);
+    // Every large record takes more than 1 KiB, including the attribute values
+    BOOST_CHECK_GT(large_count, 0u);
+    BOOST_CHECK_LT(large_count, 16u);
+    BOOST_CHECK_GT(small_count, 0u);
+    BOOST_CHECK_EQUAL(backend->m_Messages.size(), large_count + small_count);
+    BOOST_CHECK_EQUAL(backend->m_Messages.back(), small);
+}
+
+// The test checks that the statistics account the enqueued, dropped and dequeued records and the queue depth
+BOOST_AUTO_TEST_CASE(statistics_counters)
+{
+    typedef sinks::asynchronous_sink< collecting_backend, sinks::bounded_fifo_queue< 10u, sinks::drop_on_overflow > > sink_t;
+    boost::shared_ptr< collecting_backend > backend = boost::make_shared< collecting_backend >();
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(backend, keywords::start_thread = false, keywords::collect_statistics = true);
+    sink->set_formatter(expr::stream << expr::smessage);
+
+    consume_records(*sink, 25u);
+
+    sinks::queue_statistics stats = sink->get_statistics();
+    BOOST_CHECK_EQUAL(stats.enqueued_count, 25u);
+    BOOST_CHECK_EQUAL(stats.dropped_count, 15u);
+    BOOST_CHECK_EQUAL(stats.dequeued_count, 0u);
+    BOOST_CHECK_EQUAL(stats.depth, 10u);
+    BOOST_CHECK_EQUAL(stats.max_depth, 10u);
+
+    sink->feed_records();
+
+    stats = sink->get_statistics();
+    BOOST_CHECK_EQUAL(backend->m_Messages.size(), 10u);
+    BOOST_CHECK_EQUAL(stats.enqueued_count, 25u);
+    BOOST_CHECK_EQUAL(stats.dropped_count, 15u);
+    BOOST_CHECK_EQUAL(stats.dequeued_count, 10u);
+    BOOST_CHECK_EQUAL(stats.depth, 0u);
+    BOOST_CHECK_EQUAL(stats.max_depth, 10u);
+}
+
+// The test checks that the statistics can be read while the records are being fed and account the blocking and feeding times
+BOOST_AUTO_TEST_CASE(statistics_times)
+{
+    typedef sinks::asynchronous_sink< slow_backend, sinks::bounded_fifo_queue< 10u, sinks::block_on_overflow > > sink_t;
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(boost::make_shared< slow_backend >(), keywords::collect_statistics = true);
+
+    // Let the feeding thread wait for records for a while
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    for (unsigned int i = 0; i < 5u; ++i)
+    {
+        consume_records(*sink, 20u);
+        // The counters are not synchronized with each other, so only the basic relations hold
+        const sinks::queue_statistics stats = sink->get_statistics();
+        BOOST_CHECK_LE(stats.dequeued_count, stats.enqueued_count);
+    }
+    sink->flush();
+    sink->stop();
+
+    const sinks::queue_statistics stats = sink->get_statistics();
+    BOOST_CHECK_EQUAL(stats.enqueued_count, 100u);
+    BOOST_CHECK_EQUAL(stats.dequeued_count, 100u);
+    BOOST_CHECK_EQUAL(stats.dropped_count, 0u);
+    BOOST_CHECK_EQUAL(stats.depth, 0u);
+    BOOST_CHECK_GT(stats.max_depth, 0u);
+    // The backend is slower than the logging thread, so the logging thread had to wait for the queue space
+    BOOST_CHECK(stats.producer_block_time > boost::posix_time::time_duration(0, 0, 0));
+    BOOST_CHECK(stats.feeding_busy_time >= boost::posix_time::milliseconds(100));
+    BOOST_CHECK(stats.feeding_idle_time >= boost::posix_time::milliseconds(10));
+}
+
+// The test checks that the statistics are collected with a queueing strategy that does not maintain overflow statistics
+BOOST_AUTO_TEST_CASE(statistics_custom_queue)
+{
+    typedef sinks::asynchronous_sink< collecting_backend, custom_fifo_queue > sink_t;
+    boost::shared_ptr< collecting_backend > backend = boost::make_shared< collecting_backend >();
+    boost::shared_ptr< sink_t > sink = boost::make_shared< sink_t >(backend, keywords::start_thread = false, keywords::collect_statistics = true);
+    sink->set_formatter(expr::stream << expr::smessage);
+
+    consume_records(*sink, 10u);
+    sink->feed_records();
+
+    const sinks::queue_statistics stats = sink->get_statistics();
+    BOOST_CHECK_EQUAL(backend->m_Messages.size(), 10u);
+    BOOST_CHECK_EQUAL(stats.enqueued_count, 10u);
+    BOOST_CHECK_EQUAL(stats.dequeued_count, 10u);
+    BOOST_CHECK_EQUAL(stats.dropped_count, 0u);
+    BOOST_CHECK_EQUAL(stats.depth, 0u);
+}
+
+#endif // !defined(BOOST_LOG_NO_THREADS)
@@ -0,0 +1,238 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   sink_dispatcher.cpp
+ * \author Andrey Semashev
+ * \date   19.10.2013
+ *
+ * \brief  This header contains tests for the sink dispatchers.
+ */
+
+#define BOOST_TEST_MODULE sink_dispatcher
+
+#include <boost/log/detail/config.hpp>
+
+#if !defined(BOOST_LOG_NO_THREADS) && !defined(BOOST_LOG_NO_ASIO)
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <functional>
+#include <boost/ref.hpp>
+#include <boost/bind.hpp>
+#include <boost/smart_ptr/bad_weak_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/log/attributes/counter.hpp>
+#include <boost/log/attributes/attribute_set.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/keywords/order.hpp>
+#include <boost/log/keywords/dispatcher.hpp>
+#include <boost/log/keywords/ordering_window.hpp>
+#include <boost/log/utility/empty_deleter.hpp>
+#include <boost/log/utility/record_ordering.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/sinks/unbounded_ordering_queue.hpp>
+#include <boost/log/sinks/sink_dispatcher.hpp>
+#include <boost/log/sinks/asio_sink_dispatcher.hpp>
+#include "consume_records.hpp"
+
+namespace logging = boost::log;
+namespace attrs = logging::attributes;
+namespace sinks = logging::sinks;
+namespace expr = logging::expressions;
+namespace keywords = logging::keywords;
+
+namespace {
+
+enum config
+{
+    SINK_COUNT = 8,
+    RECORD_COUNT = 1000
+};
+
+//! The backend counts formatted messages and throws when it receives the "fail" message
+class counting_backend :
+    public sinks::basic_formatted_sink_backend< char, sinks::synchronized_feeding >
+{
+private:
+    mutable boost::mutex m_Mutex;
+    std::vector< std::string > m_Messages;
+
+public:
+    void consume(logging::record_view const&, string_type const& message)
+    {
+        if (message == "fail")
+            throw std::runtime_error("backend failure");
+
+        boost::lock_guard< boost::mutex > lock(m_Mutex);
+        m_Messages.push_back(message);
+    }
+
+    std::size_t count() const
+    {
+        boost::lock_guard< boost::mutex > lock(m_Mutex);
+        return m_Messages.size();
+    }
+
+    std::vector< std::string > messages() const
+    {
+        boost::lock_guard< boost::mutex > lock(m_Mutex);
+        return m_Messages;
+    }
+};
+
+typedef sinks::asynchronous_sink< counting_backend > fifo_sink;
+typedef sinks::asynchronous_sink<
+    counting_backend,
+    sinks::unbounded_ordering_queue< logging::attribute_value_ordering< unsigned int, std::less< unsigned int > > >
+> ordering_sink;
+
+//! Waits until the backend receives the specified number of records, returns \c false on timeout
+bool wait_for_records(counting_backend const& backend, std::size_t count)
+{
+    for (unsigned int i = 0; i < 500u && backend.count() < count; ++i)
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    return backend.count() >= count;
+}
+
+//! Passes every message to all sinks
+void consume_shared_records(std::vector< boost::shared_ptr< fifo_sink > > const& sinks_list, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const logging::record_view rec = make_message_record_view("message " + boost::lexical_cast< std::string >(i));
+        for (std::size_t j = 0, n = sinks_list.size(); j < n; ++j)
+            sinks_list[j]->consume(rec);
+    }
+}
+
+} // namespace
+
+// The test checks that the dispatcher threads feed records of all attached sinks without flushing
+BOOST_AUTO_TEST_CASE(shared_threads)
+{
+    boost::shared_ptr< sinks::sink_dispatcher > dispatcher = boost::make_shared< sinks::sink_dispatcher >(2u);
+    BOOST_CHECK_EQUAL(dispatcher->worker_count(), 2u);
+
+    std::vector< boost::shared_ptr< counting_backend > > backends;
+    std::vector< boost::shared_ptr< fifo_sink > > sinks_list;
+    for (unsigned int i = 0; i < SINK_COUNT; ++i)
+    {
+        backends.push_back(boost::make_shared< counting_backend >());
+        sinks_list.push_back(boost::make_shared< fifo_sink >(backends.back(), keywords::dispatcher = boost::shared_ptr< sinks::sink_dispatcher >(dispatcher)));
+        sinks_list.back()->set_formatter(expr::stream << expr::smessage);
+    }
+
+    boost::thread_group group;
+    group.create_thread(boost::bind(&consume_shared_records, boost::cref(sinks_list), static_cast< unsigned int >(RECORD_COUNT)));
+    group.create_thread(boost::bind(&consume_shared_records, boost::cref(sinks_list), static_cast< unsigned int >(RECORD_COUNT)));
+    group.join_all();
+
+    for (unsigned int i = 0; i < SINK_COUNT; ++i)
+        BOOST_CHECK(wait_for_records(*backends[i], 2u * RECORD_COUNT));
+
+    sinks_list.clear();
+    for (unsigned int i = 0; i < SINK_COUNT; ++i)
+        BOOST_CHECK_EQUAL(backends[i]->count(), static_cast< std::size_t >(2u * RECORD_COUNT));
+}
+
+// The test checks that the dispatcher polls sinks with ordering queues to feed records once the ordering window expires
+BOOST_AUTO_TEST_CASE(polling)
+{
+    boost::shared_ptr< sinks::sink_dispatcher > dispatcher =
+        boost::make_shared< sinks::sink_dispatcher >(1u, boost::posix_time::milliseconds(10));
+
+    boost::shared_ptr< counting_backend > backend = boost::make_shared< counting_backend >();
+    boost::shared_ptr< ordering_sink > sink = boost::make_shared< ordering_sink >(
+        backend,
+        keywords::order = logging::make_attr_ordering("RecordID", std::less< unsigned int >()),
+        keywords::ordering_window = boost::posix_time::milliseconds(50),
+        keywords::dispatcher = boost::shared_ptr< sinks::sink_dispatcher >(dispatcher));
+    sink->set_formatter(expr::stream << expr::attr< unsigned int >("RecordID"));
+
+    logging::attribute_set record_attrs;
+    record_attrs["RecordID"] = attrs::counter< unsigned int >();
+    consume_records(*sink, 10u, "message ", record_attrs);
+
+    // No more records are enqueued, so only polling can pick up the records
+    BOOST_REQUIRE(wait_for_records(*backend, 10u));
+    std::vector< std::string > messages = backend->messages();
+    for (unsigned int i = 0; i < 10u; ++i)
+        BOOST_CHECK_EQUAL(messages[i], boost::lexical_cast< std::string >(i));
+}
+
+// The test checks that a backend failure stops the sink from accepting records and is reported by flush
+BOOST_AUTO_TEST_CASE(backend_failure)
+{
+    boost::shared_ptr< sinks::sink_dispatcher > dispatcher = boost::make_shared< sinks::sink_dispatcher >(1u);
+
+    boost::shared_ptr< counting_backend > backend = boost::make_shared< counting_backend >();
+    boost::shared_ptr< fifo_sink > sink = boost::make_shared< fifo_sink >(backend, keywords::dispatcher = boost::shared_ptr< sinks::sink_dispatcher >(dispatcher));
+    sink->set_formatter(expr::stream << expr::smessage);
+
+    sink->consume(make_message_record_view("fail"));
+
+    // The sink stops accepting records when the dispatcher fails to feed the failing record
+    const logging::record_view probe = make_message_record_view("probe");
+    unsigned int attempts = 0;
+    while (sink->try_consume(probe) && ++attempts < 500u)
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    BOOST_REQUIRE_LT(attempts, 500u);
+
+    BOOST_CHECK_THROW(sink->flush(), std::runtime_error);
+    BOOST_CHECK_EQUAL(backend->count(), 0u);
+
+    // The sink accepts records again after the error has been reported
+    sink->consume(make_message_record_view("accepted"));
+    BOOST_REQUIRE(wait_for_records(*backend, 1u));
+    BOOST_CHECK_EQUAL(backend->messages().back(), "accepted");
+}
+
+// The test checks that the Boost.ASIO dispatcher feeds records in the threads running the io_service
+BOOST_AUTO_TEST_CASE(asio_dispatcher)
+{
+    boost::asio::io_service ios;
+    boost::shared_ptr< sinks::asio_sink_dispatcher > dispatcher =
+        boost::make_shared< sinks::asio_sink_dispatcher >(boost::ref(ios), boost::posix_time::time_duration(boost::posix_time::pos_infin));
+
+    boost::shared_ptr< counting_backend > backend = boost::make_shared< counting_backend >();
+    boost::shared_ptr< fifo_sink > sink = boost::make_shared< fifo_sink >(backend, keywords::dispatcher = boost::shared_ptr< sinks::sink_dispatcher >(dispatcher));
+    sink->set_formatter(expr::stream << expr::smessage);
+
+    consume_records(*sink, RECORD_COUNT);
+
+    // Nothing is fed until the io_service is run
+    BOOST_CHECK_EQUAL(backend->count(), 0u);
+
+    // Polling is disabled, so the io_service runs out of work when all records are fed
+    ios.run();
+    BOOST_CHECK_EQUAL(backend->count(), static_cast< std::size_t >(RECORD_COUNT));
+}
+
+// The test checks that the Boost.ASIO dispatcher has to be owned by a shared_ptr for frontends to attach to it
+BOOST_AUTO_TEST_CASE(asio_dispatcher_ownership)
+{
+    boost::asio::io_service ios;
+    sinks::asio_sink_dispatcher dispatcher(ios);
+    // The pointer does not own the dispatcher as asio_sink_dispatcher
+    boost::shared_ptr< sinks::sink_dispatcher > dispatcher_ptr(static_cast< sinks::sink_dispatcher* >(&dispatcher), logging::empty_deleter());
+
+    boost::shared_ptr< counting_backend > backend = boost::make_shared< counting_backend >();
+    BOOST_CHECK_THROW(fifo_sink(backend, keywords::dispatcher = boost::shared_ptr< sinks::sink_dispatcher >(dispatcher_ptr)), boost::bad_weak_ptr);
+}
+
+#endif // !defined(BOOST_LOG_NO_THREADS) && !defined(BOOST_LOG_NO_ASIO)
@@ -0,0 +1,382 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   sink_file_collector.cpp
+ * \author Andrey Semashev
+ * \date   19.10.2013
+ *
+ * \brief  This header contains tests for the file collector of the text file sink backend.
+ */
+
+#define BOOST_TEST_MODULE sink_file_collector
+
+#include <string>
+#include <fstream>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/keywords/file_name.hpp>
+#include <boost/log/keywords/rotation_size.hpp>
+#include <boost/log/keywords/target.hpp>
+#include <boost/log/keywords/max_size.hpp>
+#include <boost/log/keywords/background_collection.hpp>
+#include <boost/log/keywords/compression_level.hpp>
+#include <boost/log/keywords/manifest.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_file_backend.hpp>
+#include "consume_records.hpp"
+#include "temp_files.hpp"
+
+#if !defined(BOOST_LOG_NO_THREADS) && !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+#include <vector>
+#include <zlib.h>
+#endif
+
+namespace logging = boost::log;
+namespace sinks = logging::sinks;
+namespace expr = logging::expressions;
+namespace keywords = logging::keywords;
+namespace fs = boost::filesystem;
+
+namespace {
+
+typedef sinks::synchronous_sink< sinks::text_file_backend > sync_sink;
+
+enum config
+{
+    RECORD_COUNT = 2000,
+    ROTATION_SIZE = 1000,
+    MAX_SIZE = 5000
+};
+
+//! Returns the number of files in the directory and their total size
+unsigned int count_files(fs::path const& dir, boost::uintmax_t& total_size)
+{
+    unsigned int count = 0;
+    total_size = 0;
+    fs::directory_iterator it(dir), end;
+    for (; it != end; ++it)
+    {
+        ++count;
+        total_size += fs::file_size(it->path());
+    }
+    return count;
+}
+
+//! Writes numbered records to the rotated files in \a log_dir, which are passed to the collector, returns the written records
+std::string write_rotated_files(fs::path const& log_dir, boost::shared_ptr< sinks::file::collector > const& collector)
+{
+    boost::shared_ptr< sinks::text_file_backend > backend = boost::make_shared< sinks::text_file_backend >(
+        keywords::file_name = log_dir / "test_%N.log",
+        keywords::rotation_size = static_cast< unsigned int >(ROTATION_SIZE));
+    backend->set_file_collector(collector);
+
+    boost::shared_ptr< sync_sink > sink = boost::make_shared< sync_sink >(backend);
+    sink->set_formatter(expr::stream << expr::smessage);
+    return consume_records(*sink, RECORD_COUNT);
+}
+
+//! Creates the file that imitates the rotated file left under the temporary name when the application terminated before storing it
+fs::path make_pending_file(fs::path const& log_dir)
+{
+    fs::create_directories(log_dir);
+    const fs::path path = log_dir / "test_3.log.boost_log_pending.0123-4567-89ab-cdef";
+    std::ofstream file(path.string().c_str());
+    file << "pending\n";
+    return path;
+}
+
+} // namespace
+
+// The test checks that the manifest written by the collector is used when the target directory is scanned again, unless the directory is modified
+BOOST_AUTO_TEST_CASE(manifest_reuse)
+{
+    temp_directory dir;
+    const fs::path log_dir = dir.m_Path / "logs", target_dir = dir.m_Path / "target", manifest_path = target_dir / ".boost_log_manifest";
+
+    // Scanning creates the manifest, which is then updated as the files are stored and deleted
+    boost::shared_ptr< sinks::file::collector > collector = sinks::file::make_collector(
+        keywords::target = target_dir,
+        keywords::max_size = static_cast< unsigned int >(MAX_SIZE),
+        keywords::manifest = true);
+    BOOST_CHECK_EQUAL(collector->scan_for_files(sinks::file::scan_all), 0u);
+    write_rotated_files(log_dir, collector);
+    collector.reset();
+
+    const std::string manifest = read_file(manifest_path);
+    BOOST_REQUIRE(!manifest.empty());
+    BOOST_CHECK(manifest.find("\n- ") != std::string::npos);
+
+    boost::uintmax_t total_size = 0;
+    const unsigned int stored_count = count_files(target_dir, total_size) - 1u;
+
+    // The manifest is used as is, if it was rejected the directory would be scanned and the manifest would be rewritten without the records of the deleted files
+    collector = sinks::file::make_collector(
+        keywords::target = target_dir,
+        keywords::max_size = static_cast< unsigned int >(MAX_SIZE),
+        keywords::manifest = true);
+    BOOST_CHECK_EQUAL(collector->scan_for_files(sinks::file::scan_all), stored_count);
+    collector.reset();
+    BOOST_CHECK(read_file(manifest_path) == manifest);
+
+    // Once the directory is modified, the manifest is rebuilt
+    {
+        std::ofstream file((target_dir / "extra.log").string().c_str());
+        file << "extra\n";
+    }
+    collector = sinks::file::make_collector(
+        keywords::target = target_dir,
+        keywords::max_size = static_cast< unsigned int >(MAX_SIZE),
+        keywords::manifest = true);
+    BOOST_CHECK_EQUAL(collector->scan_for_files(sinks::file::scan_all), stored_count + 1u);
+    collector.reset();
+
+    const std::string rebuilt_manifest = read_file(manifest_path);
+    BOOST_CHECK(rebuilt_manifest.find("\n- ") == std::string::npos);
+    BOOST_CHECK(rebuilt_manifest.find(" extra.log\n") != std::string::npos);
+}
+
+// The test checks that the manifest updated right after the directory was modified is not trusted until the collector makes sure the directory was not modified since then
+BOOST_AUTO_TEST_CASE(manifest_granularity)
+{
+    temp_directory dir;
+    const fs::path target_dir = dir.m_Path / "target", manifest_path = target_dir / ".boost_log_manifest";
+
+    // The directory has just been created, so the trailer of the manifest does not record its modification time
+    boost::shared_ptr< sinks::file::collector > collector = sinks::file::make_collector(
+        keywords::target = target_dir,
+        keywords::manifest = true);
+    BOOST_CHECK_EQUAL(collector->scan_for_files(sinks::file::scan_all), 0u);
+    BOOST_CHECK_EQUAL(read_file(manifest_path), "boost_log_manifest 3\n= 0 0\n");
+
+    // The destructor checks the directory contents and records the modification time
+    collector.reset();
+    const std::string manifest = read_file(manifest_path), prefix = "boost_log_manifest 3\n= 0 0\n= 0 ";
+    BOOST_REQUIRE_GT(manifest.size(), prefix.size());
+    BOOST_CHECK(manifest.compare(0u, prefix.size(), prefix) == 0);
+    BOOST_CHECK(manifest[prefix.size()] != '0');
+}
+
+// The test checks that the manifest is removed once the files written to the target directory are stored synchronously
+BOOST_AUTO_TEST_CASE(manifest_synchronous_collection)
+{
+    temp_directory dir;
+    const fs::path manifest_path = dir.m_Path / ".boost_log_manifest";
+
+    boost::shared_ptr< sinks::file::collector > collector = sinks::file::make_collector(
+        keywords::target = dir.m_Path,
+        keywords::max_size = static_cast< unsigned int >(MAX_SIZE),
+        keywords::manifest = true);
+    BOOST_CHECK_EQUAL(collector->scan_for_files(sinks::file::scan_all), 0u);
+    BOOST_CHECK(fs::exists(manifest_path));
+
+    write_rotated_files(dir.m_Path, collector);
+    collector.reset();
+    BOOST_CHECK(!fs::exists(manifest_path));
+}
+
+// The test checks that the files left under temporary names are counted towards the storage limits when the files are stored synchronously
+BOOST_AUTO_TEST_CASE(pending_files_counted)
+{
+    temp_directory dir;
+    const fs::path log_dir = dir.m_Path / "logs", target_dir = dir.m_Path / "target";
+    const fs::path pending_path = make_pending_file(log_dir);
+
+    boost::shared_ptr< sinks::file::collector > collector = sinks::file::make_collector(keywords::target = target_dir);
+    unsigned int counter = 0;
+    BOOST_CHECK_EQUAL(collector->scan_for_files(sinks::file::scan_matching, log_dir / "test_%N.log", &counter), 1u);
+    BOOST_CHECK_EQUAL(counter, 4u);
+
+    // The file is left where it is and is not counted twice
+    BOOST_CHECK_EQUAL(collector->scan_for_files(sinks::file::scan_matching, log_dir / "test_%N.log"), 0u);
+    BOOST_CHECK(fs::exists(pending_path));
+}
+
+#if !defined(BOOST_LOG_NO_THREADS)
+
+namespace {
+
+//! Checks that the files are stored by the background thread of the collector and the storage limits are enforced
+void check_background_collection(fs::path const& log_dir, fs::path const& target_dir)
+{
+    boost::shared_ptr< sinks::file::collector > collector = sinks::file::make_collector(
+        keywords::target = target_dir,
+        keywords::max_size = static_cast< unsigned int >(MAX_SIZE),
+        keywords::background_collection = true);
+    write_rotated_files(log_dir, collector);
+
+    // The destructor waits for the background thread to store the pending files
+    collector.reset();
+
+    boost::uintmax_t total_size = 0;
+    BOOST_CHECK_EQUAL(count_files(log_dir, total_size), 0u);
+
+    const unsigned int stored_count = count_files(target_dir, total_size);
+    BOOST_CHECK_GT(stored_count, 1u);
+    BOOST_CHECK_LE(total_size, static_cast< boost::uintmax_t >(MAX_SIZE));
+
+    // The most recent records are retained
+    const std::string last_record = "record " + boost::lexical_cast< std::string >(RECORD_COUNT - 1) + "\n";
+    bool last_found = false;
+    fs::directory_iterator it(target_dir), end;
+    for (; it != end && !last_found; ++it)
+    {
+        const std::string contents = read_file(it->path());
+        last_found = contents.size() >= last_record.size() && contents.compare(contents.size() - last_record.size(), last_record.size(), last_record) == 0;
+    }
+    BOOST_CHECK(last_found);
+}
+
+} // namespace
+
+// The test checks that the rotated files are stored in the background and the size limit is enforced
+BOOST_AUTO_TEST_CASE(background_collection)
+{
+    temp_directory dir;
+    check_background_collection(dir.m_Path / "logs", dir.m_Path / "target");
+}
+
+// The test checks that the files are moved to the target directory on another file system in the background
+BOOST_AUTO_TEST_CASE(background_collection_cross_device)
+{
+    // Use a memory file system for the log files, if available, so that the files cannot be renamed to the target directory
+    const fs::path shm_dir("/dev/shm");
+    boost::system::error_code ec;
+    if (!fs::is_directory(shm_dir, ec))
+    {
+        BOOST_TEST_MESSAGE("Memory file system is not available, the test is skipped");
+        return;
+    }
+
+    temp_directory log_dir(shm_dir), target_dir;
+    check_background_collection(log_dir.m_Path, target_dir.m_Path);
+}
+
+// The test checks that the manifest is removed once the files written to the target directory are stored in the background
+BOOST_AUTO_TEST_CASE(manifest_background_collection)
+{
+    temp_directory dir;
+    const fs::path manifest_path = dir.m_Path / ".boost_log_manifest";
+
+    boost::shared_ptr< sinks::file::collector > collector = sinks::file::make_collector(
+        keywords::target = dir.m_Path,
+        keywords::max_size = static_cast< unsigned int >(MAX_SIZE),
+        keywords::background_collection = true,
+        keywords::manifest = true);
+    BOOST_CHECK_EQUAL(collector->scan_for_files(sinks::file::scan_all), 0u);
+    BOOST_CHECK(fs::exists(manifest_path));
+
+    write_rotated_files(dir.m_Path, collector);
+    collector.reset();
+    BOOST_CHECK(!fs::exists(manifest_path));
+
+    // The files are found by scanning the directory
+    boost::uintmax_t total_size = 0;
+    const unsigned int stored_count = count_files(dir.m_Path, total_size);
+    collector = sinks::file::make_collector(
+        keywords::target = dir.m_Path,
+        keywords::max_size = static_cast< unsigned int >(MAX_SIZE),
+        keywords::manifest = true);
+    BOOST_CHECK_EQUAL(collector->scan_for_files(sinks::file::scan_all), stored_count);
+}
+
+// The test checks that the background thread stores the files left under temporary names once they are found by scanning
+BOOST_AUTO_TEST_CASE(pending_files_stored)
+{
+    temp_directory dir;
+    const fs::path log_dir = dir.m_Path / "logs", target_dir = dir.m_Path / "target";
+    const fs::path pending_path = make_pending_file(log_dir);
+
+    boost::shared_ptr< sinks::file::collector > collector = sinks::file::make_collector(
+        keywords::target = target_dir,
+        keywords::background_collection = true);
+    unsigned int counter = 0;
+    BOOST_CHECK_EQUAL(collector->scan_for_files(sinks::file::scan_matching, log_dir / "test_%N.log", &counter), 1u);
+    BOOST_CHECK_EQUAL(counter, 4u);
+
+    // The destructor waits for the background thread to store the pending files
+    collector.reset();
+    BOOST_CHECK(!fs::exists(pending_path));
+    BOOST_CHECK_EQUAL(read_file(target_dir / "test_3.log"), "pending\n");
+}
+
+#if !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+
+namespace {
+
+//! Reads and decompresses the whole gzip file
+std::string read_compressed_file(fs::path const& path)
+{
+    std::string contents;
+    gzFile file = gzopen(path.string().c_str(), "rb");
+    BOOST_REQUIRE(file != NULL);
+    std::vector< char > buffer(4096u);
+    int size;
+    while ((size = gzread(file, &buffer[0], static_cast< unsigned int >(buffer.size()))) > 0)
+        contents.append(&buffer[0], static_cast< std::size_t >(size));
+    gzclose(file);
+    BOOST_CHECK_EQUAL(size, 0);
+    return contents;
+}
+
+} // namespace
+
+// The test checks that the stored files are compressed and the sizes of the compressed files are accounted when scanning the target directory
+BOOST_AUTO_TEST_CASE(compression_round_trip)
+{
+    temp_directory dir;
+    const fs::path log_dir = dir.m_Path / "logs", target_dir = dir.m_Path / "target";
+
+    boost::shared_ptr< sinks::file::collector > collector = sinks::file::make_collector(
+        keywords::target = target_dir,
+        keywords::compression_level = 6);
+    const std::string expected = write_rotated_files(log_dir, collector);
+    collector.reset();
+
+    // The files are compressed in the background thread, which has finished by now
+    boost::uintmax_t compressed_size = 0;
+    const unsigned int stored_count = count_files(target_dir, compressed_size);
+    BOOST_REQUIRE_GT(stored_count, 1u);
+    BOOST_CHECK_LT(compressed_size, static_cast< boost::uintmax_t >(expected.size()));
+
+    std::string written;
+    unsigned int file_count = 0;
+    for (; fs::exists(target_dir / ("test_" + boost::lexical_cast< std::string >(file_count) + ".log.gz")); ++file_count)
+        written += read_compressed_file(target_dir / ("test_" + boost::lexical_cast< std::string >(file_count) + ".log.gz"));
+    BOOST_CHECK_EQUAL(file_count, stored_count);
+    BOOST_CHECK(written == expected);
+
+    // The limit is only exceeded by the new file if the scanned files are accounted with their compressed sizes.
+    // Then storing the small file removes a single old file.
+    collector = sinks::file::make_collector(
+        keywords::target = target_dir,
+        keywords::max_size = compressed_size - 1u,
+        keywords::compression_level = 6);
+    BOOST_CHECK_EQUAL(collector->scan_for_files(sinks::file::scan_all), stored_count);
+
+    {
+        std::ofstream file((log_dir / "extra.log").string().c_str());
+        file << "extra\n";
+    }
+    collector->store_file(log_dir / "extra.log");
+    collector.reset();
+
+    boost::uintmax_t total_size = 0;
+    BOOST_CHECK_EQUAL(count_files(target_dir, total_size), stored_count);
+    BOOST_CHECK_LT(total_size, compressed_size);
+    BOOST_REQUIRE(fs::exists(target_dir / "extra.log.gz"));
+    BOOST_CHECK_EQUAL(read_compressed_file(target_dir / "extra.log.gz"), "extra\n");
+}
+
+#endif // !defined(BOOST_LOG_WITHOUT_COMPRESSION)
+
+#endif // !defined(BOOST_LOG_NO_THREADS)
@@ -0,0 +1,575 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   sink_syslog.cpp
+ * \author Andrey Semashev
+ * \date   19.10.2013
+ *
+ * \brief  This header contains tests for the socket based transports of the syslog sink backend.
+ */
+
+#define BOOST_TEST_MODULE sink_syslog
+
+#include <boost/log/detail/config.hpp>
+
+#if !defined(BOOST_LOG_WITHOUT_SYSLOG) && !defined(BOOST_LOG_NO_ASIO) && !defined(BOOST_LOG_NO_THREADS)
+
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ip/address.hpp>
+#if defined(BOOST_LOG_USE_NATIVE_SYSLOG)
+#include <boost/asio/local/datagram_protocol.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+#endif
+#include <boost/date_time/c_time.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/date_time/posix_time/time_parsers.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/attributes/constant.hpp>
+#include <boost/log/attributes/attribute_set.hpp>
+#include <boost/log/keywords/batch_size.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/syslog_backend.hpp>
+#include <boost/log/detail/snprintf.hpp>
+#include "consume_records.hpp"
+#if defined(BOOST_LOG_USE_NATIVE_SYSLOG)
+#include "temp_files.hpp"
+#endif
+
+namespace logging = boost::log;
+namespace sinks = logging::sinks;
+namespace expr = logging::expressions;
+namespace keywords = logging::keywords;
+namespace asio = boost::asio;
+
+namespace {
+
+typedef sinks::synchronous_sink< sinks::syslog_backend > sync_sink;
+typedef sinks::asynchronous_sink< sinks::syslog_backend > async_sink;
+
+//! Creates the synchronous sink that sends messages through the backend
+boost::shared_ptr< sync_sink > make_sync_sink(boost::shared_ptr< sinks::syslog_backend > const& backend)
+{
+    boost::shared_ptr< sync_sink > sink = boost::make_shared< sync_sink >(backend);
+    sink->set_formatter(expr::stream << expr::smessage);
+    return sink;
+}
+
+//! Creates the asynchronous sink that sends messages through the backend in batches
+boost::shared_ptr< async_sink > make_async_sink(boost::shared_ptr< sinks::syslog_backend > const& backend, unsigned int batch_size)
+{
+    boost::shared_ptr< async_sink > sink = boost::make_shared< async_sink >(backend, keywords::batch_size = batch_size);
+    sink->set_formatter(expr::stream << expr::smessage);
+    return sink;
+}
+
+//! Receives the datagrams available on the socket, waiting for \a count datagrams no longer than \a timeout
+template< typename SocketT >
+std::vector< std::string > receive_datagrams(SocketT& socket, std::size_t count, boost::posix_time::time_duration const& timeout = boost::posix_time::seconds(5))
+{
+    std::vector< std::string > datagrams;
+    std::vector< char > buffer(65536u);
+    const boost::posix_time::ptime deadline = boost::posix_time::microsec_clock::universal_time() + timeout;
+    while (datagrams.size() < count)
+    {
+        if (socket.available() > 0u)
+        {
+            const std::size_t size = socket.receive(asio::buffer(buffer));
+            datagrams.push_back(std::string(&buffer[0], size));
+        }
+        else if (boost::posix_time::microsec_clock::universal_time() < deadline)
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        else
+            break;
+    }
+    return datagrams;
+}
+
+//! Receives octet counting frames from the connection, waiting for \a count frames no longer than \a timeout
+std::vector< std::string > receive_frames(asio::ip::tcp::socket& socket, std::size_t count, boost::posix_time::time_duration const& timeout = boost::posix_time::seconds(5))
+{
+    std::vector< std::string > frames;
+    std::string data;
+    std::vector< char > buffer(65536u);
+    const boost::posix_time::ptime deadline = boost::posix_time::microsec_clock::universal_time() + timeout;
+    while (frames.size() < count)
+    {
+        // Frame: MSG-LEN SP SYSLOG-MSG
+        const std::string::size_type space = data.find(' ');
+        if (space != std::string::npos)
+        {
+            const std::size_t size = static_cast< std::size_t >(std::strtoul(data.c_str(), NULL, 10));
+            if (data.size() >= space + 1u + size)
+            {
+                frames.push_back(data.substr(space + 1u, size));
+                data.erase(0u, space + 1u + size);
+                continue;
+            }
+        }
+
+        if (socket.available() > 0u)
+        {
+            const std::size_t size = socket.read_some(asio::buffer(buffer));
+            data.append(&buffer[0], size);
+        }
+        else if (boost::posix_time::microsec_clock::universal_time() < deadline)
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        else
+            break;
+    }
+    return frames;
+}
+
+//! Checks that the packet ends with the message
+bool ends_with(std::string const& packet, std::string const& message)
+{
+    return packet.size() > message.size() &&
+        packet.compare(packet.size() - message.size(), message.size(), message) == 0;
+}
+
+//! Checks that the packet contains the message after the header
+bool check_packet(std::string const& packet, std::string const& message)
+{
+    return packet.compare(0, 4u, "<14>") == 0 && ends_with(packet, message);
+}
+
+//! Passes a record with the message "level <level>" for every syslog level to the sink
+template< typename SinkT >
+void consume_levels(SinkT& sink)
+{
+    for (unsigned int i = 0; i < 8u; ++i)
+    {
+        logging::attribute_set attrs;
+        attrs["Severity"] = logging::attributes::constant< int >(static_cast< int >(i));
+        sink.consume(make_message_record_view("level " + boost::lexical_cast< std::string >(i), attrs));
+    }
+}
+
+//! Waits until the system clock, which has one second precision, advances by at least the specified number of seconds
+void wait_seconds(std::time_t seconds)
+{
+    const std::time_t start = std::time(NULL);
+    while (std::time(NULL) - start <= seconds)
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+}
+
+//! Renders the RFC 3164 time stamp of the current local time
+std::string rfc3164_time_stamp()
+{
+    static const char months[12][4] =
+    {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+    };
+
+    const std::time_t t = std::time(NULL);
+    std::tm ts;
+    std::tm* time_stamp = boost::date_time::c_time::localtime(&t, &ts);
+    char buf[32];
+    const int size = logging::aux::snprintf(buf, sizeof(buf), "%s % 2d %02d:%02d:%02d ",
+        months[time_stamp->tm_mon], time_stamp->tm_mday, time_stamp->tm_hour, time_stamp->tm_min, time_stamp->tm_sec);
+    return std::string(buf, static_cast< std::size_t >(size));
+}
+
+} // namespace
+
+// The test checks that the UDP transport sends every record in a separate datagram, both with and without batching
+BOOST_AUTO_TEST_CASE(udp_batching)
+{
+    asio::io_service ios;
+    asio::ip::udp::socket server(ios, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+    server.set_option(asio::socket_base::receive_buffer_size(1024 * 1024));
+
+    boost::shared_ptr< sinks::syslog_backend > backend = boost::make_shared< sinks::syslog_backend >(
+        keywords::use_impl = sinks::syslog::udp_socket_based);
+    backend->set_target_address(asio::ip::address_v4::loopback(), server.local_endpoint().port());
+    boost::shared_ptr< sync_sink > sink = make_sync_sink(backend);
+
+    consume_records(*sink, 10u);
+    std::vector< std::string > packets = receive_datagrams(server, 10u);
+    BOOST_REQUIRE_EQUAL(packets.size(), 10u);
+    for (unsigned int i = 0; i < 10u; ++i)
+        BOOST_CHECK(check_packet(packets[i], "record " + boost::lexical_cast< std::string >(i)));
+
+    // The batch is sent when it is full, the rest is sent on flushing
+    backend->set_batch_size(16u);
+    consume_records(*sink, 40u, "batched ");
+    packets = receive_datagrams(server, 40u, boost::posix_time::milliseconds(200));
+    BOOST_CHECK_EQUAL(packets.size(), 32u);
+
+    backend->flush();
+    std::vector< std::string > rest = receive_datagrams(server, 8u);
+    packets.insert(packets.end(), rest.begin(), rest.end());
+    BOOST_REQUIRE_EQUAL(packets.size(), 40u);
+    for (unsigned int i = 0; i < 40u; ++i)
+        BOOST_CHECK(check_packet(packets[i], "batched " + boost::lexical_cast< std::string >(i)));
+
+    // Batches larger than a single system call can send are sent in several calls
+    backend->set_batch_size(200u);
+    consume_records(*sink, 200u, "large batch ");
+    packets = receive_datagrams(server, 200u);
+    BOOST_REQUIRE_EQUAL(packets.size(), 200u);
+    for (unsigned int i = 0; i < 200u; ++i)
+        BOOST_CHECK(check_packet(packets[i], "large batch " + boost::lexical_cast< std::string >(i)));
+}
+
+// The test checks that the UDP transport sends the accumulated datagrams before switching to a new local address
+BOOST_AUTO_TEST_CASE(udp_local_address)
+{
+    asio::io_service ios;
+    asio::ip::udp::socket server(ios, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+
+    boost::shared_ptr< sinks::syslog_backend > backend = boost::make_shared< sinks::syslog_backend >(
+        keywords::use_impl = sinks::syslog::udp_socket_based);
+    backend->set_target_address(asio::ip::address_v4::loopback(), server.local_endpoint().port());
+    backend->set_batch_size(16u);
+    boost::shared_ptr< sync_sink > sink = make_sync_sink(backend);
+
+    consume_records(*sink, 4u);
+    backend->set_local_address(asio::ip::address_v4::loopback(), 0);
+    std::vector< std::string > packets = receive_datagrams(server, 4u);
+    BOOST_REQUIRE_EQUAL(packets.size(), 4u);
+    for (unsigned int i = 0; i < 4u; ++i)
+        BOOST_CHECK(check_packet(packets[i], "record " + boost::lexical_cast< std::string >(i)));
+
+    // The following records are sent from the new socket
+    consume_records(*sink, 4u, "rebound ");
+    backend->flush();
+    packets = receive_datagrams(server, 4u);
+    BOOST_REQUIRE_EQUAL(packets.size(), 4u);
+    for (unsigned int i = 0; i < 4u; ++i)
+        BOOST_CHECK(check_packet(packets[i], "rebound " + boost::lexical_cast< std::string >(i)));
+}
+
+// The test checks that the UDP transport sends the accumulated datagrams when the asynchronous frontend becomes idle
+BOOST_AUTO_TEST_CASE(udp_idle)
+{
+    asio::io_service ios;
+    asio::ip::udp::socket server(ios, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+
+    boost::shared_ptr< sinks::syslog_backend > backend = boost::make_shared< sinks::syslog_backend >(
+        keywords::use_impl = sinks::syslog::udp_socket_based);
+    backend->set_target_address(asio::ip::address_v4::loopback(), server.local_endpoint().port());
+    backend->set_batch_size(64u);
+    boost::shared_ptr< async_sink > sink = make_async_sink(backend, 16u);
+
+    // The batch is never full, the datagrams are sent when the frontend drains its queue
+    consume_records(*sink, 10u);
+    std::vector< std::string > packets = receive_datagrams(server, 10u);
+    BOOST_REQUIRE_EQUAL(packets.size(), 10u);
+    for (unsigned int i = 0; i < 10u; ++i)
+        BOOST_CHECK(check_packet(packets[i], "record " + boost::lexical_cast< std::string >(i)));
+    sink->stop();
+}
+
+// The test checks that the TCP transport sends RFC 5424 messages with octet counting framing
+BOOST_AUTO_TEST_CASE(tcp_framing)
+{
+    asio::io_service ios;
+    asio::ip::tcp::acceptor acceptor(ios, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+
+    boost::shared_ptr< sinks::syslog_backend > backend = boost::make_shared< sinks::syslog_backend >(
+        keywords::use_impl = sinks::syslog::tcp_socket_based,
+        keywords::ident = "test");
+    backend->set_target_address(asio::ip::address_v4::loopback(), acceptor.local_endpoint().port());
+    backend->set_batch_size(4u);
+    boost::shared_ptr< sync_sink > sink = make_sync_sink(backend);
+
+    // The records are kept until the connection is established
+    consume_records(*sink, 10u);
+    backend->flush();
+
+    asio::ip::tcp::socket connection(ios);
+    acceptor.accept(connection);
+    std::vector< std::string > frames = receive_frames(connection, 10u);
+    BOOST_REQUIRE_EQUAL(frames.size(), 10u);
+    for (unsigned int i = 0; i < 10u; ++i)
+    {
+        BOOST_CHECK(check_packet(frames[i], " - - record " + boost::lexical_cast< std::string >(i)));
+        BOOST_CHECK(frames[i].compare(4u, 2u, "1 ") == 0);
+        BOOST_CHECK(frames[i].find(" test ") != std::string::npos);
+    }
+
+    // Messages with spaces and of any length are framed by their length
+    const std::string large(100000u, 'x');
+    sink->consume(make_message_record_view(large));
+    backend->flush();
+    frames = receive_frames(connection, 1u);
+    BOOST_REQUIRE_EQUAL(frames.size(), 1u);
+    BOOST_CHECK(check_packet(frames[0], large));
+}
+
+// The test checks that the RFC 3164 header contains the priority of the record level and the current time stamp, which changes every second
+BOOST_AUTO_TEST_CASE(udp_header)
+{
+    asio::io_service ios;
+    asio::ip::udp::socket server(ios, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+
+    boost::shared_ptr< sinks::syslog_backend > backend = boost::make_shared< sinks::syslog_backend >(
+        keywords::use_impl = sinks::syslog::udp_socket_based);
+    backend->set_target_address(asio::ip::address_v4::loopback(), server.local_endpoint().port());
+    backend->set_severity_mapper(sinks::syslog::direct_severity_mapping< int >("Severity"));
+    boost::shared_ptr< sync_sink > sink = make_sync_sink(backend);
+
+    // The priority is the user facility (8) combined with the level
+    consume_levels(*sink);
+    std::vector< std::string > packets = receive_datagrams(server, 8u);
+    BOOST_REQUIRE_EQUAL(packets.size(), 8u);
+    for (unsigned int i = 0; i < 8u; ++i)
+    {
+        const std::string priority = "<" + boost::lexical_cast< std::string >(8u + i) + "> ";
+        BOOST_CHECK_EQUAL(packets[i].substr(0u, priority.size()), priority);
+        BOOST_CHECK(ends_with(packets[i], " level " + boost::lexical_cast< std::string >(i)));
+    }
+
+    // Start at the beginning of a second, so that the clock does not advance before the record is sent
+    wait_seconds(0);
+    std::string time_stamp = rfc3164_time_stamp();
+    consume_records(*sink, 1u);
+    packets = receive_datagrams(server, 1u);
+    BOOST_REQUIRE_EQUAL(packets.size(), 1u);
+    BOOST_CHECK_EQUAL(packets[0].substr(0u, 5u + time_stamp.size()), "<14> " + time_stamp);
+
+    // The cached time stamp is updated in the next second
+    wait_seconds(0);
+    const std::string next_time_stamp = rfc3164_time_stamp();
+    BOOST_CHECK_NE(next_time_stamp, time_stamp);
+    consume_records(*sink, 1u);
+    packets = receive_datagrams(server, 1u);
+    BOOST_REQUIRE_EQUAL(packets.size(), 1u);
+    BOOST_CHECK_EQUAL(packets[0].substr(0u, 5u + next_time_stamp.size()), "<14> " + next_time_stamp);
+}
+
+// The test checks that the RFC 5424 header contains the priority of the record level and the current time stamp with microseconds
+BOOST_AUTO_TEST_CASE(tcp_header)
+{
+    asio::io_service ios;
+    asio::ip::tcp::acceptor acceptor(ios, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+
+    boost::shared_ptr< sinks::syslog_backend > backend = boost::make_shared< sinks::syslog_backend >(
+        keywords::use_impl = sinks::syslog::tcp_socket_based);
+    backend->set_target_address(asio::ip::address_v4::loopback(), acceptor.local_endpoint().port());
+    backend->set_severity_mapper(sinks::syslog::direct_severity_mapping< int >("Severity"));
+    boost::shared_ptr< sync_sink > sink = make_sync_sink(backend);
+
+    consume_levels(*sink);
+    backend->flush();
+
+    asio::ip::tcp::socket connection(ios);
+    acceptor.accept(connection);
+    std::vector< std::string > frames = receive_frames(connection, 8u);
+    BOOST_REQUIRE_EQUAL(frames.size(), 8u);
+    for (unsigned int i = 0; i < 8u; ++i)
+    {
+        const std::string priority = "<" + boost::lexical_cast< std::string >(8u + i) + ">1 ";
+        BOOST_CHECK_EQUAL(frames[i].substr(0u, priority.size()), priority);
+        BOOST_CHECK(ends_with(frames[i], " - - level " + boost::lexical_cast< std::string >(i)));
+    }
+
+    // The records are sent a few milliseconds apart, so that most of them share the cached part of the time stamp.
+    // The time stamp is rendered when the record is sent, in UTC: YYYY-MM-DDThh:mm:ss.ffffffZ
+    enum { record_count = 20 };
+    boost::posix_time::ptime before_send[record_count], after_send[record_count];
+    for (unsigned int i = 0; i < record_count; ++i)
+    {
+        before_send[i] = boost::posix_time::microsec_clock::universal_time();
+        sink->consume(make_message_record_view("record " + boost::lexical_cast< std::string >(i)));
+        after_send[i] = boost::posix_time::microsec_clock::universal_time();
+        boost::this_thread::sleep(boost::posix_time::milliseconds(3));
+    }
+    backend->flush();
+
+    frames = receive_frames(connection, record_count);
+    BOOST_REQUIRE_EQUAL(frames.size(), static_cast< std::size_t >(record_count));
+    const std::size_t time_stamp_pos = sizeof("<14>1 ") - 1u, time_stamp_size = sizeof("YYYY-MM-DDThh:mm:ss.ffffff") - 1u;
+    for (unsigned int i = 0; i < record_count; ++i)
+    {
+        BOOST_TEST_CHECKPOINT("Frame: \"" << frames[i] << "\"");
+        BOOST_REQUIRE_GT(frames[i].size(), time_stamp_pos + time_stamp_size + 1u);
+        BOOST_CHECK_EQUAL(frames[i].substr(time_stamp_pos + time_stamp_size, 2u), "Z ");
+        const boost::posix_time::ptime time_stamp = boost::posix_time::from_iso_extended_string(frames[i].substr(time_stamp_pos, time_stamp_size));
+        BOOST_CHECK(time_stamp >= before_send[i]);
+        BOOST_CHECK(time_stamp <= after_send[i]);
+    }
+}
+
+// The test checks that flushing and destroying the backend does not block for longer than the flush timeout
+BOOST_AUTO_TEST_CASE(tcp_flush_timeout)
+{
+    asio::io_service ios;
+    asio::ip::tcp::acceptor acceptor(ios, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+
+    boost::shared_ptr< sinks::syslog_backend > backend = boost::make_shared< sinks::syslog_backend >(
+        keywords::use_impl = sinks::syslog::tcp_socket_based);
+    backend->set_target_address(asio::ip::address_v4::loopback(), acceptor.local_endpoint().port());
+    backend->set_max_backlog_size(64u * 1024u * 1024u);
+    backend->set_flush_timeout(boost::posix_time::milliseconds(200));
+    {
+        boost::shared_ptr< sync_sink > sink = make_sync_sink(backend);
+
+        // The server never reads, so the messages cannot be sent entirely
+        const logging::record_view rec = make_message_record_view(std::string(1000u, 'x'));
+        for (unsigned int i = 0; i < 20000u; ++i)
+            sink->consume(rec);
+    }
+
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    backend->flush();
+    BOOST_CHECK_LT((boost::posix_time::microsec_clock::universal_time() - start).total_milliseconds(), 2000);
+
+    start = boost::posix_time::microsec_clock::universal_time();
+    backend.reset();
+    BOOST_CHECK_LT((boost::posix_time::microsec_clock::universal_time() - start).total_milliseconds(), 2000);
+}
+
+#if defined(BOOST_LOG_USE_NATIVE_SYSLOG)
+
+namespace {
+
+//! Local datagram sockets block the sender when the receiver queue is full (10 datagrams by default on Linux), so the tests keep fewer datagrams unread
+enum { LOCAL_RECORD_COUNT = 8 };
+
+//! The local datagram socket that plays the role of the syslog daemon
+struct local_server
+{
+    asio::io_service m_IOService;
+    boost::filesystem::path m_Path;
+    asio::local::datagram_protocol::socket m_Socket;
+
+    local_server() :
+        m_Path(make_temp_path()),
+        m_Socket(m_IOService)
+    {
+        bind();
+    }
+    ~local_server()
+    {
+        boost::system::error_code err;
+        m_Socket.close(err);
+        boost::filesystem::remove(m_Path, err);
+    }
+
+    //! Closes the socket and binds a new one to the same path, like a restarted syslog daemon does
+    void restart()
+    {
+        m_Socket.close();
+        boost::filesystem::remove(m_Path);
+        bind();
+    }
+
+private:
+    void bind()
+    {
+        m_Socket.open(asio::local::datagram_protocol());
+        m_Socket.bind(asio::local::datagram_protocol::endpoint(m_Path.string()));
+    }
+};
+
+} // namespace
+
+// The test checks that the local socket transport sends every record in a separate datagram in the format of the native syslog API
+BOOST_AUTO_TEST_CASE(local_socket)
+{
+    local_server server;
+
+    boost::shared_ptr< sinks::syslog_backend > backend = boost::make_shared< sinks::syslog_backend >(
+        keywords::use_impl = sinks::syslog::local_socket_based,
+        keywords::ident = "test");
+    backend->set_target_socket(server.m_Path.string());
+    boost::shared_ptr< sync_sink > sink = make_sync_sink(backend);
+
+    consume_records(*sink, LOCAL_RECORD_COUNT);
+    std::vector< std::string > packets = receive_datagrams(server.m_Socket, LOCAL_RECORD_COUNT);
+    BOOST_REQUIRE_EQUAL(packets.size(), static_cast< std::size_t >(LOCAL_RECORD_COUNT));
+    for (unsigned int i = 0; i < LOCAL_RECORD_COUNT; ++i)
+        BOOST_CHECK(check_packet(packets[i], "test: record " + boost::lexical_cast< std::string >(i)));
+
+    // The batch is sent when it is full, the rest is sent on flushing
+    backend->set_batch_size(4u);
+    consume_records(*sink, 6u, "batched ");
+    packets = receive_datagrams(server.m_Socket, 6u, boost::posix_time::milliseconds(200));
+    BOOST_CHECK_EQUAL(packets.size(), 4u);
+
+    backend->flush();
+    std::vector< std::string > rest = receive_datagrams(server.m_Socket, 2u);
+    packets.insert(packets.end(), rest.begin(), rest.end());
+    BOOST_REQUIRE_EQUAL(packets.size(), 6u);
+    for (unsigned int i = 0; i < 6u; ++i)
+        BOOST_CHECK(check_packet(packets[i], "test: batched " + boost::lexical_cast< std::string >(i)));
+}
+
+// The test checks that the local socket transport reconnects when the syslog daemon is restarted
+BOOST_AUTO_TEST_CASE(local_socket_reconnect)
+{
+    local_server server;
+
+    boost::shared_ptr< sinks::syslog_backend > backend = boost::make_shared< sinks::syslog_backend >(
+        keywords::use_impl = sinks::syslog::local_socket_based,
+        keywords::ident = "test");
+    backend->set_target_socket(server.m_Path.string());
+    boost::shared_ptr< sync_sink > sink = make_sync_sink(backend);
+
+    consume_records(*sink, 1u, "before restart ");
+    std::vector< std::string > packets = receive_datagrams(server.m_Socket, 1u);
+    BOOST_REQUIRE_EQUAL(packets.size(), 1u);
+    BOOST_CHECK(check_packet(packets[0], "test: before restart 0"));
+
+    server.restart();
+
+    consume_records(*sink, 1u, "after restart ");
+    packets = receive_datagrams(server.m_Socket, 1u);
+    BOOST_REQUIRE_EQUAL(packets.size(), 1u);
+    BOOST_CHECK(check_packet(packets[0], "test: after restart 0"));
+
+    // Batched packets are resent to the new socket as well
+    backend->set_batch_size(4u);
+    server.restart();
+
+    consume_records(*sink, 4u, "batch after restart ");
+    packets = receive_datagrams(server.m_Socket, 4u);
+    BOOST_REQUIRE_EQUAL(packets.size(), 4u);
+    for (unsigned int i = 0; i < 4u; ++i)
+        BOOST_CHECK(check_packet(packets[i], "test: batch after restart " + boost::lexical_cast< std::string >(i)));
+}
+
+// The test checks that the local socket transport sends the accumulated datagrams when the asynchronous frontend becomes idle
+BOOST_AUTO_TEST_CASE(local_socket_idle)
+{
+    local_server server;
+
+    boost::shared_ptr< sinks::syslog_backend > backend = boost::make_shared< sinks::syslog_backend >(
+        keywords::use_impl = sinks::syslog::local_socket_based,
+        keywords::ident = "test");
+    backend->set_target_socket(server.m_Path.string());
+    backend->set_batch_size(64u);
+    boost::shared_ptr< async_sink > sink = make_async_sink(backend, 16u);
+
+    // The batch is never full, the datagrams are sent when the frontend drains its queue
+    consume_records(*sink, LOCAL_RECORD_COUNT);
+    std::vector< std::string > packets = receive_datagrams(server.m_Socket, LOCAL_RECORD_COUNT);
+    BOOST_REQUIRE_EQUAL(packets.size(), static_cast< std::size_t >(LOCAL_RECORD_COUNT));
+    for (unsigned int i = 0; i < LOCAL_RECORD_COUNT; ++i)
+        BOOST_CHECK(check_packet(packets[i], "test: record " + boost::lexical_cast< std::string >(i)));
+    sink->stop();
+}
+
+#endif // defined(BOOST_LOG_USE_NATIVE_SYSLOG)
+
+#endif // !defined(BOOST_LOG_WITHOUT_SYSLOG) && !defined(BOOST_LOG_NO_ASIO) && !defined(BOOST_LOG_NO_THREADS)
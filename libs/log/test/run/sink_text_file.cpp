@@ -0,0 +1,434 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   sink_text_file.cpp
+ * \author Andrey Semashev
+ * \date   19.10.2013
+ *
+ * \brief  This header contains tests for the output modes of the text file sink backend.
+ */
+
+#define BOOST_TEST_MODULE sink_text_file
+
+#include <ctime>
+#include <cstddef>
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/keywords/file_name.hpp>
+#include <boost/log/keywords/open_mode.hpp>
+#include <boost/log/keywords/direct_io.hpp>
+#include <boost/log/keywords/durability.hpp>
+#include <boost/log/keywords/output_mode.hpp>
+#include <boost/log/keywords/rotation_size.hpp>
+#include <boost/log/keywords/sync_latency.hpp>
+#include <boost/log/keywords/write_buffer_count.hpp>
+#include <boost/log/keywords/write_buffer_size.hpp>
+#include <boost/log/keywords/write_buffer_latency.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_file_backend.hpp>
+#if !defined(BOOST_LOG_NO_THREADS)
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#endif
+#include "consume_records.hpp"
+#include "temp_files.hpp"
+
+namespace logging = boost::log;
+namespace sinks = logging::sinks;
+namespace expr = logging::expressions;
+namespace keywords = logging::keywords;
+namespace fs = boost::filesystem;
+
+namespace {
+
+typedef sinks::synchronous_sink< sinks::text_file_backend > sync_sink;
+
+//! Creates the sink that writes messages to the backend
+template< typename SinkT >
+boost::shared_ptr< SinkT > make_sink(boost::shared_ptr< sinks::text_file_backend > const& backend)
+{
+    boost::shared_ptr< SinkT > sink = boost::make_shared< SinkT >(backend);
+    sink->set_formatter(expr::stream << expr::smessage);
+    return sink;
+}
+
+//! Reads the files of the "test_%N.log" pattern in the order of their numbers
+std::string read_numbered_files(fs::path const& dir, unsigned int& file_count)
+{
+    std::string contents;
+    for (file_count = 0; fs::exists(dir / ("test_" + boost::lexical_cast< std::string >(file_count) + ".log")); ++file_count)
+        contents += read_file(dir / ("test_" + boost::lexical_cast< std::string >(file_count) + ".log"));
+    return contents;
+}
+
+} // namespace
+
+// The test checks that the records are accumulated in the write buffer and written when the buffer is full or flushed
+BOOST_AUTO_TEST_CASE(write_buffer)
+{
+    temp_directory dir;
+    const fs::path file_name = dir.m_Path / "test.log";
+
+    boost::shared_ptr< sinks::text_file_backend > backend = boost::make_shared< sinks::text_file_backend >(
+        keywords::file_name = file_name,
+        keywords::write_buffer_size = 1024u);
+    boost::shared_ptr< sync_sink > sink = make_sink< sync_sink >(backend);
+
+    // The records fit into the buffer
+    std::string expected = consume_records(*sink, 10u);
+    BOOST_CHECK(read_file(file_name).empty());
+
+    sinks::text_file_backend::write_buffer_statistics stats = backend->get_write_buffer_statistics();
+    BOOST_CHECK_EQUAL(stats.capacity, 1024u);
+    BOOST_CHECK_EQUAL(stats.size, expected.size());
+    BOOST_CHECK_EQUAL(stats.write_count, 0u);
+
+    // The buffer overflows
+    expected += consume_records(*sink, 200u, "more ");
+    stats = backend->get_write_buffer_statistics();
+    BOOST_CHECK_GT(stats.size_triggered_write_count, 0u);
+    BOOST_CHECK_EQUAL(read_file(file_name), expected.substr(0, static_cast< std::size_t >(stats.written_characters)));
+
+    backend->flush();
+    BOOST_CHECK_EQUAL(read_file(file_name), expected);
+    BOOST_CHECK_EQUAL(backend->get_write_buffer_statistics().size, 0u);
+}
+
+// The test checks that the records are written in the asynchronous output mode, either asynchronously or through the synchronous fallback
+BOOST_AUTO_TEST_CASE(async_output)
+{
+    temp_directory dir;
+    const fs::path file_name = dir.m_Path / "test.log";
+
+    boost::shared_ptr< sinks::text_file_backend > backend = boost::make_shared< sinks::text_file_backend >(
+        keywords::file_name = file_name,
+        keywords::output_mode = sinks::file::async_output,
+        keywords::write_buffer_size = 4096u,
+        keywords::write_buffer_count = 2u);
+    boost::shared_ptr< sync_sink > sink = make_sink< sync_sink >(backend);
+
+    // The records span many buffers, so that the backend has to wait for the buffers to be written
+    std::string expected = consume_records(*sink, 10000u);
+    backend->flush();
+    BOOST_CHECK_EQUAL(read_file(file_name), expected);
+
+    // Records written after flushing are appended
+    expected += consume_records(*sink, 10u, "after flush ");
+    backend->flush();
+    BOOST_CHECK_EQUAL(read_file(file_name), expected);
+}
+
+// The test checks that rotation completes the pending writes and that direct I/O is ignored if not supported
+BOOST_AUTO_TEST_CASE(async_output_rotation)
+{
+    temp_directory dir;
+
+    boost::shared_ptr< sinks::text_file_backend > backend = boost::make_shared< sinks::text_file_backend >(
+        keywords::file_name = dir.m_Path / "test_%N.log",
+        keywords::output_mode = sinks::file::async_output,
+        keywords::direct_io = true,
+        keywords::rotation_size = 100000u);
+    boost::shared_ptr< sync_sink > sink = make_sink< sync_sink >(backend);
+    const std::string expected = consume_records(*sink, 20000u);
+    sink.reset();
+    backend.reset();
+
+    unsigned int file_count = 0;
+    const std::string written = read_numbered_files(dir.m_Path, file_count);
+    for (unsigned int i = 0; i < file_count; ++i)
+        BOOST_CHECK_LE(fs::file_size(dir.m_Path / ("test_" + boost::lexical_cast< std::string >(i) + ".log")), 100000u + 64u);
+
+    BOOST_CHECK_GT(file_count, 1u);
+    BOOST_CHECK(written == expected);
+}
+
+// The test checks that the memory mapped file is truncated to the written size when closed
+BOOST_AUTO_TEST_CASE(mapped_output)
+{
+    temp_directory dir;
+    const fs::path file_name = dir.m_Path / "test.log";
+
+    boost::shared_ptr< sinks::text_file_backend > backend = boost::make_shared< sinks::text_file_backend >(
+        keywords::file_name = file_name,
+        keywords::output_mode = sinks::file::mapped_output,
+        keywords::rotation_size = 1024u * 1024u);
+    boost::shared_ptr< sync_sink > sink = make_sink< sync_sink >(backend);
+    const std::string expected = consume_records(*sink, 1000u);
+    backend->flush();
+
+    // The records are visible in the file while it is open, followed by the preallocated space
+    const std::string file_contents = read_file(file_name);
+    BOOST_CHECK_GE(file_contents.size(), expected.size());
+    BOOST_CHECK(file_contents.compare(0, expected.size(), expected) == 0);
+
+    sink.reset();
+    backend.reset();
+
+    BOOST_CHECK_EQUAL(fs::file_size(file_name), static_cast< boost::uintmax_t >(expected.size()));
+    BOOST_CHECK(read_file(file_name) == expected);
+}
+
+#if !defined(BOOST_WINDOWS)
+
+// The test checks that appending to a file left preallocated by a crashed process skips the preallocated space
+BOOST_AUTO_TEST_CASE(mapped_output_append)
+{
+    temp_directory dir;
+    const fs::path file_name = dir.m_Path / "test.log";
+
+    // Emulate a file that was not truncated after writing
+    const std::string previous = "previous run\n";
+    {
+        std::ofstream file(file_name.string().c_str(), std::ios_base::out | std::ios_base::binary);
+        file << previous << std::string(100000u, '\0');
+    }
+
+    boost::shared_ptr< sinks::text_file_backend > backend = boost::make_shared< sinks::text_file_backend >(
+        keywords::file_name = file_name,
+        keywords::open_mode = std::ios_base::out | std::ios_base::app,
+        keywords::output_mode = sinks::file::mapped_output,
+        keywords::rotation_size = 1024u * 1024u);
+    boost::shared_ptr< sync_sink > sink = make_sink< sync_sink >(backend);
+    const std::string expected = previous + consume_records(*sink, 10u);
+    sink.reset();
+    backend.reset();
+
+    BOOST_CHECK(read_file(file_name) == expected);
+}
+
+#endif // !defined(BOOST_WINDOWS)
+
+// The test checks that in the flush durability mode every record is written to the file, bypassing the write buffer
+BOOST_AUTO_TEST_CASE(flush_durability)
+{
+    temp_directory dir;
+    const fs::path file_name = dir.m_Path / "test.log";
+
+    boost::shared_ptr< sinks::text_file_backend > backend = boost::make_shared< sinks::text_file_backend >(
+        keywords::file_name = file_name,
+        keywords::write_buffer_size = 65536u,
+        keywords::durability = sinks::file::flush_durability);
+    boost::shared_ptr< sync_sink > sink = make_sink< sync_sink >(backend);
+
+    std::string expected;
+    for (unsigned int i = 0; i < 10u; ++i)
+    {
+        expected += consume_records(*sink, 1u);
+        BOOST_CHECK_EQUAL(read_file(file_name), expected);
+    }
+
+    // The records are buffered again after the durability level is lowered
+    backend->set_durability(sinks::file::no_durability);
+    const std::string buffered = consume_records(*sink, 1u, "buffered ");
+    BOOST_CHECK_EQUAL(read_file(file_name), expected);
+    backend->flush();
+    BOOST_CHECK_EQUAL(read_file(file_name), expected + buffered);
+}
+
+#if !defined(BOOST_LOG_NO_THREADS)
+
+namespace {
+
+typedef sinks::asynchronous_sink< sinks::text_file_backend > async_sink;
+
+//! Passes records tagged with the thread index to the sink
+void consume_thread_records(sync_sink& sink, unsigned int thread_index, unsigned int count)
+{
+    consume_records(sink, count, "thread " + boost::lexical_cast< std::string >(thread_index) + " record ");
+}
+
+} // namespace
+
+// The test checks that concurrently written records are committed in the sync durability mode, including across file rotation
+BOOST_AUTO_TEST_CASE(sync_durability)
+{
+    temp_directory dir;
+
+    boost::shared_ptr< sinks::text_file_backend > backend = boost::make_shared< sinks::text_file_backend >(
+        keywords::file_name = dir.m_Path / "test_%N.log",
+        keywords::rotation_size = 4096u,
+        keywords::durability = sinks::file::sync_durability,
+        keywords::sync_latency = boost::posix_time::milliseconds(1));
+    boost::shared_ptr< sync_sink > sink = make_sink< sync_sink >(backend);
+
+    boost::thread_group group;
+    for (unsigned int i = 0; i < 4u; ++i)
+        group.create_thread(boost::bind(&consume_thread_records, boost::ref(*sink), i, 200u));
+    group.join_all();
+
+    // Nothing is left to commit
+    backend->commit();
+    sink.reset();
+    backend.reset();
+
+    unsigned int file_count = 0;
+    const std::string written = read_numbered_files(dir.m_Path, file_count);
+
+    // Every record of every thread is written exactly once
+    for (unsigned int i = 0; i < 4u; ++i)
+    {
+        for (unsigned int j = 0; j < 200u; ++j)
+        {
+            const std::string record = "thread " + boost::lexical_cast< std::string >(i) + " record " + boost::lexical_cast< std::string >(j) + "\n";
+            const std::string::size_type pos = written.find(record);
+            BOOST_REQUIRE(pos != std::string::npos);
+            BOOST_CHECK(written.find(record, pos + 1u) == std::string::npos);
+        }
+    }
+    BOOST_CHECK_EQUAL(std::count(written.begin(), written.end(), '\n'), 4 * 200);
+}
+
+// The test checks that the write buffer latency is enforced when records are written
+BOOST_AUTO_TEST_CASE(write_buffer_latency)
+{
+    temp_directory dir;
+    const fs::path file_name = dir.m_Path / "test.log";
+
+    boost::shared_ptr< sinks::text_file_backend > backend = boost::make_shared< sinks::text_file_backend >(
+        keywords::file_name = file_name,
+        keywords::write_buffer_size = 65536u,
+        keywords::write_buffer_latency = boost::posix_time::milliseconds(10));
+    boost::shared_ptr< sync_sink > sink = make_sink< sync_sink >(backend);
+
+    std::string expected = consume_records(*sink, 1u);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    // The deadline has been reached, the buffer is written along with the record
+    expected += consume_records(*sink, 1u, "late ");
+
+    BOOST_CHECK_EQUAL(read_file(file_name), expected);
+    BOOST_CHECK_EQUAL(backend->get_write_buffer_statistics().deadline_triggered_write_count, 1u);
+}
+
+// The test checks that the write buffer is written when the asynchronous frontend becomes idle
+BOOST_AUTO_TEST_CASE(write_buffer_idle)
+{
+    temp_directory dir;
+    const fs::path file_name = dir.m_Path / "test.log";
+
+    boost::shared_ptr< sinks::text_file_backend > backend = boost::make_shared< sinks::text_file_backend >(
+        keywords::file_name = file_name,
+        keywords::write_buffer_size = 65536u,
+        keywords::write_buffer_latency = boost::posix_time::seconds(60));
+    boost::shared_ptr< async_sink > sink = make_sink< async_sink >(backend);
+    const std::string expected = consume_records(*sink, 100u);
+
+    // No records follow, the buffer is written as soon as the frontend drains its queue
+    for (unsigned int i = 0; i < 500u && read_file(file_name) != expected; ++i)
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+
+    BOOST_CHECK_EQUAL(read_file(file_name), expected);
+    BOOST_CHECK_GT(backend->get_write_buffer_statistics().idle_triggered_write_count, 0u);
+    sink->stop();
+}
+
+// The test checks that the interval rotation predicate starts the interval on the first call and fires once the interval has passed
+BOOST_AUTO_TEST_CASE(rotation_at_time_interval)
+{
+    sinks::file::rotation_at_time_interval predicate(boost::posix_time::seconds(1));
+    BOOST_CHECK(!predicate());
+    BOOST_CHECK(!predicate());
+
+    // The predicate uses the system clock with one second precision
+    bool rotated = false;
+    for (unsigned int i = 0; i < 300u && !rotated; ++i)
+    {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+        rotated = predicate();
+    }
+    BOOST_CHECK(rotated);
+
+    // The next interval starts when the predicate fires
+    BOOST_CHECK(!predicate());
+}
+
+#if !defined(BOOST_WINDOWS)
+
+namespace {
+
+//! Sets the time zone for the duration of the test and restores the original one on destruction
+struct time_zone_guard
+{
+    bool m_HadTZ;
+    std::string m_OldTZ;
+
+    explicit time_zone_guard(std::string const& tz) : m_HadTZ(std::getenv("TZ") != NULL)
+    {
+        if (m_HadTZ)
+            m_OldTZ = std::getenv("TZ");
+        setenv("TZ", tz.c_str(), 1);
+        tzset();
+    }
+    ~time_zone_guard()
+    {
+        if (m_HadTZ)
+            setenv("TZ", m_OldTZ.c_str(), 1);
+        else
+            unsetenv("TZ");
+        tzset();
+    }
+};
+
+//! Formats the time of day in the "hh:mm:ss" format of the POSIX TZ rules
+std::string format_time_of_day(long seconds)
+{
+    std::ostringstream strm;
+    strm << seconds / 3600 << ':' << (seconds / 60) % 60 << ':' << seconds % 60;
+    return strm.str();
+}
+
+} // namespace
+
+// The test checks that the time point rotation predicate fires at the specified local time when the DST starts before the rotation
+BOOST_AUTO_TEST_CASE(rotation_at_time_point_dst)
+{
+    // The DST starts a few seconds from now, the local time before that matches UTC
+    const std::time_t now = std::time(NULL);
+    std::tm utc_tm = *std::gmtime(&now);
+    const long time_of_day = utc_tm.tm_hour * 3600L + utc_tm.tm_min * 60L + utc_tm.tm_sec;
+    if (time_of_day < 60L || time_of_day > 22L * 3600L || utc_tm.tm_yday >= 364)
+    {
+        BOOST_TEST_MESSAGE("The test is skipped because the DST rule would wrap around the end of the day or the year");
+        return;
+    }
+    const long dst_start = time_of_day + 3L;
+
+    std::ostringstream tz;
+    tz << "XST0XDT-1," << utc_tm.tm_yday << '/' << format_time_of_day(dst_start) << ',' << (utc_tm.tm_yday + 1) << "/0";
+    time_zone_guard guard(tz.str());
+
+    // Rotate shortly after the DST starts, the local time of the rotation is one hour ahead of UTC
+    const long rotation_time = dst_start + 3600L + 2L;
+    sinks::file::rotation_at_time_point predicate(
+        static_cast< unsigned char >(rotation_time / 3600), static_cast< unsigned char >((rotation_time / 60) % 60), static_cast< unsigned char >(rotation_time % 60));
+    BOOST_CHECK(!predicate());
+
+    bool rotated = false;
+    for (unsigned int i = 0; i < 1000u && !rotated; ++i)
+    {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+        rotated = predicate();
+    }
+    BOOST_CHECK(rotated);
+    BOOST_CHECK(!predicate());
+}
+
+#endif // !defined(BOOST_WINDOWS)
+
+#endif // !defined(BOOST_LOG_NO_THREADS)
@@ -0,0 +1,185 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   sink_text_multifile.cpp
+ * \author Andrey Semashev
+ * \date   19.10.2013
+ *
+ * \brief  This header contains tests for the open files management of the text multi-file sink backend.
+ */
+
+#define BOOST_TEST_MODULE sink_text_multifile
+
+#include <ctime>
+#include <string>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include <boost/log/exceptions.hpp>
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/attributes/value_extraction.hpp>
+#include <boost/log/sinks/text_multifile_backend.hpp>
+#if !defined(BOOST_LOG_NO_THREADS)
+#include <boost/thread/thread.hpp>
+#endif
+#include "consume_records.hpp"
+#include "temp_files.hpp"
+
+namespace logging = boost::log;
+namespace sinks = logging::sinks;
+namespace fs = boost::filesystem;
+
+namespace {
+
+//! Composes the file name from the record message
+fs::path compose_file_name(fs::path const& dir, logging::record_view const& rec)
+{
+    return dir / (logging::extract_or_throw< std::string >("Message", rec) + ".log");
+}
+
+//! The fixture provides the backend that writes every record to the file named after the record message
+struct multifile_fixture
+{
+    temp_directory m_Dir;
+    sinks::text_multifile_backend m_Backend;
+
+    multifile_fixture()
+    {
+        m_Backend.set_file_name_composer(boost::bind(&compose_file_name, boost::cref(m_Dir.m_Path), _1));
+    }
+
+    //! Writes the message to the file named after it
+    void write(std::string const& message)
+    {
+        m_Backend.consume(make_message_record_view(message), message);
+    }
+
+    //! Returns the contents of the file named after the message. The files that are kept open are not flushed, so their contents are not written yet.
+    std::string contents(std::string const& message) const
+    {
+        return read_file(m_Dir.m_Path / (message + ".log"));
+    }
+};
+
+#if !defined(BOOST_LOG_NO_THREADS)
+
+//! Waits until the system clock, which has one second precision, advances by at least the specified number of seconds
+void wait_seconds(std::time_t seconds)
+{
+    const std::time_t start = std::time(NULL);
+    while (std::time(NULL) - start <= seconds)
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+}
+
+#endif // !defined(BOOST_LOG_NO_THREADS)
+
+} // namespace
+
+// The test checks that the least recently used file is closed when the open files limit is reached
+BOOST_FIXTURE_TEST_CASE(lru_eviction, multifile_fixture)
+{
+    m_Backend.set_max_open_files(2u);
+    write("a");
+    write("b");
+    BOOST_CHECK_EQUAL(contents("a"), "");
+    BOOST_CHECK_EQUAL(contents("b"), "");
+
+    write("c");
+    BOOST_CHECK_EQUAL(contents("a"), "a\n");
+    BOOST_CHECK_EQUAL(contents("b"), "");
+
+    // Writing to "b" makes "c" the least recently used file
+    write("b");
+    write("a");
+    BOOST_CHECK_EQUAL(contents("c"), "c\n");
+    BOOST_CHECK_EQUAL(contents("b"), "");
+
+    // Reducing the limit closes the least recently used files
+    m_Backend.set_max_open_files(1u);
+    BOOST_CHECK_EQUAL(contents("b"), "b\nb\n");
+    BOOST_CHECK_EQUAL(contents("a"), "a\n");
+}
+
+// The test checks that different names of the same file share one open file
+BOOST_FIXTURE_TEST_CASE(equivalent_names, multifile_fixture)
+{
+    // With a single open file, writing to a different file would flush the previous one
+    m_Backend.set_max_open_files(1u);
+    write("x");
+    write("./x");
+    write("sub/../x");
+    BOOST_CHECK_EQUAL(contents("x"), "");
+
+    m_Backend.set_max_open_files(0u);
+    BOOST_CHECK_EQUAL(contents("x"), "x\n./x\nsub/../x\n");
+}
+
+#if !defined(BOOST_LOG_NO_THREADS)
+
+// The test checks that the files are closed once they have not been written to for the idle timeout
+BOOST_FIXTURE_TEST_CASE(idle_timeout, multifile_fixture)
+{
+    m_Backend.set_max_open_files(10u);
+
+    // Start at the beginning of a second, so that the clock does not advance before the checks
+    wait_seconds(0);
+
+    // The files written before the timeout is set are not considered idle
+    write("a");
+    m_Backend.set_idle_timeout(boost::posix_time::seconds(1));
+    write("b");
+    BOOST_CHECK_EQUAL(contents("a"), "");
+    BOOST_CHECK_EQUAL(contents("b"), "");
+
+    wait_seconds(1);
+    write("c");
+    BOOST_CHECK_EQUAL(contents("a"), "a\n");
+    BOOST_CHECK_EQUAL(contents("b"), "b\n");
+    BOOST_CHECK_EQUAL(contents("c"), "");
+
+    // Flushing also closes the idle files
+    wait_seconds(1);
+    m_Backend.flush();
+    BOOST_CHECK_EQUAL(contents("c"), "c\n");
+    write("c");
+    BOOST_CHECK_EQUAL(contents("c"), "c\n");
+}
+
+#endif // !defined(BOOST_LOG_NO_THREADS)
+
+// The test checks that invalid idle timeouts are rejected
+BOOST_FIXTURE_TEST_CASE(invalid_idle_timeout, multifile_fixture)
+{
+    BOOST_CHECK_THROW(m_Backend.set_idle_timeout(boost::posix_time::seconds(0)), logging::setup_error);
+    BOOST_CHECK_THROW(m_Backend.set_idle_timeout(boost::posix_time::seconds(-1)), logging::setup_error);
+    BOOST_CHECK_NO_THROW(m_Backend.set_idle_timeout(boost::posix_time::milliseconds(100)));
+    BOOST_CHECK_NO_THROW(m_Backend.set_idle_timeout());
+}
+
+// The test checks that flushing writes the buffered data of all open files
+BOOST_FIXTURE_TEST_CASE(flush, multifile_fixture)
+{
+    m_Backend.set_max_open_files(10u);
+    write("a");
+    write("b");
+    write("a");
+    BOOST_CHECK_EQUAL(contents("a"), "");
+    BOOST_CHECK_EQUAL(contents("b"), "");
+
+    m_Backend.flush();
+    BOOST_CHECK_EQUAL(contents("a"), "a\na\n");
+    BOOST_CHECK_EQUAL(contents("b"), "b\n");
+
+    // The files are kept open after flushing
+    write("b");
+    BOOST_CHECK_EQUAL(contents("b"), "b\n");
+    m_Backend.flush();
+    BOOST_CHECK_EQUAL(contents("b"), "b\nb\n");
+}
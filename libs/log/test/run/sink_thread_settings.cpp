@@ -0,0 +1,171 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   sink_thread_settings.cpp
+ * \author Andrey Semashev
+ * \date   19.10.2013
+ *
+ * \brief  This header contains tests for the settings of the record feeding threads.
+ */
+
+#define BOOST_TEST_MODULE sink_thread_settings
+
+#include <boost/log/detail/config.hpp>
+
+#if !defined(BOOST_LOG_NO_THREADS)
+
+#include <string>
+#include <vector>
+#include <boost/test/included/unit_test.hpp>
+#include <boost/log/core/core.hpp>
+#include <boost/log/exceptions.hpp>
+#include <boost/log/sinks/thread_settings.hpp>
+#include <boost/log/utility/setup/settings.hpp>
+#include <boost/log/utility/setup/from_settings.hpp>
+
+#if defined(__linux__)
+#include <fstream>
+#include <boost/thread/thread.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/filesystem/operations.hpp>
+#endif
+
+namespace logging = boost::log;
+namespace sinks = logging::sinks;
+
+namespace {
+
+//! Parses the CPU list and returns the resulting CPU numbers
+std::vector< unsigned int > parse_cpus(const char* cpus)
+{
+    sinks::thread_settings settings;
+    settings.set_cpu_affinity(cpus);
+    return settings.cpu_affinity();
+}
+
+#if defined(__linux__)
+
+//! Reads a line from the file, returns an empty string if the file cannot be read
+std::string read_line(boost::filesystem::path const& file)
+{
+    std::string line;
+    std::ifstream strm(file.string().c_str());
+    std::getline(strm, line);
+    return line;
+}
+
+//! Returns the directory of the thread of the current process that has the specified name, or an empty path if there is no such thread
+boost::filesystem::path find_thread(std::string const& name)
+{
+    boost::filesystem::directory_iterator it("/proc/self/task"), end;
+    for (; it != end; ++it)
+    {
+        if (read_line(it->path() / "comm") == name)
+            return it->path();
+    }
+    return boost::filesystem::path();
+}
+
+#endif // defined(__linux__)
+
+} // namespace
+
+// The test checks that CPU lists with numbers and ranges are parsed
+BOOST_AUTO_TEST_CASE(cpu_list_parsing)
+{
+    const unsigned int expected[] = { 0u, 1u, 2u, 3u, 8u };
+    std::vector< unsigned int > cpus = parse_cpus("0-3,8");
+    BOOST_CHECK_EQUAL_COLLECTIONS(cpus.begin(), cpus.end(), expected, expected + sizeof(expected) / sizeof(*expected));
+
+    const unsigned int expected_spaces[] = { 1u, 2u, 5u };
+    cpus = parse_cpus(" 1 , 2-2,\t5 ");
+    BOOST_CHECK_EQUAL_COLLECTIONS(cpus.begin(), cpus.end(), expected_spaces, expected_spaces + sizeof(expected_spaces) / sizeof(*expected_spaces));
+
+    BOOST_CHECK(parse_cpus("").empty());
+    BOOST_CHECK(parse_cpus("  ").empty());
+}
+
+// The test checks that malformed CPU lists are rejected and the previously set CPUs are preserved
+BOOST_AUTO_TEST_CASE(cpu_list_malformed)
+{
+    const char* const malformed[] = { "a", "-1", "1-", "3-1", "1,", ",1", "1,,2", "1;2", "1 2", "1-2-3" };
+    for (unsigned int i = 0; i < sizeof(malformed) / sizeof(*malformed); ++i)
+    {
+        BOOST_TEST_CHECKPOINT("CPU list: \"" << malformed[i] << "\"");
+        BOOST_CHECK_THROW(parse_cpus(malformed[i]), logging::invalid_value);
+    }
+
+    sinks::thread_settings settings;
+    settings.set_cpu_affinity("1");
+    BOOST_CHECK_THROW(settings.set_cpu_affinity("2,x"), logging::invalid_value);
+    BOOST_REQUIRE_EQUAL(settings.cpu_affinity().size(), 1u);
+    BOOST_CHECK_EQUAL(settings.cpu_affinity()[0], 1u);
+}
+
+// The test checks that CPU numbers exceeding the limit of the system API are rejected
+BOOST_AUTO_TEST_CASE(cpu_list_out_of_range)
+{
+    BOOST_CHECK_THROW(parse_cpus("1000000"), logging::invalid_value);
+    BOOST_CHECK_THROW(parse_cpus("0-1000000"), logging::invalid_value);
+    BOOST_CHECK_THROW(parse_cpus("0,1000000"), logging::invalid_value);
+    // The number does not fit into unsigned int
+    BOOST_CHECK_THROW(parse_cpus("99999999999999999999"), logging::invalid_value);
+}
+
+// The test checks that the thread settings of asynchronous sinks are read from the settings and invalid values are rejected
+BOOST_AUTO_TEST_CASE(settings_keys)
+{
+    logging::settings setts;
+    setts["Sinks.Async.Destination"] = "Console";
+    setts["Sinks.Async.Asynchronous"] = "true";
+    setts["Sinks.Async.SchedulingPolicy"] = "Batch";
+    setts["Sinks.Async.Nice"] = "5";
+    setts["Sinks.Async.ThreadName"] = "log_settings_ts";
+    logging::init_from_settings(setts);
+
+#if defined(__linux__)
+    // The settings are applied by the feeding thread upon starting
+    boost::filesystem::path thread_dir;
+    for (unsigned int i = 0; i < 1000u && thread_dir.empty(); ++i)
+    {
+        thread_dir = find_thread("log_settings_ts");
+        if (thread_dir.empty())
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+    BOOST_REQUIRE(!thread_dir.empty());
+
+    // The nice value is the 19th field of the stat file, the thread name in the second field contains no spaces
+    std::string stat = read_line(thread_dir / "stat");
+    std::string::size_type pos = 0;
+    for (unsigned int i = 0; i < 18u && pos != std::string::npos; ++i)
+    {
+        pos = stat.find(' ', pos);
+        if (pos != std::string::npos)
+            ++pos;
+    }
+    BOOST_REQUIRE(pos != std::string::npos);
+    BOOST_CHECK_EQUAL(stat.substr(pos, stat.find(' ', pos) - pos), "5");
+#endif // defined(__linux__)
+
+    logging::core::get()->remove_all_sinks();
+
+    logging::settings invalid_cpus(setts);
+    invalid_cpus["Sinks.Async.CPUAffinity"] = "0-";
+    BOOST_CHECK_THROW(logging::init_from_settings(invalid_cpus), logging::invalid_value);
+
+    logging::settings invalid_policy(setts);
+    invalid_policy["Sinks.Async.SchedulingPolicy"] = "Realtime";
+    BOOST_CHECK_THROW(logging::init_from_settings(invalid_policy), logging::invalid_value);
+
+    logging::settings invalid_nice(setts);
+    invalid_nice["Sinks.Async.Nice"] = "low";
+    BOOST_CHECK_THROW(logging::init_from_settings(invalid_nice), logging::invalid_value);
+
+    logging::core::get()->remove_all_sinks();
+}
+
+#endif // !defined(BOOST_LOG_NO_THREADS)
@@ -0,0 +1,249 @@
+/*
+ *          Copyright Andrey Semashev 2007 - 2013.
+ * Distributed under the Boost Software License, Version 1.0.
+ *    (See accompanying file LICENSE_1_0.txt or copy at
+ *          http://www.boost.org/LICENSE_1_0.txt)
+ */
+/*!
+ * \file   util_threadsafe_queue.cpp
+ * \author Andrey Semashev
+ * \date   19.10.2013
+ *
+ * \brief  This header contains tests for the thread-safe queue used by the asynchronous sink frontend.
+ */
+
+#define BOOST_TEST_MODULE util_threadsafe_queue
+
+#include <boost/log/detail/config.hpp>
+
+#if !defined(BOOST_LOG_NO_THREADS)
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/log/detail/threadsafe_queue.hpp>
+
+namespace aux = boost::log::aux;
+
+namespace {
+
+enum config
+{
+    PRODUCER_COUNT = 4,
+    ELEMENT_COUNT = 20000,
+    MAX_RECYCLED_NODES = 1024
+};
+
+//! The allocator counts the nodes that are currently allocated
+template< typename T >
+class counting_allocator :
+    public std::allocator< T >
+{
+public:
+    template< typename U >
+    struct rebind
+    {
+        typedef counting_allocator< U > other;
+    };
+
+    static unsigned int m_Allocations;
+    static unsigned int m_Allocated;
+
+public:
+    counting_allocator() {}
+    template< typename U >
+    counting_allocator(counting_allocator< U > const&) {}
+
+    T* allocate(std::size_t n, const void* = 0)
+    {
+        ++m_Allocations;
+        m_Allocated += static_cast< unsigned int >(n);
+        return std::allocator< T >::allocate(n);
+    }
+    void deallocate(T* p, std::size_t n)
+    {
+        m_Allocated -= static_cast< unsigned int >(n);
+        std::allocator< T >::deallocate(p, n);
+    }
+};
+
+template< typename T >
+unsigned int counting_allocator< T >::m_Allocations = 0;
+template< typename T >
+unsigned int counting_allocator< T >::m_Allocated = 0;
+
+typedef aux::threadsafe_queue< unsigned int, counting_allocator< void > > queue_t;
+typedef aux::threadsafe_queue_types< unsigned int, counting_allocator< void > >::allocator_type node_allocator_t;
+
+//! Pushes the numbered elements, the producer index is stored in the low bits of the elements
+void produce(queue_t& queue, unsigned int producer)
+{
+    for (unsigned int i = 0; i < ELEMENT_COUNT; ++i)
+        queue.push(i * PRODUCER_COUNT + producer);
+}
+
+//! Pushes a single element, which fills the cache of the calling thread with the recycled nodes
+void push_one(queue_t& queue)
+{
+    queue.push(0u);
+}
+
+} // namespace
+
+// The test checks that the elements pushed by several threads are popped in the order each thread pushed them
+BOOST_AUTO_TEST_CASE(concurrent_push_pop)
+{
+    {
+        queue_t queue;
+        boost::thread_group producers;
+        for (unsigned int i = 0; i < PRODUCER_COUNT; ++i)
+            producers.create_thread(boost::bind(&produce, boost::ref(queue), i));
+
+        std::vector< unsigned int > next(PRODUCER_COUNT, 0u);
+        unsigned int popped = 0, value = 0;
+        while (popped < PRODUCER_COUNT * ELEMENT_COUNT)
+        {
+            if (queue.try_pop(value))
+            {
+                const unsigned int producer = value % PRODUCER_COUNT;
+                BOOST_REQUIRE_EQUAL(value / PRODUCER_COUNT, next[producer]);
+                ++next[producer];
+                ++popped;
+            }
+            else
+                boost::this_thread::yield();
+        }
+
+        producers.join_all();
+        BOOST_CHECK(queue.unsafe_empty());
+        BOOST_CHECK(!queue.try_pop(value));
+    }
+
+    BOOST_CHECK_EQUAL(node_allocator_t::m_Allocated, 0u);
+}
+
+// The test checks that the queue reuses the nodes of the popped elements instead of allocating new ones
+BOOST_AUTO_TEST_CASE(node_recycling)
+{
+    {
+        queue_t queue;
+        unsigned int value = 0;
+
+        // In the steady state a single node is circulating between the consumer and the producer
+        queue.push(0u);
+        BOOST_REQUIRE(queue.try_pop(value));
+        const unsigned int allocations = node_allocator_t::m_Allocations;
+        for (unsigned int i = 0; i < ELEMENT_COUNT; ++i)
+        {
+            queue.push(i);
+            BOOST_REQUIRE(queue.try_pop(value));
+            BOOST_REQUIRE_EQUAL(value, i);
+        }
+        BOOST_CHECK_EQUAL(node_allocator_t::m_Allocations, allocations);
+
+        // The nodes of a burst are taken by the producer all at once when its cache is exhausted
+        for (unsigned int i = 0; i < 100u; ++i)
+            queue.push(i);
+        for (unsigned int i = 0; i < 100u; ++i)
+            BOOST_REQUIRE(queue.try_pop(value));
+        const unsigned int burst_allocations = node_allocator_t::m_Allocations;
+        for (unsigned int i = 0; i < 100u; ++i)
+            queue.push(i);
+        BOOST_CHECK_EQUAL(node_allocator_t::m_Allocations, burst_allocations);
+        for (unsigned int i = 0; i < 100u; ++i)
+        {
+            BOOST_REQUIRE(queue.try_pop(value));
+            BOOST_CHECK_EQUAL(value, i);
+        }
+    }
+
+    BOOST_CHECK_EQUAL(node_allocator_t::m_Allocated, 0u);
+}
+
+// The test checks that the number of the recycled nodes is limited, so that the memory is released after a burst of elements
+BOOST_AUTO_TEST_CASE(recycled_nodes_limit)
+{
+    {
+        queue_t queue;
+        for (unsigned int i = 0; i < 4u * MAX_RECYCLED_NODES; ++i)
+            queue.push(i);
+        // All elements plus the dummy node
+        BOOST_CHECK_EQUAL(node_allocator_t::m_Allocated, 4u * MAX_RECYCLED_NODES + 1u);
+
+        unsigned int value = 0;
+        while (queue.try_pop(value)) {}
+        // The recycled nodes plus the dummy node
+        BOOST_CHECK_EQUAL(node_allocator_t::m_Allocated, static_cast< unsigned int >(MAX_RECYCLED_NODES) + 1u);
+
+        // The recycled nodes are used again for the next burst
+        const unsigned int allocations = node_allocator_t::m_Allocations;
+        for (unsigned int i = 0; i < MAX_RECYCLED_NODES; ++i)
+            queue.push(i);
+        BOOST_CHECK_EQUAL(node_allocator_t::m_Allocations, allocations);
+        queue.push(0u);
+        BOOST_CHECK_EQUAL(node_allocator_t::m_Allocations, allocations + 1u);
+    }
+
+    // The destructor releases the elements left in the queue and the cached nodes
+    BOOST_CHECK_EQUAL(node_allocator_t::m_Allocated, 0u);
+}
+
+// The test checks that the nodes cached by a producer thread are reused after the thread terminates
+BOOST_AUTO_TEST_CASE(terminated_producer_cache)
+{
+    {
+        queue_t queue;
+        unsigned int value = 0;
+        for (unsigned int i = 0; i < 100u; ++i)
+            queue.push(i);
+        while (queue.try_pop(value)) {}
+
+        // The producer takes all recycled nodes to its cache and uses only one of them
+        boost::thread producer(boost::bind(&push_one, boost::ref(queue)));
+        producer.join();
+        BOOST_REQUIRE(queue.try_pop(value));
+
+        // The rest of the nodes are returned when the producer terminates
+        const unsigned int allocations = node_allocator_t::m_Allocations;
+        for (unsigned int i = 0; i < 100u; ++i)
+            queue.push(i);
+        BOOST_CHECK_EQUAL(node_allocator_t::m_Allocations, allocations);
+    }
+
+    BOOST_CHECK_EQUAL(node_allocator_t::m_Allocated, 0u);
+}
+
+// The test checks that the destructor releases the nodes cached by the producer threads that are still running
+BOOST_AUTO_TEST_CASE(running_producer_cache)
+{
+    {
+        queue_t queue;
+        unsigned int value = 0;
+        for (unsigned int i = 0; i < 100u; ++i)
+            queue.push(i);
+        while (queue.try_pop(value)) {}
+
+        // The current thread is the producer that keeps the cached nodes
+        queue.push(0u);
+        BOOST_REQUIRE(queue.try_pop(value));
+    }
+
+    BOOST_CHECK_EQUAL(node_allocator_t::m_Allocated, 0u);
+
+    // A new queue that may occupy the same memory does not pick up the cache of the destroyed one
+    {
+        queue_t queue;
+        unsigned int value = 0;
+        queue.push(1u);
+        BOOST_REQUIRE(queue.try_pop(value));
+        BOOST_CHECK_EQUAL(value, 1u);
+    }
+
+    BOOST_CHECK_EQUAL(node_allocator_t::m_Allocated, 0u);
+}
+
+#endif // !defined(BOOST_LOG_NO_THREADS)